@@ -0,0 +1,689 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#define CL_API_CAPTURE_NO_REDIRECT
+#include "apiCapture.h"
+#include "errorHelpers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CaptureRecord {
+public:
+    explicit CaptureRecord(CaptureOp op): op(op) {}
+
+    CaptureRecord &u32(cl_uint value) { return raw(&value, sizeof(value)); }
+    CaptureRecord &u64(cl_ulong value) { return raw(&value, sizeof(value)); }
+    CaptureRecord &blob(const void *data, size_t size)
+    {
+        u64(size);
+        return raw(data, size);
+    }
+    CaptureRecord &str(const char *value)
+    {
+        return blob(value, value ? strlen(value) : 0);
+    }
+
+    CaptureOp op;
+    std::vector<char> payload;
+
+private:
+    CaptureRecord &raw(const void *data, size_t size)
+    {
+        if (size)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            payload.insert(payload.end(), bytes, bytes + size);
+        }
+        return *this;
+    }
+};
+
+struct CaptureState
+{
+    std::mutex mutex;
+    FILE *file = nullptr;
+    cl_uint next_id = 1;
+    std::map<const void *, cl_uint> ids;
+    // Objects the replay cannot recreate
+    std::set<const void *> unsupported;
+};
+
+const char *capture_dir()
+{
+    static const char *dir = getenv("CL_CONFORMANCE_CAPTURE_DIR");
+    return dir;
+}
+
+CaptureState &capture_state()
+{
+    static CaptureState state;
+    return state;
+}
+
+// All helpers below must be called with the state mutex held
+
+bool capturing(CaptureState &state) { return state.file != nullptr; }
+
+cl_uint assign_id(CaptureState &state, const void *object)
+{
+    state.unsupported.erase(object);
+    cl_uint id = state.next_id++;
+    state.ids[object] = id;
+    return id;
+}
+
+cl_uint find_id(CaptureState &state, const void *object)
+{
+    auto it = state.ids.find(object);
+    return it == state.ids.end() ? 0 : it->second;
+}
+
+void write_record(CaptureState &state, const CaptureRecord &record)
+{
+    cl_ulong size = record.payload.size();
+    fwrite(&record.op, sizeof(record.op), 1, state.file);
+    fwrite(&size, sizeof(size), 1, state.file);
+    if (size) fwrite(record.payload.data(), 1, size, state.file);
+}
+
+// Queues are never created through the wrappers, they get an id on first use
+cl_uint queue_id(CaptureState &state, cl_command_queue queue)
+{
+    cl_uint id = find_id(state, queue);
+    return id ? id : assign_id(state, queue);
+}
+
+void track_unsupported(const void *object)
+{
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state) || object == nullptr) return;
+
+    state.ids.erase(object);
+    state.unsupported.insert(object);
+}
+
+// Drops a destroyed object, so that a new object the driver creates at the
+// same address is not taken for it
+void forget(const void *object)
+{
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.ids.erase(object);
+    state.unsupported.erase(object);
+}
+
+void CL_CALLBACK mem_destroyed(cl_mem mem, void *) { forget(mem); }
+
+// Memory objects are also released by the typeWrappers and by code that is
+// not redirected, so their destruction is observed with a callback instead
+// of a clReleaseMemObject wrapper. Must be called without the state mutex.
+void watch_mem(cl_mem mem)
+{
+    if (mem != nullptr && capture_enabled())
+        clSetMemObjectDestructorCallback(mem, mem_destroyed, nullptr);
+}
+
+// Calls release and forgets the object if that dropped its last reference
+template <typename Object, typename GetRefCount, typename Release>
+cl_int release_tracked(Object object, GetRefCount get_ref_count,
+                       Release release)
+{
+    cl_uint ref_count = 0;
+    bool last = capture_enabled() && get_ref_count(object, &ref_count)
+        && ref_count == 1;
+    cl_int error = release(object);
+    if (last && error == CL_SUCCESS) forget(object);
+    return error;
+}
+
+}
+
+bool capture_enabled() { return capture_dir() != nullptr; }
+
+void capture_begin_test(const char *name)
+{
+    if (!capture_enabled()) return;
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::string file_name = std::string(capture_dir()) + "/" + name + ".clcap";
+    state.file = fopen(file_name.c_str(), "wb");
+    if (state.file == nullptr)
+    {
+        log_error("ERROR: Failed to open '%s' for writing capture.\n",
+                  file_name.c_str());
+        return;
+    }
+    fwrite(&capture_file_magic, sizeof(capture_file_magic), 1, state.file);
+    fwrite(&capture_file_version, sizeof(capture_file_version), 1,
+           state.file);
+    write_record(state, CaptureRecord(CAPTURE_TEST_NAME).str(name));
+}
+
+void capture_end_test()
+{
+    if (!capture_enabled()) return;
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.file) fclose(state.file);
+    state.file = nullptr;
+    state.next_id = 1;
+    state.ids.clear();
+    state.unsupported.clear();
+}
+
+cl_program capture_clCreateProgramWithSource(cl_context context,
+                                             cl_uint count,
+                                             const char **strings,
+                                             const size_t *lengths,
+                                             cl_int *errcode_ret)
+{
+    cl_int error;
+    cl_program program =
+        clCreateProgramWithSource(context, count, strings, lengths, &error);
+    if (errcode_ret) *errcode_ret = error;
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state) || program == nullptr) return program;
+
+    CaptureRecord record(CAPTURE_CREATE_PROGRAM_WITH_SOURCE);
+    record.u32(assign_id(state, program)).u32(count);
+    for (cl_uint i = 0; i < count; i++)
+    {
+        if (lengths && lengths[i])
+            record.blob(strings[i], lengths[i]);
+        else
+            record.str(strings[i]);
+    }
+    write_record(state, record);
+    return program;
+}
+
+cl_program capture_clCreateProgramWithIL(cl_context context, const void *il,
+                                         size_t length, cl_int *errcode_ret)
+{
+    cl_int error;
+    cl_program program = clCreateProgramWithIL(context, il, length, &error);
+    if (errcode_ret) *errcode_ret = error;
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state) || program == nullptr) return program;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_CREATE_PROGRAM_WITH_IL)
+                     .u32(assign_id(state, program))
+                     .blob(il, length));
+    return program;
+}
+
+cl_int capture_clBuildProgram(cl_program program, cl_uint num_devices,
+                              const cl_device_id *device_list,
+                              const char *options,
+                              void(CL_CALLBACK *pfn_notify)(cl_program,
+                                                            void *),
+                              void *user_data)
+{
+    cl_int error = clBuildProgram(program, num_devices, device_list, options,
+                                  pfn_notify, user_data);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint id = find_id(state, program);
+    if (!capturing(state) || id == 0) return error;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_BUILD_PROGRAM).u32(id).str(options));
+    return error;
+}
+
+cl_kernel capture_clCreateKernel(cl_program program, const char *kernel_name,
+                                 cl_int *errcode_ret)
+{
+    cl_int error;
+    cl_kernel kernel = clCreateKernel(program, kernel_name, &error);
+    if (errcode_ret) *errcode_ret = error;
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state) || kernel == nullptr) return kernel;
+
+    // Kernels from programs created from a binary are not captured
+    cl_uint program_id = find_id(state, program);
+    if (program_id == 0)
+    {
+        state.ids.erase(kernel);
+        return kernel;
+    }
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_CREATE_KERNEL)
+                     .u32(assign_id(state, kernel))
+                     .u32(program_id)
+                     .str(kernel_name));
+    return kernel;
+}
+
+namespace {
+
+void record_create_buffer(cl_mem buffer, cl_mem_flags flags, size_t size,
+                          void *host_ptr)
+{
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state) || buffer == nullptr) return;
+
+    // Host pointer contents are snapshotted at creation, the replay always
+    // copies them into a buffer it owns
+    bool has_data = host_ptr != nullptr
+        && (flags & (CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR));
+    cl_mem_flags replay_flags = flags
+        & ~(CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR
+            | CL_MEM_ALLOC_HOST_PTR);
+    write_record(state,
+                 CaptureRecord(CAPTURE_CREATE_BUFFER)
+                     .u32(assign_id(state, buffer))
+                     .u64(replay_flags)
+                     .u64(size)
+                     .blob(host_ptr, has_data ? size : 0));
+}
+
+}
+
+cl_mem capture_clCreateBuffer(cl_context context, cl_mem_flags flags,
+                              size_t size, void *host_ptr,
+                              cl_int *errcode_ret)
+{
+    cl_mem buffer =
+        clCreateBuffer(context, flags, size, host_ptr, errcode_ret);
+    record_create_buffer(buffer, flags, size, host_ptr);
+    watch_mem(buffer);
+    return buffer;
+}
+
+cl_mem capture_clCreateBufferWithProperties(cl_context context,
+                                            const cl_mem_properties *properties,
+                                            cl_mem_flags flags, size_t size,
+                                            void *host_ptr,
+                                            cl_int *errcode_ret)
+{
+    cl_mem buffer = clCreateBufferWithProperties(context, properties, flags,
+                                                 size, host_ptr, errcode_ret);
+    // The replay creates buffers without properties
+    if (properties == nullptr || properties[0] == 0)
+        record_create_buffer(buffer, flags, size, host_ptr);
+    else
+        track_unsupported(buffer);
+    watch_mem(buffer);
+    return buffer;
+}
+
+cl_mem capture_clCreateSubBuffer(cl_mem buffer, cl_mem_flags flags,
+                                 cl_buffer_create_type buffer_create_type,
+                                 const void *buffer_create_info,
+                                 cl_int *errcode_ret)
+{
+    cl_mem sub_buffer = clCreateSubBuffer(buffer, flags, buffer_create_type,
+                                          buffer_create_info, errcode_ret);
+    track_unsupported(sub_buffer);
+    watch_mem(sub_buffer);
+    return sub_buffer;
+}
+
+cl_mem capture_clCreateImage(cl_context context, cl_mem_flags flags,
+                             const cl_image_format *image_format,
+                             const cl_image_desc *image_desc, void *host_ptr,
+                             cl_int *errcode_ret)
+{
+    cl_mem image = clCreateImage(context, flags, image_format, image_desc,
+                                 host_ptr, errcode_ret);
+    track_unsupported(image);
+    watch_mem(image);
+    return image;
+}
+
+cl_mem capture_clCreateImageWithProperties(
+    cl_context context, const cl_mem_properties *properties,
+    cl_mem_flags flags, const cl_image_format *image_format,
+    const cl_image_desc *image_desc, void *host_ptr, cl_int *errcode_ret)
+{
+    cl_mem image =
+        clCreateImageWithProperties(context, properties, flags, image_format,
+                                    image_desc, host_ptr, errcode_ret);
+    track_unsupported(image);
+    watch_mem(image);
+    return image;
+}
+
+cl_mem capture_clCreateImage2D(cl_context context, cl_mem_flags flags,
+                               const cl_image_format *image_format,
+                               size_t image_width, size_t image_height,
+                               size_t image_row_pitch, void *host_ptr,
+                               cl_int *errcode_ret)
+{
+    cl_mem image =
+        clCreateImage2D(context, flags, image_format, image_width,
+                        image_height, image_row_pitch, host_ptr, errcode_ret);
+    track_unsupported(image);
+    watch_mem(image);
+    return image;
+}
+
+cl_mem capture_clCreateImage3D(cl_context context, cl_mem_flags flags,
+                               const cl_image_format *image_format,
+                               size_t image_width, size_t image_height,
+                               size_t image_depth, size_t image_row_pitch,
+                               size_t image_slice_pitch, void *host_ptr,
+                               cl_int *errcode_ret)
+{
+    cl_mem image = clCreateImage3D(context, flags, image_format, image_width,
+                                   image_height, image_depth, image_row_pitch,
+                                   image_slice_pitch, host_ptr, errcode_ret);
+    track_unsupported(image);
+    watch_mem(image);
+    return image;
+}
+
+cl_mem capture_clCreatePipe(cl_context context, cl_mem_flags flags,
+                            cl_uint pipe_packet_size, cl_uint pipe_max_packets,
+                            const cl_pipe_properties *properties,
+                            cl_int *errcode_ret)
+{
+    cl_mem pipe = clCreatePipe(context, flags, pipe_packet_size,
+                               pipe_max_packets, properties, errcode_ret);
+    track_unsupported(pipe);
+    watch_mem(pipe);
+    return pipe;
+}
+
+cl_sampler capture_clCreateSampler(cl_context context,
+                                   cl_bool normalized_coords,
+                                   cl_addressing_mode addressing_mode,
+                                   cl_filter_mode filter_mode,
+                                   cl_int *errcode_ret)
+{
+    cl_sampler sampler = clCreateSampler(context, normalized_coords,
+                                         addressing_mode, filter_mode,
+                                         errcode_ret);
+    track_unsupported(sampler);
+    return sampler;
+}
+
+cl_sampler
+capture_clCreateSamplerWithProperties(cl_context context,
+                                      const cl_sampler_properties *properties,
+                                      cl_int *errcode_ret)
+{
+    cl_sampler sampler =
+        clCreateSamplerWithProperties(context, properties, errcode_ret);
+    track_unsupported(sampler);
+    return sampler;
+}
+
+cl_int capture_clSetKernelArg(cl_kernel kernel, cl_uint arg_index,
+                              size_t arg_size, const void *arg_value)
+{
+    cl_int error = clSetKernelArg(kernel, arg_index, arg_size, arg_value);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint kernel_id = find_id(state, kernel);
+    if (!capturing(state) || kernel_id == 0 || error != CL_SUCCESS)
+        return error;
+
+    if (arg_value == nullptr)
+    {
+        write_record(state,
+                     CaptureRecord(CAPTURE_SET_ARG_LOCAL)
+                         .u32(kernel_id)
+                         .u32(arg_index)
+                         .u64(arg_size));
+        return error;
+    }
+
+    if (arg_size == sizeof(cl_mem))
+    {
+        cl_mem mem = *static_cast<const cl_mem *>(arg_value);
+        if (state.unsupported.count(mem))
+        {
+            write_record(state,
+                         CaptureRecord(CAPTURE_SET_ARG_UNSUPPORTED)
+                             .u32(kernel_id)
+                             .u32(arg_index));
+            return error;
+        }
+
+        cl_uint mem_id = find_id(state, mem);
+        if (mem_id != 0 || mem == nullptr)
+        {
+            write_record(state,
+                         CaptureRecord(CAPTURE_SET_ARG_MEM)
+                             .u32(kernel_id)
+                             .u32(arg_index)
+                             .u32(mem_id));
+            return error;
+        }
+    }
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_SET_ARG_VALUE)
+                     .u32(kernel_id)
+                     .u32(arg_index)
+                     .blob(arg_value, arg_size));
+    return error;
+}
+
+cl_int capture_clEnqueueWriteBuffer(cl_command_queue queue, cl_mem buffer,
+                                    cl_bool blocking_write, size_t offset,
+                                    size_t size, const void *ptr,
+                                    cl_uint num_events_in_wait_list,
+                                    const cl_event *event_wait_list,
+                                    cl_event *event)
+{
+    {
+        // The data is recorded before the enqueue, as a non-blocking write
+        // lets the caller modify it as soon as the command completes
+        CaptureState &state = capture_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        cl_uint mem_id = find_id(state, buffer);
+        if (capturing(state) && mem_id != 0)
+            write_record(state,
+                         CaptureRecord(CAPTURE_WRITE_BUFFER)
+                             .u32(queue_id(state, queue))
+                             .u32(mem_id)
+                             .u64(offset)
+                             .blob(ptr, size));
+    }
+    return clEnqueueWriteBuffer(queue, buffer, blocking_write, offset, size,
+                                ptr, num_events_in_wait_list, event_wait_list,
+                                event);
+}
+
+cl_int capture_clEnqueueReadBuffer(cl_command_queue queue, cl_mem buffer,
+                                   cl_bool blocking_read, size_t offset,
+                                   size_t size, void *ptr,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event)
+{
+    cl_int error = clEnqueueReadBuffer(queue, buffer, blocking_read, offset,
+                                       size, ptr, num_events_in_wait_list,
+                                       event_wait_list, event);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint mem_id = find_id(state, buffer);
+    if (!capturing(state) || mem_id == 0) return error;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_READ_BUFFER)
+                     .u32(queue_id(state, queue))
+                     .u32(mem_id)
+                     .u64(offset)
+                     .u64(size));
+    return error;
+}
+
+cl_int capture_clEnqueueFillBuffer(cl_command_queue queue, cl_mem buffer,
+                                   const void *pattern, size_t pattern_size,
+                                   size_t offset, size_t size,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event)
+{
+    cl_int error = clEnqueueFillBuffer(queue, buffer, pattern, pattern_size,
+                                       offset, size, num_events_in_wait_list,
+                                       event_wait_list, event);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint mem_id = find_id(state, buffer);
+    if (!capturing(state) || mem_id == 0) return error;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_FILL_BUFFER)
+                     .u32(queue_id(state, queue))
+                     .u32(mem_id)
+                     .blob(pattern, pattern_size)
+                     .u64(offset)
+                     .u64(size));
+    return error;
+}
+
+cl_int capture_clEnqueueCopyBuffer(cl_command_queue queue, cl_mem src_buffer,
+                                   cl_mem dst_buffer, size_t src_offset,
+                                   size_t dst_offset, size_t size,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event)
+{
+    cl_int error = clEnqueueCopyBuffer(queue, src_buffer, dst_buffer,
+                                       src_offset, dst_offset, size,
+                                       num_events_in_wait_list,
+                                       event_wait_list, event);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint src_id = find_id(state, src_buffer);
+    cl_uint dst_id = find_id(state, dst_buffer);
+    if (!capturing(state) || src_id == 0 || dst_id == 0) return error;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_COPY_BUFFER)
+                     .u32(queue_id(state, queue))
+                     .u32(src_id)
+                     .u32(dst_id)
+                     .u64(src_offset)
+                     .u64(dst_offset)
+                     .u64(size));
+    return error;
+}
+
+cl_int capture_clEnqueueNDRangeKernel(cl_command_queue queue, cl_kernel kernel,
+                                      cl_uint work_dim,
+                                      const size_t *global_work_offset,
+                                      const size_t *global_work_size,
+                                      const size_t *local_work_size,
+                                      cl_uint num_events_in_wait_list,
+                                      const cl_event *event_wait_list,
+                                      cl_event *event)
+{
+    cl_int error = clEnqueueNDRangeKernel(
+        queue, kernel, work_dim, global_work_offset, global_work_size,
+        local_work_size, num_events_in_wait_list, event_wait_list, event);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    cl_uint kernel_id = find_id(state, kernel);
+    if (!capturing(state) || kernel_id == 0 || error != CL_SUCCESS)
+        return error;
+
+    cl_uint flags = 0;
+    if (global_work_offset) flags |= CAPTURE_HAS_OFFSET;
+    if (local_work_size) flags |= CAPTURE_HAS_LOCAL_SIZE;
+
+    CaptureRecord record(CAPTURE_ND_RANGE_KERNEL);
+    record.u32(queue_id(state, queue)).u32(kernel_id).u32(work_dim).u32(flags);
+    for (cl_uint i = 0; global_work_offset && i < work_dim; i++)
+        record.u64(global_work_offset[i]);
+    for (cl_uint i = 0; i < work_dim; i++) record.u64(global_work_size[i]);
+    for (cl_uint i = 0; local_work_size && i < work_dim; i++)
+        record.u64(local_work_size[i]);
+    write_record(state, record);
+    return error;
+}
+
+cl_int capture_clFinish(cl_command_queue queue)
+{
+    cl_int error = clFinish(queue);
+
+    CaptureState &state = capture_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!capturing(state)) return error;
+
+    write_record(state,
+                 CaptureRecord(CAPTURE_FINISH).u32(queue_id(state, queue)));
+    return error;
+}
+
+cl_int capture_clReleaseKernel(cl_kernel kernel)
+{
+    return release_tracked(
+        kernel,
+        [](cl_kernel k, cl_uint *count) {
+            return clGetKernelInfo(k, CL_KERNEL_REFERENCE_COUNT,
+                                   sizeof(*count), count, nullptr)
+                == CL_SUCCESS;
+        },
+        [](cl_kernel k) { return clReleaseKernel(k); });
+}
+
+cl_int capture_clReleaseProgram(cl_program program)
+{
+    return release_tracked(
+        program,
+        [](cl_program p, cl_uint *count) {
+            return clGetProgramInfo(p, CL_PROGRAM_REFERENCE_COUNT,
+                                    sizeof(*count), count, nullptr)
+                == CL_SUCCESS;
+        },
+        [](cl_program p) { return clReleaseProgram(p); });
+}
+
+cl_int capture_clReleaseSampler(cl_sampler sampler)
+{
+    return release_tracked(
+        sampler,
+        [](cl_sampler s, cl_uint *count) {
+            return clGetSamplerInfo(s, CL_SAMPLER_REFERENCE_COUNT,
+                                    sizeof(*count), count, nullptr)
+                == CL_SUCCESS;
+        },
+        [](cl_sampler s) { return clReleaseSampler(s); });
+}
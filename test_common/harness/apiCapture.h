@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _apiCapture_h
+#define _apiCapture_h
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+// OpenCL API capture for replaying a single test in isolation.
+//
+// When the tree is configured with -DAPI_CAPTURE=ON, every file including
+// testHarness.h has the entry points below redirected to capture_* wrappers.
+// Setting CL_CONFORMANCE_CAPTURE_DIR at run time then writes the calls made by
+// each test, with kernel sources, argument values and buffer contents, to
+// <dir>/<test name>.clcap. test_api_replay (test_conformance/api_replay)
+// re-executes such a file and reports how long each kernel took, so a slow
+// test can be compared across drivers without re-running the suite.
+//
+// Only buffers, programs built from source or IL, kernels and the buffer and
+// kernel enqueues below are captured. Images, sub-buffers, samplers, pipes and
+// buffers created with properties are only tracked so that kernel arguments
+// referring to them can be marked; the replay skips launches of kernels with
+// such arguments. Objects are forgotten when they are destroyed: memory
+// objects through a destructor callback, kernels, programs and samplers when
+// a redirected clRelease* call drops their last reference. SVM pointers and
+// host writes through mapped or CL_MEM_USE_HOST_PTR memory are not seen.
+
+// File layout: capture_file_magic, capture_file_version, then a sequence of
+// records made of a one byte CaptureOp, a 64-bit payload size and the payload.
+// Objects are referred to by 32-bit ids starting at 1, integers are stored in
+// host byte order and blobs and strings are prefixed by their 64-bit size.
+const cl_uint capture_file_magic = 0x50414343; // "CCAP"
+const cl_uint capture_file_version = 2;
+
+enum CaptureOp : cl_uchar
+{
+    // string test name
+    CAPTURE_TEST_NAME = 1,
+    // u32 program, u32 count, count x string source
+    CAPTURE_CREATE_PROGRAM_WITH_SOURCE = 2,
+    // u32 program, blob il
+    CAPTURE_CREATE_PROGRAM_WITH_IL = 3,
+    // u32 program, string options
+    CAPTURE_BUILD_PROGRAM = 4,
+    // u32 kernel, u32 program, string name
+    CAPTURE_CREATE_KERNEL = 5,
+    // u32 mem, u64 flags, u64 size, blob initial contents (may be empty)
+    CAPTURE_CREATE_BUFFER = 6,
+    // u32 kernel, u32 index, blob value
+    CAPTURE_SET_ARG_VALUE = 7,
+    // u32 kernel, u32 index, u32 mem (0 for NULL)
+    CAPTURE_SET_ARG_MEM = 8,
+    // u32 kernel, u32 index, u64 size
+    CAPTURE_SET_ARG_LOCAL = 9,
+    // u32 queue, u32 mem, u64 offset, blob data
+    CAPTURE_WRITE_BUFFER = 10,
+    // u32 queue, u32 mem, u64 offset, u64 size
+    CAPTURE_READ_BUFFER = 11,
+    // u32 queue, u32 mem, blob pattern, u64 offset, u64 size
+    CAPTURE_FILL_BUFFER = 12,
+    // u32 queue, u32 src, u32 dst, u64 src offset, u64 dst offset, u64 size
+    CAPTURE_COPY_BUFFER = 13,
+    // u32 queue, u32 kernel, u32 work_dim, u32 flags (CaptureNDRangeFlags),
+    // work_dim x u64 offset if present, work_dim x u64 global size,
+    // work_dim x u64 local size if present
+    CAPTURE_ND_RANGE_KERNEL = 14,
+    // u32 queue
+    CAPTURE_FINISH = 15,
+    // u32 kernel, u32 index
+    CAPTURE_SET_ARG_UNSUPPORTED = 16,
+};
+
+enum CaptureNDRangeFlags : cl_uint
+{
+    CAPTURE_HAS_OFFSET = 1,
+    CAPTURE_HAS_LOCAL_SIZE = 2,
+};
+
+bool capture_enabled();
+
+// Called by the harness around each test to open and close its capture file
+void capture_begin_test(const char *name);
+void capture_end_test();
+
+cl_program capture_clCreateProgramWithSource(cl_context context,
+                                             cl_uint count,
+                                             const char **strings,
+                                             const size_t *lengths,
+                                             cl_int *errcode_ret);
+cl_program capture_clCreateProgramWithIL(cl_context context, const void *il,
+                                         size_t length, cl_int *errcode_ret);
+cl_int capture_clBuildProgram(cl_program program, cl_uint num_devices,
+                              const cl_device_id *device_list,
+                              const char *options,
+                              void(CL_CALLBACK *pfn_notify)(cl_program,
+                                                            void *),
+                              void *user_data);
+cl_kernel capture_clCreateKernel(cl_program program, const char *kernel_name,
+                                 cl_int *errcode_ret);
+cl_mem capture_clCreateBuffer(cl_context context, cl_mem_flags flags,
+                              size_t size, void *host_ptr,
+                              cl_int *errcode_ret);
+cl_mem capture_clCreateBufferWithProperties(cl_context context,
+                                            const cl_mem_properties *properties,
+                                            cl_mem_flags flags, size_t size,
+                                            void *host_ptr,
+                                            cl_int *errcode_ret);
+cl_mem capture_clCreateSubBuffer(cl_mem buffer, cl_mem_flags flags,
+                                 cl_buffer_create_type buffer_create_type,
+                                 const void *buffer_create_info,
+                                 cl_int *errcode_ret);
+cl_mem capture_clCreateImage(cl_context context, cl_mem_flags flags,
+                             const cl_image_format *image_format,
+                             const cl_image_desc *image_desc, void *host_ptr,
+                             cl_int *errcode_ret);
+cl_mem capture_clCreateImageWithProperties(
+    cl_context context, const cl_mem_properties *properties,
+    cl_mem_flags flags, const cl_image_format *image_format,
+    const cl_image_desc *image_desc, void *host_ptr, cl_int *errcode_ret);
+cl_mem capture_clCreateImage2D(cl_context context, cl_mem_flags flags,
+                               const cl_image_format *image_format,
+                               size_t image_width, size_t image_height,
+                               size_t image_row_pitch, void *host_ptr,
+                               cl_int *errcode_ret);
+cl_mem capture_clCreateImage3D(cl_context context, cl_mem_flags flags,
+                               const cl_image_format *image_format,
+                               size_t image_width, size_t image_height,
+                               size_t image_depth, size_t image_row_pitch,
+                               size_t image_slice_pitch, void *host_ptr,
+                               cl_int *errcode_ret);
+cl_mem capture_clCreatePipe(cl_context context, cl_mem_flags flags,
+                            cl_uint pipe_packet_size, cl_uint pipe_max_packets,
+                            const cl_pipe_properties *properties,
+                            cl_int *errcode_ret);
+cl_sampler capture_clCreateSampler(cl_context context,
+                                   cl_bool normalized_coords,
+                                   cl_addressing_mode addressing_mode,
+                                   cl_filter_mode filter_mode,
+                                   cl_int *errcode_ret);
+cl_sampler
+capture_clCreateSamplerWithProperties(cl_context context,
+                                      const cl_sampler_properties *properties,
+                                      cl_int *errcode_ret);
+cl_int capture_clSetKernelArg(cl_kernel kernel, cl_uint arg_index,
+                              size_t arg_size, const void *arg_value);
+cl_int capture_clEnqueueWriteBuffer(cl_command_queue queue, cl_mem buffer,
+                                    cl_bool blocking_write, size_t offset,
+                                    size_t size, const void *ptr,
+                                    cl_uint num_events_in_wait_list,
+                                    const cl_event *event_wait_list,
+                                    cl_event *event);
+cl_int capture_clEnqueueReadBuffer(cl_command_queue queue, cl_mem buffer,
+                                   cl_bool blocking_read, size_t offset,
+                                   size_t size, void *ptr,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event);
+cl_int capture_clEnqueueFillBuffer(cl_command_queue queue, cl_mem buffer,
+                                   const void *pattern, size_t pattern_size,
+                                   size_t offset, size_t size,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event);
+cl_int capture_clEnqueueCopyBuffer(cl_command_queue queue, cl_mem src_buffer,
+                                   cl_mem dst_buffer, size_t src_offset,
+                                   size_t dst_offset, size_t size,
+                                   cl_uint num_events_in_wait_list,
+                                   const cl_event *event_wait_list,
+                                   cl_event *event);
+cl_int capture_clEnqueueNDRangeKernel(cl_command_queue queue, cl_kernel kernel,
+                                      cl_uint work_dim,
+                                      const size_t *global_work_offset,
+                                      const size_t *global_work_size,
+                                      const size_t *local_work_size,
+                                      cl_uint num_events_in_wait_list,
+                                      const cl_event *event_wait_list,
+                                      cl_event *event);
+cl_int capture_clFinish(cl_command_queue queue);
+cl_int capture_clReleaseKernel(cl_kernel kernel);
+cl_int capture_clReleaseProgram(cl_program program);
+cl_int capture_clReleaseSampler(cl_sampler sampler);
+
+#if defined(CL_API_CAPTURE) && !defined(CL_API_CAPTURE_NO_REDIRECT)
+#define clCreateProgramWithSource(...)                                         \
+    capture_clCreateProgramWithSource(__VA_ARGS__)
+#define clCreateProgramWithIL(...) capture_clCreateProgramWithIL(__VA_ARGS__)
+#define clBuildProgram(...) capture_clBuildProgram(__VA_ARGS__)
+#define clCreateKernel(...) capture_clCreateKernel(__VA_ARGS__)
+#define clCreateBuffer(...) capture_clCreateBuffer(__VA_ARGS__)
+#define clCreateBufferWithProperties(...)                                      \
+    capture_clCreateBufferWithProperties(__VA_ARGS__)
+#define clCreateSubBuffer(...) capture_clCreateSubBuffer(__VA_ARGS__)
+#define clCreateImage(...) capture_clCreateImage(__VA_ARGS__)
+#define clCreateImageWithProperties(...)                                       \
+    capture_clCreateImageWithProperties(__VA_ARGS__)
+#define clCreateImage2D(...) capture_clCreateImage2D(__VA_ARGS__)
+#define clCreateImage3D(...) capture_clCreateImage3D(__VA_ARGS__)
+#define clCreatePipe(...) capture_clCreatePipe(__VA_ARGS__)
+#define clCreateSampler(...) capture_clCreateSampler(__VA_ARGS__)
+#define clCreateSamplerWithProperties(...)                                     \
+    capture_clCreateSamplerWithProperties(__VA_ARGS__)
+#define clSetKernelArg(...) capture_clSetKernelArg(__VA_ARGS__)
+#define clEnqueueWriteBuffer(...) capture_clEnqueueWriteBuffer(__VA_ARGS__)
+#define clEnqueueReadBuffer(...) capture_clEnqueueReadBuffer(__VA_ARGS__)
+#define clEnqueueFillBuffer(...) capture_clEnqueueFillBuffer(__VA_ARGS__)
+#define clEnqueueCopyBuffer(...) capture_clEnqueueCopyBuffer(__VA_ARGS__)
+#define clEnqueueNDRangeKernel(...) capture_clEnqueueNDRangeKernel(__VA_ARGS__)
+#define clFinish(...) capture_clFinish(__VA_ARGS__)
+#define clReleaseKernel(...) capture_clReleaseKernel(__VA_ARGS__)
+#define clReleaseProgram(...) capture_clReleaseProgram(__VA_ARGS__)
+#define clReleaseSampler(...) capture_clReleaseSampler(__VA_ARGS__)
+#endif
+
+#endif // _apiCapture_h
@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "csvHelpers.h"
+#include "errorHelpers.h"
+
+#include <stdlib.h>
+
+FILE *open_results_csv(const char *env_var, const char *header)
+{
+    const char *file_name = getenv(env_var);
+    if (file_name == NULL) return NULL;
+
+    FILE *file = fopen(file_name, "a");
+    if (file == NULL)
+    {
+        log_error("ERROR: Failed to open '%s' for writing results.\n",
+                  file_name);
+        return NULL;
+    }
+    // Append mode does not define the initial position, so seek to the end
+    // to find out whether the file is new
+    if (fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0)
+        fprintf(file, "%s\n", header);
+    return file;
+}
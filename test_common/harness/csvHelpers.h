@@ -0,0 +1,27 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _csvHelpers_h
+#define _csvHelpers_h
+
+#include <stdio.h>
+
+// Opens the file named by the environment variable env_var for appending
+// benchmark results. The header line is only written when the file is empty,
+// so results from earlier tests and runs are kept. Returns NULL when env_var
+// is not set or the file cannot be opened; the caller closes the file.
+FILE *open_results_csv(const char *env_var, const char *header);
+
+#endif // _csvHelpers_h
@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "deviceVerify.h"
+#include "traceHelpers.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Each work-item compares a strided subset of the region and only touches
+// the summary if it found a mismatch, so a matching region costs no atomics
+const char *verify_kernels_source = R"(
+__kernel void compare_with_pattern(__global const uint *data,
+                                   __global const uint *pattern,
+                                   uint pattern_words, uint first, uint count,
+                                   volatile __global uint *summary)
+{
+    uint mismatches = 0;
+    uint first_mismatch = UINT_MAX;
+    for (uint i = get_global_id(0); i < count; i += get_global_size(0))
+    {
+        if (data[first + i] != pattern[i % pattern_words])
+        {
+            if (mismatches++ == 0) first_mismatch = i;
+        }
+    }
+    if (mismatches)
+    {
+        atomic_add(&summary[0], mismatches);
+        atomic_min(&summary[1], first_mismatch);
+    }
+}
+
+__kernel void compare_with_buffer(__global const uint *data,
+                                  __global const uint *reference,
+                                  uint pattern_words, uint first, uint count,
+                                  volatile __global uint *summary)
+{
+    uint mismatches = 0;
+    uint first_mismatch = UINT_MAX;
+    for (uint i = get_global_id(0); i < count; i += get_global_size(0))
+    {
+        if (data[first + i] != reference[first + i])
+        {
+            if (mismatches++ == 0) first_mismatch = i;
+        }
+    }
+    if (mismatches)
+    {
+        atomic_add(&summary[0], mismatches);
+        atomic_min(&summary[1], first_mismatch);
+    }
+}
+)";
+
+// Upper bound on the number of work-items used for a comparison
+const size_t max_verify_work_items = 65536;
+
+const size_t max_pattern_size = 128;
+
+}
+
+cl_int DeviceVerifier::Init()
+{
+    if (program) return CL_SUCCESS;
+
+    cl_int error = create_single_kernel_helper(context, &program,
+                                               &pattern_kernel, 1,
+                                               &verify_kernels_source,
+                                               "compare_with_pattern");
+    test_error(error, "Unable to create verification kernels");
+
+    buffer_kernel = clCreateKernel(program, "compare_with_buffer", &error);
+    test_error(error, "Unable to create verification kernel");
+
+    summary = clCreateBuffer(context, CL_MEM_READ_WRITE, 2 * sizeof(cl_uint),
+                             nullptr, &error);
+    test_error(error, "Unable to create verification summary buffer");
+    return CL_SUCCESS;
+}
+
+cl_int DeviceVerifier::Run(cl_command_queue queue, cl_kernel kernel,
+                           cl_mem buffer, cl_mem expected,
+                           cl_uint pattern_words, size_t offset, size_t size,
+                           DeviceVerifyResult &result)
+{
+    result = DeviceVerifyResult();
+    if (offset % sizeof(cl_uint) || size % sizeof(cl_uint)
+        || (offset + size) / sizeof(cl_uint) > CL_UINT_MAX)
+        return CL_INVALID_VALUE;
+    if (size == 0) return CL_SUCCESS;
+
+    cl_uint first = static_cast<cl_uint>(offset / sizeof(cl_uint));
+    cl_uint count = static_cast<cl_uint>(size / sizeof(cl_uint));
+
+    const cl_uint initial[2] = { 0, CL_UINT_MAX };
+    cl_int error = trace_enqueue_write_buffer(queue, summary, CL_TRUE, 0,
+                                              sizeof(initial), initial, 0,
+                                              nullptr, nullptr);
+    test_error(error, "Unable to reset verification summary");
+
+    error = clSetKernelArg(kernel, 0, sizeof(buffer), &buffer);
+    error |= clSetKernelArg(kernel, 1, sizeof(expected), &expected);
+    error |= clSetKernelArg(kernel, 2, sizeof(pattern_words), &pattern_words);
+    error |= clSetKernelArg(kernel, 3, sizeof(first), &first);
+    error |= clSetKernelArg(kernel, 4, sizeof(count), &count);
+    error |= clSetKernelArg(kernel, 5, sizeof(summary), &summary);
+    test_error(error, "Unable to set verification kernel arguments");
+
+    size_t global_size = std::min<size_t>(count, max_verify_work_items);
+    clEventWrapper compared;
+    error = trace_enqueue_nd_range_kernel(queue, kernel, 1, nullptr,
+                                          &global_size, nullptr, 0, nullptr,
+                                          &compared);
+    test_error(error, "Unable to enqueue verification kernel");
+
+    cl_uint summary_values[2];
+    error = trace_enqueue_read_buffer(queue, summary, CL_TRUE, 0,
+                                      sizeof(summary_values), summary_values,
+                                      1, &compared, nullptr);
+    test_error(error, "Unable to read verification summary");
+
+    result.mismatches = summary_values[0];
+    result.first_mismatch = summary_values[1];
+    return CL_SUCCESS;
+}
+
+cl_int DeviceVerifier::CompareWithPattern(cl_command_queue queue,
+                                          cl_mem buffer, size_t offset,
+                                          size_t size, const void *pattern,
+                                          size_t pattern_size,
+                                          DeviceVerifyResult &result)
+{
+    if (pattern_size == 0 || pattern_size > max_pattern_size
+        || (pattern_size > 2 && pattern_size % sizeof(cl_uint)))
+        return CL_INVALID_VALUE;
+
+    cl_int error = Init();
+    if (error != CL_SUCCESS) return error;
+
+    // Repeat one and two byte patterns to fill a word
+    size_t words_size = std::max(pattern_size, sizeof(cl_uint));
+    std::vector<cl_uchar> words(words_size);
+    for (size_t i = 0; i < words_size; i += pattern_size)
+        memcpy(&words[i], pattern, pattern_size);
+
+    clMemWrapper pattern_buffer =
+        clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                       words_size, words.data(), &error);
+    test_error(error, "Unable to create verification pattern buffer");
+
+    return Run(queue, pattern_kernel, buffer, pattern_buffer,
+               static_cast<cl_uint>(words_size / sizeof(cl_uint)), offset,
+               size, result);
+}
+
+cl_int DeviceVerifier::CompareWithBuffer(cl_command_queue queue,
+                                         cl_mem buffer, cl_mem reference,
+                                         size_t offset, size_t size,
+                                         DeviceVerifyResult &result)
+{
+    cl_int error = Init();
+    if (error != CL_SUCCESS) return error;
+
+    return Run(queue, buffer_kernel, buffer, reference, 0, offset, size,
+               result);
+}
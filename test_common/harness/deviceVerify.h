@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _deviceVerify_h
+#define _deviceVerify_h
+
+#include "typeWrappers.h"
+
+// Verification of buffer contents on the device. A comparison kernel counts
+// the 32-bit words of a buffer region that differ from a repeating pattern or
+// from the same region of a reference buffer, and only the number of
+// mismatches and the index of the first one are read back. This avoids
+// mapping or reading large buffers that are expected to be correct; when
+// mismatches are found, callers read back the region and compare it on the
+// host to report the individual differences.
+//
+// Offsets and sizes are in bytes and must be multiples of 4, patterns must be
+// 1, 2 or a multiple of 4 bytes up to 128 bytes long, and regions must end
+// within the first 16GB of the buffer; CL_INVALID_VALUE is returned
+// otherwise.
+
+struct DeviceVerifyResult
+{
+    // Number of 32-bit words that differ
+    cl_ulong mismatches = 0;
+    // Index of the first differing word from the start of the region, only
+    // valid if there are mismatches
+    cl_ulong first_mismatch = 0;
+};
+
+class DeviceVerifier {
+public:
+    // The comparison kernels are built on first use
+    explicit DeviceVerifier(cl_context context): context(context) {}
+
+    // Compares the region with pattern, repeated from offset as
+    // clEnqueueFillBuffer would write it
+    cl_int CompareWithPattern(cl_command_queue queue, cl_mem buffer,
+                              size_t offset, size_t size, const void *pattern,
+                              size_t pattern_size, DeviceVerifyResult &result);
+
+    // Compares the region with the same region of reference
+    cl_int CompareWithBuffer(cl_command_queue queue, cl_mem buffer,
+                             cl_mem reference, size_t offset, size_t size,
+                             DeviceVerifyResult &result);
+
+private:
+    cl_int Init();
+    cl_int Run(cl_command_queue queue, cl_kernel kernel, cl_mem buffer,
+               cl_mem expected, cl_uint pattern_words, size_t offset,
+               size_t size, DeviceVerifyResult &result);
+
+    cl_context context;
+    clProgramWrapper program;
+    clKernelWrapper pattern_kernel;
+    clKernelWrapper buffer_kernel;
+    clMemWrapper summary;
+};
+
+#endif // _deviceVerify_h
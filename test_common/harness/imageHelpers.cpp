@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 #include "imageHelpers.h"
+#include "traceHelpers.h"
 #include <limits.h>
 #include <assert.h>
 #if defined(__APPLE__)
@@ -3444,8 +3445,9 @@ int DetectFloatToHalfRoundingMode(
 
         // Run the kernel
         size_t global_work_size = count;
-        err = clEnqueueNDRangeKernel(q, kernel, 1, NULL, &global_work_size,
-                                     NULL, 0, NULL, NULL);
+        err = trace_enqueue_nd_range_kernel(q, kernel, 1, NULL,
+                                            &global_work_size, NULL, 0, NULL,
+                                            NULL);
         if (err)
         {
             log_error("Error: could not enqueue kernel in "
@@ -3461,8 +3463,8 @@ int DetectFloatToHalfRoundingMode(
         memset(outBuf, -1, sizeof(outBuf));
         size_t origin[3] = { 0, 0, 0 };
         size_t region[3] = { count, 1, 1 };
-        err = clEnqueueReadImage(q, outImage, CL_TRUE, origin, region, 0, 0,
-                                 outBuf, 0, NULL, NULL);
+        err = trace_enqueue_read_image(q, outImage, CL_TRUE, origin, region,
+                                       0, 0, outBuf, 0, NULL, NULL);
         if (err)
         {
             log_error("Error: could not read output image in "
@@ -46,21 +46,46 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <mutex>
+#include <vector>
 #include "mt19937.h"
 #include "mingw_compat.h"
 #include "harness/alloc.h"
 
 #ifdef __SSE2__
-#include <mutex>
 #include <emmintrin.h>
 #endif
 
+// The AVX2 loops are compiled for AVX2 whatever the flags of the rest of the
+// harness and are only used when the CPU supports it.
+#if defined(__SSE2__)                                                          \
+    && ((defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))      \
+        || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))))
+#define MT_HAS_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MT_TARGET_AVX2
+#else
+#define MT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 /* Period parameters */
 #define N 624 /* vector code requires multiple of 4 here */
 #define M 397
 #define MATRIX_A (cl_uint)0x9908b0dfUL /* constant vector a */
 #define UPPER_MASK (cl_uint)0x80000000UL /* most significant w-r bits */
 #define LOWER_MASK (cl_uint)0x7fffffffUL /* least significant r bits */
+#define MEXP 19937 /* degree of the characteristic polynomial */
+
+#ifdef MT_HAS_AVX2
+#define MT_ALIGNMENT 32
+#else
+#define MT_ALIGNMENT 16
+#endif
 
 typedef struct _MTdata
 {
@@ -74,7 +99,7 @@ typedef struct _MTdata
 /* initializes mt[N] with a seed */
 MTdata init_genrand(cl_uint s)
 {
-    MTdata r = (MTdata)align_malloc(sizeof(_MTdata), 16);
+    MTdata r = (MTdata)align_malloc(sizeof(_MTdata), MT_ALIGNMENT);
     if (NULL != r)
     {
         cl_uint *mt = r->mt;
@@ -102,11 +127,86 @@ void free_mtdata(MTdata d)
     if (d) align_free(d);
 }
 
-/* generates a random number on [0,0xffffffff]-interval */
-cl_uint genrand_int32(MTdata d)
+/* mag01[x] = x * MATRIX_A  for x=0,1 */
+static const cl_uint mag01[2] = { 0x0UL, MATRIX_A };
+
+#ifdef MT_HAS_AVX2
+/* true when the CPU and the OS support AVX2 */
+static bool use_avx2()
+{
+    static const bool supported = []() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        // OSXSAVE and AVX, and the OS saves the YMM registers
+        if ((info[2] & 0x18000000) != 0x18000000) return false;
+        if ((_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & 0x20) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }();
+    return supported;
+}
+
+/* 8-wide version of the SSE2 refill loop below, for kk from start while
+ * kk + 8 <= end, reading mt[kk + offset].  mt + start must be 32-byte
+ * aligned.  Returns the first kk not done. */
+static MT_TARGET_AVX2 int refill_avx2(cl_uint *mt, int start, int end,
+                                      int offset)
+{
+    const __m256i upper_mask = _mm256_set1_epi32((int)UPPER_MASK);
+    const __m256i lower_mask = _mm256_set1_epi32((int)LOWER_MASK);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i matrix_a = _mm256_set1_epi32((int)MATRIX_A);
+
+    int kk = start;
+    for (; kk + 8 <= end; kk += 8)
+    {
+        __m256i vy = _mm256_or_si256(
+            _mm256_and_si256(_mm256_load_si256((__m256i *)(mt + kk)),
+                             upper_mask),
+            _mm256_and_si256(_mm256_loadu_si256((__m256i *)(mt + kk + 1)),
+                             lower_mask));
+        __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(vy, one), one);
+        __m256i vmag01 = _mm256_and_si256(mask, matrix_a);
+        __m256i vr =
+            _mm256_xor_si256(_mm256_loadu_si256((__m256i *)(mt + kk + offset)),
+                             _mm256_srli_epi32(vy, 1));
+        vr = _mm256_xor_si256(vr, vmag01);
+        _mm256_store_si256((__m256i *)(mt + kk), vr);
+    }
+    return kk;
+}
+
+/* 8-wide version of the SSE2 tempering loop.  Returns the first word not
+ * done. */
+static MT_TARGET_AVX2 int temper_avx2(const cl_uint *mt, cl_uint *cache)
+{
+    const __m256i c0 = _mm256_set1_epi32((int)0x9d2c5680UL);
+    const __m256i c1 = _mm256_set1_epi32((int)0xefc60000UL);
+
+    int kk = 0;
+    for (; kk + 8 <= N; kk += 8)
+    {
+        __m256i vy = _mm256_load_si256((__m256i *)(mt + kk));
+        vy = _mm256_xor_si256(vy, _mm256_srli_epi32(vy, 11));
+        vy = _mm256_xor_si256(vy,
+                              _mm256_and_si256(_mm256_slli_epi32(vy, 7), c0));
+        vy = _mm256_xor_si256(vy,
+                              _mm256_and_si256(_mm256_slli_epi32(vy, 15), c1));
+        vy = _mm256_xor_si256(vy, _mm256_srli_epi32(vy, 18));
+        _mm256_store_si256((__m256i *)(cache + kk), vy);
+    }
+    return kk;
+}
+#endif
+
+/* generates the next N words of the state and, for the vector paths, the
+ * tempered output for them */
+static void genrand_refill(MTdata d)
 {
-    /* mag01[x] = x * MATRIX_A  for x=0,1 */
-    static const cl_uint mag01[2] = { 0x0UL, MATRIX_A };
 #ifdef __SSE2__
     static std::once_flag init_flag;
     static union {
@@ -114,135 +214,447 @@ cl_uint genrand_int32(MTdata d)
         cl_uint s[4];
     } upper_mask, lower_mask, one, matrix_a, c0, c1;
 #endif
-
+#ifdef MT_HAS_AVX2
+    const bool avx2 = use_avx2();
+#endif
 
     cl_uint *mt = d->mt;
     cl_uint y;
+    int kk;
+
+#ifdef __SSE2__
+    auto init_fn = []() {
+        upper_mask.s[0] = upper_mask.s[1] = upper_mask.s[2] = upper_mask.s[3] =
+            UPPER_MASK;
+        lower_mask.s[0] = lower_mask.s[1] = lower_mask.s[2] = lower_mask.s[3] =
+            LOWER_MASK;
+        one.s[0] = one.s[1] = one.s[2] = one.s[3] = 1;
+        matrix_a.s[0] = matrix_a.s[1] = matrix_a.s[2] = matrix_a.s[3] =
+            MATRIX_A;
+        c0.s[0] = c0.s[1] = c0.s[2] = c0.s[3] = (cl_uint)0x9d2c5680UL;
+        c1.s[0] = c1.s[1] = c1.s[2] = c1.s[3] = (cl_uint)0xefc60000UL;
+    };
+    std::call_once(init_flag, init_fn);
+#endif
+
+    kk = 0;
+#ifdef MT_HAS_AVX2
+    if (avx2) kk = refill_avx2(mt, kk, N - M, M);
+#endif
+#ifdef __SSE2__
+    // vector loop
+    for (; kk + 4 <= N - M; kk += 4)
+    {
+        // ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
+        __m128i vy = _mm_or_si128(
+            _mm_and_si128(_mm_load_si128((__m128i *)(mt + kk)), upper_mask.v),
+            _mm_and_si128(_mm_loadu_si128((__m128i *)(mt + kk + 1)),
+                          lower_mask.v));
+
+        // y & 1 ? -1 : 0
+        __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(vy, one.v), one.v);
+        // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
+        __m128i vmag01 = _mm_and_si128(mask, matrix_a.v);
+        // mt[kk+M] ^ (y >> 1)
+        __m128i vr = _mm_xor_si128(_mm_loadu_si128((__m128i *)(mt + kk + M)),
+                                   (__m128i)_mm_srli_epi32(vy, 1));
+        // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
+        vr = _mm_xor_si128(vr, vmag01);
+        _mm_store_si128((__m128i *)(mt + kk), vr);
+    }
+#endif
+    for (; kk < N - M; kk++)
+    {
+        y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
+        mt[kk] = mt[kk + M] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+    }
+
+#ifdef __SSE2__
+    // advance to next aligned location
+    for (; kk < N - 1 && (kk & (MT_ALIGNMENT / sizeof(cl_uint) - 1)); kk++)
+    {
+        y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
+        mt[kk] = mt[kk + (M - N)] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+    }
+
+#ifdef MT_HAS_AVX2
+    if (avx2) kk = refill_avx2(mt, kk, N - 1, M - N);
+#endif
+
+    // vector loop
+    for (; kk + 4 <= N - 1; kk += 4)
+    {
+        __m128i vy = _mm_or_si128(
+            _mm_and_si128(_mm_load_si128((__m128i *)(mt + kk)), upper_mask.v),
+            // ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
+            _mm_and_si128(_mm_loadu_si128((__m128i *)(mt + kk + 1)),
+                          lower_mask.v));
+
+        // y & 1 ? -1 : 0
+        __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(vy, one.v), one.v);
+        // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
+        __m128i vmag01 = _mm_and_si128(mask, matrix_a.v);
+        // mt[kk+M-N] ^ (y >> 1)
+        __m128i vr =
+            _mm_xor_si128(_mm_loadu_si128((__m128i *)(mt + kk + M - N)),
+                          _mm_srli_epi32(vy, 1));
+        // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
+        vr = _mm_xor_si128(vr, vmag01);
+        _mm_store_si128((__m128i *)(mt + kk), vr);
+    }
+#endif
+
+    for (; kk < N - 1; kk++)
+    {
+        y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
+        mt[kk] = mt[kk + (M - N)] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+    }
+    y = (cl_uint)((mt[N - 1] & UPPER_MASK) | (mt[0] & LOWER_MASK));
+    mt[N - 1] = mt[M - 1] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+
+#ifdef __SSE2__
+    // Do the tempering ahead of time in vector code
+    kk = 0;
+#ifdef MT_HAS_AVX2
+    if (avx2) kk = temper_avx2(mt, d->cache);
+#endif
+    for (; kk + 4 <= N; kk += 4)
+    {
+        // y = mt[k];
+        __m128i vy = _mm_load_si128((__m128i *)(mt + kk));
+        // y ^= (y >> 11);
+        vy = _mm_xor_si128(vy, _mm_srli_epi32(vy, 11));
+        // y ^= (y << 7) & (cl_uint) 0x9d2c5680UL;
+        vy = _mm_xor_si128(vy, _mm_and_si128(_mm_slli_epi32(vy, 7), c0.v));
+        // y ^= (y << 15) & (cl_uint) 0xefc60000UL;
+        vy = _mm_xor_si128(vy, _mm_and_si128(_mm_slli_epi32(vy, 15), c1.v));
+        // y ^= (y >> 18);
+        vy = _mm_xor_si128(vy, _mm_srli_epi32(vy, 18));
+        _mm_store_si128((__m128i *)(d->cache + kk), vy);
+    }
+#endif
+
+    d->mti = 0;
+}
+
+static inline cl_uint temper(cl_uint y)
+{
+    y ^= (y >> 11);
+    y ^= (y << 7) & (cl_uint)0x9d2c5680UL;
+    y ^= (y << 15) & (cl_uint)0xefc60000UL;
+    y ^= (y >> 18);
+    return y;
+}
 
+/* generates a random number on [0,0xffffffff]-interval */
+cl_uint genrand_int32(MTdata d)
+{
     if (d->mti == N)
     { /* generate N words at one time */
-        int kk;
+        genrand_refill(d);
+    }
+#ifdef __SSE2__
+    return d->cache[d->mti++];
+#else
+    return temper(d->mt[d->mti++]);
+#endif
+}
 
+void genrand_fill(MTdata d, cl_uint *out, size_t count)
+{
+    while (count)
+    {
+        if (d->mti == N) genrand_refill(d);
+
+        size_t n = (size_t)(N - d->mti);
+        if (n > count) n = count;
 #ifdef __SSE2__
-        auto init_fn = []() {
-            upper_mask.s[0] = upper_mask.s[1] = upper_mask.s[2] =
-                upper_mask.s[3] = UPPER_MASK;
-            lower_mask.s[0] = lower_mask.s[1] = lower_mask.s[2] =
-                lower_mask.s[3] = LOWER_MASK;
-            one.s[0] = one.s[1] = one.s[2] = one.s[3] = 1;
-            matrix_a.s[0] = matrix_a.s[1] = matrix_a.s[2] = matrix_a.s[3] =
-                MATRIX_A;
-            c0.s[0] = c0.s[1] = c0.s[2] = c0.s[3] = (cl_uint)0x9d2c5680UL;
-            c1.s[0] = c1.s[1] = c1.s[2] = c1.s[3] = (cl_uint)0xefc60000UL;
-        };
-        std::call_once(init_flag, init_fn);
+        memcpy(out, d->cache + d->mti, n * sizeof(cl_uint));
+#else
+        for (size_t i = 0; i < n; i++) out[i] = temper(d->mt[d->mti + i]);
+#endif
+        d->mti += (cl_int)n;
+        out += n;
+        count -= n;
+    }
+}
+
+/*
+ *  Jump-ahead.
+ *
+ *  Advancing the generator by J values is the linear map T^J on the 19937 bit
+ *  state, where T is one step of the recurrence.  With phi the characteristic
+ *  polynomial of T, T^J = p(T) for p = x^J mod phi, which is evaluated on the
+ *  state with Horner's rule (Haramoto et al., "Efficient Jump Ahead for
+ *  F2-Linear Random Number Generators", 2008).  phi is recovered once with
+ *  Berlekamp-Massey and the polynomials for J = 2^n are cached.
+ */
+namespace {
+
+/* polynomial over GF(2); coefficient of x^i is bit (i % 64) of word i / 64 */
+typedef std::vector<cl_ulong> Poly;
+
+const size_t kPolyWords = MEXP / 64 + 1;
+
+inline int poly_bit(const Poly &p, size_t i)
+{
+    return (int)((p[i / 64] >> (i % 64)) & 1);
+}
+
+/* dst ^= src * x^shift */
+void poly_xor_shifted(Poly &dst, const Poly &src, size_t srcBits, size_t shift)
+{
+    size_t words = (srcBits + 63) / 64;
+    size_t wordShift = shift / 64;
+    unsigned bitShift = (unsigned)(shift % 64);
+    for (size_t i = 0; i < words; i++)
+    {
+        cl_ulong w = src[i];
+        if (0 == w) continue;
+        dst[i + wordShift] ^= w << bitShift;
+        if (bitShift && i + wordShift + 1 < dst.size())
+            dst[i + wordShift + 1] ^= w >> (64 - bitShift);
+    }
+}
+
+/* state of the recurrence advanced one word at a time, logical word j is
+ * s[(i + j) % N] */
+struct StepState
+{
+    cl_uint s[N];
+    int i;
+};
+
+inline void step(StepState &st)
+{
+    int i = st.i;
+    int i1 = i + 1 < N ? i + 1 : 0;
+    int im = i + M < N ? i + M : i + M - N;
+    cl_uint y = (st.s[i] & UPPER_MASK) | (st.s[i1] & LOWER_MASK);
+    st.s[i] = st.s[im] ^ (y >> 1) ^ mag01[y & 1];
+    st.i = i1;
+}
+
+#ifdef MT_HAS_AVX2
+/* 8-wide part of xor_words.  Returns the first word not done. */
+MT_TARGET_AVX2 int xor_words_avx2(char *d, const char *s, int n)
+{
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256i a = _mm256_loadu_si256((__m256i *)(d + 4 * j));
+        __m256i b = _mm256_loadu_si256((__m256i *)(s + 4 * j));
+        __m256i v = _mm256_xor_si256(a, b);
+        _mm256_storeu_si256((__m256i *)(d + 4 * j), v);
+    }
+    return j;
+}
 #endif
 
-        kk = 0;
+/* dst[j] ^= src[j] for the n 32-bit words at dst and src.  The words are
+ * accessed through memcpy as polynomials pass their 64-bit words here. */
+inline void xor_words(void *dst, const void *src, int n)
+{
+    char *d = (char *)dst;
+    const char *s = (const char *)src;
+    int j = 0;
+#ifdef MT_HAS_AVX2
+    if (use_avx2()) j = xor_words_avx2(d, s, n);
+#endif
 #ifdef __SSE2__
-        // vector loop
-        for (; kk + 4 <= N - M; kk += 4)
-        {
-            // ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
-            __m128i vy = _mm_or_si128(
-                _mm_and_si128(_mm_load_si128((__m128i *)(mt + kk)),
-                              upper_mask.v),
-                _mm_and_si128(_mm_loadu_si128((__m128i *)(mt + kk + 1)),
-                              lower_mask.v));
-
-            // y & 1 ? -1 : 0
-            __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(vy, one.v), one.v);
-            // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
-            __m128i vmag01 = _mm_and_si128(mask, matrix_a.v);
-            // mt[kk+M] ^ (y >> 1)
-            __m128i vr =
-                _mm_xor_si128(_mm_loadu_si128((__m128i *)(mt + kk + M)),
-                              (__m128i)_mm_srli_epi32(vy, 1));
-            // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
-            vr = _mm_xor_si128(vr, vmag01);
-            _mm_store_si128((__m128i *)(mt + kk), vr);
-        }
+    for (; j + 4 <= n; j += 4)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((__m128i *)(d + 4 * j)),
+                                  _mm_loadu_si128((__m128i *)(s + 4 * j)));
+        _mm_storeu_si128((__m128i *)(d + 4 * j), v);
+    }
 #endif
-        for (; kk < N - M; kk++)
+    for (; j < n; j++)
+    {
+        cl_uint a, b;
+        memcpy(&a, d + 4 * j, sizeof(a));
+        memcpy(&b, s + 4 * j, sizeof(b));
+        a ^= b;
+        memcpy(d + 4 * j, &a, sizeof(a));
+    }
+}
+
+inline void add_state(StepState &acc, const StepState &st)
+{
+    int head = N - acc.i;
+    xor_words(acc.s + acc.i, st.s, head);
+    xor_words(acc.s, st.s + head, N - head);
+}
+
+/* characteristic polynomial of the recurrence */
+Poly compute_char_poly()
+{
+    // Bit sequence: the most significant bit of successive state words.
+    const size_t len = 2 * MEXP;
+    Poly seq((len + 63) / 64, 0);
+    StepState st;
+    MTdata seed = init_genrand(5489);
+    memcpy(st.s, seed->mt, sizeof(st.s));
+    st.i = 0;
+    free_mtdata(seed);
+    for (size_t n = 0; n < len; n++)
+    {
+        if (st.s[st.i] & UPPER_MASK) seq[n / 64] |= (cl_ulong)1 << (n % 64);
+        step(st);
+    }
+
+    // The sequence reversed, so that s_(n-i) for i = 0, 1, ... are
+    // consecutive bits starting at bit len - 1 - n.
+    Poly rev(seq.size() + 1, 0);
+    for (size_t n = 0; n < len; n++)
+        if (poly_bit(seq, n))
+            rev[(len - 1 - n) / 64] |= (cl_ulong)1 << ((len - 1 - n) % 64);
+
+    // Berlekamp-Massey, c is the connection polynomial
+    // 1 + c_1 x + ... + c_L x^L with s_n = sum c_i s_(n-i)
+    const size_t words = (len + 63) / 64 + 1;
+    Poly c(words, 0), b(words, 0), t;
+    c[0] = b[0] = 1;
+    size_t L = 0, m = 1;
+    for (size_t n = 0; n < len; n++)
+    {
+        // discrepancy: parity of sum c_i s_(n-i), i = 0..L
+        size_t offset = len - 1 - n;
+        unsigned bitShift = (unsigned)(offset % 64);
+        cl_ulong acc = 0;
+        for (size_t i = 0; i <= L / 64; i++)
         {
-            y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
-            mt[kk] = mt[kk + M] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+            size_t w = offset / 64 + i;
+            cl_ulong bits = rev[w] >> bitShift;
+            if (bitShift && w + 1 < rev.size())
+                bits |= rev[w + 1] << (64 - bitShift);
+            acc ^= c[i] & bits;
         }
-
-#ifdef __SSE2__
-        // advance to next aligned location
-        for (; kk < N - 1 && (kk & 3); kk++)
+        int disc = 0;
+        for (; acc; acc &= acc - 1) disc ^= 1;
+        if (!disc)
         {
-            y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
-            mt[kk] = mt[kk + (M - N)] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+            m++;
+            continue;
         }
-
-        // vector loop
-        for (; kk + 4 <= N - 1; kk += 4)
+        if (2 * L <= n)
         {
-            __m128i vy = _mm_or_si128(
-                _mm_and_si128(_mm_load_si128((__m128i *)(mt + kk)),
-                              upper_mask.v),
-                // ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
-                _mm_and_si128(_mm_loadu_si128((__m128i *)(mt + kk + 1)),
-                              lower_mask.v));
-
-            // y & 1 ? -1 : 0
-            __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(vy, one.v), one.v);
-            // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
-            __m128i vmag01 = _mm_and_si128(mask, matrix_a.v);
-            // mt[kk+M-N] ^ (y >> 1)
-            __m128i vr =
-                _mm_xor_si128(_mm_loadu_si128((__m128i *)(mt + kk + M - N)),
-                              _mm_srli_epi32(vy, 1));
-            // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
-            vr = _mm_xor_si128(vr, vmag01);
-            _mm_store_si128((__m128i *)(mt + kk), vr);
+            t = c;
+            poly_xor_shifted(c, b, n + 1, m);
+            L = n + 1 - L;
+            b.swap(t);
+            m = 1;
         }
-#endif
-
-        for (; kk < N - 1; kk++)
+        else
         {
-            y = (cl_uint)((mt[kk] & UPPER_MASK) | (mt[kk + 1] & LOWER_MASK));
-            mt[kk] = mt[kk + (M - N)] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+            poly_xor_shifted(c, b, n + 1, m);
+            m++;
         }
-        y = (cl_uint)((mt[N - 1] & UPPER_MASK) | (mt[0] & LOWER_MASK));
-        mt[N - 1] = mt[M - 1] ^ (y >> 1) ^ mag01[y & (cl_uint)0x1UL];
+    }
 
-#ifdef __SSE2__
-        // Do the tempering ahead of time in vector code
-        for (kk = 0; kk + 4 <= N; kk += 4)
+    // phi is the reciprocal of c
+    Poly phi(kPolyWords + 1, 0);
+    for (size_t i = 0; i <= L; i++)
+        if (poly_bit(c, i)) phi[(L - i) / 64] |= (cl_ulong)1 << ((L - i) % 64);
+    return phi;
+}
+
+/* phi * x^k for k = 0..63, so that reduction only needs word aligned xors */
+std::vector<Poly> shifted_char_polys(const Poly &phi)
+{
+    std::vector<Poly> r(64);
+    for (size_t k = 0; k < 64; k++)
+    {
+        r[k].assign(kPolyWords + 1, 0);
+        poly_xor_shifted(r[k], phi, MEXP + 1, k);
+    }
+    return r;
+}
+
+/* p * p mod phi, p of degree < MEXP */
+Poly square_mod(const Poly &p, const std::vector<Poly> &phi)
+{
+    Poly r(2 * kPolyWords + 1, 0);
+    for (size_t i = 0; i < kPolyWords; i++)
+    {
+        // spread the bits of each half word apart
+        for (int h = 0; h < 2; h++)
         {
-            // y = mt[k];
-            __m128i vy = _mm_load_si128((__m128i *)(mt + kk));
-            // y ^= (y >> 11);
-            vy = _mm_xor_si128(vy, _mm_srli_epi32(vy, 11));
-            // y ^= (y << 7) & (cl_uint) 0x9d2c5680UL;
-            vy = _mm_xor_si128(vy, _mm_and_si128(_mm_slli_epi32(vy, 7), c0.v));
-            // y ^= (y << 15) & (cl_uint) 0xefc60000UL;
-            vy = _mm_xor_si128(vy, _mm_and_si128(_mm_slli_epi32(vy, 15), c1.v));
-            // y ^= (y >> 18);
-            vy = _mm_xor_si128(vy, _mm_srli_epi32(vy, 18));
-            _mm_store_si128((__m128i *)(d->cache + kk), vy);
+            cl_ulong x = (p[i] >> (32 * h)) & 0xffffffffULL;
+            x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+            x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+            x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+            x = (x | (x << 2)) & 0x3333333333333333ULL;
+            x = (x | (x << 1)) & 0x5555555555555555ULL;
+            r[2 * i + h] = x;
         }
-#endif
+    }
+    for (size_t i = 2 * (MEXP - 1); i >= MEXP; i--)
+    {
+        if (!poly_bit(r, i)) continue;
+        const Poly &q = phi[(i - MEXP) % 64];
+        xor_words(&r[(i - MEXP) / 64], q.data(), 2 * (int)q.size());
+    }
+    r.resize(kPolyWords);
+    return r;
+}
 
-        d->mti = 0;
+std::mutex jump_mutex;
+std::vector<Poly> char_polys; // phi * x^k
+std::deque<Poly> jump_polys; // x^(2^n) mod phi
+
+const Poly &get_jump_poly(cl_uint log2_count)
+{
+    std::lock_guard<std::mutex> lock(jump_mutex);
+    if (char_polys.empty())
+    {
+        char_polys = shifted_char_polys(compute_char_poly());
+        Poly x(kPolyWords, 0);
+        x[0] = 2;
+        jump_polys.push_back(x);
     }
-#ifdef __SSE2__
-    y = d->cache[d->mti++];
-#else
-    y = mt[d->mti++];
+    while (jump_polys.size() <= log2_count)
+        jump_polys.push_back(square_mod(jump_polys.back(), char_polys));
+    return jump_polys[log2_count];
+}
 
-    /* Tempering */
-    y ^= (y >> 11);
-    y ^= (y << 7) & (cl_uint)0x9d2c5680UL;
-    y ^= (y << 15) & (cl_uint)0xefc60000UL;
-    y ^= (y >> 18);
-#endif
+} // namespace
 
+void genrand_jump(MTdata d, cl_uint log2_count)
+{
+    const Poly &p = get_jump_poly(log2_count);
 
-    return y;
+    StepState st, acc;
+    memcpy(st.s, d->mt, sizeof(st.s));
+    st.i = 0;
+    memset(acc.s, 0, sizeof(acc.s));
+    acc.i = 0;
+
+    // Horner's rule: acc = sum p_i T^i st
+    for (int i = MEXP - 1; i >= 0; i--)
+    {
+        step(acc);
+        if (poly_bit(p, i)) add_state(acc, st);
+    }
+
+    for (int j = 0; j < N; j++) d->mt[j] = acc.s[(acc.i + j) % N];
+
+    // The words not yet consumed from the current block are the state words
+    // from mti onwards, so they move with the rest of the state.
+#ifdef __SSE2__
+    for (int j = d->mti; j < N; j++) d->cache[j] = temper(d->mt[j]);
+#endif
+}
+
+MTdata init_genrand_stream(cl_uint seed, cl_uint stream)
+{
+    MTdata r = init_genrand(seed);
+    if (NULL != r)
+    {
+        for (cl_uint n = 0; stream; n++, stream >>= 1)
+            if (stream & 1) genrand_jump(r, MT_STREAM_LOG2 + n);
+    }
+    return r;
 }
 
 cl_ulong genrand_int64(MTdata d)
@@ -72,6 +72,27 @@ void free_mtdata(MTdata /*data*/);
 /* generates a random number on [0,0xffffffff]-interval */
 cl_uint genrand_int32(MTdata /*data*/);
 
+/* fills out with count random numbers on [0,0xffffffff]-interval, giving the
+ * same values as count calls to genrand_int32 */
+void genrand_fill(MTdata /*data*/, cl_uint * /*out*/, size_t /*count*/);
+
+/* advances the generator as if genrand_int32 had been called 2^log2_count
+ * times.  The first call computes the characteristic polynomial, which takes
+ * some tens of milliseconds, and each new log2_count costs a squaring of about
+ * a millisecond.  A jump itself costs about as much as generating a few
+ * hundred thousand numbers. */
+void genrand_jump(MTdata /*data*/, cl_uint /*log2_count*/);
+
+/* Sub-streams are spaced 2^MT_STREAM_LOG2 numbers apart */
+#define MT_STREAM_LOG2 64
+
+/* Create the random number generator for sub-stream 'stream' of seed, i.e.
+ * init_genrand(seed) advanced by stream * 2^MT_STREAM_LOG2 numbers.  Gives
+ * each worker of a multithreaded test its own non-overlapping sequence, where
+ * seeding every worker with the same seed would repeat one sequence.  The
+ * jumps cost about a millisecond per set bit of stream. */
+MTdata init_genrand_stream(cl_uint /*seed*/, cl_uint /*stream*/);
+
 /* generates a random number on [0,0xffffffffffffffffULL]-interval */
 cl_ulong genrand_int64(MTdata /*data*/);
 
@@ -104,6 +125,11 @@ public:
         m_mtdata = init_genrand(seed);
         assert(m_mtdata != nullptr);
     }
+    MTdataHolder(cl_uint seed, cl_uint stream)
+    {
+        m_mtdata = init_genrand_stream(seed, stream);
+        assert(m_mtdata != nullptr);
+    }
 
     // Forbid copy.
     MTdataHolder(const MTdataHolder&) = delete;
@@ -38,6 +38,7 @@ unsigned gNumWorkerThreads;
 unsigned gNumThreadPoolThreads = 0;
 bool gListTests = false;
 bool gWimpyMode = false;
+bool gBenchmarkMode = false;
 
 void helpInfo()
 {
@@ -58,6 +59,10 @@ void helpInfo()
         Enable wimpy mode. It does not impact all tests. Impacted tests will run
         with a very small subset of the tests. This option should not be used
         for conformance submission (default: disabled).
+    --benchmark
+        Run benchmark tests over their full sweeps. Without it they only run
+        a small smoke-test configuration. Can also be enabled by setting
+        CL_BENCHMARK_MODE (default: disabled).
     -m, --disable-threadpool
         Disable multi-threading (using the ThreadPool API) within individual tests.
     -t, --num-threadpool-threads <num>
@@ -131,6 +136,12 @@ int parseCommonParamAndGetRemovedArgs(int argc, const char *argv[],
             removed_args.push_back("--wimpy");
             gWimpyMode = true;
         }
+        else if (!strcmp(argv[i], "--benchmark"))
+        {
+            delArg++;
+            removed_args.push_back("--benchmark");
+            gBenchmarkMode = true;
+        }
         else if (!strcmp(argv[i], "-m")
                  || !strcmp(argv[i], "--disable-threadpool"))
         {
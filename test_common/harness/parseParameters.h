@@ -43,6 +43,7 @@ extern bool gDisableSPIRVValidation;
 extern std::string gSPIRVValidator;
 extern bool gListTests;
 extern bool gWimpyMode;
+extern bool gBenchmarkMode;
 extern unsigned gNumWorkerThreads;
 extern unsigned gNumThreadPoolThreads;
 
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "profilingStats.h"
+#include "csvHelpers.h"
+#include "errorHelpers.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Nearest-rank percentile of sorted values
+double sorted_percentile(const std::vector<double> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+double sorted_median(const std::vector<double> &sorted)
+{
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+struct ProfileInterval
+{
+    const char *name;
+    SampleStats CommandProfile::*stats;
+};
+
+const ProfileInterval profile_intervals[] = {
+    { "queued->submit", &CommandProfile::queued_to_submit },
+    { "submit->start", &CommandProfile::submit_to_start },
+    { "start->end", &CommandProfile::start_to_end },
+    { "queued->end", &CommandProfile::queued_to_end },
+};
+
+void write_csv(const char *name, const char *interval, const SampleStats &s)
+{
+    FILE *file = open_results_csv(
+        "CL_PROFILING_STATS_CSV",
+        "command,interval,count,outliers,min_us,median_us,mean_us,p99_us,"
+        "max_us,stddev_us");
+    if (file == NULL) return;
+
+    fprintf(file, "%s,%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", name,
+            interval, s.count, s.outliers, s.min, s.median, s.mean, s.p99,
+            s.max, s.stddev);
+    fclose(file);
+}
+
+}
+
+SampleStats compute_sample_stats(std::vector<double> samples)
+{
+    SampleStats stats;
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    double median = sorted_median(samples);
+
+    // The median absolute deviation, scaled to estimate the standard
+    // deviation of normally distributed samples, is not itself thrown off by
+    // the outliers it is used to detect
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (double sample : samples)
+        deviations.push_back(std::fabs(sample - median));
+    std::sort(deviations.begin(), deviations.end());
+    double mad = 1.4826 * sorted_median(deviations);
+
+    double sum = 0.0;
+    std::vector<double> inliers;
+    inliers.reserve(samples.size());
+    for (double sample : samples)
+    {
+        if (mad > 0.0
+            && std::fabs(sample - median) > profiling_outlier_mads * mad)
+        {
+            stats.outliers++;
+        }
+        else
+        {
+            inliers.push_back(sample);
+            sum += sample;
+        }
+    }
+    stats.mean = sum / inliers.size();
+
+    double sum_of_squares = 0.0;
+    for (double sample : inliers)
+        sum_of_squares += (sample - stats.mean) * (sample - stats.mean);
+    stats.stddev = inliers.size() > 1
+        ? std::sqrt(sum_of_squares / (inliers.size() - 1))
+        : 0.0;
+
+    stats.count = samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.median = median;
+    stats.p99 = sorted_percentile(samples, 0.99);
+    return stats;
+}
+
+cl_int profile_command(cl_command_queue queue, const ProfiledCommand &command,
+                       size_t warmup, size_t samples, CommandProfile &profile)
+{
+    std::vector<double> queued_to_submit, submit_to_start, start_to_end,
+        queued_to_end;
+    profile = CommandProfile();
+
+    for (size_t i = 0; i < warmup + samples; i++)
+    {
+        cl_event event = nullptr;
+        cl_int error = command(&event);
+        test_error(error, "Unable to enqueue the profiled command");
+
+        error = clFinish(queue);
+        if (error != CL_SUCCESS)
+        {
+            clReleaseEvent(event);
+            test_error(error, "clFinish failed");
+        }
+        if (i < warmup)
+        {
+            clReleaseEvent(event);
+            continue;
+        }
+
+        const cl_profiling_info params[] = {
+            CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_SUBMIT,
+            CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END
+        };
+        cl_ulong times[4];
+        for (int t = 0; t < 4; t++)
+        {
+            error = clGetEventProfilingInfo(event, params[t], sizeof(times[t]),
+                                            &times[t], nullptr);
+            if (error != CL_SUCCESS) break;
+        }
+        clReleaseEvent(event);
+        test_error(error, "clGetEventProfilingInfo failed");
+
+        if (times[0] > times[1] || times[1] > times[2] || times[2] > times[3])
+        {
+            profile.ordering_errors++;
+            continue;
+        }
+        queued_to_submit.push_back((times[1] - times[0]) * 1e-3);
+        submit_to_start.push_back((times[2] - times[1]) * 1e-3);
+        start_to_end.push_back((times[3] - times[2]) * 1e-3);
+        queued_to_end.push_back((times[3] - times[0]) * 1e-3);
+    }
+
+    profile.queued_to_submit = compute_sample_stats(queued_to_submit);
+    profile.submit_to_start = compute_sample_stats(submit_to_start);
+    profile.start_to_end = compute_sample_stats(start_to_end);
+    profile.queued_to_end = compute_sample_stats(queued_to_end);
+    return CL_SUCCESS;
+}
+
+void log_command_profile(const char *name, const CommandProfile &profile)
+{
+    log_info("%s (microseconds, %zu samples", name,
+             profile.queued_to_end.count);
+    if (profile.ordering_errors)
+        log_info(", %zu with misordered timestamps", profile.ordering_errors);
+    log_info(")\n");
+    log_info("  %-15s %10s %10s %10s %10s %10s %8s\n", "interval", "min",
+             "median", "p99", "max", "stddev", "outliers");
+    for (const ProfileInterval &interval : profile_intervals)
+    {
+        const SampleStats &s = profile.*interval.stats;
+        log_info("  %-15s %10.2f %10.2f %10.2f %10.2f %10.2f %8zu\n",
+                 interval.name, s.min, s.median, s.p99, s.max, s.stddev,
+                 s.outliers);
+        write_csv(name, interval.name, s);
+    }
+}
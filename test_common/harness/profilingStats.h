@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _profilingStats_h
+#define _profilingStats_h
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <functional>
+#include <vector>
+
+// Statistics over repeated executions of a command, from the
+// CL_PROFILING_COMMAND_* timestamps of its events. The command is enqueued a
+// number of times that are discarded as warm-up, then once per sample, and
+// each interval between consecutive timestamps is summarised separately.
+// The min, median, p99 and max are taken over all samples. Samples further
+// than profiling_outlier_mads scaled median absolute deviations from the
+// median are counted as outliers and only excluded from the mean and stddev,
+// so that a few preempted runs do not hide the typical spread.
+
+const double profiling_outlier_mads = 5.0;
+
+// All values in microseconds
+struct SampleStats
+{
+    // Number of samples, and how many of them are outliers
+    size_t count = 0;
+    size_t outliers = 0;
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double stddev = 0.0;
+};
+
+SampleStats compute_sample_stats(std::vector<double> samples);
+
+struct CommandProfile
+{
+    SampleStats queued_to_submit;
+    SampleStats submit_to_start;
+    SampleStats start_to_end;
+    SampleStats queued_to_end;
+    // Samples whose timestamps were not in queued <= submit <= start <= end
+    // order
+    size_t ordering_errors = 0;
+};
+
+// Enqueues one instance of the command and returns its event
+using ProfiledCommand = std::function<cl_int(cl_event *event)>;
+
+// Runs command warmup + samples times, each followed by clFinish on queue,
+// which must have CL_QUEUE_PROFILING_ENABLE
+cl_int profile_command(cl_command_queue queue, const ProfiledCommand &command,
+                       size_t warmup, size_t samples,
+                       CommandProfile &profile);
+
+// Logs the median, p99 and spread of each interval of the profile, and
+// appends them to the file named by CL_PROFILING_STATS_CSV if it is set
+void log_command_profile(const char *name, const CommandProfile &profile);
+
+#endif // _profilingStats_h
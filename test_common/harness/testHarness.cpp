@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cassert>
+#include <chrono>
 #include <deque>
 #include <filesystem>
 #include <mutex>
@@ -36,6 +37,10 @@
 #include "typeWrappers.h"
 #include "imageHelpers.h"
 #include "parseParameters.h"
+#include "traceHelpers.h"
+#if defined(CL_STAND_IN_ICD)
+#include "stand_in_icd/stand_in_icd.h"
+#endif
 
 namespace fs = std::filesystem;
 
@@ -389,6 +394,7 @@ int runTestHarnessWithCheckAndParse(int argc, const char *argv[], int testNum,
     }
 
     gWimpyMode |= (getenv("CL_WIMPY_MODE") != nullptr);
+    gBenchmarkMode |= (getenv("CL_BENCHMARK_MODE") != nullptr);
     if (gWimpyMode)
     {
         log_info("\n");
@@ -991,6 +997,65 @@ void CL_CALLBACK notify_callback(const char *errinfo, const void *private_info,
     log_info("%s\n", errinfo);
 }
 
+// Logs the wall time of a test when CL_CONFORMANCE_TEST_TIMING is set. On the
+// stand-in ICD the time spent inside the driver is reported as well, the rest
+// being host work done by the harness and the test itself. Driver time is
+// process-wide, so the split is only exact when tests run one at a time.
+class TestTimer {
+public:
+    TestTimer(const char *name, cl_device_id device): name(name)
+    {
+        if (getenv("CL_CONFORMANCE_TEST_TIMING") == nullptr) return;
+        enabled = true;
+#if defined(CL_STAND_IN_ICD)
+        if (clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform),
+                            &platform, nullptr)
+            == CL_SUCCESS)
+        {
+            get_driver_time = (clStandInGetDriverTimeEXT_fn)
+                clGetExtensionFunctionAddressForPlatform(
+                    platform, "clStandInGetDriverTimeEXT");
+        }
+        if (get_driver_time) get_driver_time(platform, &driver_start);
+#endif
+        start = std::chrono::steady_clock::now();
+    }
+    ~TestTimer()
+    {
+        if (!enabled) return;
+        double total_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+#if defined(CL_STAND_IN_ICD)
+        cl_ulong driver_end = 0;
+        if (get_driver_time == nullptr
+            || get_driver_time(platform, &driver_end) != CL_SUCCESS)
+#endif
+        {
+            log_info("%s took %.3f ms\n", name, total_ms);
+            return;
+        }
+#if defined(CL_STAND_IN_ICD)
+        double driver_ms = (driver_end - driver_start) * 1e-6;
+        double harness_ms = std::max(total_ms - driver_ms, 0.0);
+        log_info("%s took %.3f ms: %.3f ms in the driver, %.3f ms in the "
+                 "harness and test\n",
+                 name, total_ms, driver_ms, harness_ms);
+        log_perf(harness_ms, false, "ms", "%s harness-side time", name);
+#endif
+    }
+
+private:
+    const char *name;
+    bool enabled = false;
+#if defined(CL_STAND_IN_ICD)
+    cl_platform_id platform = nullptr;
+    clStandInGetDriverTimeEXT_fn get_driver_time = nullptr;
+    cl_ulong driver_start = 0;
+#endif
+    std::chrono::steady_clock::time_point start;
+};
+
 // Actual function execution
 test_status callSingleTestFunction(test_definition test,
                                    cl_device_id deviceToUse,
@@ -1004,6 +1069,8 @@ test_status callSingleTestFunction(test_definition test,
     log_info("%s...\n", test.name);
     fflush(stdout);
 
+    TestTimer timer(test.name, deviceToUse);
+
     const Version device_version = get_device_cl_version(deviceToUse);
     if (test.min_version > device_version)
     {
@@ -1034,17 +1101,22 @@ test_status callSingleTestFunction(test_definition test,
             return TEST_FAIL;
         }
 
+        // Device timestamps for the traced commands of the test
+        cl_command_queue_properties queueProps = config.queueProps;
+        if (trace_device_timeline(test.name))
+            queueProps |= CL_QUEUE_PROFILING_ENABLE;
+
         if (device_version < Version(2, 0))
         {
-            queue = clCreateCommandQueue(context, deviceToUse,
-                                         config.queueProps, &error);
+            queue = clCreateCommandQueue(context, deviceToUse, queueProps,
+                                         &error);
         }
         else
         {
             const cl_command_queue_properties cmd_queueProps =
-                (config.queueProps) ? CL_QUEUE_PROPERTIES : 0;
+                (queueProps) ? CL_QUEUE_PROPERTIES : 0;
             cl_command_queue_properties queueCreateProps[] = {
-                cmd_queueProps, config.queueProps, 0
+                cmd_queueProps, queueProps, 0
             };
             queue = clCreateCommandQueueWithProperties(
                 context, deviceToUse, &queueCreateProps[0], &error);
@@ -1070,8 +1142,12 @@ test_status callSingleTestFunction(test_definition test,
     }
     else
     {
+        capture_begin_test(test.name);
+        trace_begin_test(test.name, deviceToUse);
         int ret =
             test.func(deviceToUse, context, queue, config.numElementsToUse);
+        trace_end_test();
+        capture_end_test();
         if (ret == TEST_SKIPPED_ITSELF)
         {
             /* Tests can also let us know they're not supported by the
@@ -16,6 +16,7 @@
 #ifndef _testHarness_h
 #define _testHarness_h
 
+#include "apiCapture.h"
 #include "clImageHelper.h"
 #include <string>
 #include <sstream>
@@ -43,11 +43,98 @@ int main(void)
 
     free_mtdata(d);
 
+    // genrand_fill must give the same sequence as genrand_int32, starting
+    // from any position in the current block.
+    {
+        MTdata a = init_genrand(42);
+        MTdata b = init_genrand(42);
+        cl_uint buffer[2000];
+        for (i = 0; i < 100; i++)
+        {
+            genrand_int32(a);
+            genrand_int32(b);
+        }
+        genrand_fill(a, buffer, 2000);
+        for (i = 0; i < 2000; i++)
+        {
+            cl_uint u = genrand_int32(b);
+            if (u != buffer[i])
+            {
+                printf("ERROR: genrand_fill expected 0x%8.8x at %d.  Got "
+                       "0x%8.8x\n",
+                       u, i, buffer[i]);
+                errcount++;
+                break;
+            }
+        }
+        free_mtdata(a);
+        free_mtdata(b);
+    }
+
+    // genrand_jump(d, 20) must match 2^20 calls to genrand_int32.
+    {
+        MTdata a = init_genrand(42);
+        MTdata b = init_genrand(42);
+        for (i = 0; i < 1000; i++)
+        {
+            genrand_int32(a);
+            genrand_int32(b);
+        }
+        genrand_jump(a, 20);
+        for (i = 0; i < (1 << 20); i++) genrand_int32(b);
+        for (i = 0; i < 2000; i++)
+        {
+            cl_uint u = genrand_int32(b);
+            cl_uint v = genrand_int32(a);
+            if (u != v)
+            {
+                printf("ERROR: genrand_jump expected 0x%8.8x at %d.  Got "
+                       "0x%8.8x\n",
+                       u, i, v);
+                errcount++;
+                break;
+            }
+        }
+        free_mtdata(a);
+        free_mtdata(b);
+    }
+
+    // Two jumps of 2^20 must match one jump of 2^21, and sub-stream 0 must be
+    // the plain sequence.
+    {
+        MTdata a = init_genrand(42);
+        MTdata b = init_genrand(42);
+        MTdata c = init_genrand_stream(42, 0);
+        MTdata e = init_genrand(42);
+        genrand_jump(a, 20);
+        genrand_jump(a, 20);
+        genrand_jump(b, 21);
+        for (i = 0; i < 2000; i++)
+        {
+            cl_uint u = genrand_int32(b);
+            cl_uint v = genrand_int32(a);
+            cl_uint w = genrand_int32(e);
+            cl_uint x = genrand_int32(c);
+            if (u != v || w != x)
+            {
+                printf("ERROR: genrand_jump/init_genrand_stream mismatch at "
+                       "%d\n",
+                       i);
+                errcount++;
+                break;
+            }
+        }
+        free_mtdata(a);
+        free_mtdata(b);
+        free_mtdata(c);
+        free_mtdata(e);
+    }
+
     if (errcount)
         printf("mt19937 test failed.\n");
     else
         printf("mt19937 test passed.\n");
 
 
-    return 0;
+    return errcount ? 1 : 0;
 }
\ No newline at end of file
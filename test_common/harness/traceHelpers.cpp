@@ -0,0 +1,529 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "traceHelpers.h"
+#include "errorHelpers.h"
+#include "testHarness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Take a new host/device timer sample after this many recorded commands so
+// that drift between the two clocks is tracked within long tests
+const size_t trace_sample_interval = 64;
+
+struct TimerSample
+{
+    cl_ulong device_ns;
+    double host_us;
+};
+
+struct PendingEvent
+{
+    cl_event event;
+    std::string name;
+    std::string args;
+    double record_us;
+};
+
+struct TraceState
+{
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point epoch =
+        std::chrono::steady_clock::now();
+    std::vector<std::string> lines;
+    FILE *file = nullptr;
+
+    bool test_active = false;
+    std::string test_name;
+    double test_start_us = 0.0;
+    cl_device_id device = nullptr;
+    bool has_device_timer = false;
+    std::vector<TimerSample> samples;
+    std::vector<PendingEvent> pending;
+    size_t events_since_sample = 0;
+
+    std::map<std::thread::id, int> host_threads;
+    std::map<cl_command_queue, int> device_queues;
+};
+
+const char *trace_file_name()
+{
+    static const char *name = getenv("CL_CONFORMANCE_TRACE_FILENAME");
+    return name;
+}
+
+const char *trace_device_tests()
+{
+    static const char *tests = getenv("CL_CONFORMANCE_TRACE_DEVICE");
+    return tests;
+}
+
+TraceState &trace_state()
+{
+    static TraceState state;
+    return state;
+}
+
+double host_now_us(const TraceState &state)
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - state.epoch)
+        .count();
+}
+
+std::string json_escape(const char *str)
+{
+    std::string out;
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\') out += '\\';
+        if ((unsigned char)*str < 0x20)
+            out += ' ';
+        else
+            out += *str;
+    }
+    return out;
+}
+
+std::string sizes_to_string(cl_uint work_dim, const size_t *sizes)
+{
+    if (sizes == nullptr) return "null";
+    std::string out;
+    for (cl_uint i = 0; i < work_dim; i++)
+    {
+        if (i) out += 'x';
+        out += std::to_string(sizes[i]);
+    }
+    return out;
+}
+
+void add_complete_event(TraceState &state, const std::string &name,
+                        const char *category, int pid, int tid, double ts,
+                        double dur, const std::string &args)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer),
+             "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", pid, tid, ts,
+             dur);
+    std::string line = "{\"name\":\"" + json_escape(name.c_str())
+        + "\",\"cat\":\"" + category + "\",\"ph\":\"X\"," + buffer;
+    if (!args.empty()) line += ",\"args\":{" + args + "}";
+    line += "}";
+    state.lines.push_back(line);
+}
+
+// Must be called with the state mutex held
+void sample_timers(TraceState &state)
+{
+    state.events_since_sample = 0;
+    if (!state.has_device_timer) return;
+
+    // The returned host timestamp uses an implementation-defined clock, so
+    // pair the device timestamp with the midpoint of the call on the
+    // steady_clock timeline used for host spans instead.
+    cl_ulong device_ns = 0;
+    cl_ulong host_ns = 0;
+    double before = host_now_us(state);
+    cl_int error = clGetDeviceAndHostTimer(state.device, &device_ns, &host_ns);
+    double after = host_now_us(state);
+    if (error != CL_SUCCESS)
+    {
+        log_info("Trace: clGetDeviceAndHostTimer failed (%s), device "
+                 "timestamps will be aligned to enqueue time\n",
+                 IGetErrorString(error));
+        state.has_device_timer = false;
+        return;
+    }
+    state.samples.push_back({ device_ns, (before + after) * 0.5 });
+}
+
+// Maps a device timestamp onto the host timeline by interpolating between
+// the two nearest timer samples. Returns false if no sample is available.
+bool device_to_host_us(const TraceState &state, cl_ulong device_ns,
+                       double *host_us)
+{
+    const std::vector<TimerSample> &samples = state.samples;
+    if (samples.empty()) return false;
+    if (samples.size() == 1)
+    {
+        *host_us = samples[0].host_us
+            + ((double)device_ns - (double)samples[0].device_ns) * 1e-3;
+        return true;
+    }
+
+    size_t i = 0;
+    while (i + 2 < samples.size() && samples[i + 1].device_ns < device_ns) i++;
+
+    const TimerSample &lo = samples[i];
+    const TimerSample &hi = samples[i + 1];
+    double slope = 1e-3;
+    if (hi.device_ns > lo.device_ns)
+        slope = (hi.host_us - lo.host_us)
+            / ((double)hi.device_ns - (double)lo.device_ns);
+    *host_us =
+        lo.host_us + ((double)device_ns - (double)lo.device_ns) * slope;
+    return true;
+}
+
+int device_queue_index(TraceState &state, cl_event event)
+{
+    cl_command_queue queue = nullptr;
+    clGetEventInfo(event, CL_EVENT_COMMAND_QUEUE, sizeof(queue), &queue,
+                   nullptr);
+    auto it = state.device_queues.find(queue);
+    if (it != state.device_queues.end()) return it->second;
+    int index = (int)state.device_queues.size();
+    state.device_queues[queue] = index;
+    return index;
+}
+
+// Must be called with the state mutex held
+void resolve_pending_events(TraceState &state)
+{
+    // Aligns the queued timestamp of the first command to its enqueue time
+    // when no timer samples could be taken
+    bool have_fallback_offset = false;
+    double fallback_offset_us = 0.0;
+
+    for (PendingEvent &pending : state.pending)
+    {
+        cl_int status = CL_COMPLETE;
+        clGetEventInfo(pending.event, CL_EVENT_COMMAND_EXECUTION_STATUS,
+                       sizeof(status), &status, nullptr);
+        if (status > CL_COMPLETE) clWaitForEvents(1, &pending.event);
+
+        cl_ulong queued = 0, start = 0, end = 0;
+        cl_int error = clGetEventProfilingInfo(
+            pending.event, CL_PROFILING_COMMAND_QUEUED, sizeof(queued),
+            &queued, nullptr);
+        error |= clGetEventProfilingInfo(pending.event,
+                                         CL_PROFILING_COMMAND_START,
+                                         sizeof(start), &start, nullptr);
+        error |= clGetEventProfilingInfo(pending.event,
+                                         CL_PROFILING_COMMAND_END, sizeof(end),
+                                         &end, nullptr);
+        int tid = device_queue_index(state, pending.event);
+
+        if (error != CL_SUCCESS || status < 0)
+        {
+            // No device timing, mark the enqueue on the host timeline
+            std::string args = pending.args;
+            if (status < 0)
+                args += std::string(args.empty() ? "" : ",")
+                    + "\"status\":\"" + IGetErrorString(status) + "\"";
+            add_complete_event(state, pending.name, "enqueue", 1, tid,
+                               pending.record_us, 0.0, args);
+        }
+        else
+        {
+            double start_us;
+            if (!device_to_host_us(state, start, &start_us))
+            {
+                if (!have_fallback_offset)
+                {
+                    fallback_offset_us =
+                        pending.record_us - (double)queued * 1e-3;
+                    have_fallback_offset = true;
+                }
+                start_us = (double)start * 1e-3 + fallback_offset_us;
+            }
+
+            char latency[64];
+            snprintf(latency, sizeof(latency), "\"queued_to_start_us\":%.3f",
+                     (double)(start - queued) * 1e-3);
+            std::string args = pending.args;
+            args += std::string(args.empty() ? "" : ",") + latency;
+            add_complete_event(state, pending.name, "device", 1, tid,
+                               start_us, (double)(end - start) * 1e-3, args);
+        }
+        clReleaseEvent(pending.event);
+    }
+    state.pending.clear();
+}
+
+// Closes the array of trace events. The format allows a missing closing
+// bracket, so the file is still usable if the process does not exit normally.
+void close_trace_file()
+{
+    TraceState &state = trace_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.file == nullptr) return;
+    fprintf(state.file, "\n]\n");
+    fclose(state.file);
+    state.file = nullptr;
+}
+
+// Appends the events collected since the last call to the trace file. Must be
+// called with the state mutex held.
+void write_trace_events(TraceState &state)
+{
+    if (state.file == nullptr)
+    {
+        state.file = fopen(trace_file_name(), "w");
+        if (state.file == nullptr)
+        {
+            log_error("ERROR: Failed to open '%s' for writing trace.\n",
+                      trace_file_name());
+            state.lines.clear();
+            return;
+        }
+        fprintf(state.file,
+                "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                "\"args\":{\"name\":\"host\"}},\n"
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"args\":{\"name\":\"device\"}}");
+        atexit(close_trace_file);
+    }
+    for (const std::string &line : state.lines)
+        fprintf(state.file, ",\n%s", line.c_str());
+    fflush(state.file);
+    state.lines.clear();
+}
+
+void record_event(cl_event event, const char *name, const std::string &args)
+{
+    if (!trace_enabled() || event == nullptr) return;
+
+    TraceState &state = trace_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.test_active) return;
+
+    clRetainEvent(event);
+    state.pending.push_back({ event, name, args, host_now_us(state) });
+    if (++state.events_since_sample >= trace_sample_interval)
+        sample_timers(state);
+}
+
+std::string bytes_arg(size_t size)
+{
+    return "\"bytes\":" + std::to_string(size);
+}
+
+// Runs enqueue, asking it for an event when tracing is enabled so that record
+// can add the command to the trace, and hands the event to the caller if it
+// asked for one
+template <typename Enqueue, typename Record>
+cl_int traced_enqueue(cl_event *event, Enqueue enqueue, Record record)
+{
+    if (!trace_enabled()) return enqueue(event);
+
+    cl_event trace_event = nullptr;
+    cl_int error = enqueue(&trace_event);
+    if (error != CL_SUCCESS) return error;
+
+    record(trace_event);
+
+    if (event != nullptr)
+        *event = trace_event;
+    else
+        clReleaseEvent(trace_event);
+    return CL_SUCCESS;
+}
+
+}
+
+bool trace_enabled() { return trace_file_name() != nullptr; }
+
+bool trace_device_timeline(const char *test_name)
+{
+    const char *tests = trace_device_tests();
+    if (!trace_enabled() || tests == nullptr) return false;
+    if (strcmp(tests, "all") == 0) return true;
+
+    size_t length = strlen(test_name);
+    for (const char *p = tests; *p;)
+    {
+        const char *end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == length && strncmp(p, test_name, n) == 0) return true;
+        if (end == nullptr) break;
+        p = end + 1;
+    }
+    return false;
+}
+
+void trace_begin_test(const char *name, cl_device_id device)
+{
+    if (!trace_enabled()) return;
+
+    TraceState &state = trace_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.test_active = true;
+    state.test_name = name;
+    state.device = device;
+    state.has_device_timer = device != nullptr
+        && get_device_cl_version(device) >= Version(2, 1);
+    state.samples.clear();
+    state.device_queues.clear();
+    sample_timers(state);
+    state.test_start_us = host_now_us(state);
+}
+
+void trace_end_test()
+{
+    if (!trace_enabled()) return;
+
+    TraceState &state = trace_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.test_active) return;
+
+    double end_us = host_now_us(state);
+    sample_timers(state);
+    resolve_pending_events(state);
+    add_complete_event(state, state.test_name, "test", 0, 0,
+                       state.test_start_us, end_us - state.test_start_us, "");
+    state.test_active = false;
+    state.device = nullptr;
+    write_trace_events(state);
+}
+
+void trace_record_event(cl_event event, const char *name, cl_uint work_dim,
+                        const size_t *global_size, const size_t *local_size)
+{
+    std::string args;
+    if (work_dim > 0)
+    {
+        args = "\"global_size\":\"" + sizes_to_string(work_dim, global_size)
+            + "\",\"local_size\":\""
+            + sizes_to_string(work_dim, local_size) + "\"";
+    }
+    record_event(event, name, args);
+}
+
+cl_int trace_enqueue_nd_range_kernel(cl_command_queue queue, cl_kernel kernel,
+                                     cl_uint work_dim,
+                                     const size_t *global_offset,
+                                     const size_t *global_size,
+                                     const size_t *local_size,
+                                     cl_uint num_events_in_wait_list,
+                                     const cl_event *event_wait_list,
+                                     cl_event *event)
+{
+    return traced_enqueue(
+        event,
+        [&](cl_event *e) {
+            return clEnqueueNDRangeKernel(queue, kernel, work_dim,
+                                          global_offset, global_size,
+                                          local_size, num_events_in_wait_list,
+                                          event_wait_list, e);
+        },
+        [&](cl_event e) {
+            char name[256] = "clEnqueueNDRangeKernel";
+            clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, sizeof(name),
+                            name, nullptr);
+            trace_record_event(e, name, work_dim, global_size, local_size);
+        });
+}
+
+cl_int trace_enqueue_read_buffer(cl_command_queue queue, cl_mem buffer,
+                                 cl_bool blocking_read, size_t offset,
+                                 size_t size, void *ptr,
+                                 cl_uint num_events_in_wait_list,
+                                 const cl_event *event_wait_list,
+                                 cl_event *event)
+{
+    return traced_enqueue(
+        event,
+        [&](cl_event *e) {
+            return clEnqueueReadBuffer(queue, buffer, blocking_read, offset,
+                                       size, ptr, num_events_in_wait_list,
+                                       event_wait_list, e);
+        },
+        [&](cl_event e) {
+            record_event(e, "clEnqueueReadBuffer", bytes_arg(size));
+        });
+}
+
+cl_int trace_enqueue_write_buffer(cl_command_queue queue, cl_mem buffer,
+                                  cl_bool blocking_write, size_t offset,
+                                  size_t size, const void *ptr,
+                                  cl_uint num_events_in_wait_list,
+                                  const cl_event *event_wait_list,
+                                  cl_event *event)
+{
+    return traced_enqueue(
+        event,
+        [&](cl_event *e) {
+            return clEnqueueWriteBuffer(queue, buffer, blocking_write, offset,
+                                        size, ptr, num_events_in_wait_list,
+                                        event_wait_list, e);
+        },
+        [&](cl_event e) {
+            record_event(e, "clEnqueueWriteBuffer", bytes_arg(size));
+        });
+}
+
+cl_int trace_enqueue_read_image(cl_command_queue queue, cl_mem image,
+                                cl_bool blocking_read, const size_t *origin,
+                                const size_t *region, size_t row_pitch,
+                                size_t slice_pitch, void *ptr,
+                                cl_uint num_events_in_wait_list,
+                                const cl_event *event_wait_list,
+                                cl_event *event)
+{
+    return traced_enqueue(
+        event,
+        [&](cl_event *e) {
+            return clEnqueueReadImage(queue, image, blocking_read, origin,
+                                      region, row_pitch, slice_pitch, ptr,
+                                      num_events_in_wait_list,
+                                      event_wait_list, e);
+        },
+        [&](cl_event e) {
+            record_event(e, "clEnqueueReadImage",
+                         "\"region\":\"" + sizes_to_string(3, region)
+                             + "\"");
+        });
+}
+
+TraceSpan::TraceSpan(const char *name, const char *category)
+    : name(name), category(category), start(std::chrono::steady_clock::now())
+{}
+
+TraceSpan::~TraceSpan()
+{
+    if (!trace_enabled()) return;
+
+    TraceState &state = trace_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.test_active) return;
+
+    double ts =
+        std::chrono::duration<double, std::micro>(start - state.epoch).count();
+    double dur = host_now_us(state) - ts;
+
+    std::thread::id id = std::this_thread::get_id();
+    auto it = state.host_threads.find(id);
+    int tid;
+    if (it != state.host_threads.end())
+        tid = it->second;
+    else
+    {
+        // Thread 0 is used for the test spans
+        tid = (int)state.host_threads.size() + 1;
+        state.host_threads[id] = tid;
+    }
+    add_complete_event(state, name, category, 0, tid, ts, dur, "");
+}
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _traceHelpers_h
+#define _traceHelpers_h
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <chrono>
+
+// Opt-in timeline tracing. When CL_CONFORMANCE_TRACE_FILENAME is set, the
+// harness writes a Chrome trace event file (viewable in chrome://tracing or
+// ui.perfetto.dev) containing one span per test, the host spans opened with
+// TraceSpan, and the commands recorded with trace_record_event() or enqueued
+// with the trace_enqueue_* functions. The harness helpers (DeviceVerifier and
+// DetectFloatToHalfRoundingMode) and the relationals shuffle tests enqueue
+// through them; other commands are not traced.
+//
+// Commands are placed at their device execution time when their queue has
+// profiling enabled, and marked at their enqueue time otherwise. The harness
+// only enables profiling on the queue of the tests listed, comma-separated, in
+// CL_CONFORMANCE_TRACE_DEVICE ("all" for every test), so that the other tests
+// run on the queue they asked for. Device timestamps are mapped onto the host
+// timeline using clGetDeviceAndHostTimer samples taken while the test runs.
+
+bool trace_enabled();
+
+// True when the harness should enable profiling on the queue of the test
+bool trace_device_timeline(const char *test_name);
+
+// Called by the harness around each test. trace_end_test() waits for the
+// recorded events, converts their profiling info and appends the test's trace
+// events to the file, which is completed when the process exits.
+void trace_begin_test(const char *name, cl_device_id device);
+void trace_end_test();
+
+// Records a command for the trace. The event is retained until the end of the
+// test. work_dim, global_size and local_size are optional and are only used
+// to annotate kernel launches.
+void trace_record_event(cl_event event, const char *name,
+                        cl_uint work_dim = 0,
+                        const size_t *global_size = nullptr,
+                        const size_t *local_size = nullptr);
+
+// clEnqueueNDRangeKernel that records the launch when tracing is enabled,
+// creating an event if the caller did not ask for one.
+cl_int trace_enqueue_nd_range_kernel(cl_command_queue queue, cl_kernel kernel,
+                                     cl_uint work_dim,
+                                     const size_t *global_offset,
+                                     const size_t *global_size,
+                                     const size_t *local_size,
+                                     cl_uint num_events_in_wait_list,
+                                     const cl_event *event_wait_list,
+                                     cl_event *event);
+
+// Buffer and image transfers that are recorded the same way
+cl_int trace_enqueue_read_buffer(cl_command_queue queue, cl_mem buffer,
+                                 cl_bool blocking_read, size_t offset,
+                                 size_t size, void *ptr,
+                                 cl_uint num_events_in_wait_list,
+                                 const cl_event *event_wait_list,
+                                 cl_event *event);
+cl_int trace_enqueue_write_buffer(cl_command_queue queue, cl_mem buffer,
+                                  cl_bool blocking_write, size_t offset,
+                                  size_t size, const void *ptr,
+                                  cl_uint num_events_in_wait_list,
+                                  const cl_event *event_wait_list,
+                                  cl_event *event);
+cl_int trace_enqueue_read_image(cl_command_queue queue, cl_mem image,
+                                cl_bool blocking_read, const size_t *origin,
+                                const size_t *region, size_t row_pitch,
+                                size_t slice_pitch, void *ptr,
+                                cl_uint num_events_in_wait_list,
+                                const cl_event *event_wait_list,
+                                cl_event *event);
+
+// Records the lifetime of the object as a host span, e.g. around reference
+// computation or result verification. Safe to use from worker threads.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *category = "host");
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    const char *category;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // _traceHelpers_h
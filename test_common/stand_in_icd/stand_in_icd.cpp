@@ -0,0 +1,2076 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Minimal OpenCL 1.2 ICD backed by host memory, used to run the harness and
+// the buffers, events and api suites without a real implementation, e.g. to
+// measure harness-side costs. It implements the platform, device, context,
+// queue, buffer, program, kernel and event entry points; all other dispatch
+// entries are left NULL, which the ICD loader reports as an error.
+//
+// All entry points are serialised by one mutex. Commands execute on the
+// calling thread, in submission order, as soon as their wait list is
+// complete, so out-of-order queues behave as in-order ones.
+//
+#include "stand_in_icd.h"
+
+#include <CL/cl_icd.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t max_work_group_size = 1024;
+const size_t mem_base_addr_align = 128; // bytes
+const cl_ulong global_mem_size = 1ULL << 30;
+const cl_ulong max_mem_alloc_size = global_mem_size / 4;
+const cl_ulong local_mem_size = 32 * 1024;
+
+cl_icd_dispatch *get_dispatch();
+
+struct RegisteredKernel
+{
+    cl_uint num_args = 0;
+    stand_in_kernel_fn fn = nullptr;
+    void *user_data = nullptr;
+};
+
+enum ArgKind
+{
+    ARG_VALUE,
+    ARG_MEM,
+    ARG_LOCAL
+};
+
+struct KernelArg
+{
+    bool set = false;
+    ArgKind kind = ARG_VALUE;
+    std::vector<char> value;
+    cl_mem mem = nullptr;
+    size_t size = 0;
+};
+
+struct EventCallback
+{
+    cl_int type;
+    void(CL_CALLBACK *fn)(cl_event, cl_int, void *);
+    void *user_data;
+    bool fired;
+};
+
+struct MemDestructor
+{
+    void(CL_CALLBACK *fn)(cl_mem, void *);
+    void *user_data;
+};
+
+struct Command
+{
+    cl_event event;
+    std::vector<cl_event> waits;
+    std::vector<cl_mem> mems;
+    std::function<cl_int()> run;
+};
+
+}
+
+struct _cl_platform_id
+{
+    cl_icd_dispatch *dispatch;
+};
+
+struct _cl_device_id
+{
+    cl_icd_dispatch *dispatch;
+};
+
+struct _cl_context
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    std::vector<cl_context_properties> properties;
+};
+
+struct _cl_command_queue
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    cl_context context;
+    cl_command_queue_properties properties;
+    std::vector<cl_queue_properties> properties_array;
+    std::deque<Command> pending;
+};
+
+struct _cl_mem
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    cl_context context;
+    cl_mem_flags flags;
+    size_t size;
+    char *data;
+    bool owns_data;
+    void *host_ptr;
+    cl_mem parent;
+    size_t offset;
+    cl_uint map_count;
+    std::vector<MemDestructor> destructors;
+};
+
+struct _cl_program
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    cl_context context;
+    std::string source;
+    std::string options;
+    cl_build_status status;
+    cl_uint num_kernels;
+};
+
+struct _cl_kernel
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    cl_program program;
+    std::string name;
+    RegisteredKernel impl;
+    std::vector<KernelArg> args;
+};
+
+struct _cl_event
+{
+    cl_icd_dispatch *dispatch;
+    cl_uint refs;
+    cl_context context;
+    cl_command_queue queue;
+    cl_command_type type;
+    cl_int status;
+    cl_ulong queued, submitted, started, ended;
+    std::vector<EventCallback> callbacks;
+};
+
+namespace {
+
+struct IcdState
+{
+    std::recursive_mutex mutex;
+    std::condition_variable_any completed;
+    std::atomic<cl_ulong> driver_ns{ 0 };
+    std::map<std::string, RegisteredKernel> kernels;
+    std::set<cl_command_queue> queues;
+    std::set<cl_mem> mems;
+    bool noop_kernels = getenv("STAND_IN_ICD_NOOP_KERNELS") != nullptr;
+    bool draining = false;
+    bool redrain = false;
+};
+
+IcdState &state()
+{
+    static IcdState icd_state;
+    return icd_state;
+}
+
+cl_platform_id the_platform()
+{
+    static _cl_platform_id platform{ get_dispatch() };
+    return &platform;
+}
+
+cl_device_id the_device()
+{
+    static _cl_device_id device{ get_dispatch() };
+    return &device;
+}
+
+cl_ulong now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+thread_local int api_depth = 0;
+
+// Held by every entry point: serialises the API and accounts the time spent
+// in the outermost call as driver time
+class ApiScope {
+public:
+    ApiScope(): lock(state().mutex), start(now_ns()) { api_depth++; }
+    ~ApiScope()
+    {
+        if (--api_depth == 0) state().driver_ns += now_ns() - start;
+    }
+
+    std::unique_lock<std::recursive_mutex> lock;
+
+private:
+    cl_ulong start;
+};
+
+class InfoResult {
+public:
+    InfoResult(size_t param_value_size, void *param_value,
+               size_t *param_value_size_ret)
+        : size(param_value_size), value(param_value),
+          size_ret(param_value_size_ret)
+    {}
+
+    cl_int bytes(const void *data, size_t data_size)
+    {
+        if (value && size < data_size) return CL_INVALID_VALUE;
+        if (value && data_size) memcpy(value, data, data_size);
+        if (size_ret) *size_ret = data_size;
+        return CL_SUCCESS;
+    }
+    template <typename T> cl_int scalar(const T &data)
+    {
+        return bytes(&data, sizeof(data));
+    }
+    template <typename T> cl_int array(const std::vector<T> &data)
+    {
+        return bytes(data.data(), data.size() * sizeof(T));
+    }
+    cl_int string(const std::string &data)
+    {
+        return bytes(data.c_str(), data.size() + 1);
+    }
+
+private:
+    size_t size;
+    void *value;
+    size_t *size_ret;
+};
+
+void set_error(cl_int *errcode_ret, cl_int error)
+{
+    if (errcode_ret) *errcode_ret = error;
+}
+
+bool device_type_matches(cl_device_type type)
+{
+    return (type
+            & (CL_DEVICE_TYPE_CPU | CL_DEVICE_TYPE_DEFAULT
+               | CL_DEVICE_TYPE_ALL))
+        != 0;
+}
+
+// Object lifetime helpers, called with the API mutex held
+
+void release_context(cl_context context)
+{
+    if (--context->refs == 0) delete context;
+}
+
+void release_mem(cl_mem mem)
+{
+    if (--mem->refs) return;
+
+    for (auto it = mem->destructors.rbegin(); it != mem->destructors.rend();
+         ++it)
+        it->fn(mem, it->user_data);
+    state().mems.erase(mem);
+    if (mem->owns_data)
+        ::operator delete(mem->data, std::align_val_t(mem_base_addr_align));
+    if (mem->parent) release_mem(mem->parent);
+    release_context(mem->context);
+    delete mem;
+}
+
+void release_program(cl_program program)
+{
+    if (--program->refs) return;
+    release_context(program->context);
+    delete program;
+}
+
+void release_queue(cl_command_queue queue)
+{
+    if (--queue->refs) return;
+    state().queues.erase(queue);
+    release_context(queue->context);
+    delete queue;
+}
+
+void release_event(cl_event event)
+{
+    if (--event->refs) return;
+    if (event->queue) release_queue(event->queue);
+    release_context(event->context);
+    delete event;
+}
+
+void release_kernel(cl_kernel kernel)
+{
+    if (--kernel->refs) return;
+    kernel->program->num_kernels--;
+    release_program(kernel->program);
+    delete kernel;
+}
+
+cl_event create_event(cl_context context, cl_command_queue queue,
+                      cl_command_type type, cl_int status)
+{
+    cl_event event = new _cl_event();
+    event->dispatch = get_dispatch();
+    event->refs = 1;
+    event->context = context;
+    context->refs++;
+    event->queue = queue;
+    if (queue) queue->refs++;
+    event->type = type;
+    event->status = status;
+    event->queued = now_ns();
+    event->submitted = event->started = event->ended = 0;
+    return event;
+}
+
+void set_event_status(cl_event event, cl_int status)
+{
+    event->status = status;
+    cl_ulong now = now_ns();
+    if (status == CL_SUBMITTED)
+        event->submitted = now;
+    else if (status == CL_RUNNING)
+        event->started = now;
+    else
+        event->ended = now;
+
+    // Callbacks may register further callbacks, so iterate by index
+    event->refs++;
+    for (size_t i = 0; i < event->callbacks.size(); i++)
+    {
+        EventCallback callback = event->callbacks[i];
+        if (callback.fired || status > callback.type) continue;
+        event->callbacks[i].fired = true;
+        callback.fn(event, status < 0 ? status : callback.type,
+                    callback.user_data);
+    }
+    release_event(event);
+
+    if (status <= CL_COMPLETE) state().completed.notify_all();
+}
+
+// Runs the commands at the front of the queue whose wait lists are complete.
+// Returns true if any command ran.
+bool drain_queue(cl_command_queue queue)
+{
+    bool progress = false;
+    while (!queue->pending.empty())
+    {
+        Command &front = queue->pending.front();
+        cl_int wait_status = CL_COMPLETE;
+        for (cl_event wait : front.waits)
+        {
+            if (wait->status < 0)
+                wait_status = CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST;
+            else if (wait->status > CL_COMPLETE && wait_status == CL_COMPLETE)
+                wait_status = wait->status;
+        }
+        if (wait_status > CL_COMPLETE) break;
+
+        Command command = std::move(front);
+        queue->pending.pop_front();
+
+        set_event_status(command.event, CL_SUBMITTED);
+        set_event_status(command.event, CL_RUNNING);
+        cl_int result = wait_status < 0 ? wait_status : command.run();
+        set_event_status(command.event, result < 0 ? result : CL_COMPLETE);
+
+        for (cl_event wait : command.waits) release_event(wait);
+        for (cl_mem mem : command.mems) release_mem(mem);
+        release_event(command.event);
+        progress = true;
+    }
+    return progress;
+}
+
+// Runs every command that can run on any queue. Reentrant calls, e.g. from
+// event callbacks, are folded into the outermost one.
+void drain_all()
+{
+    IcdState &icd = state();
+    if (icd.draining)
+    {
+        icd.redrain = true;
+        return;
+    }
+    icd.draining = true;
+    do
+    {
+        icd.redrain = false;
+        std::vector<cl_command_queue> queues(icd.queues.begin(),
+                                             icd.queues.end());
+        for (cl_command_queue queue : queues) queue->refs++;
+        for (cl_command_queue queue : queues)
+            if (drain_queue(queue)) icd.redrain = true;
+        for (cl_command_queue queue : queues) release_queue(queue);
+    } while (icd.redrain);
+    icd.draining = false;
+}
+
+cl_int wait_for_event(ApiScope &scope, cl_event event)
+{
+    drain_all();
+    state().completed.wait(scope.lock,
+                           [event] { return event->status <= CL_COMPLETE; });
+    return event->status < 0 ? CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST
+                             : CL_SUCCESS;
+}
+
+cl_int validate_wait_list(cl_context context, cl_uint num_events,
+                          const cl_event *event_wait_list)
+{
+    if ((num_events == 0) != (event_wait_list == nullptr))
+        return CL_INVALID_EVENT_WAIT_LIST;
+    for (cl_uint i = 0; i < num_events; i++)
+    {
+        if (event_wait_list[i] == nullptr) return CL_INVALID_EVENT_WAIT_LIST;
+        if (event_wait_list[i]->context != context) return CL_INVALID_CONTEXT;
+    }
+    return CL_SUCCESS;
+}
+
+// Queues a command and runs it if its wait list allows. The command holds a
+// reference to the given memory objects until it has executed.
+cl_int submit(ApiScope &scope, cl_command_queue queue, cl_command_type type,
+              cl_uint num_events, const cl_event *event_wait_list,
+              cl_event *event_out, bool blocking, std::vector<cl_mem> mems,
+              std::function<cl_int()> run)
+{
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    cl_int error =
+        validate_wait_list(queue->context, num_events, event_wait_list);
+    if (error != CL_SUCCESS) return error;
+
+    Command command;
+    command.event =
+        create_event(queue->context, queue, type, CL_QUEUED);
+    command.waits.assign(event_wait_list, event_wait_list + num_events);
+    for (cl_event wait : command.waits) wait->refs++;
+    command.mems = std::move(mems);
+    for (cl_mem mem : command.mems) mem->refs++;
+    command.run = std::move(run);
+
+    cl_event event = command.event;
+    event->refs++;
+    queue->pending.push_back(std::move(command));
+    drain_all();
+
+    if (blocking) error = wait_for_event(scope, event);
+    if (event_out)
+        *event_out = event;
+    else
+        release_event(event);
+    return error;
+}
+
+// Fills in default pitches and checks that the rectangle fits in size bytes
+cl_int resolve_rect(const size_t *origin, const size_t *region,
+                    size_t *row_pitch, size_t *slice_pitch, size_t size)
+{
+    if (origin == nullptr || region == nullptr) return CL_INVALID_VALUE;
+    if (region[0] == 0 || region[1] == 0 || region[2] == 0)
+        return CL_INVALID_VALUE;
+    if (*row_pitch == 0) *row_pitch = region[0];
+    if (*slice_pitch == 0) *slice_pitch = region[1] * *row_pitch;
+    if (*row_pitch < region[0] || *slice_pitch < region[1] * *row_pitch)
+        return CL_INVALID_VALUE;
+    if (size != 0
+        && (origin[2] + region[2] - 1) * *slice_pitch
+                + (origin[1] + region[1] - 1) * *row_pitch + origin[0]
+                + region[0]
+            > size)
+        return CL_INVALID_VALUE;
+    return CL_SUCCESS;
+}
+
+void copy_rect(char *dst, const size_t *dst_origin, size_t dst_row_pitch,
+               size_t dst_slice_pitch, const char *src,
+               const size_t *src_origin, size_t src_row_pitch,
+               size_t src_slice_pitch, const size_t *region)
+{
+    for (size_t z = 0; z < region[2]; z++)
+    {
+        for (size_t y = 0; y < region[1]; y++)
+        {
+            memmove(dst + (dst_origin[2] + z) * dst_slice_pitch
+                        + (dst_origin[1] + y) * dst_row_pitch + dst_origin[0],
+                    src + (src_origin[2] + z) * src_slice_pitch
+                        + (src_origin[1] + y) * src_row_pitch + src_origin[0],
+                    region[0]);
+        }
+    }
+}
+
+cl_int check_buffer_range(cl_mem buffer, size_t offset, size_t size)
+{
+    if (buffer == nullptr || !state().mems.count(buffer))
+        return CL_INVALID_MEM_OBJECT;
+    if (offset > buffer->size || size > buffer->size - offset)
+        return CL_INVALID_VALUE;
+    return CL_SUCCESS;
+}
+
+//
+// Platform and device
+//
+
+cl_int CL_API_CALL standin_clGetPlatformIDs(cl_uint num_entries,
+                                            cl_platform_id *platforms,
+                                            cl_uint *num_platforms)
+{
+    if ((num_entries == 0 && platforms) || (!platforms && !num_platforms))
+        return CL_INVALID_VALUE;
+    if (platforms) platforms[0] = the_platform();
+    if (num_platforms) *num_platforms = 1;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetPlatformInfo(cl_platform_id platform,
+                                             cl_platform_info param_name,
+                                             size_t param_value_size,
+                                             void *param_value,
+                                             size_t *param_value_size_ret)
+{
+    if (platform != the_platform()) return CL_INVALID_PLATFORM;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_PLATFORM_PROFILE: return out.string("FULL_PROFILE");
+        case CL_PLATFORM_VERSION: return out.string("OpenCL 1.2 stand-in");
+        case CL_PLATFORM_NAME: return out.string("Stand-in CPU platform");
+        case CL_PLATFORM_VENDOR: return out.string("OpenCL-CTS");
+        case CL_PLATFORM_EXTENSIONS: return out.string("cl_khr_icd");
+        case CL_PLATFORM_ICD_SUFFIX_KHR: return out.string("StandIn");
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clGetDeviceIDs(cl_platform_id platform,
+                                          cl_device_type device_type,
+                                          cl_uint num_entries,
+                                          cl_device_id *devices,
+                                          cl_uint *num_devices)
+{
+    if (platform != nullptr && platform != the_platform())
+        return CL_INVALID_PLATFORM;
+    if ((num_entries == 0 && devices) || (!devices && !num_devices))
+        return CL_INVALID_VALUE;
+    if (!device_type_matches(device_type)) return CL_DEVICE_NOT_FOUND;
+    if (devices) devices[0] = the_device();
+    if (num_devices) *num_devices = 1;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetDeviceInfo(cl_device_id device,
+                                           cl_device_info param_name,
+                                           size_t param_value_size,
+                                           void *param_value,
+                                           size_t *param_value_size_ret)
+{
+    if (device != the_device()) return CL_INVALID_DEVICE;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_DEVICE_TYPE:
+            return out.scalar<cl_device_type>(CL_DEVICE_TYPE_CPU);
+        case CL_DEVICE_VENDOR_ID: return out.scalar<cl_uint>(0);
+        case CL_DEVICE_MAX_COMPUTE_UNITS: return out.scalar<cl_uint>(1);
+        case CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS: return out.scalar<cl_uint>(3);
+        case CL_DEVICE_MAX_WORK_ITEM_SIZES:
+            return out.array<size_t>({ max_work_group_size,
+                                       max_work_group_size,
+                                       max_work_group_size });
+        case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+            return out.scalar<size_t>(max_work_group_size);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_CHAR:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_CHAR:
+            return out.scalar<cl_uint>(16);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_SHORT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_SHORT:
+            return out.scalar<cl_uint>(8);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_INT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_INT:
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT:
+            return out.scalar<cl_uint>(4);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_LONG:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_LONG:
+            return out.scalar<cl_uint>(2);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_DOUBLE:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_DOUBLE:
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_HALF:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_HALF:
+            return out.scalar<cl_uint>(0);
+        case CL_DEVICE_MAX_CLOCK_FREQUENCY: return out.scalar<cl_uint>(1000);
+        case CL_DEVICE_ADDRESS_BITS:
+            return out.scalar<cl_uint>(sizeof(void *) * 8);
+        case CL_DEVICE_MAX_MEM_ALLOC_SIZE:
+            return out.scalar<cl_ulong>(max_mem_alloc_size);
+        case CL_DEVICE_IMAGE_SUPPORT: return out.scalar<cl_bool>(CL_FALSE);
+        case CL_DEVICE_MAX_READ_IMAGE_ARGS:
+        case CL_DEVICE_MAX_WRITE_IMAGE_ARGS:
+        case CL_DEVICE_MAX_SAMPLERS: return out.scalar<cl_uint>(0);
+        case CL_DEVICE_IMAGE2D_MAX_WIDTH:
+        case CL_DEVICE_IMAGE2D_MAX_HEIGHT:
+        case CL_DEVICE_IMAGE3D_MAX_WIDTH:
+        case CL_DEVICE_IMAGE3D_MAX_HEIGHT:
+        case CL_DEVICE_IMAGE3D_MAX_DEPTH:
+        case CL_DEVICE_IMAGE_MAX_BUFFER_SIZE:
+        case CL_DEVICE_IMAGE_MAX_ARRAY_SIZE: return out.scalar<size_t>(0);
+        case CL_DEVICE_MAX_PARAMETER_SIZE: return out.scalar<size_t>(1024);
+        case CL_DEVICE_MEM_BASE_ADDR_ALIGN:
+            return out.scalar<cl_uint>(mem_base_addr_align * 8);
+        case CL_DEVICE_MIN_DATA_TYPE_ALIGN_SIZE:
+            return out.scalar<cl_uint>(mem_base_addr_align);
+        case CL_DEVICE_SINGLE_FP_CONFIG:
+            return out.scalar<cl_device_fp_config>(
+                CL_FP_DENORM | CL_FP_INF_NAN | CL_FP_ROUND_TO_NEAREST
+                | CL_FP_FMA);
+        case CL_DEVICE_DOUBLE_FP_CONFIG:
+        case CL_DEVICE_HALF_FP_CONFIG:
+            return out.scalar<cl_device_fp_config>(0);
+        case CL_DEVICE_GLOBAL_MEM_CACHE_TYPE:
+            return out.scalar<cl_device_mem_cache_type>(CL_READ_WRITE_CACHE);
+        case CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE:
+            return out.scalar<cl_uint>(64);
+        case CL_DEVICE_GLOBAL_MEM_CACHE_SIZE:
+            return out.scalar<cl_ulong>(1024 * 1024);
+        case CL_DEVICE_GLOBAL_MEM_SIZE:
+            return out.scalar<cl_ulong>(global_mem_size);
+        case CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE:
+            return out.scalar<cl_ulong>(64 * 1024);
+        case CL_DEVICE_MAX_CONSTANT_ARGS: return out.scalar<cl_uint>(8);
+        case CL_DEVICE_LOCAL_MEM_TYPE:
+            return out.scalar<cl_device_local_mem_type>(CL_GLOBAL);
+        case CL_DEVICE_LOCAL_MEM_SIZE:
+            return out.scalar<cl_ulong>(local_mem_size);
+        case CL_DEVICE_ERROR_CORRECTION_SUPPORT:
+            return out.scalar<cl_bool>(CL_FALSE);
+        case CL_DEVICE_HOST_UNIFIED_MEMORY: return out.scalar<cl_bool>(CL_TRUE);
+        case CL_DEVICE_PROFILING_TIMER_RESOLUTION:
+            return out.scalar<size_t>(1);
+        case CL_DEVICE_ENDIAN_LITTLE: return out.scalar<cl_bool>(CL_TRUE);
+        case CL_DEVICE_AVAILABLE:
+        case CL_DEVICE_COMPILER_AVAILABLE: return out.scalar<cl_bool>(CL_TRUE);
+        case CL_DEVICE_LINKER_AVAILABLE: return out.scalar<cl_bool>(CL_FALSE);
+        case CL_DEVICE_EXECUTION_CAPABILITIES:
+            return out.scalar<cl_device_exec_capabilities>(CL_EXEC_KERNEL);
+        case CL_DEVICE_QUEUE_PROPERTIES:
+            return out.scalar<cl_command_queue_properties>(
+                CL_QUEUE_PROFILING_ENABLE
+                | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+        case CL_DEVICE_BUILT_IN_KERNELS: return out.string("");
+        case CL_DEVICE_PLATFORM: return out.scalar(the_platform());
+        case CL_DEVICE_NAME: return out.string("Stand-in CPU device");
+        case CL_DEVICE_VENDOR: return out.string("OpenCL-CTS");
+        case CL_DRIVER_VERSION: return out.string("1.0");
+        case CL_DEVICE_PROFILE: return out.string("FULL_PROFILE");
+        case CL_DEVICE_VERSION: return out.string("OpenCL 1.2 stand-in");
+        case CL_DEVICE_OPENCL_C_VERSION: return out.string("OpenCL C 1.2 ");
+        case CL_DEVICE_EXTENSIONS: return out.string("");
+        case CL_DEVICE_PRINTF_BUFFER_SIZE:
+            return out.scalar<size_t>(1024 * 1024);
+        case CL_DEVICE_PREFERRED_INTEROP_USER_SYNC:
+            return out.scalar<cl_bool>(CL_TRUE);
+        case CL_DEVICE_PARENT_DEVICE:
+            return out.scalar<cl_device_id>(nullptr);
+        case CL_DEVICE_PARTITION_MAX_SUB_DEVICES:
+            return out.scalar<cl_uint>(0);
+        case CL_DEVICE_PARTITION_PROPERTIES:
+        case CL_DEVICE_PARTITION_TYPE:
+            return out.scalar<cl_device_partition_property>(0);
+        case CL_DEVICE_PARTITION_AFFINITY_DOMAIN:
+            return out.scalar<cl_device_affinity_domain>(0);
+        case CL_DEVICE_REFERENCE_COUNT: return out.scalar<cl_uint>(1);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clCreateSubDevices(
+    cl_device_id in_device, const cl_device_partition_property *properties,
+    cl_uint num_devices, cl_device_id *out_devices, cl_uint *num_devices_ret)
+{
+    if (in_device != the_device()) return CL_INVALID_DEVICE;
+    // No partition types are supported
+    return CL_INVALID_VALUE;
+}
+
+cl_int CL_API_CALL standin_clRetainDevice(cl_device_id device)
+{
+    return device == the_device() ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+cl_int CL_API_CALL standin_clReleaseDevice(cl_device_id device)
+{
+    return device == the_device() ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+//
+// Context
+//
+
+cl_context create_context(const cl_context_properties *properties,
+                          cl_int *errcode_ret)
+{
+    std::vector<cl_context_properties> props;
+    for (const cl_context_properties *p = properties; p && p[0]; p += 2)
+    {
+        if (p[0] != CL_CONTEXT_PLATFORM)
+        {
+            set_error(errcode_ret, CL_INVALID_PROPERTY);
+            return nullptr;
+        }
+        if ((cl_platform_id)p[1] != the_platform())
+        {
+            set_error(errcode_ret, CL_INVALID_PLATFORM);
+            return nullptr;
+        }
+        props.push_back(p[0]);
+        props.push_back(p[1]);
+    }
+    if (!props.empty()) props.push_back(0);
+
+    cl_context context = new _cl_context();
+    context->dispatch = get_dispatch();
+    context->refs = 1;
+    context->properties = props;
+    set_error(errcode_ret, CL_SUCCESS);
+    return context;
+}
+
+cl_context CL_API_CALL standin_clCreateContext(
+    const cl_context_properties *properties, cl_uint num_devices,
+    const cl_device_id *devices,
+    void(CL_CALLBACK *pfn_notify)(const char *, const void *, size_t, void *),
+    void *user_data, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (num_devices == 0 || devices == nullptr
+        || (pfn_notify == nullptr && user_data != nullptr))
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    for (cl_uint i = 0; i < num_devices; i++)
+    {
+        if (devices[i] != the_device())
+        {
+            set_error(errcode_ret, CL_INVALID_DEVICE);
+            return nullptr;
+        }
+    }
+    return create_context(properties, errcode_ret);
+}
+
+cl_context CL_API_CALL standin_clCreateContextFromType(
+    const cl_context_properties *properties, cl_device_type device_type,
+    void(CL_CALLBACK *pfn_notify)(const char *, const void *, size_t, void *),
+    void *user_data, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (pfn_notify == nullptr && user_data != nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    if (!device_type_matches(device_type))
+    {
+        set_error(errcode_ret, CL_DEVICE_NOT_FOUND);
+        return nullptr;
+    }
+    return create_context(properties, errcode_ret);
+}
+
+cl_int CL_API_CALL standin_clRetainContext(cl_context context)
+{
+    ApiScope scope;
+    if (context == nullptr) return CL_INVALID_CONTEXT;
+    context->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseContext(cl_context context)
+{
+    ApiScope scope;
+    if (context == nullptr) return CL_INVALID_CONTEXT;
+    release_context(context);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetContextInfo(cl_context context,
+                                            cl_context_info param_name,
+                                            size_t param_value_size,
+                                            void *param_value,
+                                            size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (context == nullptr) return CL_INVALID_CONTEXT;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_CONTEXT_REFERENCE_COUNT: return out.scalar(context->refs);
+        case CL_CONTEXT_NUM_DEVICES: return out.scalar<cl_uint>(1);
+        case CL_CONTEXT_DEVICES: return out.scalar(the_device());
+        case CL_CONTEXT_PROPERTIES: return out.array(context->properties);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+//
+// Command queue
+//
+
+cl_command_queue create_queue(cl_context context, cl_device_id device,
+                              cl_command_queue_properties properties,
+                              cl_int *errcode_ret)
+{
+    if (context == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    if (device != the_device())
+    {
+        set_error(errcode_ret, CL_INVALID_DEVICE);
+        return nullptr;
+    }
+    if (properties
+        & ~(cl_command_queue_properties)(
+            CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE))
+    {
+        set_error(errcode_ret, CL_INVALID_QUEUE_PROPERTIES);
+        return nullptr;
+    }
+
+    cl_command_queue queue = new _cl_command_queue();
+    queue->dispatch = get_dispatch();
+    queue->refs = 1;
+    queue->context = context;
+    context->refs++;
+    queue->properties = properties;
+    state().queues.insert(queue);
+    set_error(errcode_ret, CL_SUCCESS);
+    return queue;
+}
+
+cl_command_queue CL_API_CALL standin_clCreateCommandQueue(
+    cl_context context, cl_device_id device,
+    cl_command_queue_properties properties, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    return create_queue(context, device, properties, errcode_ret);
+}
+
+cl_command_queue CL_API_CALL standin_clCreateCommandQueueWithProperties(
+    cl_context context, cl_device_id device,
+    const cl_queue_properties *properties, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    cl_command_queue_properties queue_properties = 0;
+    std::vector<cl_queue_properties> props;
+    for (const cl_queue_properties *p = properties; p && p[0]; p += 2)
+    {
+        if (p[0] != CL_QUEUE_PROPERTIES)
+        {
+            set_error(errcode_ret, CL_INVALID_VALUE);
+            return nullptr;
+        }
+        queue_properties = p[1];
+        props.push_back(p[0]);
+        props.push_back(p[1]);
+    }
+    if (!props.empty()) props.push_back(0);
+
+    cl_command_queue queue =
+        create_queue(context, device, queue_properties, errcode_ret);
+    if (queue) queue->properties_array = props;
+    return queue;
+}
+
+cl_int CL_API_CALL standin_clRetainCommandQueue(cl_command_queue queue)
+{
+    ApiScope scope;
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    queue->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseCommandQueue(cl_command_queue queue)
+{
+    ApiScope scope;
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    drain_all();
+    release_queue(queue);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetCommandQueueInfo(
+    cl_command_queue queue, cl_command_queue_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_QUEUE_CONTEXT: return out.scalar(queue->context);
+        case CL_QUEUE_DEVICE: return out.scalar(the_device());
+        case CL_QUEUE_REFERENCE_COUNT: return out.scalar(queue->refs);
+        case CL_QUEUE_PROPERTIES: return out.scalar(queue->properties);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clFlush(cl_command_queue queue)
+{
+    ApiScope scope;
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    drain_all();
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clFinish(cl_command_queue queue)
+{
+    ApiScope scope;
+    if (queue == nullptr) return CL_INVALID_COMMAND_QUEUE;
+    drain_all();
+    state().completed.wait(scope.lock,
+                           [queue] { return queue->pending.empty(); });
+    return CL_SUCCESS;
+}
+
+//
+// Buffers
+//
+
+cl_mem CL_API_CALL standin_clCreateBuffer(cl_context context,
+                                          cl_mem_flags flags, size_t size,
+                                          void *host_ptr, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (context == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    if (flags == 0) flags = CL_MEM_READ_WRITE;
+    const cl_mem_flags access =
+        CL_MEM_READ_WRITE | CL_MEM_WRITE_ONLY | CL_MEM_READ_ONLY;
+    const cl_mem_flags host_access = CL_MEM_HOST_WRITE_ONLY
+        | CL_MEM_HOST_READ_ONLY | CL_MEM_HOST_NO_ACCESS;
+    const cl_mem_flags valid = access | host_access | CL_MEM_USE_HOST_PTR
+        | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR;
+    bool uses_host_ptr = (flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR));
+    cl_mem_flags access_bits = flags & access;
+    cl_mem_flags host_bits = flags & host_access;
+    if ((flags & ~valid) || (access_bits & (access_bits - 1))
+        || (host_bits & (host_bits - 1))
+        || ((flags & CL_MEM_USE_HOST_PTR)
+            && (flags & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR))))
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    if (size == 0 || size > max_mem_alloc_size)
+    {
+        set_error(errcode_ret, CL_INVALID_BUFFER_SIZE);
+        return nullptr;
+    }
+    if (uses_host_ptr != (host_ptr != nullptr))
+    {
+        set_error(errcode_ret, CL_INVALID_HOST_PTR);
+        return nullptr;
+    }
+
+    cl_mem mem = new _cl_mem();
+    mem->dispatch = get_dispatch();
+    mem->refs = 1;
+    mem->context = context;
+    context->refs++;
+    mem->flags = flags;
+    mem->size = size;
+    mem->parent = nullptr;
+    mem->offset = 0;
+    mem->map_count = 0;
+    mem->host_ptr = (flags & CL_MEM_USE_HOST_PTR) ? host_ptr : nullptr;
+    mem->owns_data = !(flags & CL_MEM_USE_HOST_PTR);
+    if (mem->owns_data)
+    {
+        mem->data = static_cast<char *>(
+            ::operator new(size, std::align_val_t(mem_base_addr_align)));
+        if (flags & CL_MEM_COPY_HOST_PTR)
+            memcpy(mem->data, host_ptr, size);
+        else
+            memset(mem->data, 0, size);
+    }
+    else
+    {
+        mem->data = static_cast<char *>(host_ptr);
+    }
+    state().mems.insert(mem);
+    set_error(errcode_ret, CL_SUCCESS);
+    return mem;
+}
+
+cl_mem CL_API_CALL standin_clCreateSubBuffer(
+    cl_mem buffer, cl_mem_flags flags, cl_buffer_create_type buffer_create_type,
+    const void *buffer_create_info, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (buffer == nullptr || !state().mems.count(buffer) || buffer->parent)
+    {
+        set_error(errcode_ret, CL_INVALID_MEM_OBJECT);
+        return nullptr;
+    }
+    if (buffer_create_type != CL_BUFFER_CREATE_TYPE_REGION
+        || buffer_create_info == nullptr
+        || (flags
+            & (CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR
+               | CL_MEM_COPY_HOST_PTR)))
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    const cl_buffer_region *region =
+        static_cast<const cl_buffer_region *>(buffer_create_info);
+    if (region->size == 0)
+    {
+        set_error(errcode_ret, CL_INVALID_BUFFER_SIZE);
+        return nullptr;
+    }
+    if (region->origin > buffer->size
+        || region->size > buffer->size - region->origin)
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    if (region->origin % mem_base_addr_align)
+    {
+        set_error(errcode_ret, CL_MISALIGNED_SUB_BUFFER_OFFSET);
+        return nullptr;
+    }
+
+    cl_mem mem = new _cl_mem();
+    mem->dispatch = get_dispatch();
+    mem->refs = 1;
+    mem->context = buffer->context;
+    mem->context->refs++;
+    mem->flags = flags ? flags : buffer->flags;
+    mem->size = region->size;
+    mem->data = buffer->data + region->origin;
+    mem->owns_data = false;
+    mem->host_ptr =
+        buffer->host_ptr ? (char *)buffer->host_ptr + region->origin : nullptr;
+    mem->parent = buffer;
+    buffer->refs++;
+    mem->offset = region->origin;
+    mem->map_count = 0;
+    state().mems.insert(mem);
+    set_error(errcode_ret, CL_SUCCESS);
+    return mem;
+}
+
+cl_int CL_API_CALL standin_clRetainMemObject(cl_mem mem)
+{
+    ApiScope scope;
+    if (mem == nullptr || !state().mems.count(mem))
+        return CL_INVALID_MEM_OBJECT;
+    mem->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseMemObject(cl_mem mem)
+{
+    ApiScope scope;
+    if (mem == nullptr || !state().mems.count(mem))
+        return CL_INVALID_MEM_OBJECT;
+    release_mem(mem);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetSupportedImageFormats(
+    cl_context context, cl_mem_flags flags, cl_mem_object_type image_type,
+    cl_uint num_entries, cl_image_format *image_formats,
+    cl_uint *num_image_formats)
+{
+    if (context == nullptr) return CL_INVALID_CONTEXT;
+    if (num_image_formats) *num_image_formats = 0;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetMemObjectInfo(cl_mem mem,
+                                              cl_mem_info param_name,
+                                              size_t param_value_size,
+                                              void *param_value,
+                                              size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (mem == nullptr || !state().mems.count(mem))
+        return CL_INVALID_MEM_OBJECT;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_MEM_TYPE:
+            return out.scalar<cl_mem_object_type>(CL_MEM_OBJECT_BUFFER);
+        case CL_MEM_FLAGS: return out.scalar(mem->flags);
+        case CL_MEM_SIZE: return out.scalar(mem->size);
+        case CL_MEM_HOST_PTR: return out.scalar(mem->host_ptr);
+        case CL_MEM_MAP_COUNT: return out.scalar(mem->map_count);
+        case CL_MEM_REFERENCE_COUNT: return out.scalar(mem->refs);
+        case CL_MEM_CONTEXT: return out.scalar(mem->context);
+        case CL_MEM_ASSOCIATED_MEMOBJECT: return out.scalar(mem->parent);
+        case CL_MEM_OFFSET: return out.scalar(mem->offset);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clSetMemObjectDestructorCallback(
+    cl_mem mem, void(CL_CALLBACK *pfn_notify)(cl_mem, void *), void *user_data)
+{
+    ApiScope scope;
+    if (mem == nullptr || !state().mems.count(mem))
+        return CL_INVALID_MEM_OBJECT;
+    if (pfn_notify == nullptr) return CL_INVALID_VALUE;
+    mem->destructors.push_back({ pfn_notify, user_data });
+    return CL_SUCCESS;
+}
+
+//
+// Programs and kernels
+//
+
+cl_program CL_API_CALL standin_clCreateProgramWithSource(
+    cl_context context, cl_uint count, const char **strings,
+    const size_t *lengths, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (context == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    if (count == 0 || strings == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+
+    std::string source;
+    for (cl_uint i = 0; i < count; i++)
+    {
+        if (strings[i] == nullptr)
+        {
+            set_error(errcode_ret, CL_INVALID_VALUE);
+            return nullptr;
+        }
+        if (lengths && lengths[i])
+            source.append(strings[i], lengths[i]);
+        else
+            source.append(strings[i]);
+    }
+
+    cl_program program = new _cl_program();
+    program->dispatch = get_dispatch();
+    program->refs = 1;
+    program->context = context;
+    context->refs++;
+    program->source = source;
+    program->status = CL_BUILD_NONE;
+    program->num_kernels = 0;
+    set_error(errcode_ret, CL_SUCCESS);
+    return program;
+}
+
+cl_int CL_API_CALL standin_clRetainProgram(cl_program program)
+{
+    ApiScope scope;
+    if (program == nullptr) return CL_INVALID_PROGRAM;
+    program->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseProgram(cl_program program)
+{
+    ApiScope scope;
+    if (program == nullptr) return CL_INVALID_PROGRAM;
+    release_program(program);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clBuildProgram(
+    cl_program program, cl_uint num_devices, const cl_device_id *device_list,
+    const char *options, void(CL_CALLBACK *pfn_notify)(cl_program, void *),
+    void *user_data)
+{
+    ApiScope scope;
+    if (program == nullptr) return CL_INVALID_PROGRAM;
+    if ((num_devices == 0) != (device_list == nullptr)
+        || (pfn_notify == nullptr && user_data != nullptr))
+        return CL_INVALID_VALUE;
+    for (cl_uint i = 0; i < num_devices; i++)
+        if (device_list[i] != the_device()) return CL_INVALID_DEVICE;
+    if (program->num_kernels) return CL_INVALID_OPERATION;
+
+    program->options = options ? options : "";
+    program->status = CL_BUILD_SUCCESS;
+    if (pfn_notify) pfn_notify(program, user_data);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clUnloadPlatformCompiler(cl_platform_id platform)
+{
+    return platform == the_platform() ? CL_SUCCESS : CL_INVALID_PLATFORM;
+}
+
+cl_int CL_API_CALL standin_clGetProgramInfo(cl_program program,
+                                            cl_program_info param_name,
+                                            size_t param_value_size,
+                                            void *param_value,
+                                            size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (program == nullptr) return CL_INVALID_PROGRAM;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_PROGRAM_REFERENCE_COUNT: return out.scalar(program->refs);
+        case CL_PROGRAM_CONTEXT: return out.scalar(program->context);
+        case CL_PROGRAM_NUM_DEVICES: return out.scalar<cl_uint>(1);
+        case CL_PROGRAM_DEVICES: return out.scalar(the_device());
+        case CL_PROGRAM_SOURCE: return out.string(program->source);
+        case CL_PROGRAM_BINARY_SIZES: return out.scalar<size_t>(0);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clGetProgramBuildInfo(
+    cl_program program, cl_device_id device, cl_program_build_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (program == nullptr) return CL_INVALID_PROGRAM;
+    if (device != the_device()) return CL_INVALID_DEVICE;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_PROGRAM_BUILD_STATUS: return out.scalar(program->status);
+        case CL_PROGRAM_BUILD_OPTIONS: return out.string(program->options);
+        case CL_PROGRAM_BUILD_LOG: return out.string("");
+        case CL_PROGRAM_BINARY_TYPE:
+            return out.scalar<cl_program_binary_type>(
+                program->status == CL_BUILD_SUCCESS
+                    ? CL_PROGRAM_BINARY_TYPE_EXECUTABLE
+                    : CL_PROGRAM_BINARY_TYPE_NONE);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_kernel CL_API_CALL standin_clCreateKernel(cl_program program,
+                                            const char *kernel_name,
+                                            cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (program == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_PROGRAM);
+        return nullptr;
+    }
+    if (program->status != CL_BUILD_SUCCESS)
+    {
+        set_error(errcode_ret, CL_INVALID_PROGRAM_EXECUTABLE);
+        return nullptr;
+    }
+    if (kernel_name == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+
+    RegisteredKernel impl;
+    auto it = state().kernels.find(kernel_name);
+    if (it != state().kernels.end())
+        impl = it->second;
+    else if (!state().noop_kernels)
+    {
+        set_error(errcode_ret, CL_INVALID_KERNEL_NAME);
+        return nullptr;
+    }
+
+    cl_kernel kernel = new _cl_kernel();
+    kernel->dispatch = get_dispatch();
+    kernel->refs = 1;
+    kernel->program = program;
+    program->refs++;
+    program->num_kernels++;
+    kernel->name = kernel_name;
+    kernel->impl = impl;
+    kernel->args.resize(impl.num_args);
+    set_error(errcode_ret, CL_SUCCESS);
+    return kernel;
+}
+
+cl_int CL_API_CALL standin_clRetainKernel(cl_kernel kernel)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    kernel->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseKernel(cl_kernel kernel)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    release_kernel(kernel);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clSetKernelArg(cl_kernel kernel, cl_uint arg_index,
+                                         size_t arg_size,
+                                         const void *arg_value)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    if (kernel->impl.num_args && arg_index >= kernel->impl.num_args)
+        return CL_INVALID_ARG_INDEX;
+    if (arg_index >= kernel->args.size()) kernel->args.resize(arg_index + 1);
+
+    KernelArg &arg = kernel->args[arg_index];
+    if (arg_value == nullptr)
+    {
+        // Without a compiler the argument types are unknown, so a NULL value
+        // is always treated as a local memory allocation
+        if (arg_size == 0 || arg_size > local_mem_size)
+            return CL_INVALID_ARG_SIZE;
+        arg.kind = ARG_LOCAL;
+        arg.size = arg_size;
+    }
+    else if (arg_size == sizeof(cl_mem)
+             && state().mems.count(*static_cast<const cl_mem *>(arg_value)))
+    {
+        arg.kind = ARG_MEM;
+        arg.mem = *static_cast<const cl_mem *>(arg_value);
+        arg.size = arg_size;
+    }
+    else
+    {
+        if (arg_size == 0) return CL_INVALID_ARG_SIZE;
+        arg.kind = ARG_VALUE;
+        const char *bytes = static_cast<const char *>(arg_value);
+        arg.value.assign(bytes, bytes + arg_size);
+        arg.size = arg_size;
+    }
+    arg.set = true;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetKernelInfo(cl_kernel kernel,
+                                           cl_kernel_info param_name,
+                                           size_t param_value_size,
+                                           void *param_value,
+                                           size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_KERNEL_FUNCTION_NAME: return out.string(kernel->name);
+        case CL_KERNEL_NUM_ARGS:
+            return out.scalar<cl_uint>((cl_uint)kernel->args.size());
+        case CL_KERNEL_REFERENCE_COUNT: return out.scalar(kernel->refs);
+        case CL_KERNEL_CONTEXT: return out.scalar(kernel->program->context);
+        case CL_KERNEL_PROGRAM: return out.scalar(kernel->program);
+        case CL_KERNEL_ATTRIBUTES: return out.string("");
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_int CL_API_CALL standin_clGetKernelWorkGroupInfo(
+    cl_kernel kernel, cl_device_id device,
+    cl_kernel_work_group_info param_name, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    if (device != nullptr && device != the_device()) return CL_INVALID_DEVICE;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_KERNEL_WORK_GROUP_SIZE:
+            return out.scalar<size_t>(max_work_group_size);
+        case CL_KERNEL_COMPILE_WORK_GROUP_SIZE:
+            return out.array<size_t>({ 0, 0, 0 });
+        case CL_KERNEL_LOCAL_MEM_SIZE:
+        case CL_KERNEL_PRIVATE_MEM_SIZE: return out.scalar<cl_ulong>(0);
+        case CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE:
+            return out.scalar<size_t>(1);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+//
+// Events
+//
+
+cl_int CL_API_CALL standin_clWaitForEvents(cl_uint num_events,
+                                           const cl_event *event_list)
+{
+    ApiScope scope;
+    if (num_events == 0 || event_list == nullptr) return CL_INVALID_VALUE;
+    for (cl_uint i = 0; i < num_events; i++)
+    {
+        if (event_list[i] == nullptr) return CL_INVALID_EVENT;
+        if (event_list[i]->context != event_list[0]->context)
+            return CL_INVALID_CONTEXT;
+    }
+
+    cl_int error = CL_SUCCESS;
+    for (cl_uint i = 0; i < num_events; i++)
+        if (wait_for_event(scope, event_list[i]) != CL_SUCCESS)
+            error = CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST;
+    return error;
+}
+
+cl_int CL_API_CALL standin_clGetEventInfo(cl_event event,
+                                          cl_event_info param_name,
+                                          size_t param_value_size,
+                                          void *param_value,
+                                          size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (event == nullptr) return CL_INVALID_EVENT;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_EVENT_COMMAND_QUEUE: return out.scalar(event->queue);
+        case CL_EVENT_CONTEXT: return out.scalar(event->context);
+        case CL_EVENT_COMMAND_TYPE: return out.scalar(event->type);
+        case CL_EVENT_COMMAND_EXECUTION_STATUS:
+            return out.scalar(event->status);
+        case CL_EVENT_REFERENCE_COUNT: return out.scalar(event->refs);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+cl_event CL_API_CALL standin_clCreateUserEvent(cl_context context,
+                                               cl_int *errcode_ret)
+{
+    ApiScope scope;
+    if (context == nullptr)
+    {
+        set_error(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    set_error(errcode_ret, CL_SUCCESS);
+    return create_event(context, nullptr, CL_COMMAND_USER, CL_SUBMITTED);
+}
+
+cl_int CL_API_CALL standin_clRetainEvent(cl_event event)
+{
+    ApiScope scope;
+    if (event == nullptr) return CL_INVALID_EVENT;
+    event->refs++;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clReleaseEvent(cl_event event)
+{
+    ApiScope scope;
+    if (event == nullptr) return CL_INVALID_EVENT;
+    release_event(event);
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clSetUserEventStatus(cl_event event,
+                                                cl_int execution_status)
+{
+    ApiScope scope;
+    if (event == nullptr || event->type != CL_COMMAND_USER)
+        return CL_INVALID_EVENT;
+    if (execution_status > CL_COMPLETE) return CL_INVALID_VALUE;
+    if (event->status <= CL_COMPLETE) return CL_INVALID_OPERATION;
+    set_event_status(event, execution_status);
+    drain_all();
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clSetEventCallback(
+    cl_event event, cl_int command_exec_callback_type,
+    void(CL_CALLBACK *pfn_notify)(cl_event, cl_int, void *), void *user_data)
+{
+    ApiScope scope;
+    if (event == nullptr) return CL_INVALID_EVENT;
+    if (pfn_notify == nullptr
+        || (command_exec_callback_type != CL_SUBMITTED
+            && command_exec_callback_type != CL_RUNNING
+            && command_exec_callback_type != CL_COMPLETE))
+        return CL_INVALID_VALUE;
+
+    if (event->status <= command_exec_callback_type)
+    {
+        // The status has already been reached
+        pfn_notify(event,
+                   event->status < 0 ? event->status
+                                     : command_exec_callback_type,
+                   user_data);
+        return CL_SUCCESS;
+    }
+    event->callbacks.push_back(
+        { command_exec_callback_type, pfn_notify, user_data, false });
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clGetEventProfilingInfo(
+    cl_event event, cl_profiling_info param_name, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret)
+{
+    ApiScope scope;
+    if (event == nullptr) return CL_INVALID_EVENT;
+    if (event->queue == nullptr
+        || !(event->queue->properties & CL_QUEUE_PROFILING_ENABLE)
+        || event->status != CL_COMPLETE)
+        return CL_PROFILING_INFO_NOT_AVAILABLE;
+    InfoResult out(param_value_size, param_value, param_value_size_ret);
+    switch (param_name)
+    {
+        case CL_PROFILING_COMMAND_QUEUED: return out.scalar(event->queued);
+        case CL_PROFILING_COMMAND_SUBMIT: return out.scalar(event->submitted);
+        case CL_PROFILING_COMMAND_START: return out.scalar(event->started);
+        case CL_PROFILING_COMMAND_END: return out.scalar(event->ended);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+//
+// Enqueued commands
+//
+
+cl_int CL_API_CALL standin_clEnqueueReadBuffer(
+    cl_command_queue queue, cl_mem buffer, cl_bool blocking_read,
+    size_t offset, size_t size, void *ptr, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, offset, size);
+    if (error != CL_SUCCESS) return error;
+    if (ptr == nullptr || size == 0) return CL_INVALID_VALUE;
+    return submit(scope, queue, CL_COMMAND_READ_BUFFER,
+                  num_events_in_wait_list, event_wait_list, event,
+                  blocking_read, { buffer }, [=] {
+                      memcpy(ptr, buffer->data + offset, size);
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueWriteBuffer(
+    cl_command_queue queue, cl_mem buffer, cl_bool blocking_write,
+    size_t offset, size_t size, const void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, offset, size);
+    if (error != CL_SUCCESS) return error;
+    if (ptr == nullptr || size == 0) return CL_INVALID_VALUE;
+    return submit(scope, queue, CL_COMMAND_WRITE_BUFFER,
+                  num_events_in_wait_list, event_wait_list, event,
+                  blocking_write, { buffer }, [=] {
+                      memcpy(buffer->data + offset, ptr, size);
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueReadBufferRect(
+    cl_command_queue queue, cl_mem buffer, cl_bool blocking_read,
+    const size_t *buffer_origin, const size_t *host_origin,
+    const size_t *region, size_t buffer_row_pitch, size_t buffer_slice_pitch,
+    size_t host_row_pitch, size_t host_slice_pitch, void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, 0, 0);
+    if (error != CL_SUCCESS) return error;
+    if (ptr == nullptr) return CL_INVALID_VALUE;
+    error = resolve_rect(buffer_origin, region, &buffer_row_pitch,
+                         &buffer_slice_pitch, buffer->size);
+    if (error == CL_SUCCESS)
+        error = resolve_rect(host_origin, region, &host_row_pitch,
+                             &host_slice_pitch, 0);
+    if (error != CL_SUCCESS) return error;
+
+    std::vector<size_t> b(buffer_origin, buffer_origin + 3);
+    std::vector<size_t> h(host_origin, host_origin + 3);
+    std::vector<size_t> r(region, region + 3);
+    return submit(scope, queue, CL_COMMAND_READ_BUFFER_RECT,
+                  num_events_in_wait_list, event_wait_list, event,
+                  blocking_read, { buffer }, [=] {
+                      copy_rect((char *)ptr, h.data(), host_row_pitch,
+                                host_slice_pitch, buffer->data, b.data(),
+                                buffer_row_pitch, buffer_slice_pitch,
+                                r.data());
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueWriteBufferRect(
+    cl_command_queue queue, cl_mem buffer, cl_bool blocking_write,
+    const size_t *buffer_origin, const size_t *host_origin,
+    const size_t *region, size_t buffer_row_pitch, size_t buffer_slice_pitch,
+    size_t host_row_pitch, size_t host_slice_pitch, const void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, 0, 0);
+    if (error != CL_SUCCESS) return error;
+    if (ptr == nullptr) return CL_INVALID_VALUE;
+    error = resolve_rect(buffer_origin, region, &buffer_row_pitch,
+                         &buffer_slice_pitch, buffer->size);
+    if (error == CL_SUCCESS)
+        error = resolve_rect(host_origin, region, &host_row_pitch,
+                             &host_slice_pitch, 0);
+    if (error != CL_SUCCESS) return error;
+
+    std::vector<size_t> b(buffer_origin, buffer_origin + 3);
+    std::vector<size_t> h(host_origin, host_origin + 3);
+    std::vector<size_t> r(region, region + 3);
+    return submit(scope, queue, CL_COMMAND_WRITE_BUFFER_RECT,
+                  num_events_in_wait_list, event_wait_list, event,
+                  blocking_write, { buffer }, [=] {
+                      copy_rect(buffer->data, b.data(), buffer_row_pitch,
+                                buffer_slice_pitch, (const char *)ptr,
+                                h.data(), host_row_pitch, host_slice_pitch,
+                                r.data());
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueCopyBuffer(
+    cl_command_queue queue, cl_mem src_buffer, cl_mem dst_buffer,
+    size_t src_offset, size_t dst_offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(src_buffer, src_offset, size);
+    if (error == CL_SUCCESS)
+        error = check_buffer_range(dst_buffer, dst_offset, size);
+    if (error != CL_SUCCESS) return error;
+    if (size == 0) return CL_INVALID_VALUE;
+    const char *src_begin = src_buffer->data + src_offset;
+    char *dst_begin = dst_buffer->data + dst_offset;
+    if (src_begin < dst_begin + size && dst_begin < src_begin + size)
+        return CL_MEM_COPY_OVERLAP;
+    return submit(scope, queue, CL_COMMAND_COPY_BUFFER,
+                  num_events_in_wait_list, event_wait_list, event, false,
+                  { src_buffer, dst_buffer }, [=] {
+                      memcpy(dst_begin, src_begin, size);
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueCopyBufferRect(
+    cl_command_queue queue, cl_mem src_buffer, cl_mem dst_buffer,
+    const size_t *src_origin, const size_t *dst_origin, const size_t *region,
+    size_t src_row_pitch, size_t src_slice_pitch, size_t dst_row_pitch,
+    size_t dst_slice_pitch, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(src_buffer, 0, 0);
+    if (error == CL_SUCCESS) error = check_buffer_range(dst_buffer, 0, 0);
+    if (error == CL_SUCCESS)
+        error = resolve_rect(src_origin, region, &src_row_pitch,
+                             &src_slice_pitch, src_buffer->size);
+    if (error == CL_SUCCESS)
+        error = resolve_rect(dst_origin, region, &dst_row_pitch,
+                             &dst_slice_pitch, dst_buffer->size);
+    if (error != CL_SUCCESS) return error;
+    if (src_buffer->data == dst_buffer->data
+        && (src_row_pitch != dst_row_pitch
+            || src_slice_pitch != dst_slice_pitch))
+        return CL_INVALID_VALUE;
+
+    std::vector<size_t> s(src_origin, src_origin + 3);
+    std::vector<size_t> d(dst_origin, dst_origin + 3);
+    std::vector<size_t> r(region, region + 3);
+    if (src_buffer->data == dst_buffer->data)
+    {
+        // Overlap check on the byte ranges covered by both rectangles
+        size_t src_begin = s[2] * src_slice_pitch + s[1] * src_row_pitch + s[0];
+        size_t dst_begin = d[2] * dst_slice_pitch + d[1] * dst_row_pitch + d[0];
+        size_t extent = (r[2] - 1) * src_slice_pitch
+            + (r[1] - 1) * src_row_pitch + r[0];
+        if (src_begin < dst_begin + extent && dst_begin < src_begin + extent)
+            return CL_MEM_COPY_OVERLAP;
+    }
+    return submit(scope, queue, CL_COMMAND_COPY_BUFFER_RECT,
+                  num_events_in_wait_list, event_wait_list, event, false,
+                  { src_buffer, dst_buffer }, [=] {
+                      copy_rect(dst_buffer->data, d.data(), dst_row_pitch,
+                                dst_slice_pitch, src_buffer->data, s.data(),
+                                src_row_pitch, src_slice_pitch, r.data());
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueFillBuffer(
+    cl_command_queue queue, cl_mem buffer, const void *pattern,
+    size_t pattern_size, size_t offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, offset, size);
+    if (error != CL_SUCCESS) return error;
+    if (pattern == nullptr || pattern_size == 0 || pattern_size > 128
+        || (pattern_size & (pattern_size - 1)) || offset % pattern_size
+        || size % pattern_size)
+        return CL_INVALID_VALUE;
+
+    const char *bytes = static_cast<const char *>(pattern);
+    std::vector<char> fill(bytes, bytes + pattern_size);
+    return submit(scope, queue, CL_COMMAND_FILL_BUFFER,
+                  num_events_in_wait_list, event_wait_list, event, false,
+                  { buffer }, [=] {
+                      for (size_t i = 0; i < size; i += pattern_size)
+                          memcpy(buffer->data + offset + i, fill.data(),
+                                 pattern_size);
+                      return CL_SUCCESS;
+                  });
+}
+
+void *CL_API_CALL standin_clEnqueueMapBuffer(
+    cl_command_queue queue, cl_mem buffer, cl_bool blocking_map,
+    cl_map_flags map_flags, size_t offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event, cl_int *errcode_ret)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(buffer, offset, size);
+    if (error == CL_SUCCESS && size == 0) error = CL_INVALID_VALUE;
+    if (error == CL_SUCCESS)
+        error = submit(scope, queue, CL_COMMAND_MAP_BUFFER,
+                       num_events_in_wait_list, event_wait_list, event,
+                       blocking_map, { buffer }, [=] {
+                           buffer->map_count++;
+                           return CL_SUCCESS;
+                       });
+    set_error(errcode_ret, error);
+    // Buffers live in host memory, so the mapping is the buffer itself
+    return error == CL_SUCCESS ? buffer->data + offset : nullptr;
+}
+
+cl_int CL_API_CALL standin_clEnqueueUnmapMemObject(
+    cl_command_queue queue, cl_mem memobj, void *mapped_ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    ApiScope scope;
+    cl_int error = check_buffer_range(memobj, 0, 0);
+    if (error != CL_SUCCESS) return error;
+    char *ptr = static_cast<char *>(mapped_ptr);
+    if (ptr < memobj->data || ptr >= memobj->data + memobj->size)
+        return CL_INVALID_VALUE;
+    return submit(scope, queue, CL_COMMAND_UNMAP_MEM_OBJECT,
+                  num_events_in_wait_list, event_wait_list, event, false,
+                  { memobj }, [=] {
+                      if (memobj->map_count) memobj->map_count--;
+                      return CL_SUCCESS;
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueNDRangeKernel(
+    cl_command_queue queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *global_work_offset, const size_t *global_work_size,
+    const size_t *local_work_size, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    ApiScope scope;
+    if (kernel == nullptr) return CL_INVALID_KERNEL;
+    if (work_dim < 1 || work_dim > 3) return CL_INVALID_WORK_DIMENSION;
+    if (global_work_size == nullptr) return CL_INVALID_GLOBAL_WORK_SIZE;
+
+    stand_in_launch launch = {};
+    launch.work_dim = work_dim;
+    size_t group_size = 1;
+    for (cl_uint i = 0; i < 3; i++)
+    {
+        launch.global_size[i] = i < work_dim ? global_work_size[i] : 1;
+        launch.global_offset[i] =
+            (i < work_dim && global_work_offset) ? global_work_offset[i] : 0;
+        if (launch.global_size[i] == 0) return CL_INVALID_GLOBAL_WORK_SIZE;
+        if (local_work_size)
+        {
+            launch.local_size[i] = i < work_dim ? local_work_size[i] : 1;
+            if (launch.local_size[i] == 0
+                || launch.global_size[i] % launch.local_size[i])
+                return CL_INVALID_WORK_GROUP_SIZE;
+            group_size *= launch.local_size[i];
+        }
+    }
+    if (group_size > max_work_group_size) return CL_INVALID_WORK_GROUP_SIZE;
+
+    // Snapshot the arguments, they may be changed before the launch runs
+    std::vector<KernelArg> args = kernel->args;
+    std::vector<cl_mem> mems;
+    for (const KernelArg &arg : args)
+    {
+        if (!arg.set) return CL_INVALID_KERNEL_ARGS;
+        if (arg.kind == ARG_MEM)
+        {
+            if (!state().mems.count(arg.mem)) return CL_INVALID_MEM_OBJECT;
+            mems.push_back(arg.mem);
+        }
+    }
+
+    RegisteredKernel impl = kernel->impl;
+    return submit(scope, queue, CL_COMMAND_NDRANGE_KERNEL,
+                  num_events_in_wait_list, event_wait_list, event, false,
+                  mems, [=]() mutable {
+                      if (impl.fn == nullptr) return CL_SUCCESS;
+
+                      std::vector<std::vector<char>> local_memory;
+                      std::vector<void *> arg_ptrs;
+                      std::vector<size_t> arg_sizes;
+                      for (KernelArg &arg : args)
+                      {
+                          if (arg.kind == ARG_MEM)
+                              arg_ptrs.push_back(arg.mem->data);
+                          else if (arg.kind == ARG_LOCAL)
+                          {
+                              local_memory.emplace_back(arg.size, 0);
+                              arg_ptrs.push_back(local_memory.back().data());
+                          }
+                          else
+                              arg_ptrs.push_back(arg.value.data());
+                          arg_sizes.push_back(arg.size);
+                      }
+                      launch.num_args = (cl_uint)args.size();
+                      launch.args = arg_ptrs.data();
+                      launch.arg_sizes = arg_sizes.data();
+                      return impl.fn(&launch, impl.user_data);
+                  });
+}
+
+cl_int CL_API_CALL standin_clEnqueueTask(cl_command_queue queue,
+                                         cl_kernel kernel,
+                                         cl_uint num_events_in_wait_list,
+                                         const cl_event *event_wait_list,
+                                         cl_event *event)
+{
+    const size_t one = 1;
+    return standin_clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &one,
+                                          &one, num_events_in_wait_list,
+                                          event_wait_list, event);
+}
+
+cl_int CL_API_CALL standin_clEnqueueMarkerWithWaitList(
+    cl_command_queue queue, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    ApiScope scope;
+    return submit(scope, queue, CL_COMMAND_MARKER, num_events_in_wait_list,
+                  event_wait_list, event, false, {},
+                  [] { return CL_SUCCESS; });
+}
+
+cl_int CL_API_CALL standin_clEnqueueBarrierWithWaitList(
+    cl_command_queue queue, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    ApiScope scope;
+    return submit(scope, queue, CL_COMMAND_BARRIER, num_events_in_wait_list,
+                  event_wait_list, event, false, {},
+                  [] { return CL_SUCCESS; });
+}
+
+cl_int CL_API_CALL standin_clEnqueueMarker(cl_command_queue queue,
+                                           cl_event *event)
+{
+    if (event == nullptr) return CL_INVALID_VALUE;
+    return standin_clEnqueueMarkerWithWaitList(queue, 0, nullptr, event);
+}
+
+cl_int CL_API_CALL standin_clEnqueueWaitForEvents(cl_command_queue queue,
+                                                  cl_uint num_events,
+                                                  const cl_event *event_list)
+{
+    if (num_events == 0 || event_list == nullptr) return CL_INVALID_VALUE;
+    return standin_clEnqueueBarrierWithWaitList(queue, num_events, event_list,
+                                                nullptr);
+}
+
+cl_int CL_API_CALL standin_clEnqueueBarrier(cl_command_queue queue)
+{
+    return standin_clEnqueueBarrierWithWaitList(queue, 0, nullptr, nullptr);
+}
+
+//
+// Extensions
+//
+
+cl_int CL_API_CALL standin_clStandInRegisterKernelEXT(
+    cl_platform_id platform, const char *kernel_name, cl_uint num_args,
+    stand_in_kernel_fn fn, void *user_data)
+{
+    ApiScope scope;
+    if (platform != the_platform()) return CL_INVALID_PLATFORM;
+    if (kernel_name == nullptr || fn == nullptr) return CL_INVALID_VALUE;
+    RegisteredKernel &kernel = state().kernels[kernel_name];
+    kernel.num_args = num_args;
+    kernel.fn = fn;
+    kernel.user_data = user_data;
+    return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL standin_clStandInGetDriverTimeEXT(cl_platform_id platform,
+                                                     cl_ulong *nanoseconds)
+{
+    if (platform != the_platform()) return CL_INVALID_PLATFORM;
+    if (nanoseconds == nullptr) return CL_INVALID_VALUE;
+    *nanoseconds = state().driver_ns;
+    return CL_SUCCESS;
+}
+
+void *CL_API_CALL standin_clGetExtensionFunctionAddressForPlatform(
+    cl_platform_id platform, const char *func_name)
+{
+    if (platform != the_platform() || func_name == nullptr) return nullptr;
+    return clGetExtensionFunctionAddress(func_name);
+}
+
+cl_icd_dispatch *get_dispatch()
+{
+    static cl_icd_dispatch dispatch = [] {
+        cl_icd_dispatch d;
+        memset(&d, 0, sizeof(d));
+        d.clGetPlatformIDs = standin_clGetPlatformIDs;
+        d.clGetPlatformInfo = standin_clGetPlatformInfo;
+        d.clGetDeviceIDs = standin_clGetDeviceIDs;
+        d.clGetDeviceInfo = standin_clGetDeviceInfo;
+        d.clCreateSubDevices = standin_clCreateSubDevices;
+        d.clRetainDevice = standin_clRetainDevice;
+        d.clReleaseDevice = standin_clReleaseDevice;
+        d.clCreateContext = standin_clCreateContext;
+        d.clCreateContextFromType = standin_clCreateContextFromType;
+        d.clRetainContext = standin_clRetainContext;
+        d.clReleaseContext = standin_clReleaseContext;
+        d.clGetContextInfo = standin_clGetContextInfo;
+        d.clCreateCommandQueue = standin_clCreateCommandQueue;
+        d.clCreateCommandQueueWithProperties =
+            standin_clCreateCommandQueueWithProperties;
+        d.clRetainCommandQueue = standin_clRetainCommandQueue;
+        d.clReleaseCommandQueue = standin_clReleaseCommandQueue;
+        d.clGetCommandQueueInfo = standin_clGetCommandQueueInfo;
+        d.clFlush = standin_clFlush;
+        d.clFinish = standin_clFinish;
+        d.clCreateBuffer = standin_clCreateBuffer;
+        d.clCreateSubBuffer = standin_clCreateSubBuffer;
+        d.clRetainMemObject = standin_clRetainMemObject;
+        d.clReleaseMemObject = standin_clReleaseMemObject;
+        d.clGetSupportedImageFormats = standin_clGetSupportedImageFormats;
+        d.clGetMemObjectInfo = standin_clGetMemObjectInfo;
+        d.clSetMemObjectDestructorCallback =
+            standin_clSetMemObjectDestructorCallback;
+        d.clCreateProgramWithSource = standin_clCreateProgramWithSource;
+        d.clRetainProgram = standin_clRetainProgram;
+        d.clReleaseProgram = standin_clReleaseProgram;
+        d.clBuildProgram = standin_clBuildProgram;
+        d.clUnloadPlatformCompiler = standin_clUnloadPlatformCompiler;
+        d.clGetProgramInfo = standin_clGetProgramInfo;
+        d.clGetProgramBuildInfo = standin_clGetProgramBuildInfo;
+        d.clCreateKernel = standin_clCreateKernel;
+        d.clRetainKernel = standin_clRetainKernel;
+        d.clReleaseKernel = standin_clReleaseKernel;
+        d.clSetKernelArg = standin_clSetKernelArg;
+        d.clGetKernelInfo = standin_clGetKernelInfo;
+        d.clGetKernelWorkGroupInfo = standin_clGetKernelWorkGroupInfo;
+        d.clWaitForEvents = standin_clWaitForEvents;
+        d.clGetEventInfo = standin_clGetEventInfo;
+        d.clCreateUserEvent = standin_clCreateUserEvent;
+        d.clRetainEvent = standin_clRetainEvent;
+        d.clReleaseEvent = standin_clReleaseEvent;
+        d.clSetUserEventStatus = standin_clSetUserEventStatus;
+        d.clSetEventCallback = standin_clSetEventCallback;
+        d.clGetEventProfilingInfo = standin_clGetEventProfilingInfo;
+        d.clEnqueueReadBuffer = standin_clEnqueueReadBuffer;
+        d.clEnqueueWriteBuffer = standin_clEnqueueWriteBuffer;
+        d.clEnqueueReadBufferRect = standin_clEnqueueReadBufferRect;
+        d.clEnqueueWriteBufferRect = standin_clEnqueueWriteBufferRect;
+        d.clEnqueueCopyBuffer = standin_clEnqueueCopyBuffer;
+        d.clEnqueueCopyBufferRect = standin_clEnqueueCopyBufferRect;
+        d.clEnqueueFillBuffer = standin_clEnqueueFillBuffer;
+        d.clEnqueueMapBuffer = standin_clEnqueueMapBuffer;
+        d.clEnqueueUnmapMemObject = standin_clEnqueueUnmapMemObject;
+        d.clEnqueueNDRangeKernel = standin_clEnqueueNDRangeKernel;
+        d.clEnqueueTask = standin_clEnqueueTask;
+        d.clEnqueueMarkerWithWaitList = standin_clEnqueueMarkerWithWaitList;
+        d.clEnqueueBarrierWithWaitList = standin_clEnqueueBarrierWithWaitList;
+        d.clEnqueueMarker = standin_clEnqueueMarker;
+        d.clEnqueueWaitForEvents = standin_clEnqueueWaitForEvents;
+        d.clEnqueueBarrier = standin_clEnqueueBarrier;
+        d.clGetExtensionFunctionAddress = clGetExtensionFunctionAddress;
+        d.clGetExtensionFunctionAddressForPlatform =
+            standin_clGetExtensionFunctionAddressForPlatform;
+        return d;
+    }();
+    return &dispatch;
+}
+
+}
+
+// Entry points looked up by the ICD loader
+
+extern "C" {
+
+CL_API_ENTRY cl_int CL_API_CALL clIcdGetPlatformIDsKHR(
+    cl_uint num_entries, cl_platform_id *platforms, cl_uint *num_platforms)
+{
+    return standin_clGetPlatformIDs(num_entries, platforms, num_platforms);
+}
+
+CL_API_ENTRY void *CL_API_CALL
+clGetExtensionFunctionAddress(const char *func_name)
+{
+    if (func_name == nullptr) return nullptr;
+    if (strcmp(func_name, "clIcdGetPlatformIDsKHR") == 0)
+        return (void *)clIcdGetPlatformIDsKHR;
+    if (strcmp(func_name, "clStandInRegisterKernelEXT") == 0)
+        return (void *)standin_clStandInRegisterKernelEXT;
+    if (strcmp(func_name, "clStandInGetDriverTimeEXT") == 0)
+        return (void *)standin_clStandInGetDriverTimeEXT;
+    return nullptr;
+}
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _stand_in_icd_h
+#define _stand_in_icd_h
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+// Extension functions of the stand-in ICD (test_common/stand_in_icd). They are
+// obtained with clGetExtensionFunctionAddressForPlatform and are only
+// available when the platform is the stand-in.
+//
+// The stand-in cannot compile OpenCL C. clBuildProgram always succeeds and
+// clCreateKernel looks the kernel name up in a table of host callbacks filled
+// with clStandInRegisterKernelEXT. When STAND_IN_ICD_NOOP_KERNELS is set in
+// the environment, unregistered kernel names create kernels that do nothing,
+// which lets suites run end to end to measure harness-side costs.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Describes one clEnqueueNDRangeKernel call. Each argument points to the
+// contents of a buffer argument, to zero-initialised memory for a local
+// memory argument, or to the bytes passed to clSetKernelArg for any other
+// argument.
+typedef struct stand_in_launch
+{
+    cl_uint work_dim;
+    size_t global_offset[3];
+    size_t global_size[3];
+    // Zero in every dimension when no local size was given
+    size_t local_size[3];
+    cl_uint num_args;
+    void *const *args;
+    const size_t *arg_sizes;
+} stand_in_launch;
+
+// Executes a whole NDRange on the host. A negative return value is reported
+// as the execution status of the command.
+typedef cl_int(CL_CALLBACK *stand_in_kernel_fn)(const stand_in_launch *launch,
+                                                void *user_data);
+
+// Registers fn as the implementation of kernels named kernel_name. num_args
+// is the number of arguments clSetKernelArg accepts, 0 to accept any number.
+// Registering an existing name replaces its implementation for kernels
+// created afterwards.
+typedef cl_int(CL_API_CALL *clStandInRegisterKernelEXT_fn)(
+    cl_platform_id platform, const char *kernel_name, cl_uint num_args,
+    stand_in_kernel_fn fn, void *user_data);
+
+// Returns the total host time spent inside stand-in entry points, including
+// the execution of kernel callbacks and time spent blocked in clFinish,
+// clWaitForEvents and blocking enqueues.
+typedef cl_int(CL_API_CALL *clStandInGetDriverTimeEXT_fn)(
+    cl_platform_id platform, cl_ulong *nanoseconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _stand_in_icd_h
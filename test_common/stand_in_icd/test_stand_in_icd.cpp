@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Self-test of the harness run against the stand-in ICD: the harness sets up
+// the device, context and queue of each test, which then exercise buffers,
+// host kernels and event profiling through the ICD loader.
+//
+#include "harness/testHarness.h"
+#include "harness/typeWrappers.h"
+#include "stand_in_icd.h"
+
+#include <vector>
+
+namespace {
+
+cl_int CL_CALLBACK add_one(const stand_in_launch *launch, void *)
+{
+    cl_uint *data = static_cast<cl_uint *>(launch->args[0]);
+    for (size_t i = 0; i < launch->global_size[0]; i++)
+        data[launch->global_offset[0] + i] += 1;
+    return CL_SUCCESS;
+}
+
+}
+
+REGISTER_TEST(buffer_round_trip)
+{
+    cl_int error;
+    std::vector<cl_uint> input(num_elements), output(num_elements, 0);
+    for (int i = 0; i < num_elements; i++) input[i] = i * 3 + 1;
+
+    size_t size = input.size() * sizeof(cl_uint);
+    clMemWrapper buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE, size, nullptr, &error);
+    test_error(error, "clCreateBuffer failed");
+
+    error = clEnqueueWriteBuffer(queue, buffer, CL_FALSE, 0, size,
+                                 input.data(), 0, nullptr, nullptr);
+    test_error(error, "clEnqueueWriteBuffer failed");
+    error = clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0, size,
+                                output.data(), 0, nullptr, nullptr);
+    test_error(error, "clEnqueueReadBuffer failed");
+
+    for (int i = 0; i < num_elements; i++)
+    {
+        if (output[i] != input[i])
+        {
+            log_error("Element %d: expected %u, got %u\n", i, input[i],
+                      output[i]);
+            return TEST_FAIL;
+        }
+    }
+    return TEST_PASS;
+}
+
+REGISTER_TEST(host_kernel)
+{
+    cl_int error;
+    cl_platform_id platform;
+    error = clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform),
+                            &platform, nullptr);
+    test_error(error, "clGetDeviceInfo failed");
+
+    auto register_kernel = (clStandInRegisterKernelEXT_fn)
+        clGetExtensionFunctionAddressForPlatform(platform,
+                                                 "clStandInRegisterKernelEXT");
+    if (register_kernel == nullptr)
+    {
+        log_error("clStandInRegisterKernelEXT not found, the platform is not "
+                  "the stand-in ICD\n");
+        return TEST_FAIL;
+    }
+    error = register_kernel(platform, "add_one", 1, add_one, nullptr);
+    test_error(error, "clStandInRegisterKernelEXT failed");
+
+    // The source is not compiled, only the kernel name is looked up
+    const char *source = "__kernel void add_one(__global uint *data) {}";
+    clProgramWrapper program =
+        clCreateProgramWithSource(context, 1, &source, nullptr, &error);
+    test_error(error, "clCreateProgramWithSource failed");
+    error = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
+    test_error(error, "clBuildProgram failed");
+    clKernelWrapper kernel = clCreateKernel(program, "add_one", &error);
+    test_error(error, "clCreateKernel failed");
+
+    std::vector<cl_uint> data(num_elements);
+    for (int i = 0; i < num_elements; i++) data[i] = i;
+    clMemWrapper buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                       data.size() * sizeof(cl_uint), data.data(), &error);
+    test_error(error, "clCreateBuffer failed");
+    error = clSetKernelArg(kernel, 0, sizeof(buffer), &buffer);
+    test_error(error, "clSetKernelArg failed");
+
+    size_t global_size = num_elements;
+    error = clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &global_size,
+                                   nullptr, 0, nullptr, nullptr);
+    test_error(error, "clEnqueueNDRangeKernel failed");
+    error = clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0,
+                                data.size() * sizeof(cl_uint), data.data(), 0,
+                                nullptr, nullptr);
+    test_error(error, "clEnqueueReadBuffer failed");
+
+    for (int i = 0; i < num_elements; i++)
+    {
+        if (data[i] != (cl_uint)i + 1)
+        {
+            log_error("Element %d: expected %u, got %u\n", i, i + 1,
+                      data[i]);
+            return TEST_FAIL;
+        }
+    }
+    return TEST_PASS;
+}
+
+REGISTER_TEST(event_profiling)
+{
+    cl_int error;
+    clCommandQueueWrapper profiling_queue = clCreateCommandQueue(
+        context, device, CL_QUEUE_PROFILING_ENABLE, &error);
+    test_error(error, "clCreateCommandQueue failed");
+
+    cl_uint pattern = 0xdeadbeef;
+    clMemWrapper buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE,
+                       num_elements * sizeof(cl_uint), nullptr, &error);
+    test_error(error, "clCreateBuffer failed");
+
+    clEventWrapper event;
+    error = clEnqueueFillBuffer(profiling_queue, buffer, &pattern,
+                                sizeof(pattern), 0,
+                                num_elements * sizeof(cl_uint), 0, nullptr,
+                                &event);
+    test_error(error, "clEnqueueFillBuffer failed");
+    error = clWaitForEvents(1, &event);
+    test_error(error, "clWaitForEvents failed");
+
+    const cl_profiling_info params[] = {
+        CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_SUBMIT,
+        CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END
+    };
+    cl_ulong previous = 0;
+    for (cl_profiling_info param : params)
+    {
+        cl_ulong value;
+        error = clGetEventProfilingInfo(event, param, sizeof(value), &value,
+                                        nullptr);
+        test_error(error, "clGetEventProfilingInfo failed");
+        if (value < previous)
+        {
+            log_error("Profiling timestamps are not monotonic\n");
+            return TEST_FAIL;
+        }
+        previous = value;
+    }
+    return TEST_PASS;
+}
+
+int main(int argc, const char *argv[])
+{
+    return runTestHarness(argc, argv, test_registry::getInstance().num_tests(),
+                          test_registry::getInstance().definitions(), false, 0);
+}
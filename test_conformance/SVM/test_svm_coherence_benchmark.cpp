@@ -0,0 +1,583 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "common.h"
+#include "harness/alloc.h"
+#include "harness/csvHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// Benchmark of the cost of sharing data between the host and the device
+// through SVM, for comparing SVM modes in zero-copy pipelines. It measures:
+// - the round trip latency of a flag passed back and forth between the host
+//   and a running kernel with fine-grain SVM atomics;
+// - the throughput of a single producer, single consumer ring buffer in
+//   fine-grain SVM, with the host producing for the device and the device
+//   producing for the host;
+// - the cost of making data written by a kernel available to the host and
+//   of handing data written by the host to the device, for 4KB to 64MB
+//   coarse-grain buffers with map and unmap, for fine-grain buffers and for
+//   fine-grain system allocations.
+// Every part is skipped when the device lacks the SVM capabilities it needs.
+// The host gives up on a kernel that stops making progress for
+// svm_spin_timeout seconds and tells it to return. Results are appended to
+// the file named by CL_SVM_COHERENCE_CSV if it is set.
+//
+// Full round and item counts and buffers above 64KB only run with
+// --benchmark. Otherwise every part runs briefly, which checks the data but
+// is too short for stable timings.
+
+// Only built when the device supports fine-grain SVM atomics with
+// memory_scope_all_svm_devices and acquire/release ordering
+static const char *svm_handshake_kernels[] = {
+    "#define SCOPE memory_scope_all_svm_devices\n"
+    "\n"
+    "// control[0] is the flag, control[1] is set by the host to give up\n"
+    "__kernel void svm_ping_pong(volatile __global atomic_int* control,\n"
+    "                            int rounds)\n"
+    "{\n"
+    "    for (int i = 0; i < rounds; i++)\n"
+    "    {\n"
+    "        while (atomic_load_explicit(&control[0], memory_order_acquire,\n"
+    "                                    SCOPE) != 2 * i + 1)\n"
+    "            if (atomic_load_explicit(&control[1], memory_order_relaxed,\n"
+    "                                     SCOPE)) return;\n"
+    "        atomic_fetch_add_explicit(&control[0], 1, memory_order_release,\n"
+    "                                  SCOPE);\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "// control[0] counts the items produced, control[1] the items consumed\n"
+    "// and control[2] is set by the host to give up\n"
+    "__kernel void svm_ring_consume(__global uint* slots,\n"
+    "                               volatile __global atomic_int* control,\n"
+    "                               int count, int capacity,\n"
+    "                               __global uint* sum)\n"
+    "{\n"
+    "    uint total = 0;\n"
+    "    for (int i = 0; i < count; i++)\n"
+    "    {\n"
+    "        while (atomic_load_explicit(&control[0], memory_order_acquire,\n"
+    "                                    SCOPE) <= i)\n"
+    "            if (atomic_load_explicit(&control[2], memory_order_relaxed,\n"
+    "                                     SCOPE)) return;\n"
+    "        total += slots[i % capacity];\n"
+    "        atomic_fetch_add_explicit(&control[1], 1, memory_order_release,\n"
+    "                                  SCOPE);\n"
+    "    }\n"
+    "    *sum = total;\n"
+    "}\n"
+    "\n"
+    "__kernel void svm_ring_produce(__global uint* slots,\n"
+    "                               volatile __global atomic_int* control,\n"
+    "                               int count, int capacity)\n"
+    "{\n"
+    "    for (int i = 0; i < count; i++)\n"
+    "    {\n"
+    "        while (i - atomic_load_explicit(&control[1],\n"
+    "                                        memory_order_acquire, SCOPE)\n"
+    "               >= capacity)\n"
+    "            if (atomic_load_explicit(&control[2], memory_order_relaxed,\n"
+    "                                     SCOPE)) return;\n"
+    "        slots[i % capacity] = i;\n"
+    "        atomic_fetch_add_explicit(&control[0], 1, memory_order_release,\n"
+    "                                  SCOPE);\n"
+    "    }\n"
+    "}\n"
+};
+
+static const char *svm_touch_kernel[] = {
+    "__kernel void svm_touch(__global uint* data, uint seed)\n"
+    "{\n"
+    "    size_t i = get_global_id(0);\n"
+    "    data[i] = seed + (uint)i;\n"
+    "}\n"
+};
+
+namespace {
+
+const int ping_pong_warmup = 10;
+const int ping_pong_rounds = 1000;
+const int ping_pong_smoke_rounds = 100;
+const int ring_capacity = 1024;
+const int ring_items = 1 << 18;
+const int ring_smoke_items = 1 << 12;
+const size_t access_min_size = 4096;
+const size_t access_max_size = 64 << 20;
+const size_t access_smoke_max_size = 64 << 10;
+const size_t access_runs = 10;
+const size_t access_smoke_runs = 2;
+const double svm_spin_timeout = 10.0;
+
+using clock_type = std::chrono::steady_clock;
+
+double microseconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(clock_type::now() - start)
+        .count();
+}
+
+// Spins until the value at location is past limit, or the deadline passes
+bool spin_until_above(volatile cl_int *location, cl_int limit,
+                      clock_type::time_point deadline)
+{
+    while (AtomicLoadExplicit(location, memory_order_acquire) <= limit)
+        if (clock_type::now() > deadline) return false;
+    return true;
+}
+
+clock_type::time_point spin_deadline()
+{
+    return clock_type::now()
+        + std::chrono::duration_cast<clock_type::duration>(
+               std::chrono::duration<double>(svm_spin_timeout));
+}
+
+class SvmCoherenceBenchmark {
+public:
+    SvmCoherenceBenchmark(cl_device_id device, cl_context context,
+                          cl_command_queue queue, FILE *file)
+        : device(device), context(context), queue(queue), file(file),
+          full_sweep(gBenchmarkMode && !gWimpyMode)
+    {}
+
+    cl_int Init();
+    cl_int InitHandshakes();
+    cl_int PingPong();
+    cl_int Ring(bool host_produces);
+    cl_int Access(const char *mode, cl_svm_mem_flags flags, bool system);
+
+private:
+    cl_int GiveUp(volatile cl_int *abort_flag, const char *what);
+    cl_int AccessRun(void *data, size_t size, bool coarse, cl_uint seed,
+                     double times_us[4]);
+
+    cl_device_id device;
+    cl_context context;
+    cl_command_queue queue;
+    FILE *file;
+    bool full_sweep;
+
+    clProgramWrapper touch_program;
+    clProgramWrapper handshake_program;
+    clKernelWrapper ping_pong;
+    clKernelWrapper ring_consume;
+    clKernelWrapper ring_produce;
+    clKernelWrapper touch;
+};
+
+cl_int SvmCoherenceBenchmark::Init()
+{
+    cl_int error = create_single_kernel_helper(context, &touch_program, &touch,
+                                               1, svm_touch_kernel,
+                                               "svm_touch");
+    test_error(error, "Unable to create svm_touch kernel");
+    return CL_SUCCESS;
+}
+
+cl_int SvmCoherenceBenchmark::InitHandshakes()
+{
+    cl_int error =
+        create_single_kernel_helper(context, &handshake_program, NULL, 1,
+                                    svm_handshake_kernels, NULL);
+    test_error(error, "Unable to create program");
+
+    ping_pong = clCreateKernel(handshake_program, "svm_ping_pong", &error);
+    test_error(error, "clCreateKernel failed");
+    ring_consume =
+        clCreateKernel(handshake_program, "svm_ring_consume", &error);
+    test_error(error, "clCreateKernel failed");
+    ring_produce =
+        clCreateKernel(handshake_program, "svm_ring_produce", &error);
+    test_error(error, "clCreateKernel failed");
+    return CL_SUCCESS;
+}
+
+// Tells a kernel that stopped making progress to return so that the queue can
+// drain
+cl_int SvmCoherenceBenchmark::GiveUp(volatile cl_int *abort_flag,
+                                     const char *what)
+{
+    log_error("ERROR: %s made no progress for %.0f seconds\n", what,
+              svm_spin_timeout);
+    AtomicFetchAddExplicit(abort_flag, 1, memory_order_seq_cst);
+    clFinish(queue);
+    return -1;
+}
+
+cl_int SvmCoherenceBenchmark::PingPong()
+{
+    const int rounds = full_sweep ? ping_pong_rounds : ping_pong_smoke_rounds;
+    const int total_rounds = ping_pong_warmup + rounds;
+
+    cl_int *control = (cl_int *)clSVMAlloc(
+        context,
+        CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS,
+        2 * sizeof(cl_int), 0);
+    if (control == NULL)
+    {
+        log_error("ERROR: clSVMAlloc failed\n");
+        return -1;
+    }
+    control[0] = 0;
+    control[1] = 0;
+
+    cl_int error = clSetKernelArgSVMPointer(ping_pong, 0, control);
+    error |= clSetKernelArg(ping_pong, 1, sizeof(total_rounds), &total_rounds);
+    test_error(error, "clSetKernelArg failed");
+
+    const size_t global_size = 1;
+    error = clEnqueueNDRangeKernel(queue, ping_pong, 1, NULL, &global_size,
+                                   NULL, 0, NULL, NULL);
+    test_error(error, "clEnqueueNDRangeKernel failed");
+    error = clFlush(queue);
+    test_error(error, "clFlush failed");
+
+    std::vector<double> round_trip_us;
+    for (int i = 0; i < total_rounds; i++)
+    {
+        clock_type::time_point start = clock_type::now();
+        AtomicFetchAddExplicit(&control[0], 1, memory_order_release);
+        if (!spin_until_above(&control[0], 2 * i + 1, spin_deadline()))
+        {
+            error = GiveUp(&control[1], "svm_ping_pong");
+            clSVMFree(context, control);
+            return error;
+        }
+        if (i >= ping_pong_warmup)
+            round_trip_us.push_back(microseconds_since(start));
+    }
+    error = clFinish(queue);
+    clSVMFree(context, control);
+    test_error(error, "clFinish failed");
+
+    SampleStats stats = compute_sample_stats(round_trip_us);
+    log_info("Ping-pong round trip: median %.2f us, p99 %.2f us, min %.2f "
+             "us\n",
+             stats.median, stats.p99, stats.min);
+    log_perf(stats.median, false, "us", "fine-grain SVM ping-pong round trip");
+    if (file)
+        fprintf(file, "ping_pong,fine_grain_buffer,%zu,%.3f,%.3f,0\n",
+                sizeof(cl_int), stats.median, stats.p99);
+    return CL_SUCCESS;
+}
+
+cl_int SvmCoherenceBenchmark::Ring(bool host_produces)
+{
+    const int count = full_sweep ? ring_items : ring_smoke_items;
+    const char *mode = host_produces ? "host_to_device" : "device_to_host";
+    const cl_svm_mem_flags flags =
+        CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS;
+
+    // control[3] receives the sum computed by a consuming kernel
+    cl_int *control =
+        (cl_int *)clSVMAlloc(context, flags, 4 * sizeof(cl_int), 0);
+    cl_uint *slots = (cl_uint *)clSVMAlloc(
+        context, flags, ring_capacity * sizeof(cl_uint), 0);
+    if (control == NULL || slots == NULL)
+    {
+        log_error("ERROR: clSVMAlloc failed\n");
+        clSVMFree(context, control);
+        clSVMFree(context, slots);
+        return -1;
+    }
+    memset(control, 0, 4 * sizeof(cl_int));
+
+    cl_kernel kernel = host_produces ? ring_consume : ring_produce;
+    cl_int error = clSetKernelArgSVMPointer(kernel, 0, slots);
+    error |= clSetKernelArgSVMPointer(kernel, 1, control);
+    error |= clSetKernelArg(kernel, 2, sizeof(count), &count);
+    error |= clSetKernelArg(kernel, 3, sizeof(ring_capacity), &ring_capacity);
+    if (host_produces)
+        error |= clSetKernelArgSVMPointer(kernel, 4, &control[3]);
+    test_error(error, "clSetKernelArg failed");
+
+    const size_t global_size = 1;
+    error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global_size, NULL,
+                                   0, NULL, NULL);
+    test_error(error, "clEnqueueNDRangeKernel failed");
+    error = clFlush(queue);
+    test_error(error, "clFlush failed");
+
+    // Timed from the first item to reach the consumer, so that the kernel
+    // launch is not counted
+    volatile cl_uint *ring = slots;
+    cl_uint sum = 0;
+    clock_type::time_point start;
+    bool progress = true;
+    for (int i = 0; i < count && progress; i++)
+    {
+        if (host_produces)
+        {
+            progress = spin_until_above(&control[1], i - ring_capacity,
+                                        spin_deadline());
+            if (!progress) break;
+            ring[i % ring_capacity] = (cl_uint)i;
+            AtomicFetchAddExplicit(&control[0], 1, memory_order_release);
+            if (i > 0) continue;
+            progress = spin_until_above(&control[1], 0, spin_deadline());
+        }
+        else
+        {
+            progress = spin_until_above(&control[0], i, spin_deadline());
+            if (!progress) break;
+            sum += ring[i % ring_capacity];
+            AtomicFetchAddExplicit(&control[1], 1, memory_order_release);
+        }
+        if (i == 0) start = clock_type::now();
+    }
+    if (progress && host_produces)
+        progress = spin_until_above(&control[1], count - 1, spin_deadline());
+    double elapsed_us = microseconds_since(start);
+
+    if (!progress)
+        error = GiveUp(&control[2], host_produces ? "svm_ring_consume"
+                                                  : "svm_ring_produce");
+    else
+        error = clFinish(queue);
+    if (host_produces) sum = (cl_uint)control[3];
+    clSVMFree(context, control);
+    clSVMFree(context, slots);
+    if (!progress) return error;
+    test_error(error, "clFinish failed");
+
+    cl_uint expected = 0;
+    for (int i = 0; i < count; i++) expected += (cl_uint)i;
+    if (sum != expected)
+    {
+        log_error("ERROR: %s ring buffer delivered items summing to %u, "
+                  "expected %u\n",
+                  mode, sum, expected);
+        return -1;
+    }
+
+    const double items_per_second = (count - 1) / (1e-6 * elapsed_us);
+    const double mb_per_second = 1e-6 * items_per_second * sizeof(cl_uint);
+    log_info("Ring buffer %-15s %12.0f items/s %8.2f MB/s\n", mode,
+             items_per_second, mb_per_second);
+    log_perf(items_per_second, true, "items/s", "fine-grain SVM ring %s",
+             mode);
+    if (file)
+        fprintf(file, "ring,%s,%zu,%.3f,0,%.3f\n", mode, sizeof(cl_uint),
+                elapsed_us / (count - 1), mb_per_second);
+    return CL_SUCCESS;
+}
+
+// One handover of size bytes each way. times_us receives the time to make
+// the kernel's writes visible to the host (the map for coarse-grain buffers),
+// to read them on the host, to write the buffer on the host and to make
+// those writes visible to the device again (the unmap)
+cl_int SvmCoherenceBenchmark::AccessRun(void *data, size_t size, bool coarse,
+                                        cl_uint seed, double times_us[4])
+{
+    const size_t count = size / sizeof(cl_uint);
+    cl_int error = clSetKernelArgSVMPointer(touch, 0, data);
+    error |= clSetKernelArg(touch, 1, sizeof(seed), &seed);
+    test_error(error, "clSetKernelArg failed");
+    error = clEnqueueNDRangeKernel(queue, touch, 1, NULL, &count, NULL, 0,
+                                   NULL, NULL);
+    test_error(error, "clEnqueueNDRangeKernel failed");
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+
+    clock_type::time_point start = clock_type::now();
+    if (coarse)
+    {
+        error = clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+                                data, size, 0, NULL, NULL);
+        test_error(error, "clEnqueueSVMMap failed");
+    }
+    times_us[0] = microseconds_since(start);
+
+    start = clock_type::now();
+    const cl_uint *values = (const cl_uint *)data;
+    cl_uint sum = 0, expected = 0;
+    for (size_t i = 0; i < count; i++) sum += values[i];
+    times_us[1] = microseconds_since(start);
+    for (size_t i = 0; i < count; i++) expected += seed + (cl_uint)i;
+
+    start = clock_type::now();
+    memset(data, 0, size);
+    times_us[2] = microseconds_since(start);
+
+    start = clock_type::now();
+    if (coarse)
+    {
+        error = clEnqueueSVMUnmap(queue, data, 0, NULL, NULL);
+        test_error(error, "clEnqueueSVMUnmap failed");
+        error = clFinish(queue);
+        test_error(error, "clFinish failed");
+    }
+    times_us[3] = microseconds_since(start);
+
+    if (sum != expected)
+    {
+        log_error("ERROR: Host read data summing to %u from the kernel, "
+                  "expected %u\n",
+                  sum, expected);
+        return -1;
+    }
+    return CL_SUCCESS;
+}
+
+cl_int SvmCoherenceBenchmark::Access(const char *mode, cl_svm_mem_flags flags,
+                                     bool system)
+{
+    cl_ulong max_alloc = 0;
+    cl_int error = clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                                   sizeof(max_alloc), &max_alloc, NULL);
+    test_error(error, "clGetDeviceInfo failed");
+
+    const bool coarse =
+        !system && !(flags & CL_MEM_SVM_FINE_GRAIN_BUFFER);
+    const size_t max_size =
+        full_sweep ? access_max_size : access_smoke_max_size;
+    const size_t runs = full_sweep ? access_runs : access_smoke_runs;
+    for (size_t size = access_min_size; size <= max_size; size *= 4)
+    {
+        if (size > max_alloc) break;
+
+        void *data = system ? align_malloc(size, 4096)
+                            : clSVMAlloc(context, flags, size, 0);
+        if (data == NULL)
+        {
+            log_error("ERROR: Unable to allocate %zu bytes of %s memory\n",
+                      size, mode);
+            return -1;
+        }
+
+        std::vector<double> samples[4], total_us;
+        for (size_t run = 0; run < runs && error == CL_SUCCESS; run++)
+        {
+            double times_us[4];
+            error = AccessRun(data, size, coarse, (cl_uint)run, times_us);
+            for (int i = 0; i < 4; i++) samples[i].push_back(times_us[i]);
+            total_us.push_back(times_us[0] + times_us[1] + times_us[2]
+                               + times_us[3]);
+        }
+        if (system)
+            align_free(data);
+        else
+            clSVMFree(context, data);
+        if (error != CL_SUCCESS) return error;
+
+        SampleStats total = compute_sample_stats(total_us);
+        const double mb_per_second = size / total.median;
+        log_info("%-18s %10zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.1f\n",
+                 mode, size, compute_sample_stats(samples[0]).median,
+                 compute_sample_stats(samples[1]).median,
+                 compute_sample_stats(samples[2]).median,
+                 compute_sample_stats(samples[3]).median, total.median,
+                 mb_per_second);
+        log_perf(total.median, false, "us", "%s handover of %zu bytes", mode,
+                 size);
+        if (file)
+            fprintf(file, "access,%s,%zu,%.3f,%.3f,%.3f\n", mode, size,
+                    total.median, total.p99, mb_per_second);
+    }
+    return CL_SUCCESS;
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(svm_coherence_benchmark)
+{
+    cl_device_svm_capabilities caps = 0;
+    cl_int error = clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES,
+                                   sizeof(caps), &caps, NULL);
+    test_error(error, "clGetDeviceInfo failed for CL_DEVICE_SVM_CAPABILITIES");
+    if (caps == 0)
+    {
+        log_info("SVM is not supported, test not executed.\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    // The handshakes need memory_scope_all_svm_devices
+    bool all_devices_scope = true;
+    if (get_device_cl_version(device) >= Version(3, 0))
+    {
+        cl_device_atomic_capabilities atomic_caps = 0;
+        error = clGetDeviceInfo(device, CL_DEVICE_ATOMIC_MEMORY_CAPABILITIES,
+                                sizeof(atomic_caps), &atomic_caps, NULL);
+        test_error(error,
+                   "clGetDeviceInfo for CL_DEVICE_ATOMIC_MEMORY_CAPABILITIES "
+                   "failed");
+        all_devices_scope = (atomic_caps & CL_DEVICE_ATOMIC_SCOPE_ALL_DEVICES)
+            && (atomic_caps & CL_DEVICE_ATOMIC_ORDER_ACQ_REL);
+    }
+
+    FILE *file =
+        open_results_csv("CL_SVM_COHERENCE_CSV",
+                         "benchmark,mode,bytes,median_us,p99_us,mb_per_s");
+    SvmCoherenceBenchmark benchmark(device, context, queue, file);
+    error = benchmark.Init();
+    if (error != CL_SUCCESS)
+    {
+        if (file) fclose(file);
+        return -1;
+    }
+
+    int result = 0;
+    const cl_device_svm_capabilities atomics_caps =
+        CL_DEVICE_SVM_FINE_GRAIN_BUFFER | CL_DEVICE_SVM_ATOMICS;
+    if ((caps & atomics_caps) == atomics_caps && all_devices_scope)
+    {
+        if (benchmark.InitHandshakes() != CL_SUCCESS)
+            result = -1;
+        else
+        {
+            if (benchmark.PingPong() != CL_SUCCESS) result = -1;
+            if (benchmark.Ring(true) != CL_SUCCESS) result = -1;
+            if (benchmark.Ring(false) != CL_SUCCESS) result = -1;
+        }
+    }
+    else
+    {
+        log_info("Fine-grain SVM atomics across the host and the device are "
+                 "not supported; skipping the ping-pong and ring buffer "
+                 "benchmarks.\n");
+    }
+
+    log_info("%-18s %10s %10s %10s %10s %10s %10s %10s\n", "mode", "bytes",
+             "map us", "read us", "write us", "unmap us", "total us", "MB/s");
+    if (caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+    {
+        if (benchmark.Access("coarse_grain", CL_MEM_READ_WRITE, false)
+            != CL_SUCCESS)
+            result = -1;
+    }
+    if (caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)
+    {
+        if (benchmark.Access("fine_grain_buffer",
+                             CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER,
+                             false)
+            != CL_SUCCESS)
+            result = -1;
+    }
+    if (caps & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM)
+    {
+        if (benchmark.Access("fine_grain_system", 0, true) != CL_SUCCESS)
+            result = -1;
+    }
+
+    if (file) fclose(file);
+    return result;
+}
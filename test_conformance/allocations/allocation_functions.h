@@ -28,6 +28,8 @@ int allocate_image2d_read(cl_context context, cl_command_queue *queue,
 int allocate_image2d_write(cl_context context, cl_command_queue *queue,
                            cl_device_id device_id, cl_mem *mem,
                            size_t size_to_allocate);
+int find_good_image_size(cl_device_id device_id, size_t size_to_allocate,
+                         size_t *width, size_t *height, size_t *max_size);
 int allocate_size(cl_context context, cl_command_queue *queue,
                   cl_device_id device_id, int multiple_allocations,
                   size_t size_to_allocate, int type, cl_mem mems[],
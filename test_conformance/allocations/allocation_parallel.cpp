@@ -0,0 +1,460 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "allocation_parallel.h"
+#include "allocation_functions.h"
+#include "harness/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define PARALLEL_MAX_THREADS 8
+#define PARALLEL_SIZE_CLASSES 4
+#define PARALLEL_MAX_OBJECTS 4096
+#define PARALLEL_MIN_SIZE (1024 * 1024)
+
+namespace {
+
+typedef std::chrono::steady_clock clock_type;
+
+const cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT32 };
+
+struct Allocation
+{
+    cl_mem mem;
+    size_t size;
+};
+
+struct SizeClassStats
+{
+    cl_uint count = 0;
+    cl_uint failures = 0;
+    size_t bytes = 0;
+    double create_seconds = 0.0;
+    double first_use_seconds = 0.0;
+};
+
+struct ParallelState
+{
+    cl_context context;
+    cl_device_id device_id;
+    AllocType type;
+    size_t total_size;
+    // Largest first
+    size_t sizes[PARALLEL_SIZE_CLASSES];
+
+    // Bytes claimed against total_size, including allocations in flight
+    std::atomic<size_t> reserved;
+    // Bytes held by allocations that have been created and used
+    std::atomic<size_t> in_use;
+    // Bytes in use when a size class first failed, 0 if it never did
+    std::atomic<size_t> failed_at[PARALLEL_SIZE_CLASSES];
+    std::atomic<bool> exhausted;
+    std::atomic<int> result;
+
+    std::mutex lock;
+    std::vector<Allocation> allocations;
+};
+
+double seconds(clock_type::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+int create_object(ParallelState *state, cl_command_queue *queue, size_t size,
+                  cl_mem *mem, size_t *actual_size)
+{
+    int error;
+
+    if (state->type == BUFFER)
+    {
+        *mem = clCreateBuffer(state->context, CL_MEM_READ_WRITE, size, NULL,
+                              &error);
+        *actual_size = size;
+    }
+    else
+    {
+        size_t width, height;
+        error = find_good_image_size(state->device_id, size, &width, &height,
+                                     NULL);
+        if (error != SUCCEEDED) return error;
+        *mem = create_image_2d(state->context, CL_MEM_READ_WRITE,
+                               &image_format, width, height, 0, NULL, &error);
+        *actual_size = width * height * 4 * sizeof(cl_uint);
+    }
+
+    int result = check_allocation_error(state->context, state->device_id,
+                                        error, queue);
+    if (result != SUCCEEDED) *mem = NULL;
+    return result;
+}
+
+// Fills the whole object with pattern and reads back its first and last
+// element. Many implementations only commit memory on first use, so this is
+// where a device that over-commits reports that it ran out of memory.
+int first_use(ParallelState *state, cl_command_queue *queue, cl_mem mem,
+              size_t size, cl_uint pattern)
+{
+    cl_int error;
+    cl_uint check[2][4] = {};
+    int components;
+
+    if (state->type == BUFFER)
+    {
+        components = 1;
+        error = clEnqueueFillBuffer(*queue, mem, &pattern, sizeof(pattern), 0,
+                                    size, 0, NULL, NULL);
+        if (error == CL_SUCCESS)
+            error = clEnqueueReadBuffer(*queue, mem, CL_TRUE, 0,
+                                        sizeof(cl_uint), check[0], 0, NULL,
+                                        NULL);
+        if (error == CL_SUCCESS)
+            error = clEnqueueReadBuffer(*queue, mem, CL_TRUE,
+                                        size - sizeof(cl_uint), sizeof(cl_uint),
+                                        check[1], 0, NULL, NULL);
+    }
+    else
+    {
+        size_t width, height;
+        components = 4;
+        error =
+            clGetImageInfo(mem, CL_IMAGE_WIDTH, sizeof(width), &width, NULL);
+        test_error_abort(error, "clGetImageInfo failed for CL_IMAGE_WIDTH.");
+        error =
+            clGetImageInfo(mem, CL_IMAGE_HEIGHT, sizeof(height), &height, NULL);
+        test_error_abort(error, "clGetImageInfo failed for CL_IMAGE_HEIGHT.");
+
+        const cl_uint color[4] = { pattern, pattern, pattern, pattern };
+        size_t origin[3] = { 0, 0, 0 };
+        size_t region[3] = { width, height, 1 };
+        size_t pixel[3] = { 1, 1, 1 };
+        error = clEnqueueFillImage(*queue, mem, color, origin, region, 0, NULL,
+                                   NULL);
+        if (error == CL_SUCCESS)
+            error = clEnqueueReadImage(*queue, mem, CL_TRUE, origin, pixel, 0,
+                                       0, check[0], 0, NULL, NULL);
+        origin[0] = width - 1;
+        origin[1] = height - 1;
+        if (error == CL_SUCCESS)
+            error = clEnqueueReadImage(*queue, mem, CL_TRUE, origin, pixel, 0,
+                                       0, check[1], 0, NULL, NULL);
+    }
+
+    cl_int finish_error = clFinish(*queue);
+    if (error == CL_SUCCESS) error = finish_error;
+
+    int result = check_allocation_error(state->context, state->device_id,
+                                        error, queue);
+    if (result != SUCCEEDED) return result;
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int c = 0; c < components; c++)
+        {
+            if (check[i][c] != pattern)
+            {
+                log_error("Memory object of %gMB read back 0x%08x at its %s "
+                          "element, expected 0x%08x.\n",
+                          toMB(size), check[i][c], i ? "last" : "first",
+                          pattern);
+                return FAILED_ABORT;
+            }
+        }
+    }
+    return SUCCEEDED;
+}
+
+void allocation_thread(ParallelState *state, cl_uint thread_index,
+                       std::vector<SizeClassStats> *stats)
+{
+    int error;
+    cl_command_queue queue =
+        clCreateCommandQueue(state->context, state->device_id, 0, &error);
+    if (error != CL_SUCCESS)
+    {
+        print_error(error, "Unable to create command queue");
+        state->result = FAILED_ABORT;
+        return;
+    }
+
+    // Start each thread on a different size class so that all classes are
+    // requested concurrently.
+    int size_class = thread_index % PARALLEL_SIZE_CLASSES;
+    for (cl_uint n = 0; !state->exhausted && state->result == SUCCEEDED;
+         n++, size_class = (size_class + 1) % PARALLEL_SIZE_CLASSES)
+    {
+        bool smallest = size_class == PARALLEL_SIZE_CLASSES - 1;
+        if (state->failed_at[size_class]) continue;
+
+        size_t size = state->sizes[size_class];
+        if (state->reserved.fetch_add(size) + size > state->total_size)
+        {
+            state->reserved -= size;
+            if (smallest) state->exhausted = true;
+            continue;
+        }
+
+        cl_mem mem;
+        size_t actual_size = 0;
+        clock_type::time_point start = clock_type::now();
+        int result = create_object(state, &queue, size, &mem, &actual_size);
+        clock_type::time_point created = clock_type::now();
+        if (result == SUCCEEDED)
+        {
+            cl_uint pattern = (thread_index << 24) | (n & 0xFFFFFF);
+            result = first_use(state, &queue, mem, actual_size, pattern);
+            if (result != SUCCEEDED) clReleaseMemObject(mem);
+        }
+        clock_type::time_point used = clock_type::now();
+
+        SizeClassStats &class_stats = (*stats)[size_class];
+        if (result != SUCCEEDED)
+        {
+            state->reserved -= size;
+            if (result == FAILED_ABORT)
+            {
+                state->result = FAILED_ABORT;
+                break;
+            }
+            class_stats.failures++;
+            size_t expected = 0;
+            state->failed_at[size_class].compare_exchange_strong(
+                expected, std::max<size_t>(state->in_use, 1));
+            if (smallest) state->exhausted = true;
+            continue;
+        }
+
+        state->reserved -= size - actual_size;
+        state->in_use += actual_size;
+        class_stats.count++;
+        class_stats.bytes += actual_size;
+        class_stats.create_seconds += seconds(created - start);
+        class_stats.first_use_seconds += seconds(used - created);
+
+        std::lock_guard<std::mutex> guard(state->lock);
+        state->allocations.push_back({ mem, actual_size });
+    }
+
+    clReleaseCommandQueue(queue);
+}
+
+// Frees every other allocation and measures how much of the freed memory can
+// be reused by objects of the largest size class. Returns the percentage
+// reused, or a negative value if the freed memory can not hold even one.
+double measure_reuse(ParallelState *state, int *result)
+{
+    std::vector<Allocation> kept;
+    size_t freed = 0;
+    for (size_t i = 0; i < state->allocations.size(); i++)
+    {
+        if (i % 2)
+        {
+            clReleaseMemObject(state->allocations[i].mem);
+            freed += state->allocations[i].size;
+        }
+        else
+        {
+            kept.push_back(state->allocations[i]);
+        }
+    }
+    state->allocations.swap(kept);
+
+    size_t size = state->sizes[0];
+    size_t possible = freed / size * size;
+    if (possible == 0) return -1.0;
+
+    int error;
+    cl_command_queue queue =
+        clCreateCommandQueue(state->context, state->device_id, 0, &error);
+    if (error != CL_SUCCESS)
+    {
+        print_error(error, "Unable to create command queue");
+        *result = FAILED_ABORT;
+        return 0.0;
+    }
+
+    size_t reused = 0;
+    while (reused + size <= possible)
+    {
+        cl_mem mem;
+        size_t actual_size;
+        *result = create_object(state, &queue, size, &mem, &actual_size);
+        if (*result == SUCCEEDED)
+        {
+            *result = first_use(state, &queue, mem, actual_size, 0xA5A5A5A5);
+            if (*result != SUCCEEDED) clReleaseMemObject(mem);
+        }
+        if (*result != SUCCEEDED) break;
+        state->allocations.push_back({ mem, actual_size });
+        reused += size;
+    }
+    if (*result == FAILED_TOO_BIG) *result = SUCCEEDED;
+
+    clReleaseCommandQueue(queue);
+    return 100.0 * reused / possible;
+}
+
+} // namespace
+
+int allocate_parallel(cl_context context, cl_device_id device_id,
+                      AllocType type, size_t total_size,
+                      size_t max_individual_size)
+{
+    int failure_counts = 0;
+
+    if (type != BUFFER && checkForImageSupport(device_id))
+    {
+        log_info("Can not test image allocation because device does not "
+                 "support images.\n");
+        return 0;
+    }
+
+    cl_uint thread_count =
+        std::min<cl_uint>(GetThreadCount(), PARALLEL_MAX_THREADS);
+
+    ParallelState state;
+    state.context = context;
+    state.device_id = device_id;
+    state.type = type;
+    state.total_size = total_size;
+    state.reserved = 0;
+    state.in_use = 0;
+    state.exhausted = false;
+    state.result = SUCCEEDED;
+
+    // The largest class lets every thread hold one object at once; the
+    // smallest bounds the number of objects that can be created.
+    size_t largest =
+        std::min<size_t>(max_individual_size, total_size / thread_count);
+    if (type != BUFFER)
+    {
+        size_t width, height, max_size;
+        int error = find_good_image_size(device_id, largest, &width, &height,
+                                         &max_size);
+        if (error != SUCCEEDED && error != FAILED_TOO_BIG) return 1;
+        largest = std::min(largest, max_size);
+    }
+    size_t smallest = std::max<size_t>(PARALLEL_MIN_SIZE,
+                                       total_size / PARALLEL_MAX_OBJECTS);
+    for (int i = 0; i < PARALLEL_SIZE_CLASSES; i++)
+    {
+        size_t size = std::max(largest >> (2 * i), smallest);
+        state.sizes[i] = std::min(size, largest) & ~(size_t)4095;
+        state.failed_at[i] = 0;
+    }
+    if (state.sizes[PARALLEL_SIZE_CLASSES - 1] == 0)
+    {
+        log_error("Target allocation size of %gMB is too small.\n",
+                  toMB(total_size));
+        return 1;
+    }
+
+    log_info("** Allocating %s up to %gMB from %u threads in size classes of",
+             type == BUFFER ? "buffers" : "images", toMB(total_size),
+             thread_count);
+    for (int i = 0; i < PARALLEL_SIZE_CLASSES; i++)
+        log_info(" %gMB", toMB(state.sizes[i]));
+    log_info(".\n");
+
+    std::vector<std::vector<SizeClassStats>> stats(
+        thread_count, std::vector<SizeClassStats>(PARALLEL_SIZE_CLASSES));
+    std::vector<std::thread> threads;
+    clock_type::time_point start = clock_type::now();
+    for (cl_uint i = 0; i < thread_count; i++)
+        threads.emplace_back(allocation_thread, &state, i, &stats[i]);
+    for (auto &t : threads) t.join();
+    double wall_seconds = seconds(clock_type::now() - start);
+
+    size_t in_use = state.in_use;
+    log_info("\tAllocated %gMB in %zu memory objects in %gs.\n", toMB(in_use),
+             state.allocations.size(), wall_seconds);
+
+    if (state.result == SUCCEEDED)
+    {
+        for (int i = 0; i < PARALLEL_SIZE_CLASSES; i++)
+        {
+            SizeClassStats total;
+            for (auto &thread_stats : stats)
+            {
+                total.count += thread_stats[i].count;
+                total.failures += thread_stats[i].failures;
+                total.bytes += thread_stats[i].bytes;
+                total.create_seconds += thread_stats[i].create_seconds;
+                total.first_use_seconds += thread_stats[i].first_use_seconds;
+            }
+
+            log_info("\tSize class %gMB: %u objects, %u failed",
+                     toMB(state.sizes[i]), total.count, total.failures);
+            if (state.failed_at[i])
+                log_info(" (first failure with %gMB in use)",
+                         toMB(state.failed_at[i]));
+            log_info(".\n");
+            if (total.count == 0) continue;
+
+            log_perf(1e6 * total.create_seconds / total.count, false, "us",
+                     "Time to allocate a %gMB object", toMB(state.sizes[i]));
+            log_perf(1e3 * total.first_use_seconds / total.count, false, "ms",
+                     "Time to first use of a %gMB object",
+                     toMB(state.sizes[i]));
+            log_perf(toMB(total.bytes) / total.first_use_seconds, true, "MB/s",
+                     "First use bandwidth for %gMB objects",
+                     toMB(state.sizes[i]));
+        }
+        log_perf(toMB(in_use) / wall_seconds, true, "MB/s",
+                 "Effective allocation bandwidth (%u threads)", thread_count);
+
+        int result = SUCCEEDED;
+        double reuse = measure_reuse(&state, &result);
+        if (result != SUCCEEDED)
+        {
+            log_error("\tFAIL: Reallocating freed memory failed.\n");
+            failure_counts++;
+        }
+        else if (reuse < 0.0)
+        {
+            log_info("\tNot enough memory was freed to reallocate a %gMB "
+                     "object.\n",
+                     toMB(state.sizes[0]));
+        }
+        else
+        {
+            log_perf(reuse, true, "%",
+                     "Freed memory reused by %gMB objects after releasing "
+                     "every other allocation",
+                     toMB(state.sizes[0]));
+        }
+    }
+    else
+    {
+        log_error("\tFAIL: Parallel allocation failed.\n");
+        failure_counts++;
+    }
+
+    for (auto &allocation : state.allocations)
+        clReleaseMemObject(allocation.mem);
+
+    if (in_use < total_size / 8)
+    {
+        log_error("\tFAIL: Failed to allocate more than 1/8th of the requested "
+                  "size.\n");
+        failure_counts++;
+    }
+
+    return failure_counts;
+}
@@ -0,0 +1,31 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _allocation_parallel_h
+#define _allocation_parallel_h
+
+#include "testBase.h"
+#include "allocation_utils.h"
+
+// Allocates and fills memory objects of several size classes from multiple
+// host threads, each with its own queue, until total_size bytes are in use or
+// the device refuses further allocations. Reports allocation and first-use
+// timings per size class and how much of a fragmented heap can be reused for
+// the largest size class. Returns the number of failures.
+int allocate_parallel(cl_context context, cl_device_id device_id,
+                      AllocType type, size_t total_size,
+                      size_t max_individual_size);
+
+#endif // _allocation_parallel_h
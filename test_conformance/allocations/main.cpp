@@ -18,6 +18,7 @@
 #include "allocation_functions.h"
 #include "allocation_fill.h"
 #include "allocation_execute.h"
+#include "allocation_parallel.h"
 #include "harness/testHarness.h"
 #include <time.h>
 
@@ -297,6 +298,26 @@ REGISTER_TEST(image2d_write_non_blocking)
     return doTest(device, context, queue, IMAGE_WRITE_NON_BLOCKING);
 }
 
+int doParallelTest(cl_device_id device, cl_context context,
+                   AllocType alloc_type)
+{
+    // Unlike the single and multiple modes this always targets the combined
+    // allocation size, so that the device is driven close to its limit.
+    size_t total_size = (size_t)((double)g_global_mem_size
+                                 * (double)g_reduction_percentage / 100.0);
+    return allocate_parallel(context, device, alloc_type, total_size,
+                             (size_t)g_max_individual_allocation_size);
+}
+
+REGISTER_TEST(buffer_parallel)
+{
+    return doParallelTest(device, context, BUFFER);
+}
+REGISTER_TEST(image2d_parallel)
+{
+    return doParallelTest(device, context, IMAGE_READ);
+}
+
 static test_status parseArgs(int &argc, const char *argv[],
                              std::vector<std::string> &removed_args,
                              std::string &help)
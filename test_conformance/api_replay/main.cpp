@@ -0,0 +1,580 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Replays a capture written by a suite built with -DAPI_CAPTURE=ON (see
+// harness/apiCapture.h) and reports the time spent building programs and
+// executing each kernel. The platform and device are selected with
+// CL_PLATFORM_INDEX and CL_DEVICE_INDEX as for the conformance suites.
+//
+#define CL_API_CAPTURE_NO_REDIRECT
+#include "harness/compat.h"
+#include "harness/apiCapture.h"
+#include "harness/errorHelpers.h"
+#include "harness/profilingStats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Record
+{
+    CaptureOp op;
+    const char *data;
+    size_t size;
+};
+
+class RecordReader {
+public:
+    explicit RecordReader(const Record &record)
+        : pos(record.data), end(record.data + record.size)
+    {}
+
+    cl_uint u32() { return read<cl_uint>(); }
+    cl_ulong u64() { return read<cl_ulong>(); }
+    const char *blob(size_t *size)
+    {
+        *size = (size_t)u64();
+        const char *data = pos;
+        if (*size > (size_t)(end - pos))
+        {
+            valid = false;
+            *size = 0;
+            return nullptr;
+        }
+        pos += *size;
+        return data;
+    }
+    std::string str()
+    {
+        size_t size;
+        const char *data = blob(&size);
+        return data ? std::string(data, size) : std::string();
+    }
+
+    bool valid = true;
+
+private:
+    template <typename T> T read()
+    {
+        T value = 0;
+        if (sizeof(T) > (size_t)(end - pos))
+        {
+            valid = false;
+            return value;
+        }
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    const char *pos;
+    const char *end;
+};
+
+struct KernelTiming
+{
+    std::string name;
+    std::vector<double> pass_us;
+    size_t launches_per_pass = 0;
+    SampleStats stats;
+};
+
+struct ReplayTimings
+{
+    std::vector<double> build_ms;
+    std::vector<double> total_ms;
+    std::map<std::string, KernelTiming> kernels;
+    size_t skipped_launches = 0;
+};
+
+bool load_capture(const char *file_name, std::vector<char> &contents,
+                  std::vector<Record> &records, std::string &test_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (file == nullptr)
+    {
+        log_error("ERROR: Unable to open capture '%s'\n", file_name);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    contents.resize(size > 0 ? (size_t)size : 0);
+    size_t read = fread(contents.data(), 1, contents.size(), file);
+    fclose(file);
+
+    cl_uint header[2] = { 0, 0 };
+    if (read != contents.size() || read < sizeof(header))
+    {
+        log_error("ERROR: Unable to read capture '%s'\n", file_name);
+        return false;
+    }
+    memcpy(header, contents.data(), sizeof(header));
+    if (header[0] != capture_file_magic || header[1] != capture_file_version)
+    {
+        log_error("ERROR: '%s' is not a version %u capture file\n", file_name,
+                  capture_file_version);
+        return false;
+    }
+
+    // One byte CaptureOp followed by the 64-bit payload size
+    const size_t record_header_size = 1 + sizeof(cl_ulong);
+    size_t pos = sizeof(header);
+    while (pos + record_header_size <= contents.size())
+    {
+        Record record;
+        cl_ulong payload_size;
+        record.op = (CaptureOp)contents[pos];
+        memcpy(&payload_size, &contents[pos + 1], sizeof(payload_size));
+        pos += record_header_size;
+        if (payload_size > contents.size() - pos)
+        {
+            log_error("ERROR: Truncated capture record at offset %zu\n", pos);
+            return false;
+        }
+        record.data = &contents[pos];
+        record.size = (size_t)payload_size;
+        pos += payload_size;
+
+        if (record.op == CAPTURE_TEST_NAME)
+            test_name = RecordReader(record).str();
+        else
+            records.push_back(record);
+    }
+    return true;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Replays the records once in a fresh context. Kernel launches are timed with
+// event profiling, their device time is added to timings.
+cl_int replay_pass(cl_device_id device, const std::vector<Record> &records,
+                   ReplayTimings &timings)
+{
+    cl_int error;
+    cl_context context =
+        clCreateContext(nullptr, 1, &device, nullptr, nullptr, &error);
+    test_error(error, "clCreateContext failed");
+
+    std::map<cl_uint, cl_command_queue> queues;
+    std::map<cl_uint, cl_program> programs;
+    std::map<cl_uint, cl_kernel> kernels;
+    std::map<cl_uint, std::string> kernel_names;
+    std::map<cl_uint, cl_mem> mems;
+    // Argument indices of each kernel that could not be replayed
+    std::map<cl_uint, std::map<cl_uint, bool>> unsupported_args;
+    std::vector<std::pair<std::string, cl_event>> launches;
+    std::vector<char> scratch;
+    double build_ms = 0.0;
+
+    auto get_queue = [&](cl_uint id) {
+        cl_command_queue &queue = queues[id];
+        if (queue == nullptr)
+        {
+            cl_queue_properties props[] = { CL_QUEUE_PROPERTIES,
+                                            CL_QUEUE_PROFILING_ENABLE, 0 };
+            queue = clCreateCommandQueueWithProperties(context, device, props,
+                                                       &error);
+            if (queue == nullptr)
+                print_error(error, "clCreateCommandQueueWithProperties failed");
+        }
+        return queue;
+    };
+
+    auto pass_start = std::chrono::steady_clock::now();
+    for (const Record &record : records)
+    {
+        RecordReader in(record);
+        error = CL_SUCCESS;
+        switch (record.op)
+        {
+            case CAPTURE_CREATE_PROGRAM_WITH_SOURCE: {
+                cl_uint id = in.u32();
+                cl_uint count = in.u32();
+                std::vector<const char *> strings(count);
+                std::vector<size_t> lengths(count);
+                for (cl_uint i = 0; i < count; i++)
+                {
+                    // Sources are not NUL terminated in the capture
+                    strings[i] = in.blob(&lengths[i]);
+                    if (lengths[i] == 0) strings[i] = "";
+                }
+                programs[id] = clCreateProgramWithSource(
+                    context, count, strings.data(), lengths.data(), &error);
+                break;
+            }
+            case CAPTURE_CREATE_PROGRAM_WITH_IL: {
+                cl_uint id = in.u32();
+                size_t length;
+                const char *il = in.blob(&length);
+                programs[id] =
+                    clCreateProgramWithIL(context, il, length, &error);
+                break;
+            }
+            case CAPTURE_BUILD_PROGRAM: {
+                cl_program program = programs[in.u32()];
+                std::string options = in.str();
+                auto start = std::chrono::steady_clock::now();
+                error = clBuildProgram(program, 1, &device, options.c_str(),
+                                       nullptr, nullptr);
+                build_ms += elapsed_ms(start);
+                break;
+            }
+            case CAPTURE_CREATE_KERNEL: {
+                cl_uint id = in.u32();
+                cl_program program = programs[in.u32()];
+                kernel_names[id] = in.str();
+                kernels[id] =
+                    clCreateKernel(program, kernel_names[id].c_str(), &error);
+                unsupported_args.erase(id);
+                break;
+            }
+            case CAPTURE_CREATE_BUFFER: {
+                cl_uint id = in.u32();
+                cl_mem_flags flags = in.u64();
+                size_t size = (size_t)in.u64();
+                size_t data_size;
+                const char *data = in.blob(&data_size);
+                if (data_size) flags |= CL_MEM_COPY_HOST_PTR;
+                mems[id] = clCreateBuffer(context, flags, size,
+                                          data_size ? (void *)data : nullptr,
+                                          &error);
+                break;
+            }
+            case CAPTURE_SET_ARG_VALUE: {
+                cl_uint id = in.u32();
+                cl_uint index = in.u32();
+                size_t size;
+                const char *value = in.blob(&size);
+                error = clSetKernelArg(kernels[id], index, size, value);
+                unsupported_args[id].erase(index);
+                break;
+            }
+            case CAPTURE_SET_ARG_MEM: {
+                cl_uint id = in.u32();
+                cl_uint index = in.u32();
+                cl_uint mem_id = in.u32();
+                cl_mem mem = mem_id ? mems[mem_id] : nullptr;
+                error = clSetKernelArg(kernels[id], index, sizeof(mem), &mem);
+                unsupported_args[id].erase(index);
+                break;
+            }
+            case CAPTURE_SET_ARG_LOCAL: {
+                cl_uint id = in.u32();
+                cl_uint index = in.u32();
+                size_t size = (size_t)in.u64();
+                error = clSetKernelArg(kernels[id], index, size, nullptr);
+                unsupported_args[id].erase(index);
+                break;
+            }
+            case CAPTURE_SET_ARG_UNSUPPORTED: {
+                cl_uint id = in.u32();
+                unsupported_args[id][in.u32()] = true;
+                break;
+            }
+            case CAPTURE_WRITE_BUFFER: {
+                cl_command_queue queue = get_queue(in.u32());
+                cl_mem mem = mems[in.u32()];
+                size_t offset = (size_t)in.u64();
+                size_t size;
+                const char *data = in.blob(&size);
+                // The capture buffer outlives the pass, so no copy is needed
+                error = clEnqueueWriteBuffer(queue, mem, CL_FALSE, offset, size,
+                                             data, 0, nullptr, nullptr);
+                break;
+            }
+            case CAPTURE_READ_BUFFER: {
+                cl_command_queue queue = get_queue(in.u32());
+                cl_mem mem = mems[in.u32()];
+                size_t offset = (size_t)in.u64();
+                size_t size = (size_t)in.u64();
+                if (scratch.size() < size) scratch.resize(size);
+                error = clEnqueueReadBuffer(queue, mem, CL_TRUE, offset, size,
+                                            scratch.data(), 0, nullptr,
+                                            nullptr);
+                break;
+            }
+            case CAPTURE_FILL_BUFFER: {
+                cl_command_queue queue = get_queue(in.u32());
+                cl_mem mem = mems[in.u32()];
+                size_t pattern_size;
+                const char *pattern = in.blob(&pattern_size);
+                size_t offset = (size_t)in.u64();
+                size_t size = (size_t)in.u64();
+                error = clEnqueueFillBuffer(queue, mem, pattern, pattern_size,
+                                            offset, size, 0, nullptr, nullptr);
+                break;
+            }
+            case CAPTURE_COPY_BUFFER: {
+                cl_command_queue queue = get_queue(in.u32());
+                cl_mem src = mems[in.u32()];
+                cl_mem dst = mems[in.u32()];
+                size_t src_offset = (size_t)in.u64();
+                size_t dst_offset = (size_t)in.u64();
+                size_t size = (size_t)in.u64();
+                error = clEnqueueCopyBuffer(queue, src, dst, src_offset,
+                                            dst_offset, size, 0, nullptr,
+                                            nullptr);
+                break;
+            }
+            case CAPTURE_ND_RANGE_KERNEL: {
+                cl_command_queue queue = get_queue(in.u32());
+                cl_uint id = in.u32();
+                cl_uint work_dim = std::min<cl_uint>(in.u32(), 3);
+                cl_uint flags = in.u32();
+                size_t offset[3] = { 0, 0, 0 };
+                size_t global[3] = { 1, 1, 1 };
+                size_t local[3] = { 1, 1, 1 };
+                for (cl_uint i = 0; (flags & CAPTURE_HAS_OFFSET) && i < work_dim;
+                     i++)
+                    offset[i] = (size_t)in.u64();
+                for (cl_uint i = 0; i < work_dim; i++)
+                    global[i] = (size_t)in.u64();
+                for (cl_uint i = 0;
+                     (flags & CAPTURE_HAS_LOCAL_SIZE) && i < work_dim; i++)
+                    local[i] = (size_t)in.u64();
+
+                if (!unsupported_args[id].empty())
+                {
+                    timings.skipped_launches++;
+                    break;
+                }
+
+                cl_event event = nullptr;
+                error = clEnqueueNDRangeKernel(
+                    queue, kernels[id], work_dim,
+                    (flags & CAPTURE_HAS_OFFSET) ? offset : nullptr, global,
+                    (flags & CAPTURE_HAS_LOCAL_SIZE) ? local : nullptr, 0,
+                    nullptr, &event);
+                if (error == CL_SUCCESS)
+                    launches.emplace_back(kernel_names[id], event);
+                break;
+            }
+            case CAPTURE_FINISH: error = clFinish(get_queue(in.u32())); break;
+            default:
+                // Unknown records are skipped so that older tools can read
+                // newer captures
+                break;
+        }
+
+        if (!in.valid)
+        {
+            log_error("ERROR: Malformed capture record (op %d)\n",
+                      (int)record.op);
+            error = CL_INVALID_VALUE;
+        }
+        if (error != CL_SUCCESS)
+        {
+            print_error(error, "Replay of capture record failed");
+            break;
+        }
+    }
+
+    for (auto &queue : queues)
+        if (queue.second) clFinish(queue.second);
+    double total_ms = elapsed_ms(pass_start);
+
+    std::map<std::string, std::pair<double, size_t>> pass_kernels;
+    for (auto &launch : launches)
+    {
+        cl_ulong start = 0, end = 0;
+        cl_int profiling_error = clGetEventProfilingInfo(
+            launch.second, CL_PROFILING_COMMAND_START, sizeof(start), &start,
+            nullptr);
+        profiling_error |=
+            clGetEventProfilingInfo(launch.second, CL_PROFILING_COMMAND_END,
+                                    sizeof(end), &end, nullptr);
+        if (profiling_error == CL_SUCCESS)
+        {
+            pass_kernels[launch.first].first += (double)(end - start) * 1e-3;
+            pass_kernels[launch.first].second++;
+        }
+        clReleaseEvent(launch.second);
+    }
+    for (auto &kernel : pass_kernels)
+    {
+        KernelTiming &timing = timings.kernels[kernel.first];
+        timing.name = kernel.first;
+        timing.pass_us.push_back(kernel.second.first);
+        timing.launches_per_pass = kernel.second.second;
+    }
+    timings.build_ms.push_back(build_ms);
+    timings.total_ms.push_back(total_ms);
+
+    for (auto &kernel : kernels)
+        if (kernel.second) clReleaseKernel(kernel.second);
+    for (auto &program : programs)
+        if (program.second) clReleaseProgram(program.second);
+    for (auto &mem : mems)
+        if (mem.second) clReleaseMemObject(mem.second);
+    for (auto &queue : queues)
+        if (queue.second) clReleaseCommandQueue(queue.second);
+    clReleaseContext(context);
+
+    return error;
+}
+
+cl_device_id choose_device()
+{
+    cl_uint platform_index = 0, device_index = 0;
+    if (const char *env = getenv("CL_PLATFORM_INDEX"))
+        platform_index = atoi(env);
+    if (const char *env = getenv("CL_DEVICE_INDEX")) device_index = atoi(env);
+
+    cl_uint num_platforms = 0;
+    clGetPlatformIDs(0, nullptr, &num_platforms);
+    if (platform_index >= num_platforms)
+    {
+        log_error("ERROR: Platform %u not found\n", platform_index);
+        return nullptr;
+    }
+    std::vector<cl_platform_id> platforms(num_platforms);
+    clGetPlatformIDs(num_platforms, platforms.data(), nullptr);
+
+    cl_uint num_devices = 0;
+    clGetDeviceIDs(platforms[platform_index], CL_DEVICE_TYPE_ALL, 0, nullptr,
+                   &num_devices);
+    if (device_index >= num_devices)
+    {
+        log_error("ERROR: Device %u not found\n", device_index);
+        return nullptr;
+    }
+    std::vector<cl_device_id> devices(num_devices);
+    clGetDeviceIDs(platforms[platform_index], CL_DEVICE_TYPE_ALL, num_devices,
+                   devices.data(), nullptr);
+    return devices[device_index];
+}
+
+void print_usage(const char *name)
+{
+    log_info("Usage: %s [-n <passes>] [-csv <file>] <capture.clcap>\n", name);
+    log_info("\t-n <passes>\tNumber of times the capture is replayed (default "
+             "5)\n");
+    log_info("\t-csv <file>\tAppend per-kernel median timings to a CSV file\n");
+}
+
+}
+
+int main(int argc, const char *argv[])
+{
+    int passes = 5;
+    const char *csv_file = nullptr;
+    const char *capture_file = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            passes = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-csv") == 0 && i + 1 < argc)
+            csv_file = argv[++i];
+        else if (argv[i][0] != '-' && capture_file == nullptr)
+            capture_file = argv[i];
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture_file == nullptr)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<char> contents;
+    std::vector<Record> records;
+    std::string test_name = "unknown";
+    if (!load_capture(capture_file, contents, records, test_name))
+        return EXIT_FAILURE;
+
+    cl_device_id device = choose_device();
+    if (device == nullptr) return EXIT_FAILURE;
+
+    char device_name[256] = "";
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_name), device_name,
+                    nullptr);
+    log_info("Replaying %s (%zu records) %d times on %s\n", test_name.c_str(),
+             records.size(), passes, device_name);
+
+    ReplayTimings timings;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        if (replay_pass(device, records, timings) != CL_SUCCESS)
+            return EXIT_FAILURE;
+    }
+
+    log_info("Total %.3f ms, program builds %.3f ms (median of %d passes)\n",
+             compute_sample_stats(timings.total_ms).median,
+             compute_sample_stats(timings.build_ms).median, passes);
+    if (timings.skipped_launches)
+        log_info("Skipped %zu launches with arguments that cannot be "
+                 "replayed\n",
+                 timings.skipped_launches / passes);
+
+    std::vector<const KernelTiming *> kernels;
+    for (auto &kernel : timings.kernels)
+    {
+        kernel.second.stats = compute_sample_stats(kernel.second.pass_us);
+        kernels.push_back(&kernel.second);
+    }
+    std::sort(kernels.begin(), kernels.end(),
+              [](const KernelTiming *a, const KernelTiming *b) {
+                  return a->stats.median > b->stats.median;
+              });
+
+    log_info("%-40s %10s %14s %14s\n", "kernel", "launches", "median us",
+             "min us");
+    for (const KernelTiming *kernel : kernels)
+        log_info("%-40s %10zu %14.1f %14.1f\n", kernel->name.c_str(),
+                 kernel->launches_per_pass, kernel->stats.median,
+                 *std::min_element(kernel->pass_us.begin(),
+                                   kernel->pass_us.end()));
+
+    if (csv_file)
+    {
+        FILE *file = fopen(csv_file, "a");
+        if (file == nullptr)
+        {
+            log_error("ERROR: Failed to open '%s' for writing results.\n",
+                      csv_file);
+            return EXIT_FAILURE;
+        }
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) == 0)
+            fprintf(file, "test,device,kernel,launches,median_us,min_us\n");
+        for (const KernelTiming *kernel : kernels)
+            fprintf(file, "%s,%s,%s,%zu,%.3f,%.3f\n", test_name.c_str(),
+                    device_name, kernel->name.c_str(),
+                    kernel->launches_per_pass, kernel->stats.median,
+                    *std::min_element(kernel->pass_us.begin(),
+                                      kernel->pass_us.end()));
+        fclose(file);
+    }
+
+    return EXIT_SUCCESS;
+}
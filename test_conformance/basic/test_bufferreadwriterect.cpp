@@ -16,7 +16,9 @@
 #include "harness/compat.h"
 #include "errorHelpers.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,6 +28,7 @@
 #include <cinttypes>
 
 #include "testBase.h"
+#include "harness/parseParameters.h"
 
 #define TEST_READWRITERECT_PRINT_BUFFER 0
 #define CL_EXIT_ERROR(cmd, format, ...)                                        \
@@ -111,6 +114,67 @@ void print_buffer(BufferType* buf, size_t w, size_t h, size_t d) {
 }
 #endif
 
+// Generates a random source region and a destination region of the same
+// size that fit in the src and dst buffers. Shapes other than RandomRegion
+// stretch or narrow the random region to model common access patterns.
+enum RegionShape
+{
+    RandomRegion,
+    FullRows,   // complete rows, random number of rows and slices
+    Columns,    // at most 16 bytes wide, strided by the row pitch
+    FullSlices, // complete slices, random number of slices
+};
+
+void random_region(size_t src, size_t soffset[3], size_t sregion[3],
+                   size_t dst, size_t doffset[3], size_t dregion[3],
+                   RegionShape shape = RandomRegion)
+{
+    // Determine the minimum dimensions.
+    size_t min_width = width[src] < width[dst] ? width[src] : width[dst];
+    size_t min_height = height[src] < height[dst] ? height[src] : height[dst];
+    size_t min_depth = depth[src] < depth[dst] ? depth[src] : depth[dst];
+
+    // Generate a random source rectangle within the minimum dimensions.
+    size_t mx = get_random_size_t(0, min_width - 1, mt);
+    size_t my = get_random_size_t(0, min_height - 1, mt);
+    size_t mz = get_random_size_t(0, min_depth - 1, mt);
+
+    size_t sw = get_random_size_t(1, (min_width - mx), mt);
+    size_t sh = get_random_size_t(1, (min_height - my), mt);
+    size_t sd = get_random_size_t(1, (min_depth - mz), mt);
+
+    switch (shape)
+    {
+        case RandomRegion: break;
+        case FullRows: sw = min_width; break;
+        case Columns: sw = sw < 16 ? sw : 16; break;
+        case FullSlices:
+            sw = min_width;
+            sh = min_height;
+            break;
+    }
+
+    size_t sx = get_random_size_t(0, width[src] - sw, mt);
+    size_t sy = get_random_size_t(0, height[src] - sh, mt);
+    size_t sz = get_random_size_t(0, depth[src] - sd, mt);
+
+    soffset[0] = sx;
+    soffset[1] = sy;
+    soffset[2] = sz;
+    sregion[0] = sw;
+    sregion[1] = sh;
+    sregion[2] = sd;
+
+    // Generate a destination rectangle of the same size at a random offset
+    // within the buffer.
+    doffset[0] = get_random_size_t(0, (width[dst] - sw), mt);
+    doffset[1] = get_random_size_t(0, (height[dst] - sh), mt);
+    doffset[2] = get_random_size_t(0, (depth[dst] - sd), mt);
+    dregion[0] = sw;
+    dregion[1] = sh;
+    dregion[2] = sd;
+}
+
 // Returns true if the two specified regions overlap.
 bool check_overlap_rect(size_t src_offset[3], size_t dst_offset[3],
                         size_t region[3], size_t src)
@@ -593,38 +657,8 @@ int test_bufferreadwriterect_impl(cl_device_id device, cl_context context,
         size_t src = get_random_size_t(0,TotalImages,mt);
         size_t dst = get_random_size_t(0,TotalImages,mt);
 
-        // Determine the minimum dimensions.
-        size_t min_width = width[src] < width[dst] ? width[src] : width[dst];
-        size_t min_height = height[src] < height[dst] ? height[src] : height[dst];
-        size_t min_depth = depth[src] < depth[dst] ? depth[src] : depth[dst];
-
-        // Generate a random source rectangle within the minimum dimensions.
-        size_t mx = get_random_size_t(0, min_width-1, mt);
-        size_t my = get_random_size_t(0, min_height-1, mt);
-        size_t mz = get_random_size_t(0, min_depth-1, mt);
-
-        size_t sw = get_random_size_t(1, (min_width - mx), mt);
-        size_t sh = get_random_size_t(1, (min_height - my), mt);
-        size_t sd = get_random_size_t(1, (min_depth - mz), mt);
-
-        size_t sx = get_random_size_t(0, width[src]-sw, mt);
-        size_t sy = get_random_size_t(0, height[src]-sh, mt);
-        size_t sz = get_random_size_t(0, depth[src]-sd, mt);
-
-        size_t soffset[] = { sx, sy, sz };
-        size_t sregion[] = { sw, sh, sd };
-
-        // Generate a destination rectangle of the same size.
-        size_t dw = sw;
-        size_t dh = sh;
-        size_t dd = sd;
-
-        // Generate a random destination offset within the buffer.
-        size_t dx = get_random_size_t(0, (width[dst] - dw), mt);
-        size_t dy = get_random_size_t(0, (height[dst] - dh), mt);
-        size_t dz = get_random_size_t(0, (depth[dst] - dd), mt);
-        size_t doffset[] = { dx, dy, dz };
-        size_t dregion[] = { dw, dh, dd };
+        size_t soffset[3], sregion[3], doffset[3], dregion[3];
+        random_region(src, soffset, sregion, dst, doffset, dregion);
 
         // Execute one of three operations:
         // - Copy: Copies between src and dst within each set of host, buffer, and images.
@@ -706,6 +740,270 @@ int test_bufferreadwriterect_impl(cl_device_id device, cl_context context,
     return err;
 }
 
+// Throughput of the rect commands for several region shapes, with host and
+// copy pitches either matching the buffer layout or packed to the region.
+// Buffer 0 is only read, so its verify copy stays valid, and buffer 1
+// receives copies and writes. Only one in ThroughputVerifyInterval commands
+// is checked on the host so that checking does not disturb the measurement.
+// The buffers are kept to throughput_smoke_bytes unless --benchmark is given.
+enum
+{
+    ThroughputCommands = 64,
+    ThroughputVerifyInterval = 16
+};
+const size_t throughput_max_bytes = 64 * 1024 * 1024;
+const size_t throughput_smoke_bytes = 1024 * 1024;
+
+enum RectCommand
+{
+    RectCopy,
+    RectRead,
+    RectWrite
+};
+const char* rect_command_names[] = { "copy", "read", "write" };
+const char* region_shape_names[] = { "random", "rows", "columns", "slices" };
+
+std::vector<BufferType> readback_buffer;
+
+// Compares a region stored in a and b with the given origins and pitches.
+int compare_region(const BufferType* a, const size_t a_origin[3],
+                   size_t a_row_pitch, size_t a_slice_pitch,
+                   const BufferType* b, const size_t b_origin[3],
+                   size_t b_row_pitch, size_t b_slice_pitch,
+                   const size_t region[3])
+{
+    for (size_t z = 0; z != region[2]; ++z)
+    {
+        for (size_t y = 0; y != region[1]; ++y)
+        {
+            const BufferType* a_row = a + (a_origin[2] + z) * a_slice_pitch
+                + (a_origin[1] + y) * a_row_pitch + a_origin[0];
+            const BufferType* b_row = b + (b_origin[2] + z) * b_slice_pitch
+                + (b_origin[1] + y) * b_row_pitch + b_origin[0];
+            if (memcmp(a_row, b_row, region[0] * sizeof(BufferType)) == 0)
+                continue;
+            for (size_t x = 0; x != region[0]; ++x)
+            {
+                if (a_row[x] != b_row[x])
+                {
+                    log_error("Verify failed at coordinate (%zu, %zu, %zu) "
+                              "of region\n",
+                              x, y, z);
+                    log_error("0x%02x != 0x%02x\n", a_row[x], b_row[x]);
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int measure_rect_throughput(RectCommand command, RegionShape shape,
+                            bool packed, double* device_gbps,
+                            double* wall_gbps)
+{
+    const size_t zero[3] = { 0, 0, 0 };
+    const size_t row_pitch = width[0];
+    const size_t slice_pitch = width[0] * height[0];
+    size_t total_bytes = 0;
+    double device_seconds = 0.0;
+    double wall_seconds = 0.0;
+    std::vector<clEventWrapper> events(ThroughputCommands);
+    cl_int err;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != ThroughputCommands; ++i)
+    {
+        size_t soffset[3], sregion[3], doffset[3], dregion[3];
+        random_region(0, soffset, sregion, 1, doffset, dregion, shape);
+
+        // Pitches passed for the host side, or for both sides of a copy, and
+        // the pitches they stand for.
+        size_t pitch = packed ? 0 : row_pitch;
+        size_t slice = packed ? 0 : slice_pitch;
+        size_t effective_pitch = packed ? sregion[0] : row_pitch;
+        size_t effective_slice =
+            packed ? sregion[0] * sregion[1] : slice_pitch;
+        const size_t* host_origin =
+            packed ? zero : (command == RectRead ? doffset : soffset);
+
+        cl_event* event = &events[i];
+        switch (command)
+        {
+            case RectCopy:
+                err = clEnqueueCopyBufferRect(
+                    gQueue, buffer[0], buffer[1], soffset, doffset, sregion,
+                    pitch, slice, pitch, slice, 0, NULL, event);
+                break;
+            case RectRead:
+                err = clEnqueueReadBufferRect(
+                    gQueue, buffer[0], CL_FALSE, soffset, host_origin, sregion,
+                    row_pitch, slice_pitch, pitch, slice, tmp_buffer.data(), 0,
+                    NULL, event);
+                break;
+            case RectWrite:
+                err = clEnqueueWriteBufferRect(
+                    gQueue, buffer[1], CL_FALSE, doffset, host_origin, sregion,
+                    row_pitch, slice_pitch, pitch, slice, tmp_buffer.data(), 0,
+                    NULL, event);
+                break;
+        }
+        CL_EXIT_ERROR(err, "%s rect command failed",
+                      rect_command_names[command]);
+        total_bytes += sregion[0] * sregion[1] * sregion[2];
+
+        if ((i % ThroughputVerifyInterval) != 0) continue;
+
+        CL_EXIT_ERROR(clFinish(gQueue), "clFinish failed");
+        auto pause = std::chrono::steady_clock::now();
+        wall_seconds += std::chrono::duration<double>(pause - start).count();
+
+        int ret = 0;
+        switch (command)
+        {
+            case RectCopy:
+                CL_EXIT_ERROR(clEnqueueReadBufferRect(
+                                  gQueue, buffer[1], CL_TRUE, doffset, zero,
+                                  sregion, pitch, slice, 0, 0,
+                                  readback_buffer.data(), 0, NULL, NULL),
+                              "clEnqueueReadBufferRect failed");
+                ret = compare_region(readback_buffer.data(), zero, sregion[0],
+                                     sregion[0] * sregion[1], verify[0].data(),
+                                     soffset, effective_pitch, effective_slice,
+                                     sregion);
+                break;
+            case RectRead:
+                ret = compare_region(tmp_buffer.data(), host_origin,
+                                     effective_pitch, effective_slice,
+                                     verify[0].data(), soffset, row_pitch,
+                                     slice_pitch, sregion);
+                break;
+            case RectWrite:
+                CL_EXIT_ERROR(clEnqueueReadBufferRect(
+                                  gQueue, buffer[1], CL_TRUE, doffset,
+                                  host_origin, sregion, row_pitch,
+                                  slice_pitch, pitch, slice,
+                                  readback_buffer.data(), 0, NULL, NULL),
+                              "clEnqueueReadBufferRect failed");
+                ret = compare_region(readback_buffer.data(), host_origin,
+                                     effective_pitch, effective_slice,
+                                     tmp_buffer.data(), host_origin,
+                                     effective_pitch, effective_slice, sregion);
+                break;
+        }
+        if (ret)
+        {
+            log_error("%s rect of region (%zux%zux%zu) from (%zu,%zu,%zu) to "
+                      "(%zu,%zu,%zu) failed\n",
+                      rect_command_names[command], sregion[0], sregion[1],
+                      sregion[2], soffset[0], soffset[1], soffset[2],
+                      doffset[0], doffset[1], doffset[2]);
+            return ret;
+        }
+
+        start = std::chrono::steady_clock::now();
+    }
+    CL_EXIT_ERROR(clFinish(gQueue), "clFinish failed");
+    wall_seconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    for (size_t i = 0; i != ThroughputCommands; ++i)
+    {
+        cl_ulong begin, end;
+        CL_EXIT_ERROR(clGetEventProfilingInfo(events[i],
+                                              CL_PROFILING_COMMAND_START,
+                                              sizeof(begin), &begin, NULL),
+                      "Unable to get command start time");
+        CL_EXIT_ERROR(clGetEventProfilingInfo(events[i],
+                                              CL_PROFILING_COMMAND_END,
+                                              sizeof(end), &end, NULL),
+                      "Unable to get command end time");
+        device_seconds += (end - begin) * 1e-9;
+    }
+
+    *device_gbps = device_seconds > 0.0 ? total_bytes / device_seconds * 1e-9
+                                        : 0.0;
+    *wall_gbps = total_bytes / wall_seconds * 1e-9;
+    return 0;
+}
+
+int test_bufferreadwriterect_throughput_impl(cl_device_id device,
+                                             cl_context context)
+{
+    cl_int err;
+
+    clCommandQueueWrapper profiling_queue = clCreateCommandQueue(
+        context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+    CL_EXIT_ERROR(err, "Unable to create profiling command queue");
+    gQueue = profiling_queue;
+
+    std::array<clMemWrapper, TotalImages> local_buffer;
+    buffer = local_buffer.data();
+
+    mt = init_genrand(gRandomSeed);
+
+    cl_ulong max_mem_alloc_size = 0;
+    CL_EXIT_ERROR(clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                                  sizeof(cl_ulong), &max_mem_alloc_size, NULL),
+                  "Could not get device info");
+
+    // Two cubic buffers of the same size
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    size_t dim = (size_t)cbrt(
+        (double)(std::min<cl_ulong>(max_mem_alloc_size,
+                                    full_sweep ? throughput_max_bytes
+                                               : throughput_smoke_bytes)
+                 / sizeof(BufferType)));
+    size_t num_elems = dim * dim * dim;
+    log_info("Using two %zux%zux%zu buffers.\n", dim, dim, dim);
+
+    for (unsigned i = 0; i != 2; ++i)
+    {
+        width[i] = height[i] = depth[i] = dim;
+        verify[i].resize(num_elems);
+        initialize_image(verify[i].data(), dim, dim, dim, mt);
+        buffer[i] = clCreateBuffer(
+            context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            num_elems * sizeof(BufferType), verify[i].data(), &err);
+        CL_EXIT_ERROR(err, "clCreateBuffer failed for buffer %u", i);
+    }
+
+    tmp_buffer_size = num_elems;
+    tmp_buffer.resize(tmp_buffer_size);
+    initialize_image(tmp_buffer.data(), tmp_buffer_size, 1, 1, mt);
+    readback_buffer.resize(tmp_buffer_size);
+
+    log_info("%-6s %-8s %-7s %12s %12s\n", "cmd", "shape", "pitch",
+             "device GB/s", "wall GB/s");
+    int ret = 0;
+    for (int command = RectCopy; command <= RectWrite && !ret; ++command)
+    {
+        for (int shape = RandomRegion; shape <= FullSlices && !ret; ++shape)
+        {
+            for (int packed = 0; packed != 2 && !ret; ++packed)
+            {
+                double device_gbps, wall_gbps;
+                ret = measure_rect_throughput((RectCommand)command,
+                                              (RegionShape)shape, packed != 0,
+                                              &device_gbps, &wall_gbps);
+                if (ret) break;
+                log_info("%-6s %-8s %-7s %12.3f %12.3f\n",
+                         rect_command_names[command], region_shape_names[shape],
+                         packed ? "packed" : "buffer", device_gbps, wall_gbps);
+                log_perf(device_gbps, true, "GB/s", "%s rect, %s, %s pitch",
+                         rect_command_names[command], region_shape_names[shape],
+                         packed ? "packed" : "buffer");
+            }
+        }
+    }
+
+    free_mtdata(mt);
+    buffer = nullptr;
+
+    return ret;
+}
+
 } // end anonymous namespace
 
 // This is the main test function for the conformance test.
@@ -732,3 +1030,8 @@ REGISTER_TEST(immutable_bufferreadwriterect)
         device, context, queue, num_elements,
         CL_MEM_USE_HOST_PTR | CL_MEM_IMMUTABLE_EXT, test_functions);
 }
+
+REGISTER_TEST(bufferreadwriterect_throughput)
+{
+    return test_bufferreadwriterect_throughput_impl(device, context);
+}
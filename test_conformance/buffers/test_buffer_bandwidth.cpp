@@ -0,0 +1,442 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "harness/compat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "testBase.h"
+#include "harness/alloc.h"
+#include "harness/csvHelpers.h"
+#include "harness/deviceInfo.h"
+#include "harness/errorHelpers.h"
+#include "harness/parseParameters.h"
+
+// Transfer bandwidth sweep over sizes from BANDWIDTH_MIN_SIZE up to the
+// largest buffer the device allows, for device, ALLOC_HOST_PTR and
+// USE_HOST_PTR buffers, several host pointer alignments and blocking and
+// non-blocking variants. Every point is timed by wall clock and by the sum of
+// the profiled command durations. Results are logged as a table and, if
+// CL_BUFFER_BANDWIDTH_CSV names a file, appended to it as CSV. The full sweep
+// only runs with --benchmark; otherwise sizes stop at
+// BANDWIDTH_SMOKE_MAX_SIZE with the minimum number of repetitions.
+
+#define BANDWIDTH_MIN_SIZE 4096
+#define BANDWIDTH_SIZE_STEP 4
+#define BANDWIDTH_BYTES_PER_POINT (256 * 1024 * 1024)
+#define BANDWIDTH_MIN_REPS 3
+#define BANDWIDTH_MAX_REPS 64
+#define BANDWIDTH_SMOKE_MAX_SIZE (1024 * 1024)
+#define BANDWIDTH_VERIFY_CHUNK (4 * 1024 * 1024)
+#define BANDWIDTH_PAGE_SIZE 4096
+#define BANDWIDTH_PATTERN 0x5A5A0F0FU
+
+namespace {
+
+enum BandwidthAPI
+{
+    API_READ,
+    API_WRITE,
+    API_COPY,
+    API_FILL,
+    API_MAP_READ,
+    API_MAP_WRITE,
+};
+
+const char *api_names[] = { "read", "write", "copy",
+                            "fill", "map_read", "map_write" };
+
+const cl_mem_flags bandwidth_flags[] = { 0, CL_MEM_ALLOC_HOST_PTR,
+                                         CL_MEM_USE_HOST_PTR };
+const char *bandwidth_flag_names[] = { "device", "alloc_host_ptr",
+                                       "use_host_ptr" };
+
+// Offsets from a page aligned host allocation
+const size_t host_offsets[] = { 0, 64, 4 };
+
+struct BandwidthPoint
+{
+    size_t size;
+    cl_uint reps;
+    double wall_seconds;
+    double device_seconds;
+};
+
+bool uses_host_pointer(BandwidthAPI api)
+{
+    return api == API_READ || api == API_WRITE;
+}
+
+bool has_blocking_variant(BandwidthAPI api)
+{
+    return api != API_COPY && api != API_FILL;
+}
+
+void write_csv(BandwidthAPI api, const char *flags, size_t offset,
+               bool blocking, const BandwidthPoint &point)
+{
+    FILE *file = open_results_csv("CL_BUFFER_BANDWIDTH_CSV",
+                                  "api,flags,host_offset,blocking,bytes,"
+                                  "repetitions,wall_gbps,device_gbps");
+    if (file == NULL) return;
+
+    double bytes = (double)point.size * point.reps;
+    fprintf(file, "%s,%s,%zu,%d,%zu,%u,%.3f,%.3f\n", api_names[api], flags,
+            offset, blocking ? 1 : 0, point.size, point.reps,
+            bytes / point.wall_seconds * 1e-9,
+            point.device_seconds > 0.0 ? bytes / point.device_seconds * 1e-9
+                                       : 0.0);
+    fclose(file);
+}
+
+cl_int enqueue_transfer(cl_command_queue queue, BandwidthAPI api, cl_mem buffer,
+                        cl_mem other, void *host, size_t size, bool blocking,
+                        cl_event *event)
+{
+    cl_int error = CL_SUCCESS;
+    const cl_uint pattern = BANDWIDTH_PATTERN;
+    cl_bool block = blocking ? CL_TRUE : CL_FALSE;
+    void *mapped;
+
+    switch (api)
+    {
+        case API_READ:
+            return clEnqueueReadBuffer(queue, buffer, block, 0, size, host, 0,
+                                       NULL, event);
+        case API_WRITE:
+            return clEnqueueWriteBuffer(queue, buffer, block, 0, size, host, 0,
+                                        NULL, event);
+        case API_COPY:
+            return clEnqueueCopyBuffer(queue, other, buffer, 0, 0, size, 0,
+                                       NULL, event);
+        case API_FILL:
+            return clEnqueueFillBuffer(queue, buffer, &pattern,
+                                       sizeof(pattern), 0, size, 0, NULL,
+                                       event);
+        case API_MAP_READ:
+        case API_MAP_WRITE:
+            mapped = clEnqueueMapBuffer(
+                queue, buffer, block,
+                api == API_MAP_READ ? CL_MAP_READ
+                                    : CL_MAP_WRITE_INVALIDATE_REGION,
+                0, size, 0, NULL, event, &error);
+            if (error != CL_SUCCESS) return error;
+            return clEnqueueUnmapMemObject(queue, buffer, mapped, 0, NULL,
+                                           NULL);
+    }
+    return CL_INVALID_VALUE;
+}
+
+// Reads and maps for reading transfer the expected data out of the buffer,
+// and copies transfer it from the other buffer. The buffer starts out zeroed
+// for every other transfer, so that verification shows it was written.
+cl_int initialize_buffers(cl_command_queue queue, BandwidthAPI api,
+                          cl_mem buffer, cl_mem other, size_t size)
+{
+    const cl_uint pattern = BANDWIDTH_PATTERN;
+    const cl_uint zero = 0;
+    bool source = api == API_READ || api == API_MAP_READ;
+    cl_int error =
+        clEnqueueFillBuffer(queue, buffer, source ? &pattern : &zero,
+                            sizeof(cl_uint), 0, size, 0, NULL, NULL);
+    if (error == CL_SUCCESS && api == API_COPY)
+        error = clEnqueueFillBuffer(queue, other, &pattern, sizeof(pattern), 0,
+                                    size, 0, NULL, NULL);
+    return error;
+}
+
+int check_words(BandwidthAPI api, size_t size, size_t first,
+                const cl_uint *words, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (words[i] != BANDWIDTH_PATTERN)
+        {
+            log_error("ERROR: %s of %zu bytes produced 0x%08x at word %zu, "
+                      "expected 0x%08x\n",
+                      api_names[api], size, words[i], first + i,
+                      BANDWIDTH_PATTERN);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Checks every word of the result of the last transfer. The buffer is read
+// back, or mapped for the map variants, BANDWIDTH_VERIFY_CHUNK bytes at a
+// time.
+int verify_transfer(cl_command_queue queue, BandwidthAPI api, cl_mem buffer,
+                    const cl_uint *host, size_t size)
+{
+    cl_int error;
+
+    if (api == API_READ)
+        return check_words(api, size, 0, host, size / sizeof(cl_uint));
+
+    if (api == API_MAP_WRITE)
+    {
+        // The timed maps only invalidate the region, so check that data
+        // written through a mapped pointer reaches the buffer
+        cl_uint *mapped = (cl_uint *)clEnqueueMapBuffer(
+            queue, buffer, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, size, 0,
+            NULL, NULL, &error);
+        test_error(error, "Unable to map buffer for writing");
+        std::fill(mapped, mapped + size / sizeof(cl_uint),
+                  (cl_uint)BANDWIDTH_PATTERN);
+        error = clEnqueueUnmapMemObject(queue, buffer, mapped, 0, NULL, NULL);
+        test_error(error, "Unable to unmap buffer");
+    }
+
+    std::vector<cl_uint> words;
+    if (api != API_MAP_READ)
+        words.resize(std::min<size_t>(size, BANDWIDTH_VERIFY_CHUNK)
+                     / sizeof(cl_uint));
+    for (size_t offset = 0; offset < size; offset += BANDWIDTH_VERIFY_CHUNK)
+    {
+        size_t chunk = std::min<size_t>(size - offset, BANDWIDTH_VERIFY_CHUNK);
+        const cl_uint *result = words.data();
+        if (api == API_MAP_READ)
+        {
+            result = (const cl_uint *)clEnqueueMapBuffer(
+                queue, buffer, CL_TRUE, CL_MAP_READ, offset, chunk, 0, NULL,
+                NULL, &error);
+            test_error(error, "Unable to map buffer for reading");
+        }
+        else
+        {
+            error = clEnqueueReadBuffer(queue, buffer, CL_TRUE, offset, chunk,
+                                        words.data(), 0, NULL, NULL);
+            test_error(error, "Unable to read back transfer result");
+        }
+
+        int mismatch = check_words(api, size, offset / sizeof(cl_uint), result,
+                                   chunk / sizeof(cl_uint));
+        if (api == API_MAP_READ)
+        {
+            error = clEnqueueUnmapMemObject(queue, buffer, (void *)result, 0,
+                                            NULL, NULL);
+            test_error(error, "Unable to unmap buffer");
+        }
+        if (mismatch) return -1;
+    }
+    return 0;
+}
+
+int measure_point(cl_command_queue queue, BandwidthAPI api, cl_mem buffer,
+                  cl_mem other, void *host, bool blocking,
+                  BandwidthPoint *point)
+{
+    cl_int error;
+    std::vector<clEventWrapper> events(point->reps);
+
+    auto start = std::chrono::steady_clock::now();
+    for (cl_uint r = 0; r < point->reps; r++)
+    {
+        cl_event event;
+        error = enqueue_transfer(queue, api, buffer, other, host, point->size,
+                                 blocking, &event);
+        test_error(error, "Unable to enqueue transfer");
+        events[r] = event;
+    }
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+    point->wall_seconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+    point->device_seconds = 0.0;
+    for (cl_uint r = 0; r < point->reps; r++)
+    {
+        cl_ulong begin, end;
+        error = clGetEventProfilingInfo(events[r], CL_PROFILING_COMMAND_START,
+                                        sizeof(begin), &begin, NULL);
+        test_error(error, "Unable to get command start time");
+        error = clGetEventProfilingInfo(events[r], CL_PROFILING_COMMAND_END,
+                                        sizeof(end), &end, NULL);
+        test_error(error, "Unable to get command end time");
+        point->device_seconds += (double)(end - begin) * 1e-9;
+    }
+    return 0;
+}
+
+int sweep_sizes(cl_command_queue queue, BandwidthAPI api, int flag_index,
+                size_t offset, bool blocking, cl_mem buffer, cl_mem other,
+                cl_uint *host, size_t max_size, bool full_sweep)
+{
+    BandwidthPoint point = {};
+    for (size_t size = BANDWIDTH_MIN_SIZE; size <= max_size;)
+    {
+        point.size = size;
+        point.reps = (cl_uint)std::min<size_t>(
+            std::max<size_t>(BANDWIDTH_BYTES_PER_POINT / size,
+                             BANDWIDTH_MIN_REPS),
+            BANDWIDTH_MAX_REPS);
+        if (!full_sweep) point.reps = BANDWIDTH_MIN_REPS;
+
+        if (api == API_READ) memset(host, 0, size);
+        if (measure_point(queue, api, buffer, other, host, blocking, &point))
+            return -1;
+
+        double bytes = (double)point.size * point.reps;
+        log_info("\t%-9s %-14s %4zu %-12s %11zu %3u %9.3f %9.3f\n",
+                 api_names[api], bandwidth_flag_names[flag_index], offset,
+                 blocking ? "blocking" : "non-blocking", point.size,
+                 point.reps, bytes / point.wall_seconds * 1e-9,
+                 point.device_seconds > 0.0
+                     ? bytes / point.device_seconds * 1e-9
+                     : 0.0);
+        write_csv(api, bandwidth_flag_names[flag_index], offset, blocking,
+                  point);
+
+        if (size == max_size) break;
+        size = std::min(size * BANDWIDTH_SIZE_STEP, max_size);
+    }
+
+    if (verify_transfer(queue, api, buffer, host, point.size)) return -1;
+
+    if (offset == 0)
+        log_perf(point.size * point.reps / point.wall_seconds * 1e-9, true,
+                 "GB/s", "%s %s %s %zu bytes", api_names[api],
+                 bandwidth_flag_names[flag_index],
+                 blocking ? "blocking" : "non-blocking", point.size);
+    return 0;
+}
+
+int test_bandwidth(cl_device_id device, cl_context context, BandwidthAPI api)
+{
+    cl_int error;
+
+    size_t max_size = (size_t)std::min(
+        get_device_info_max_mem_alloc_size(device),
+        get_device_info_global_mem_size(device, 4));
+    max_size &= ~(size_t)(BANDWIDTH_PAGE_SIZE - 1);
+    if (max_size < BANDWIDTH_MIN_SIZE)
+    {
+        log_error("ERROR: Device allows allocations of only %zu bytes\n",
+                  max_size);
+        return -1;
+    }
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    if (!full_sweep)
+        max_size = std::min<size_t>(max_size, BANDWIDTH_SMOKE_MAX_SIZE);
+
+    clCommandQueueWrapper queue = clCreateCommandQueue(
+        context, device, CL_QUEUE_PROFILING_ENABLE, &error);
+    test_error(error, "Unable to create profiling command queue");
+
+    const size_t alloc_size = max_size + BANDWIDTH_PAGE_SIZE;
+    BufferOwningPtr<char> host_memory;
+    BufferOwningPtr<char> backing_memory;
+    BufferOwningPtr<char> other_backing_memory;
+    host_memory.reset(align_malloc(alloc_size, BANDWIDTH_PAGE_SIZE), NULL, 0,
+                      alloc_size, true);
+    backing_memory.reset(align_malloc(alloc_size, BANDWIDTH_PAGE_SIZE), NULL,
+                         0, alloc_size, true);
+    if (api == API_COPY)
+        other_backing_memory.reset(
+            align_malloc(alloc_size, BANDWIDTH_PAGE_SIZE), NULL, 0, alloc_size,
+            true);
+    if (!host_memory || !backing_memory
+        || (api == API_COPY && !other_backing_memory))
+    {
+        log_error("ERROR: Unable to allocate %zu bytes of host memory\n",
+                  alloc_size);
+        return -1;
+    }
+
+    log_info("\t%-9s %-14s %4s %-12s %11s %3s %9s %9s\n", "api", "flags",
+             "off", "mode", "bytes", "n", "wall GB/s", "dev GB/s");
+
+    for (int f = 0; f < (int)ARRAY_SIZE(bandwidth_flags); f++)
+    {
+        bool use_host_ptr = bandwidth_flags[f] & CL_MEM_USE_HOST_PTR;
+        for (size_t offset : host_offsets)
+        {
+            // The alignment only matters where a host pointer is involved
+            if (offset != 0 && !use_host_ptr && !uses_host_pointer(api))
+                continue;
+
+            cl_uint *host = (cl_uint *)((char *)host_memory + offset);
+            char *backing = (char *)backing_memory + offset;
+            char *other_backing = (char *)other_backing_memory + offset;
+
+            for (size_t i = 0; i < max_size / sizeof(cl_uint); i++)
+                host[i] = BANDWIDTH_PATTERN;
+
+            clMemWrapper buffer =
+                clCreateBuffer(context, bandwidth_flags[f] | CL_MEM_READ_WRITE,
+                               max_size, use_host_ptr ? backing : NULL, &error);
+            test_error(error, "Unable to create buffer");
+
+            clMemWrapper other;
+            if (api == API_COPY)
+            {
+                other = clCreateBuffer(
+                    context, bandwidth_flags[f] | CL_MEM_READ_WRITE, max_size,
+                    use_host_ptr ? other_backing : NULL, &error);
+                test_error(error, "Unable to create source buffer");
+            }
+
+            for (int b = 0; b < 2; b++)
+            {
+                bool blocking = b == 1;
+                if (blocking && !has_blocking_variant(api)) continue;
+                error =
+                    initialize_buffers(queue, api, buffer, other, max_size);
+                test_error(error, "Unable to initialize buffer");
+                if (sweep_sizes(queue, api, f, offset, blocking, buffer, other,
+                                host, max_size, full_sweep))
+                    return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+REGISTER_TEST(buffer_bandwidth_read)
+{
+    return test_bandwidth(device, context, API_READ);
+}
+
+REGISTER_TEST(buffer_bandwidth_write)
+{
+    return test_bandwidth(device, context, API_WRITE);
+}
+
+REGISTER_TEST(buffer_bandwidth_copy)
+{
+    return test_bandwidth(device, context, API_COPY);
+}
+
+REGISTER_TEST(buffer_bandwidth_fill)
+{
+    return test_bandwidth(device, context, API_FILL);
+}
+
+REGISTER_TEST(buffer_bandwidth_map)
+{
+    int result = test_bandwidth(device, context, API_MAP_READ);
+    if (result == 0) result = test_bandwidth(device, context, API_MAP_WRITE);
+    return result;
+}
@@ -35,6 +35,32 @@ static void initVecSizes() {
     }
 }
 
+int create_vector_size_kernels(cl_context context, cl_program *outProgram,
+                               std::vector<clKernelWrapper> &kernels,
+                               const std::vector<std::string> &sources,
+                               const std::vector<std::string> &kernelNames)
+{
+    std::vector<const char *> lines;
+    for (const std::string &source : sources) lines.push_back(source.c_str());
+
+    kernels.clear();
+    kernels.resize(kernelNames.size());
+
+    int error = create_single_kernel_helper(
+        context, outProgram, &kernels[0], (unsigned int)lines.size(),
+        lines.data(), kernelNames[0].c_str());
+    test_error(error, "Unable to create program");
+
+    for (size_t i = 1; i < kernelNames.size(); i++)
+    {
+        kernels[i] =
+            clCreateKernel(*outProgram, kernelNames[i].c_str(), &error);
+        test_error(error, "Unable to create kernel");
+    }
+
+    return CL_SUCCESS;
+}
+
 test_status InitCL(cl_device_id device)
 {
     if (is_extension_available(device, "cl_khr_fp16"))
@@ -209,6 +209,14 @@ template <typename T> float UlpFn(const T &val, const double &r)
     return -1.f; // wrong val
 }
 
+// Builds the per vector size kernel sources as a single program and creates
+// kernels[i] from it by the name kernelNames[i], so that all vector sizes of a
+// function share one build.
+int create_vector_size_kernels(cl_context context, cl_program *outProgram,
+                               std::vector<clKernelWrapper> &kernels,
+                               const std::vector<std::string> &sources,
+                               const std::vector<std::string> &kernelNames);
+
 template <class T>
 int MakeAndRunTest(cl_device_id device, cl_context context,
                    cl_command_queue queue, int num_elements,
@@ -28,7 +28,7 @@
 
 const char *binary_fn_code_pattern =
 "%s\n" /* optional pragma */
-"__kernel void test_fn(__global %s%s *x, __global %s%s *y, __global %s%s *dst)\n"
+"__kernel void test_fn%s(__global %s%s *x, __global %s%s *y, __global %s%s *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -37,7 +37,7 @@ const char *binary_fn_code_pattern =
 
 const char *binary_fn_code_pattern_v3 =
 "%s\n" /* optional pragma */
-"__kernel void test_fn(__global %s *x, __global %s *y, __global %s *dst)\n"
+"__kernel void test_fn%s(__global %s *x, __global %s *y, __global %s *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -46,7 +46,7 @@ const char *binary_fn_code_pattern_v3 =
 
 const char *binary_fn_code_pattern_v3_scalar =
 "%s\n" /* optional pragma */
-"__kernel void test_fn(__global %s *x, __global %s *y, __global %s *dst)\n"
+"__kernel void test_fn%s(__global %s *x, __global %s *y, __global %s *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -62,7 +62,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
     clMemWrapper streams[3];
     std::vector<T> input_ptr[2], output_ptr;
 
-    std::vector<clProgramWrapper> programs;
+    clProgramWrapper program;
     std::vector<clKernelWrapper> kernels;
     int err, i, j;
     MTdataHolder d = MTdataHolder(gRandomSeed);
@@ -71,9 +71,6 @@ int test_binary_fn(cl_device_id device, cl_context context,
            != BaseFunctionTest::type2name.end());
     auto tname = BaseFunctionTest::type2name[sizeof(T)];
 
-    programs.resize(kTotalVecCount);
-    kernels.resize(kTotalVecCount);
-
     int num_elements = n_elems * (1 << (kTotalVecCount - 1));
 
     for (i = 0; i < 2; i++) input_ptr[i].resize(num_elements);
@@ -125,40 +122,46 @@ int test_binary_fn(cl_device_id device, cl_context context,
 
     char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
 
+    // All vector sizes are built as a single program with one kernel each.
+    std::vector<std::string> kernelSources(kTotalVecCount);
+    std::vector<std::string> kernelNames(kTotalVecCount);
     for (i = 0; i < kTotalVecCount; i++)
     {
-        std::string kernelSource;
+        kernelNames[i] = std::string("test_fn") + vecSizeNames[i];
         if (i >= kVectorSizeCount)
         {
             if (vecSecParam)
             {
                 std::string str = binary_fn_code_pattern_v3;
-                kernelSource =
-                    str_sprintf(str, pragma_str.c_str(), tname.c_str(),
-                                tname.c_str(), tname.c_str(), fnName.c_str());
+                kernelSources[i] = str_sprintf(
+                    str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                    tname.c_str(), tname.c_str(), fnName.c_str());
             }
             else
             {
                 std::string str = binary_fn_code_pattern_v3_scalar;
-                kernelSource =
-                    str_sprintf(str, pragma_str.c_str(), tname.c_str(),
-                                tname.c_str(), tname.c_str(), fnName.c_str());
+                kernelSources[i] = str_sprintf(
+                    str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                    tname.c_str(), tname.c_str(), fnName.c_str());
             }
         }
         else
         {
             // do regular
             std::string str = binary_fn_code_pattern;
-            kernelSource = str_sprintf(
-                str, pragma_str.c_str(), tname.c_str(), vecSizeNames[i],
-                tname.c_str(), vecSecParam ? vecSizeNames[i] : "",
-                tname.c_str(), vecSizeNames[i], fnName.c_str());
+            kernelSources[i] = str_sprintf(
+                str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                vecSizeNames[i], tname.c_str(),
+                vecSecParam ? vecSizeNames[i] : "", tname.c_str(),
+                vecSizeNames[i], fnName.c_str());
         }
-        const char* programPtr = kernelSource.c_str();
-        err = create_single_kernel_helper(context, &programs[i], &kernels[i], 1,
-                                          (const char**)&programPtr, "test_fn");
-        test_error(err, "Unable to create kernel");
+    }
+    err = create_vector_size_kernels(context, &program, kernels, kernelSources,
+                                     kernelNames);
+    test_error(err, "Unable to create kernels");
 
+    for (i = 0; i < kTotalVecCount; i++)
+    {
         for( j = 0; j < 3; j++ )
         {
             err =
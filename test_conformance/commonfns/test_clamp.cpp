@@ -41,7 +41,7 @@
 
 #define CLAMP_KERNEL_V(type, size)                                             \
     const char *clamp_##type##size##_kernel_code = EMIT_PRAGMA_DIRECTIVE       \
-        "__kernel void test_clamp(__global " #type #size                       \
+        "__kernel void test_clamp" #size "(__global " #type #size              \
         " *x, __global " #type #size " *minval, __global " #type #size         \
         " *maxval, __global " #type #size " *dst)\n"                           \
         "{\n"                                                                  \
@@ -52,8 +52,9 @@
 
 #define CLAMP_KERNEL_V3(type, size)                                            \
     const char *clamp_##type##size##_kernel_code = EMIT_PRAGMA_DIRECTIVE       \
-        "__kernel void test_clamp(__global " #type " *x, __global " #type      \
-        " *minval, __global " #type " *maxval, __global " #type " *dst)\n"     \
+        "__kernel void test_clamp" #size "(__global " #type                    \
+        " *x, __global " #type " *minval, __global " #type                     \
+        " *maxval, __global " #type " *dst)\n"                                 \
         "{\n"                                                                  \
         "    int  tid = get_global_id(0);\n"                                   \
         "\n"                                                                   \
@@ -64,7 +65,7 @@
 #define CLAMP_KERNEL_V_SCALAR(type, size)                                      \
     const char *clamp_##type##size##_scalar_kernel_code =                      \
         EMIT_PRAGMA_DIRECTIVE                                                  \
-        "__kernel void test_clamp(__global " #type #size                       \
+        "__kernel void test_clamp" #size "(__global " #type #size              \
         " *x, __global " #type " *minval, __global " #type                     \
         " *maxval, __global " #type #size " *dst)\n"                           \
         "{\n"                                                                  \
@@ -76,8 +77,9 @@
 #define CLAMP_KERNEL_V3_SCALAR(type, size)                                     \
     const char *clamp_##type##size##_scalar_kernel_code =                      \
         EMIT_PRAGMA_DIRECTIVE                                                  \
-        "__kernel void test_clamp(__global " #type " *x, __global " #type      \
-        " *minval, __global " #type " *maxval, __global " #type " *dst)\n"     \
+        "__kernel void test_clamp" #size "(__global " #type                    \
+        " *x, __global " #type " *minval, __global " #type                     \
+        " *maxval, __global " #type " *dst)\n"                                 \
         "{\n"                                                                  \
         "    size_t tid = get_global_id(0);\n"                                 \
         "\n"                                                                   \
@@ -215,7 +217,7 @@ int test_clamp_fn(cl_device_id device, cl_context context,
     clMemWrapper streams[4];
     std::vector<T> input_ptr[3], output_ptr;
 
-    std::vector<clProgramWrapper> programs;
+    clProgramWrapper program;
     std::vector<clKernelWrapper> kernels;
 
     int err, i, j;
@@ -225,9 +227,6 @@ int test_clamp_fn(cl_device_id device, cl_context context,
            != BaseFunctionTest::type2name.end());
     auto tname = BaseFunctionTest::type2name[sizeof(T)];
 
-    programs.resize(kTotalVecCount);
-    kernels.resize(kTotalVecCount);
-
     int num_elements = n_elems * (1 << (kVectorSizeCount - 1));
 
     for (i = 0; i < 3; i++) input_ptr[i].resize(num_elements);
@@ -282,54 +281,47 @@ int test_clamp_fn(cl_device_id device, cl_context context,
     // clamp(gentype, gentype, gentype), which is already covered by clamp.
     // So skip the all-scalar overload for clamp_scalar_bounds.
     const int firstVecIndex = hasScalarBounds ? 1 : 0;
+
+    // All vector sizes are built as a single program with one kernel each.
+    const char **codes = nullptr;
+    if (std::is_same<T, float>::value)
+        codes = hasScalarBounds ? clamp_float_scalar_codes : clamp_float_codes;
+    else if (std::is_same<T, double>::value)
+        codes =
+            hasScalarBounds ? clamp_double_scalar_codes : clamp_double_codes;
+    else if (std::is_same<T, half>::value)
+        codes = hasScalarBounds ? clamp_half_scalar_codes : clamp_half_codes;
+
+    std::vector<std::string> kernelSources;
+    std::vector<std::string> kernelNames;
+    for (i = firstVecIndex; i < kTotalVecCount; i++)
+    {
+        kernelSources.push_back(codes[i]);
+        kernelNames.push_back(
+            g_arrVecSizes[i] == 1
+                ? std::string("test_clamp")
+                : "test_clamp" + std::to_string(g_arrVecSizes[i]));
+    }
+    err = create_vector_size_kernels(context, &program, kernels, kernelSources,
+                                     kernelNames);
+    test_error(err, "Unable to create kernels");
+
     for (i = firstVecIndex; i < kTotalVecCount; i++)
     {
         std::string gentype = tname;
         if (g_arrVecSizes[i] != 1) gentype += std::to_string(g_arrVecSizes[i]);
         const std::string &boundType = hasScalarBounds ? tname : gentype;
-
-        if (std::is_same<T, float>::value)
-        {
-            err = create_single_kernel_helper(
-                context, &programs[i], &kernels[i], 1,
-                hasScalarBounds ? &clamp_float_scalar_codes[i]
-                                : &clamp_float_codes[i],
-                "test_clamp");
-            test_error(err, "Unable to create kernel");
-        }
-        else if (std::is_same<T, double>::value)
-        {
-            err = create_single_kernel_helper(
-                context, &programs[i], &kernels[i], 1,
-                hasScalarBounds ? &clamp_double_scalar_codes[i]
-                                : &clamp_double_codes[i],
-                "test_clamp");
-            test_error(err, "Unable to create kernel");
-        }
-        else if (std::is_same<T, half>::value)
-        {
-            err = create_single_kernel_helper(
-                context, &programs[i], &kernels[i], 1,
-                hasScalarBounds ? &clamp_half_scalar_codes[i]
-                                : &clamp_half_codes[i],
-                "test_clamp");
-            test_error(err, "Unable to create kernel");
-        }
-
-        log_info("Just made a program for clamp(%s, %s, %s), in slot %d\n",
-                 gentype.c_str(), boundType.c_str(), boundType.c_str(), i);
-        fflush(stdout);
+        cl_kernel kernel = kernels[i - firstVecIndex];
 
         for (j = 0; j < 4; j++)
         {
-            err =
-                clSetKernelArg(kernels[i], j, sizeof(streams[j]), &streams[j]);
+            err = clSetKernelArg(kernel, j, sizeof(streams[j]), &streams[j]);
             test_error(err, "Unable to set kernel argument");
         }
 
         size_t threads = (size_t)n_elems;
 
-        err = clEnqueueNDRangeKernel(queue, kernels[i], 1, NULL, &threads, NULL,
+        err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &threads, NULL,
                                      0, NULL, NULL);
         test_error(err, "Unable to execute kernel");
 
@@ -25,7 +25,7 @@
 
 const char *mix_fn_code_pattern =
     "%s\n" /* optional pragma */
-    "__kernel void test_fn(__global %s%s *x, __global %s%s *y, __global %s%s "
+    "__kernel void test_fn%s(__global %s%s *x, __global %s%s *y, __global %s%s "
     "*a, __global %s%s *dst)\n"
     "{\n"
     "    int  tid = get_global_id(0);\n"
@@ -34,7 +34,7 @@ const char *mix_fn_code_pattern =
 
 const char *mix_fn_code_pattern_v3 =
     "%s\n" /* optional pragma */
-    "__kernel void test_fn(__global %s *x, __global %s *y, __global %s *a, "
+    "__kernel void test_fn%s(__global %s *x, __global %s *y, __global %s *a, "
     "__global %s *dst)\n"
     "{\n"
     "    int  tid = get_global_id(0);\n"
@@ -45,7 +45,7 @@ const char *mix_fn_code_pattern_v3 =
 
 const char *mix_fn_code_pattern_v3_scalar =
     "%s\n" /* optional pragma */
-    "__kernel void test_fn(__global %s *x, __global %s *y, __global %s *a, "
+    "__kernel void test_fn%s(__global %s *x, __global %s *y, __global %s *a, "
     "__global %s *dst)\n"
     "{\n"
     "    int  tid = get_global_id(0);\n"
@@ -144,7 +144,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     clMemWrapper streams[4];
     std::vector<T> input_ptr[3], output_ptr;
 
-    std::vector<clProgramWrapper> programs;
+    clProgramWrapper program;
     std::vector<clKernelWrapper> kernels;
 
     int err, i;
@@ -154,9 +154,6 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
            != BaseFunctionTest::type2name.end());
     auto tname = BaseFunctionTest::type2name[sizeof(T)];
 
-    programs.resize(kTotalVecCount);
-    kernels.resize(kTotalVecCount);
-
     int num_elements = n_elems * (1 << (kTotalVecCount - 1));
 
 
@@ -205,42 +202,47 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     }
 
     char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
+
+    // All vector sizes are built as a single program with one kernel each.
+    std::vector<std::string> kernelSources(kTotalVecCount);
+    std::vector<std::string> kernelNames(kTotalVecCount);
     for (i = 0; i < kTotalVecCount; i++)
     {
-        std::string kernelSource;
+        kernelNames[i] = std::string("test_fn") + vecSizeNames[i];
         if (i >= kVectorSizeCount)
         {
             if (vecParam)
             {
                 std::string str = mix_fn_code_pattern_v3;
-                kernelSource =
-                    str_sprintf(str, pragma_str.c_str(), tname.c_str(),
-                                tname.c_str(), tname.c_str(), tname.c_str());
+                kernelSources[i] = str_sprintf(
+                    str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                    tname.c_str(), tname.c_str(), tname.c_str());
             }
             else
             {
                 std::string str = mix_fn_code_pattern_v3_scalar;
-                kernelSource =
-                    str_sprintf(str, pragma_str.c_str(), tname.c_str(),
-                                tname.c_str(), tname.c_str(), tname.c_str());
+                kernelSources[i] = str_sprintf(
+                    str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                    tname.c_str(), tname.c_str(), tname.c_str());
             }
         }
         else
         {
             // regular path
             std::string str = mix_fn_code_pattern;
-            kernelSource =
-                str_sprintf(str, pragma_str.c_str(), tname.c_str(),
-                            vecSizeNames[i], tname.c_str(), vecSizeNames[i],
-                            tname.c_str(), vecParam ? vecSizeNames[i] : "",
-                            tname.c_str(), vecSizeNames[i]);
+            kernelSources[i] = str_sprintf(
+                str, pragma_str.c_str(), vecSizeNames[i], tname.c_str(),
+                vecSizeNames[i], tname.c_str(), vecSizeNames[i], tname.c_str(),
+                vecParam ? vecSizeNames[i] : "", tname.c_str(),
+                vecSizeNames[i]);
         }
-        const char *programPtr = kernelSource.c_str();
-        err =
-            create_single_kernel_helper(context, &programs[i], &kernels[i], 1,
-                                        (const char **)&programPtr, "test_fn");
-        test_error(err, "Unable to create kernel");
+    }
+    err = create_vector_size_kernels(context, &program, kernels, kernelSources,
+                                     kernelNames);
+    test_error(err, "Unable to create kernels");
 
+    for (i = 0; i < kTotalVecCount; i++)
+    {
         for (int j = 0; j < 4; j++)
         {
             err =
@@ -44,5 +44,17 @@
         }                                                                      \
     }
 
+// Program generators from test_compile.cpp, also used by the compiler
+// scalability benchmark
+extern const char *sample_kernel_start;
+extern const char *sample_kernel_end;
+extern const char *sample_kernel_lines[5];
+extern const char *simple_kernel_template;
+extern const char *composite_kernel_start;
+extern const char *composite_kernel_end;
+extern const char *composite_kernel_template;
+extern const char *composite_kernel_extern_template;
+extern const char *header_name_templates[4];
+extern const char *include_header_name_templates[4];
 
 #endif // _testBase_h
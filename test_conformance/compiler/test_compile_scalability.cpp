@@ -0,0 +1,509 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "harness/csvHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Benchmark of how the time spent in clCompileProgram, clLinkProgram and
+// clBuildProgram grows with the number of lines in a program and with the
+// number of files, libraries and embedded headers it is made of, using the
+// program generators of the large_compile, multi_file_libraries,
+// multiple_libraries and multiple_embedded_headers tests. Each size is
+// measured several times and the median is reported. A line is prepended to
+// every program to make it unique, so that compiler caches do not make
+// repetitions or runs incomparable. When a program is made of several files,
+// clCompileProgram is the compile of the composite kernel, and the mean
+// compile of the other files is reported as clCompileProgram/file.
+//
+// The growth exponent of each operation is fitted over the larger half of
+// its sweep, where fixed costs no longer dominate, and flagged if it is
+// super-linear. Setting CL_COMPILER_SCALABILITY_SCALE to N extends every
+// sweep to N times its default largest size, and results are appended to the
+// file named by CL_COMPILER_SCALABILITY_CSV if it is set.
+//
+// The sweeps and the fit only run with --benchmark. Otherwise the three
+// smallest sizes of every sweep are measured once, which checks that the
+// programs build but is too small for the exponents to mean anything.
+
+namespace {
+
+const unsigned int scalability_reps = 3;
+const double superlinear_exponent = 1.25;
+
+struct Sweep
+{
+    const char *name;
+    unsigned int first;
+    unsigned int last;
+};
+
+const Sweep program_size_sweep = { "lines", 64, 4096 };
+const Sweep file_count_sweep = { "files", 2, 256 };
+const Sweep library_count_sweep = { "libraries", 2, 64 };
+const Sweep header_count_sweep = { "headers", 2, 256 };
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+std::string format_line(const char *format, unsigned int i)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), format, i);
+    return buffer;
+}
+
+// Seconds spent in each API call for one measurement
+using OperationTimes = std::map<std::string, double>;
+
+class ScalabilityBenchmark {
+public:
+    ScalabilityBenchmark(cl_device_id device, cl_context context)
+        : device(device), context(context), d(gRandomSeed)
+    {}
+
+    cl_int Run(const Sweep &sweep, unsigned int last, unsigned int reps);
+
+    // Fits and logs the growth of every operation measured, and returns the
+    // number that grow super-linearly
+    int Report();
+
+private:
+    cl_int Measure(const Sweep &sweep, unsigned int size,
+                   OperationTimes &times);
+    cl_int MeasureProgramSize(unsigned int lines, OperationTimes &times);
+    cl_int MeasureFileCount(unsigned int files, OperationTimes &times);
+    cl_int MeasureLibraryCount(unsigned int libraries, OperationTimes &times);
+    cl_int MeasureHeaderCount(unsigned int headers, OperationTimes &times);
+
+    cl_int CreateProgram(const std::vector<std::string> &lines,
+                         clProgramWrapper &program);
+    // Compiles program and stores the time taken in seconds
+    cl_int Compile(cl_program program, double &seconds,
+                   cl_uint num_headers = 0, const cl_program *headers = nullptr,
+                   const char **header_names = nullptr);
+    cl_int CheckCompositeKernel(cl_program program);
+
+    // Lines of a composite kernel calling count CopyBuffer kernels, preceded
+    // by one line per kernel that declares or includes it
+    std::vector<std::string>
+    CompositeLines(unsigned int count, const char *const *declarations,
+                   size_t declaration_templates);
+
+    std::string UniqueLine();
+
+    cl_device_id device;
+    cl_context context;
+    MTdataHolder d;
+
+    struct Series
+    {
+        const char *sweep;
+        std::vector<double> sizes;
+        std::vector<double> seconds;
+    };
+    std::map<std::string, Series> series;
+};
+
+std::string ScalabilityBenchmark::UniqueLine()
+{
+    return format_line("// %u\n", genrand_int32(d));
+}
+
+cl_int
+ScalabilityBenchmark::CreateProgram(const std::vector<std::string> &lines,
+                                    clProgramWrapper &program)
+{
+    std::vector<const char *> strings;
+    strings.reserve(lines.size());
+    for (const std::string &line : lines) strings.push_back(line.c_str());
+
+    cl_int error = CL_SUCCESS;
+    program = clCreateProgramWithSource(context, (cl_uint)strings.size(),
+                                        strings.data(), nullptr, &error);
+    test_error(error, "clCreateProgramWithSource failed");
+    return CL_SUCCESS;
+}
+
+cl_int ScalabilityBenchmark::Compile(cl_program program, double &seconds,
+                                     cl_uint num_headers,
+                                     const cl_program *headers,
+                                     const char **header_names)
+{
+    clock_type::time_point start = clock_type::now();
+    cl_int error = clCompileProgram(program, 1, &device, nullptr, num_headers,
+                                    headers, header_names, nullptr, nullptr);
+    seconds = seconds_since(start);
+    test_error(error, "clCompileProgram failed");
+    return CL_SUCCESS;
+}
+
+cl_int ScalabilityBenchmark::CheckCompositeKernel(cl_program program)
+{
+    cl_int error = CL_SUCCESS;
+    clKernelWrapper kernel = clCreateKernel(program, "CompositeKernel", &error);
+    test_error(error, "Unable to create the composite kernel");
+    return CL_SUCCESS;
+}
+
+std::vector<std::string>
+ScalabilityBenchmark::CompositeLines(unsigned int count,
+                                     const char *const *declarations,
+                                     size_t declaration_templates)
+{
+    std::vector<std::string> lines = { UniqueLine() };
+    for (unsigned int i = 0; i < count; i++)
+        lines.push_back(
+            format_line(declarations[i % declaration_templates], i));
+    lines.push_back(composite_kernel_start);
+    for (unsigned int i = 0; i < count; i++)
+        lines.push_back(format_line(composite_kernel_template, i));
+    lines.push_back(composite_kernel_end);
+    return lines;
+}
+
+// One kernel of the given number of lines, built in one step and compiled
+// and linked in two
+cl_int ScalabilityBenchmark::MeasureProgramSize(unsigned int lines,
+                                                OperationTimes &times)
+{
+    const size_t choices = ARRAY_SIZE(sample_kernel_lines);
+    std::vector<std::string> source = { UniqueLine(), sample_kernel_start };
+    for (unsigned int i = 2; i < lines; i++)
+        source.push_back(sample_kernel_lines[genrand_int32(d) % choices]);
+    source.push_back(sample_kernel_end);
+
+    clProgramWrapper built;
+    cl_int error = CreateProgram(source, built);
+    test_error(error, "Unable to create program");
+
+    clock_type::time_point start = clock_type::now();
+    error = clBuildProgram(built, 1, &device, nullptr, nullptr, nullptr);
+    times["clBuildProgram"] = seconds_since(start);
+    test_error(error, "clBuildProgram failed");
+
+    // Recreate the program with a different first line so that the compile
+    // cannot reuse the build
+    source[0] = UniqueLine();
+    clProgramWrapper compiled;
+    error = CreateProgram(source, compiled);
+    test_error(error, "Unable to create program");
+    error = Compile(compiled, times["clCompileProgram"]);
+    test_error(error, "Unable to compile program");
+
+    start = clock_type::now();
+    clProgramWrapper linked =
+        clLinkProgram(context, 1, &device, nullptr, 1, &compiled, nullptr,
+                      nullptr, &error);
+    times["clLinkProgram"] = seconds_since(start);
+    test_error(error, "clLinkProgram failed");
+    return CL_SUCCESS;
+}
+
+// A composite kernel calling one kernel from each of the given number of
+// other files. The files are compiled separately and linked together, or
+// built as a single program.
+cl_int ScalabilityBenchmark::MeasureFileCount(unsigned int files,
+                                              OperationTimes &times)
+{
+    std::vector<std::string> composite =
+        CompositeLines(files, &composite_kernel_extern_template, 1);
+
+    std::vector<clProgramWrapper> programs(files + 1);
+    cl_int error = CreateProgram(composite, programs[files]);
+    test_error(error, "Unable to create program");
+    error = Compile(programs[files], times["clCompileProgram"]);
+    test_error(error, "Unable to compile program");
+
+    double file_seconds = 0.0;
+    std::vector<std::string> everything = composite;
+    for (unsigned int i = 0; i < files; i++)
+    {
+        std::vector<std::string> file = {
+            UniqueLine(), format_line(simple_kernel_template, i)
+        };
+        everything.push_back(file[1]);
+
+        error = CreateProgram(file, programs[i]);
+        test_error(error, "Unable to create program");
+        double seconds;
+        error = Compile(programs[i], seconds);
+        test_error(error, "Unable to compile program");
+        file_seconds += seconds;
+    }
+    times["clCompileProgram/file"] = file_seconds / files;
+
+    std::vector<cl_program> inputs(programs.begin(), programs.end());
+    clock_type::time_point start = clock_type::now();
+    clProgramWrapper linked =
+        clLinkProgram(context, 1, &device, nullptr, (cl_uint)inputs.size(),
+                      inputs.data(), nullptr, nullptr, &error);
+    times["clLinkProgram"] = seconds_since(start);
+    test_error(error, "clLinkProgram failed");
+    error = CheckCompositeKernel(linked);
+    test_error(error, "Linked program is incomplete");
+
+    everything[0] = UniqueLine();
+    clProgramWrapper built;
+    error = CreateProgram(everything, built);
+    test_error(error, "Unable to create program");
+    start = clock_type::now();
+    error = clBuildProgram(built, 1, &device, nullptr, nullptr, nullptr);
+    times["clBuildProgram"] = seconds_since(start);
+    test_error(error, "clBuildProgram failed");
+    error = CheckCompositeKernel(built);
+    test_error(error, "Built program is incomplete");
+    return CL_SUCCESS;
+}
+
+// A composite kernel linked against the given number of libraries of one
+// kernel each
+cl_int ScalabilityBenchmark::MeasureLibraryCount(unsigned int libraries,
+                                                 OperationTimes &times)
+{
+    std::vector<clProgramWrapper> programs(libraries + 1);
+    cl_int error =
+        CreateProgram(CompositeLines(libraries,
+                                     &composite_kernel_extern_template, 1),
+                      programs[libraries]);
+    test_error(error, "Unable to create program");
+    error = Compile(programs[libraries], times["clCompileProgram"]);
+    test_error(error, "Unable to compile program");
+
+    double file_seconds = 0.0;
+    for (unsigned int i = 0; i < libraries; i++)
+    {
+        clProgramWrapper file;
+        error = CreateProgram(
+            { UniqueLine(), format_line(simple_kernel_template, i) }, file);
+        test_error(error, "Unable to create program");
+        double seconds;
+        error = Compile(file, seconds);
+        test_error(error, "Unable to compile program");
+        file_seconds += seconds;
+
+        programs[i] =
+            clLinkProgram(context, 1, &device, "-create-library", 1, &file,
+                          nullptr, nullptr, &error);
+        test_error(error, "Unable to create library");
+    }
+    times["clCompileProgram/file"] = file_seconds / libraries;
+
+    std::vector<cl_program> inputs(programs.begin(), programs.end());
+    clock_type::time_point start = clock_type::now();
+    clProgramWrapper linked =
+        clLinkProgram(context, 1, &device, nullptr, (cl_uint)inputs.size(),
+                      inputs.data(), nullptr, nullptr, &error);
+    times["clLinkProgram"] = seconds_since(start);
+    test_error(error, "clLinkProgram failed");
+    error = CheckCompositeKernel(linked);
+    test_error(error, "Linked program is incomplete");
+    return CL_SUCCESS;
+}
+
+// A composite kernel that includes the given number of embedded headers,
+// spread over the directories of multiple_embedded_headers
+cl_int ScalabilityBenchmark::MeasureHeaderCount(unsigned int headers,
+                                                OperationTimes &times)
+{
+    std::vector<clProgramWrapper> header_programs(headers);
+    std::vector<std::string> header_names(headers);
+    for (unsigned int i = 0; i < headers; i++)
+    {
+        cl_int error = CreateProgram(
+            { UniqueLine(), format_line(composite_kernel_extern_template, i) },
+            header_programs[i]);
+        test_error(error, "Unable to create header program");
+        header_names[i] =
+            format_line(header_name_templates[i % ARRAY_SIZE(
+                            header_name_templates)],
+                        i);
+    }
+
+    clProgramWrapper program;
+    cl_int error = CreateProgram(
+        CompositeLines(headers, include_header_name_templates,
+                       ARRAY_SIZE(include_header_name_templates)),
+        program);
+    test_error(error, "Unable to create program");
+
+    std::vector<cl_program> header_inputs(header_programs.begin(),
+                                          header_programs.end());
+    std::vector<const char *> names;
+    for (const std::string &name : header_names) names.push_back(name.c_str());
+    error = Compile(program, times["clCompileProgram"], headers,
+                    header_inputs.data(), names.data());
+    test_error(error, "Unable to compile program with embedded headers");
+    return CL_SUCCESS;
+}
+
+cl_int ScalabilityBenchmark::Measure(const Sweep &sweep, unsigned int size,
+                                     OperationTimes &times)
+{
+    if (&sweep == &program_size_sweep) return MeasureProgramSize(size, times);
+    if (&sweep == &file_count_sweep) return MeasureFileCount(size, times);
+    if (&sweep == &library_count_sweep)
+        return MeasureLibraryCount(size, times);
+    return MeasureHeaderCount(size, times);
+}
+
+cl_int ScalabilityBenchmark::Run(const Sweep &sweep, unsigned int last,
+                                 unsigned int reps)
+{
+    log_info("Sweeping %s from %u to %u...\n", sweep.name, sweep.first, last);
+    for (unsigned int size = sweep.first; size <= last; size *= 2)
+    {
+        std::map<std::string, std::vector<double>> samples;
+        for (unsigned int rep = 0; rep < reps; rep++)
+        {
+            OperationTimes times;
+            cl_int error = Measure(sweep, size, times);
+            if (error != CL_SUCCESS)
+            {
+                log_error("ERROR: Measuring %u %s failed.\n", size,
+                          sweep.name);
+                return error;
+            }
+            for (const auto &time : times)
+                samples[time.first].push_back(time.second);
+        }
+
+        for (const auto &sample : samples)
+        {
+            double median = compute_sample_stats(sample.second).median;
+
+            Series &s = series[std::string(sweep.name) + " " + sample.first];
+            s.sweep = sweep.name;
+            s.sizes.push_back(size);
+            s.seconds.push_back(median);
+
+            log_info("  %6u %-10s %-21s %10.4f s\n", size, sweep.name,
+                     sample.first.c_str(), median);
+            log_perf(median, false, "s", "%s %u %s", sample.first.c_str(),
+                     size, sweep.name);
+        }
+    }
+    return CL_SUCCESS;
+}
+
+int ScalabilityBenchmark::Report()
+{
+    FILE *file = open_results_csv("CL_COMPILER_SCALABILITY_CSV",
+                                  "sweep,operation,size,median_s");
+
+    int superlinear = 0;
+    log_info("Growth exponents (time ~ size^k over the larger sizes):\n");
+    for (const auto &entry : series)
+    {
+        const Series &s = entry.second;
+        if (file)
+            for (size_t i = 0; i < s.sizes.size(); i++)
+                fprintf(file, "%s,%s,%.0f,%.6f\n", s.sweep,
+                        entry.first.c_str() + strlen(s.sweep) + 1, s.sizes[i],
+                        s.seconds[i]);
+
+        // Least squares fit of log(time) against log(size)
+        size_t count = std::max<size_t>(3, (s.sizes.size() + 1) / 2);
+        if (s.sizes.size() < count) continue;
+        double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        for (size_t i = s.sizes.size() - count; i < s.sizes.size(); i++)
+        {
+            double x = std::log(s.sizes[i]);
+            double y = std::log(std::max(s.seconds[i], 1e-9));
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+        }
+        double exponent = (count * sxy - sx * sy) / (count * sxx - sx * sx);
+
+        bool flagged = exponent > superlinear_exponent;
+        log_info("  %-32s k = %.2f%s\n", entry.first.c_str(), exponent,
+                 flagged ? "  <-- super-linear" : "");
+        if (flagged) superlinear++;
+    }
+    if (file) fclose(file);
+    return superlinear;
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(compile_scalability)
+{
+    if (gCompilationMode != kOnline)
+    {
+        log_info(
+            "Skipping compile_scalability, compilation mode not online\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+    check_compiler_available(device);
+
+    cl_bool linker_available = CL_FALSE;
+    cl_int error =
+        clGetDeviceInfo(device, CL_DEVICE_LINKER_AVAILABLE,
+                        sizeof(linker_available), &linker_available, nullptr);
+    test_error(error, "Unable to query CL_DEVICE_LINKER_AVAILABLE");
+    if (!linker_available)
+    {
+        log_info("Skipping compile_scalability, no linker is available\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    unsigned int scale = 1;
+    if (const char *scale_env = getenv("CL_COMPILER_SCALABILITY_SCALE"))
+        scale = std::max(1, atoi(scale_env));
+
+    ScalabilityBenchmark benchmark(device, context);
+    for (const Sweep *sweep : { &program_size_sweep, &file_count_sweep,
+                                &library_count_sweep, &header_count_sweep })
+    {
+        if (full_sweep)
+            error = benchmark.Run(*sweep, sweep->last * scale,
+                                  scalability_reps);
+        else
+            error = benchmark.Run(*sweep, sweep->first * 4, 1);
+        test_error(error, "Compiler scalability sweep failed");
+    }
+
+    if (!full_sweep)
+    {
+        log_info("Growth exponents are only fitted with --benchmark.\n");
+        return TEST_PASS;
+    }
+
+    int superlinear = benchmark.Report();
+    if (superlinear)
+        log_info("WARNING: %d operations grow super-linearly with the size "
+                 "of their input.\n",
+                 superlinear);
+    return TEST_PASS;
+}
@@ -0,0 +1,464 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "harness/csvHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stress test and throughput benchmark for concurrent compilation, as done by
+// applications that build many programs from worker threads at startup.
+// Programs are built or compiled from N host threads at once, in the
+// context of the test or in one context per thread, or N times as many
+// asynchronous builds are started from a single thread with a completion
+// callback, in one or in N contexts. Every program has a unique source so
+// that compiler caches cannot serve it.
+//
+// For each mode and N, the aggregate number of programs per second and the
+// distribution of the latency of individual builds are reported, along with
+// the throughput relative to N times the single threaded one. Throughput
+// that barely grows with N points to a global lock in the compiler; it is
+// logged but does not fail the test, whereas any failed build does.
+//
+// Without --benchmark, N only goes up to smoke_threads with
+// smoke_programs_per_thread programs per thread, which is enough to catch
+// failing concurrent builds. With it, the largest N defaults to twice the
+// number of host threads, up to 64, and can be set with
+// CL_CONCURRENT_COMPILE_THREADS. Results are appended to the file named by
+// CL_CONCURRENT_COMPILE_CSV if it is set.
+
+namespace {
+
+const char *concurrent_kernel_template =
+    "// %u\n"
+    "__kernel void concurrent_kernel(__global const float *src,\n"
+    "                                __global float *dst, int n)\n"
+    "{\n"
+    "    size_t tid = get_global_id(0);\n"
+    "    float acc = 0.0f;\n"
+    "    for (int i = 0; i < n; i++)\n"
+    "    {\n"
+    "        float x = src[(tid + i) %% n];\n"
+    "        acc = mad(acc, x, %u.0f) + sin(x) * cos(acc);\n"
+    "    }\n"
+    "    dst[tid] = acc;\n"
+    "}\n";
+
+const unsigned int max_default_threads = 64;
+const unsigned int programs_per_thread = 8;
+const unsigned int smoke_threads = 4;
+const unsigned int smoke_programs_per_thread = 2;
+
+// Seconds to wait for the completion callbacks of asynchronous builds
+const int async_timeout = 600;
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+struct CompileMode
+{
+    const char *name;
+    bool compile_only;
+    bool private_contexts;
+    bool async;
+};
+
+const CompileMode compile_modes[] = {
+    { "build", false, false, false },
+    { "compile", true, false, false },
+    { "build_private", false, true, false },
+    { "async_build", false, false, true },
+    { "async_private", false, true, true },
+};
+
+struct RoundResult
+{
+    double seconds = 0.0;
+    // Seconds from starting each build to its completion
+    std::vector<double> latencies;
+};
+
+class ConcurrentCompile {
+public:
+    ConcurrentCompile(cl_device_id device, cl_context context)
+        : device(device), context(context), d(gRandomSeed)
+    {}
+
+    // Builds n * programs programs in the given mode
+    cl_int Run(const CompileMode &mode, unsigned int n, unsigned int programs,
+               RoundResult &result);
+
+private:
+    cl_int CreateContexts(const CompileMode &mode, unsigned int n,
+                          std::vector<clContextWrapper> &contexts);
+    cl_context ContextFor(const CompileMode &mode,
+                          const std::vector<clContextWrapper> &contexts,
+                          unsigned int i) const
+    {
+        if (mode.private_contexts) return contexts[i];
+        return context;
+    }
+    cl_int CreatePrograms(cl_context program_context, unsigned int count,
+                          std::vector<clProgramWrapper> &programs);
+    cl_int CheckProgram(const CompileMode &mode, cl_program program);
+    cl_int RunThreads(const CompileMode &mode, unsigned int n,
+                      unsigned int programs, RoundResult &result);
+    cl_int RunAsync(const CompileMode &mode, unsigned int n,
+                    unsigned int programs, RoundResult &result);
+
+    cl_device_id device;
+    cl_context context;
+    MTdataHolder d;
+};
+
+cl_int
+ConcurrentCompile::CreateContexts(const CompileMode &mode, unsigned int n,
+                                  std::vector<clContextWrapper> &contexts)
+{
+    if (!mode.private_contexts) return CL_SUCCESS;
+
+    contexts.resize(n);
+    for (clContextWrapper &private_context : contexts)
+    {
+        cl_int error = CL_SUCCESS;
+        private_context =
+            clCreateContext(nullptr, 1, &device, nullptr, nullptr, &error);
+        test_error(error, "Unable to create context");
+    }
+    return CL_SUCCESS;
+}
+
+cl_int
+ConcurrentCompile::CreatePrograms(cl_context program_context,
+                                  unsigned int count,
+                                  std::vector<clProgramWrapper> &programs)
+{
+    programs.resize(count);
+    for (clProgramWrapper &program : programs)
+    {
+        char source[1024];
+        snprintf(source, sizeof(source), concurrent_kernel_template,
+                 genrand_int32(d), genrand_int32(d) % 1000);
+        const char *source_ptr = source;
+
+        cl_int error = CL_SUCCESS;
+        program = clCreateProgramWithSource(program_context, 1, &source_ptr,
+                                            nullptr, &error);
+        test_error(error, "clCreateProgramWithSource failed");
+    }
+    return CL_SUCCESS;
+}
+
+cl_int ConcurrentCompile::CheckProgram(const CompileMode &mode,
+                                       cl_program program)
+{
+    cl_build_status status = CL_BUILD_NONE;
+    cl_int error =
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_STATUS,
+                              sizeof(status), &status, nullptr);
+    test_error(error, "Unable to get program build status");
+    if (status != CL_BUILD_SUCCESS)
+    {
+        log_error("ERROR: Program build status is %d, expected %d\n", status,
+                  CL_BUILD_SUCCESS);
+        return TEST_FAIL;
+    }
+    if (mode.compile_only) return CL_SUCCESS;
+
+    clKernelWrapper kernel =
+        clCreateKernel(program, "concurrent_kernel", &error);
+    test_error(error, "Unable to create kernel from built program");
+    return CL_SUCCESS;
+}
+
+cl_int ConcurrentCompile::RunThreads(const CompileMode &mode, unsigned int n,
+                                     unsigned int programs,
+                                     RoundResult &result)
+{
+    std::vector<clContextWrapper> contexts;
+    cl_int error = CreateContexts(mode, n, contexts);
+    test_error(error, "Unable to create per thread contexts");
+
+    // Programs are created up front so that only the compiler is measured
+    std::vector<std::vector<clProgramWrapper>> thread_programs(n);
+    for (unsigned int t = 0; t < n; t++)
+    {
+        error = CreatePrograms(ContextFor(mode, contexts, t), programs,
+                               thread_programs[t]);
+        test_error(error, "Unable to create programs");
+    }
+
+    result.latencies.assign(n * programs, 0.0);
+    std::vector<cl_int> errors(n, CL_SUCCESS);
+    std::vector<clock_type::time_point> finished(n);
+    std::atomic<unsigned int> ready{ 0 };
+    std::atomic<bool> go{ false };
+    clock_type::time_point start;
+
+    auto worker = [&](unsigned int t) {
+        ready++;
+        while (!go) std::this_thread::yield();
+
+        for (unsigned int i = 0; i < programs && errors[t] == CL_SUCCESS; i++)
+        {
+            cl_program program = thread_programs[t][i];
+            clock_type::time_point issued = clock_type::now();
+            errors[t] = mode.compile_only
+                ? clCompileProgram(program, 1, &device, nullptr, 0, nullptr,
+                                   nullptr, nullptr, nullptr)
+                : clBuildProgram(program, 1, &device, nullptr, nullptr,
+                                 nullptr);
+            result.latencies[t * programs + i] = seconds_since(issued);
+        }
+        finished[t] = clock_type::now();
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < n; t++) threads.emplace_back(worker, t);
+    while (ready < n) std::this_thread::yield();
+    start = clock_type::now();
+    go = true;
+    for (std::thread &thread : threads) thread.join();
+
+    result.seconds = 0.0;
+    for (unsigned int t = 0; t < n; t++)
+    {
+        test_error(errors[t], "Concurrent build failed");
+        result.seconds = std::max(
+            result.seconds,
+            std::chrono::duration<double>(finished[t] - start).count());
+        for (const clProgramWrapper &program : thread_programs[t])
+        {
+            error = CheckProgram(mode, program);
+            test_error(error, "Concurrently built program is invalid");
+        }
+    }
+    return CL_SUCCESS;
+}
+
+struct AsyncBuilds;
+
+struct AsyncBuild
+{
+    AsyncBuilds *builds;
+    unsigned int index;
+};
+
+// State shared with the completion callbacks of asynchronous builds
+struct AsyncBuilds
+{
+    std::mutex mutex;
+    std::condition_variable completed;
+    unsigned int outstanding = 0;
+    std::vector<AsyncBuild> user_data;
+    std::vector<clock_type::time_point> issued;
+    std::vector<double> latencies;
+};
+
+void CL_CALLBACK notify_async_build(cl_program, void *user_data)
+{
+    AsyncBuild *build = static_cast<AsyncBuild *>(user_data);
+    AsyncBuilds *builds = build->builds;
+
+    std::lock_guard<std::mutex> lock(builds->mutex);
+    builds->latencies[build->index] =
+        seconds_since(builds->issued[build->index]);
+    if (--builds->outstanding == 0) builds->completed.notify_all();
+}
+
+cl_int ConcurrentCompile::RunAsync(const CompileMode &mode, unsigned int n,
+                                   unsigned int programs, RoundResult &result)
+{
+    std::vector<clContextWrapper> contexts;
+    cl_int error = CreateContexts(mode, n, contexts);
+    test_error(error, "Unable to create contexts");
+
+    const unsigned int count = n * programs;
+    std::vector<clProgramWrapper> all_programs;
+    for (unsigned int c = 0; c < n; c++)
+    {
+        std::vector<clProgramWrapper> context_programs;
+        error = CreatePrograms(ContextFor(mode, contexts, c), programs,
+                               context_programs);
+        test_error(error, "Unable to create programs");
+        for (clProgramWrapper &program : context_programs)
+            all_programs.push_back(std::move(program));
+    }
+
+    // Builds are started round robin over the contexts. The state is only
+    // released once every callback has fired, see below.
+    std::unique_ptr<AsyncBuilds> builds(new AsyncBuilds);
+    builds->user_data.resize(count);
+    builds->issued.resize(count);
+    builds->latencies.assign(count, 0.0);
+
+    clock_type::time_point start = clock_type::now();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int index = (i % n) * programs + i / n;
+        builds->user_data[index] = { builds.get(), index };
+        {
+            std::lock_guard<std::mutex> lock(builds->mutex);
+            builds->issued[index] = clock_type::now();
+            builds->outstanding++;
+        }
+        error = clBuildProgram(all_programs[index], 1, &device, nullptr,
+                               notify_async_build, &builds->user_data[index]);
+        if (error != CL_SUCCESS)
+        {
+            // The callback is only guaranteed for builds that were started
+            std::lock_guard<std::mutex> lock(builds->mutex);
+            builds->outstanding--;
+            break;
+        }
+    }
+
+    bool timed_out = false;
+    {
+        std::unique_lock<std::mutex> lock(builds->mutex);
+        timed_out = !builds->completed.wait_for(
+            lock, std::chrono::seconds(async_timeout),
+            [&] { return builds->outstanding == 0; });
+    }
+    result.seconds = seconds_since(start);
+
+    if (timed_out)
+    {
+        // Callbacks may still fire, so their state is deliberately leaked
+        log_error("ERROR: Timed out waiting for asynchronous builds.\n");
+        builds.release();
+        return TEST_FAIL;
+    }
+    test_error(error, "Unable to start asynchronous build");
+
+    result.latencies = builds->latencies;
+    for (const clProgramWrapper &program : all_programs)
+    {
+        error = CheckProgram(mode, program);
+        test_error(error, "Asynchronously built program is invalid");
+    }
+    return CL_SUCCESS;
+}
+
+cl_int ConcurrentCompile::Run(const CompileMode &mode, unsigned int n,
+                              unsigned int programs, RoundResult &result)
+{
+    return mode.async ? RunAsync(mode, n, programs, result)
+                      : RunThreads(mode, n, programs, result);
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(concurrent_compile)
+{
+    if (gCompilationMode != kOnline)
+    {
+        log_info(
+            "Skipping concurrent_compile, compilation mode not online\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+    check_compiler_available(device);
+
+    unsigned int host_threads =
+        std::max(1u, std::thread::hardware_concurrency());
+    unsigned int max_threads = std::min(max_default_threads, 2 * host_threads);
+    unsigned int programs = programs_per_thread;
+    if (const char *threads_env = getenv("CL_CONCURRENT_COMPILE_THREADS"))
+        max_threads = std::max(1, atoi(threads_env));
+    if (gWimpyMode)
+    {
+        max_threads = std::min(max_threads, smoke_threads / 2);
+        programs = 1;
+    }
+    else if (!gBenchmarkMode)
+    {
+        max_threads = std::min(max_threads, smoke_threads);
+        programs = smoke_programs_per_thread;
+    }
+
+    FILE *file = open_results_csv(
+        "CL_CONCURRENT_COMPILE_CSV",
+        "mode,n,programs,programs_per_s,p50_ms,p99_ms,max_ms,efficiency");
+
+    ConcurrentCompile benchmark(device, context);
+    cl_int error = CL_SUCCESS;
+    for (const CompileMode &mode : compile_modes)
+    {
+        log_info("Concurrent %s, %u programs per thread:\n", mode.name,
+                 programs);
+        double single_throughput = 0.0;
+        double last_efficiency = 1.0;
+        unsigned int last_n = 1;
+        for (unsigned int n = 1; n <= max_threads; n *= 2)
+        {
+            RoundResult result;
+            error = benchmark.Run(mode, n, programs, result);
+            if (error != CL_SUCCESS)
+            {
+                log_error("ERROR: Concurrent %s with %u threads failed.\n",
+                          mode.name, n);
+                if (file) fclose(file);
+                return TEST_FAIL;
+            }
+
+            const std::vector<double> &latencies = result.latencies;
+            SampleStats latency = compute_sample_stats(latencies);
+            double throughput = latencies.size() / result.seconds;
+            if (n == 1) single_throughput = throughput;
+            double efficiency = throughput / (n * single_throughput);
+
+            log_info("  %3u threads %5zu programs %9.1f programs/s  p50 %8.2f "
+                     "ms  p99 %8.2f ms  max %8.2f ms  efficiency %5.1f%%\n",
+                     n, latencies.size(), throughput, 1e3 * latency.median,
+                     1e3 * latency.p99, 1e3 * latency.max, 100.0 * efficiency);
+            log_perf(throughput, true, "programs/s", "%s %u threads",
+                     mode.name, n);
+            if (file)
+                fprintf(file, "%s,%u,%zu,%.3f,%.3f,%.3f,%.3f,%.4f\n",
+                        mode.name, n, latencies.size(), throughput,
+                        1e3 * latency.median, 1e3 * latency.p99,
+                        1e3 * latency.max, efficiency);
+
+            last_efficiency = efficiency;
+            last_n = n;
+        }
+
+        if (last_n >= 4 && last_efficiency * last_n < 1.5)
+            log_info("WARNING: Concurrent %s throughput with %u threads is "
+                     "%.2fx single threaded, compilation appears to be "
+                     "serialised.\n",
+                     mode.name, last_n, last_efficiency * last_n);
+    }
+
+    if (file) fclose(file);
+    return TEST_PASS;
+}
@@ -583,10 +583,9 @@ int ConversionsTest::DoTest(Type outType, Type inType, SaturationMode sat,
         BUFFER_SIZE / std::max(gTypeSizes[inType], gTypeSizes[outType]);
     size_t step = blockCount;
 
-    for (i = 0; i < threads; i++)
-    {
-        init_info.mdv.emplace_back(MTdataHolder(gRandomSeed));
-    }
+    // One generator per init job; each job creates it from its own sub-stream
+    // of the seed (see DataInfoSpec::init)
+    init_info.mdv.resize(kInitJobCount);
 
     writeInputBufferInfo.outType = outType;
     writeInputBufferInfo.inType = inType;
@@ -719,20 +718,11 @@ int ConversionsTest::DoTest(Type outType, Type inType, SaturationMode sat,
             return error;
         }
 
-        //      Call this in a multithreaded manner
-        cl_uint chunks = RoundUpToNextPowerOfTwo(threads) * 2;
+        //      Call this in a multithreaded manner. The split does not depend
+        //      on the thread count so that the inputs do not either.
+        cl_uint chunks = kInitJobCount;
         init_info.start = i;
         init_info.size = blockCount / chunks;
-        if (init_info.size < 16384)
-        {
-            chunks = RoundUpToNextPowerOfTwo(threads);
-            init_info.size = blockCount / chunks;
-            if (init_info.size < 16384)
-            {
-                init_info.size = blockCount;
-                chunks = 1;
-            }
-        }
 
         ThreadPool_Do(conv_test::InitData, chunks, &init_info);
 
@@ -50,6 +50,10 @@
 #define EMBEDDED_REDUCTION_FACTOR 16
 #define PERF_LOOP_COUNT 100
 
+// Number of jobs the input data of each block is generated by. Fixed so the
+// random inputs are the same whatever the thread count.
+#define kInitJobCount 16
+
 extern const char *gTypeNames[ kTypeCount ];
 extern const char *gRoundingModeNames[ kRoundingModeCount ];        // { "", "_rte", "_rtp", "_rtn", "_rtz" }
 extern const char *gSaturationNames[ kSaturationModeCount ];        // { "", "_sat" }
@@ -1008,11 +1008,18 @@ void DataInfoSpec<InType, OutType, InFP, OutFP>::set_allow_zero(uint8_t *allow,
 
 template <typename InType, typename OutType, bool InFP, bool OutFP>
 void DataInfoSpec<InType, OutType, InFP, OutFP>::init(const cl_uint &job_id,
-                                                      const cl_uint &thread_id)
+                                                      const cl_uint &)
 {
     const uint64_t ulStart = start + job_id * size;
     void *pIn = (char *)gIn + job_id * size * gTypeSizes[inType];
 
+    // Job k of every block continues sub-stream k of the seed, so the data
+    // depends only on the job index and not on which thread runs the job
+    if (start == 0 && sizeof(InType) > sizeof(uint16_t))
+    {
+        mdv[job_id] = MTdataHolder(gRandomSeed, job_id);
+    }
+
     if constexpr (sizeof(InType) <= sizeof(uint8_t))
     {
         uint8_t *o = (uint8_t *)pIn;
@@ -1055,10 +1062,7 @@ void DataInfoSpec<InType, OutType, InFP, OutFP>::init(const cl_uint &job_id,
             {
                 o[i] = specialValues[i + ulStart];
             }
-            for (; i < size; i++)
-            {
-                o[i] = genrand_int32(mdv[thread_id]);
-            }
+            genrand_fill(mdv[job_id], o + i, size - i);
         }
         else
         { // long/ulong
@@ -1071,7 +1075,7 @@ void DataInfoSpec<InType, OutType, InFP, OutFP>::init(const cl_uint &job_id,
             }
             for (; i < size; i++)
             {
-                o[i] = genrand_int64(mdv[thread_id]);
+                o[i] = genrand_int64(mdv[job_id]);
             }
         }
     } // integrals
@@ -1096,10 +1100,7 @@ void DataInfoSpec<InType, OutType, InFP, OutFP>::init(const cl_uint &job_id,
             {
                 of[i] = specialValuesFloat[i + ulStart];
             }
-            for (; i < size; i++)
-            {
-                o[i] = genrand_int32(mdv[thread_id]);
-            }
+            genrand_fill(mdv[job_id], o + i, size - i);
         }
 
         if (kUnsaturated == sat)
@@ -1120,7 +1121,7 @@ void DataInfoSpec<InType, OutType, InFP, OutFP>::init(const cl_uint &job_id,
         }
         for (; i < size; i++)
         {
-            o[i] = genrand_int64(mdv[thread_id]);
+            o[i] = genrand_int64(mdv[job_id]);
         }
 
         if (kUnsaturated == sat)
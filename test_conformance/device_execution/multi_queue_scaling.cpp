@@ -0,0 +1,486 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "harness/csvHelpers.h"
+#include "harness/testHarness.h"
+#include "harness/typeWrappers.h"
+#include "harness/parseParameters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+// Benchmark of how the throughput of independent kernels scales with the
+// number of queues they are submitted to. A fixed set of jobs, each a
+// compute-bound or a memory-bound kernel over its own part of a buffer, is
+// spread round robin over 1 to 8 in-order host queues, or enqueued from a
+// parent kernel over 1 to CL_DEVICE_MAX_ON_DEVICE_QUEUES device queues. For
+// each queue count the wall time and the speedup over a single queue are
+// reported, along with, for host queues, the overlap achieved: the sum of the
+// execution times of the jobs from their profiling timestamps over the time
+// from the first start to the last end. An overlap close to 1 means the jobs
+// ran one after the other.
+//
+// The results of every run are checked. Results are appended to the file
+// named by CL_MULTI_QUEUE_SCALING_CSV if it is set.
+//
+// The full job sizes only run with --benchmark. Otherwise half the jobs,
+// sixteen times smaller, are spread over up to 4 host queues, which checks
+// the results but is too small for the speedups to mean anything.
+
+#ifdef CL_VERSION_2_0
+static const char multi_queue_scaling_kernels[] =
+    NL "#define LCG(x) ((x) * 1664525u + 1013904223u)"
+    NL ""
+    NL "kernel void scaling_compute(__global uint* out, uint iterations)"
+    NL "{"
+    NL "  size_t tid = get_global_id(0);"
+    NL "  uint x = (uint)tid;"
+    NL "  for(uint i = 0; i < iterations; ++i) x = LCG(x);"
+    NL "  out[tid] = x;"
+    NL "}"
+    NL ""
+    NL "kernel void scaling_memory(__global const uint* src,"
+    NL "                           __global uint* dst)"
+    NL "{"
+    NL "  size_t tid = get_global_id(0);"
+    NL "  dst[tid] = src[tid] + 1u;"
+    NL "}";
+
+// Parent kernel that enqueues job j to the (j % n)-th of n device queues
+static const char multi_queue_scaling_parent[] =
+    NL "#define LCG(x) ((x) * 1664525u + 1013904223u)"
+    NL ""
+    NL "kernel void scaling_parent(__global uint* out,"
+    NL "                           __global const uint* src,"
+    NL "                           __global int* res, uint jobs,"
+    NL "                           uint job_size, uint iterations,"
+    NL "                           uint memory_bound %s)"
+    NL "{"
+    NL "  queue_t q[] = { %s };"
+    NL "  uint n = %d;"
+    NL "  res[0] = 0;"
+    NL "  for(uint j = 0; j < jobs; ++j)"
+    NL "  {"
+    NL "    uint base = j * job_size;"
+    NL "    int enq_res = enqueue_kernel(q[j %% n], CLK_ENQUEUE_FLAGS_NO_WAIT,"
+    NL "                                 ndrange_1D(job_size),"
+    NL "    ^{"
+    NL "       size_t tid = base + get_global_id(0);"
+    NL "       if(memory_bound) { out[tid] = src[tid] + 1u; return; }"
+    NL "       uint x = (uint)tid;"
+    NL "       for(uint i = 0; i < iterations; ++i) x = LCG(x);"
+    NL "       out[tid] = x;"
+    NL "     });"
+    NL "    if(enq_res != CLK_SUCCESS) { res[0] = enq_res; return; }"
+    NL "  }"
+    NL "}";
+
+namespace {
+
+const cl_uint scaling_jobs = 16;
+const cl_uint scaling_smoke_jobs = 8;
+const cl_uint compute_job_size = 16384;
+const cl_uint compute_iterations = 1024;
+const cl_uint memory_job_size = 1 << 20;
+const cl_uint scaling_max_host_queues = 8;
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+struct Workload
+{
+    const char *name;
+    bool memory_bound;
+    cl_uint job_size;
+};
+
+struct ScalingResult
+{
+    double seconds = 0.0;
+    // Sum of job execution times over the span of their execution, only
+    // known for host queues
+    double overlap = 0.0;
+};
+
+class MultiQueueScaling {
+public:
+    MultiQueueScaling(cl_device_id device, cl_context context,
+                      cl_command_queue queue)
+        : device(device), context(context), queue(queue)
+    {}
+
+    cl_int Init(const Workload &workload, cl_uint jobs);
+    cl_int RunHost(cl_uint queue_count, ScalingResult &result);
+    cl_int RunDevice(const std::vector<cl_command_queue> &device_queues,
+                     cl_uint queue_count, ScalingResult &result);
+
+private:
+    cl_int Reset();
+    cl_int Check();
+
+    cl_device_id device;
+    cl_context context;
+    cl_command_queue queue;
+
+    Workload workload{};
+    cl_uint jobs = 0;
+    clProgramWrapper program;
+    clKernelWrapper kernel;
+    clMemWrapper src;
+    clMemWrapper out;
+    std::vector<cl_uint> reference;
+};
+
+cl_int MultiQueueScaling::Init(const Workload &w, cl_uint job_count)
+{
+    workload = w;
+    jobs = job_count;
+    const size_t items = (size_t)jobs * workload.job_size;
+
+    const char *source = multi_queue_scaling_kernels;
+    cl_int error = create_single_kernel_helper(
+        context, &program, &kernel, 1, &source,
+        workload.memory_bound ? "scaling_memory" : "scaling_compute");
+    test_error(error, "Unable to create scaling kernel");
+
+    std::vector<cl_uint> input(items);
+    reference.resize(items);
+    for (size_t i = 0; i < items; i++)
+    {
+        input[i] = (cl_uint)(i * 2654435761u);
+        if (workload.memory_bound)
+        {
+            reference[i] = input[i] + 1;
+            continue;
+        }
+        cl_uint x = (cl_uint)i;
+        for (cl_uint k = 0; k < compute_iterations; k++)
+            x = x * 1664525u + 1013904223u;
+        reference[i] = x;
+    }
+
+    src = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                         items * sizeof(cl_uint), input.data(), &error);
+    test_error(error, "clCreateBuffer() failed");
+    out = clCreateBuffer(context, CL_MEM_READ_WRITE, items * sizeof(cl_uint),
+                         NULL, &error);
+    test_error(error, "clCreateBuffer() failed");
+
+    if (workload.memory_bound)
+    {
+        error = clSetKernelArg(kernel, 0, sizeof(src), &src);
+        error |= clSetKernelArg(kernel, 1, sizeof(out), &out);
+    }
+    else
+    {
+        error = clSetKernelArg(kernel, 0, sizeof(out), &out);
+        error |= clSetKernelArg(kernel, 1, sizeof(compute_iterations),
+                                &compute_iterations);
+    }
+    test_error(error, "clSetKernelArg() failed");
+    return CL_SUCCESS;
+}
+
+cl_int MultiQueueScaling::Reset()
+{
+    const cl_uint pattern = 0;
+    cl_int error = clEnqueueFillBuffer(queue, out, &pattern, sizeof(pattern), 0,
+                                       reference.size() * sizeof(cl_uint), 0,
+                                       NULL, NULL);
+    test_error(error, "clEnqueueFillBuffer() failed");
+    error = clFinish(queue);
+    test_error(error, "clFinish() failed");
+    return CL_SUCCESS;
+}
+
+cl_int MultiQueueScaling::Check()
+{
+    std::vector<cl_uint> results(reference.size());
+    cl_int error = clEnqueueReadBuffer(queue, out, CL_TRUE, 0,
+                                       results.size() * sizeof(cl_uint),
+                                       results.data(), 0, NULL, NULL);
+    test_error(error, "clEnqueueReadBuffer() failed");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (results[i] != reference[i])
+        {
+            log_error("ERROR: '%s' job %zu result %zu is 0x%08x, expected "
+                      "0x%08x\n",
+                      workload.name, i / workload.job_size, i, results[i],
+                      reference[i]);
+            return TEST_FAIL;
+        }
+    }
+    return CL_SUCCESS;
+}
+
+cl_int MultiQueueScaling::RunHost(cl_uint queue_count, ScalingResult &result)
+{
+    cl_int error = Reset();
+    test_error(error, "Unable to reset output");
+
+    const cl_queue_properties properties[] = { CL_QUEUE_PROPERTIES,
+                                               CL_QUEUE_PROFILING_ENABLE, 0 };
+    std::vector<clCommandQueueWrapper> queues(queue_count);
+    for (clCommandQueueWrapper &host_queue : queues)
+    {
+        host_queue = clCreateCommandQueueWithProperties(context, device,
+                                                        properties, &error);
+        test_error(error, "clCreateCommandQueueWithProperties() failed");
+    }
+
+    std::vector<clEventWrapper> events(jobs);
+    const size_t global = workload.job_size;
+    clock_type::time_point start = clock_type::now();
+    for (cl_uint j = 0; j < jobs; j++)
+    {
+        const size_t offset = (size_t)j * workload.job_size;
+        error = clEnqueueNDRangeKernel(queues[j % queue_count], kernel, 1,
+                                       &offset, &global, NULL, 0, NULL,
+                                       &events[j]);
+        test_error(error, "clEnqueueNDRangeKernel() failed");
+    }
+    for (clCommandQueueWrapper &host_queue : queues)
+    {
+        error = clFlush(host_queue);
+        test_error(error, "clFlush() failed");
+    }
+    for (clCommandQueueWrapper &host_queue : queues)
+    {
+        error = clFinish(host_queue);
+        test_error(error, "clFinish() failed");
+    }
+    result.seconds = seconds_since(start);
+
+    cl_ulong first_start = CL_ULONG_MAX, last_end = 0;
+    double busy = 0.0;
+    for (clEventWrapper &event : events)
+    {
+        cl_ulong job_start = 0, job_end = 0;
+        error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                        sizeof(job_start), &job_start, NULL);
+        error |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                         sizeof(job_end), &job_end, NULL);
+        test_error(error, "clGetEventProfilingInfo() failed");
+        first_start = std::min(first_start, job_start);
+        last_end = std::max(last_end, job_end);
+        busy += (double)(job_end - job_start);
+    }
+    result.overlap =
+        last_end > first_start ? busy / (double)(last_end - first_start) : 0.0;
+
+    return Check();
+}
+
+cl_int
+MultiQueueScaling::RunDevice(const std::vector<cl_command_queue> &device_queues,
+                             cl_uint queue_count, ScalingResult &result)
+{
+    cl_int error = Reset();
+    test_error(error, "Unable to reset output");
+
+    std::string q_args, q_list;
+    for (cl_uint i = 0; i < queue_count; i++)
+    {
+        q_args += ", queue_t q" + std::to_string(i);
+        q_list += (i ? ", q" : "q") + std::to_string(i);
+    }
+    std::vector<char> cl(sizeof(multi_queue_scaling_parent) + q_args.size()
+                         + q_list.size() + 16);
+    snprintf(cl.data(), cl.size(), multi_queue_scaling_parent, q_args.c_str(),
+             q_list.c_str(), queue_count);
+    const char *source = cl.data();
+
+    clProgramWrapper parent_program;
+    clKernelWrapper parent;
+    error = create_single_kernel_helper(context, &parent_program, &parent, 1,
+                                        &source, "scaling_parent");
+    test_error(error, "Unable to create parent kernel");
+
+    clMemWrapper res = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                      sizeof(cl_int), NULL, &error);
+    test_error(error, "clCreateBuffer() failed");
+
+    const cl_uint memory_bound = workload.memory_bound;
+    error = clSetKernelArg(parent, 0, sizeof(out), &out);
+    error |= clSetKernelArg(parent, 1, sizeof(src), &src);
+    error |= clSetKernelArg(parent, 2, sizeof(res), &res);
+    error |= clSetKernelArg(parent, 3, sizeof(jobs), &jobs);
+    error |= clSetKernelArg(parent, 4, sizeof(workload.job_size),
+                            &workload.job_size);
+    error |= clSetKernelArg(parent, 5, sizeof(compute_iterations),
+                            &compute_iterations);
+    error |= clSetKernelArg(parent, 6, sizeof(memory_bound), &memory_bound);
+    for (cl_uint i = 0; i < queue_count; i++)
+        error |= clSetKernelArg(parent, 7 + i, sizeof(cl_command_queue),
+                                &device_queues[i]);
+    test_error(error, "clSetKernelArg() failed");
+
+    const size_t global = 1;
+    clock_type::time_point start = clock_type::now();
+    error = clEnqueueNDRangeKernel(queue, parent, 1, NULL, &global, NULL, 0,
+                                   NULL, NULL);
+    test_error(error, "clEnqueueNDRangeKernel() failed");
+    error = clFinish(queue);
+    test_error(error, "clFinish() failed");
+    result.seconds = seconds_since(start);
+    result.overlap = 0.0;
+
+    cl_int enqueue_result = 0;
+    error = clEnqueueReadBuffer(queue, res, CL_TRUE, 0, sizeof(enqueue_result),
+                                &enqueue_result, 0, NULL, NULL);
+    test_error(error, "clEnqueueReadBuffer() failed");
+    if (enqueue_result != CL_SUCCESS)
+    {
+        log_error("ERROR: enqueue_kernel from the parent kernel returned "
+                  "%d\n",
+                  enqueue_result);
+        return TEST_FAIL;
+    }
+    return Check();
+}
+
+void report(FILE *file, const char *queue_kind, const Workload &workload,
+            cl_uint queue_count, cl_uint jobs, const ScalingResult &result,
+            double single_seconds)
+{
+    double speedup = single_seconds / result.seconds;
+    log_info("  %-6s %-8s %3u queues %10.3f ms %6.2fx", queue_kind,
+             workload.name, queue_count, 1e3 * result.seconds, speedup);
+    if (result.overlap > 0.0) log_info("  overlap %5.2f", result.overlap);
+    log_info("\n");
+    log_perf(jobs / result.seconds, true, "jobs/s", "%s %s %u queues",
+             queue_kind, workload.name, queue_count);
+    if (file)
+        fprintf(file, "%s,%s,%u,%.4f,%.4f,%.4f\n", queue_kind, workload.name,
+                queue_count, 1e3 * result.seconds, speedup, result.overlap);
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(multi_queue_scaling)
+{
+    cl_uint max_device_queues = 0;
+    cl_uint max_queue_size = 0;
+    cl_ulong max_alloc = 0;
+    cl_int error =
+        clGetDeviceInfo(device, CL_DEVICE_MAX_ON_DEVICE_QUEUES,
+                        sizeof(max_device_queues), &max_device_queues, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_QUEUE_ON_DEVICE_MAX_SIZE,
+                             sizeof(max_queue_size), &max_queue_size, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                             sizeof(max_alloc), &max_alloc, NULL);
+    test_error(error, "clGetDeviceInfo() failed");
+
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    const cl_uint jobs = full_sweep ? scaling_jobs : scaling_smoke_jobs;
+    const cl_uint max_host_queues =
+        full_sweep ? scaling_max_host_queues : scaling_max_host_queues / 2;
+
+    // Memory-bound jobs are as large as the allocation limit allows
+    cl_uint memory_size = memory_job_size;
+    if (!full_sweep) memory_size /= 16;
+    while ((cl_ulong)memory_size * jobs * sizeof(cl_uint) > max_alloc)
+        memory_size /= 2;
+    const Workload workloads[] = {
+        { "compute", false, full_sweep ? compute_job_size
+                                       : compute_job_size / 16 },
+        { "memory", true, memory_size },
+    };
+
+    // The first device queue is the default one, the others are not
+    std::vector<clCommandQueueWrapper> device_queue_wrappers;
+    std::vector<cl_command_queue> device_queues;
+    const cl_uint device_queue_count =
+        std::min(max_device_queues, scaling_max_host_queues);
+    for (cl_uint i = 0; i < device_queue_count; i++)
+    {
+        cl_command_queue_properties queue_properties =
+            CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_ON_DEVICE;
+        if (i == 0) queue_properties |= CL_QUEUE_ON_DEVICE_DEFAULT;
+        cl_queue_properties properties[] = { CL_QUEUE_PROPERTIES,
+                                             queue_properties, CL_QUEUE_SIZE,
+                                             max_queue_size, 0 };
+        clCommandQueueWrapper device_queue =
+            clCreateCommandQueueWithProperties(context, device, properties,
+                                               &error);
+        test_error(error,
+                   "clCreateCommandQueueWithProperties(CL_QUEUE_ON_DEVICE) "
+                   "failed");
+        device_queues.push_back(device_queue);
+        device_queue_wrappers.push_back(std::move(device_queue));
+    }
+
+    FILE *file =
+        open_results_csv("CL_MULTI_QUEUE_SCALING_CSV",
+                         "queue_type,workload,queues,ms,speedup,overlap");
+    int res = 0;
+    for (const Workload &workload : workloads)
+    {
+        MultiQueueScaling scaling(device, context, queue);
+        error = scaling.Init(workload, jobs);
+        test_error(error, "Unable to set up multi-queue scaling");
+
+        log_info("%u %s jobs of %u work-items:\n", jobs, workload.name,
+                 workload.job_size);
+        double single_seconds = 0.0;
+        ScalingResult result;
+        for (cl_uint n = 1; n <= max_host_queues; n *= 2)
+        {
+            error = scaling.RunHost(n, result);
+            if (check_error(error, "'%s' jobs on %u host queues failed",
+                            workload.name, n))
+            {
+                res = -1;
+                break;
+            }
+            if (n == 1) single_seconds = result.seconds;
+            report(file, "host", workload, n, jobs, result, single_seconds);
+        }
+        if (res == 0 && max_host_queues > 1
+            && single_seconds / result.seconds < 1.1)
+            log_info("  %s jobs do not run faster on several host queues\n",
+                     workload.name);
+
+        for (cl_uint n = 1; n <= device_queues.size(); n *= 2)
+        {
+            error = scaling.RunDevice(device_queues, n, result);
+            if (check_error(error, "'%s' jobs on %u device queues failed",
+                            workload.name, n))
+            {
+                res = -1;
+                break;
+            }
+            if (n == 1) single_seconds = result.seconds;
+            report(file, "device", workload, n, jobs, result, single_seconds);
+        }
+    }
+
+    if (file) fclose(file);
+    return res;
+}
+#endif
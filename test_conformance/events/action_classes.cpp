@@ -755,3 +755,60 @@ cl_int MapImageAction::Execute(cl_command_queue queue, cl_uint numWaits,
 
     return CL_SUCCESS;
 }
+
+#pragma mark -------------------- Dependency Graph Classes -------------------------
+
+const char *DAGNodeKernelAction::GetSource(void)
+{
+    return "__kernel void dag_node(__global uint *depths,\n"
+           "                       __global const uint *pred_offsets,\n"
+           "                       __global const uint *preds, uint node)\n"
+           "{\n"
+           "    uint depth = 0;\n"
+           "    for (uint i = pred_offsets[node]; i < pred_offsets[node + 1]; "
+           "i++)\n"
+           "        depth = max(depth, depths[preds[i]]);\n"
+           "    depths[node] = depth + 1;\n"
+           "}\n";
+}
+
+cl_int DAGNodeKernelAction::Setup(cl_device_id device, cl_context context,
+                                  cl_command_queue queue)
+{
+    cl_int error;
+
+    mKernel = clCreateKernel(mProgram, "dag_node", &error);
+    test_error(error, "Unable to create dag_node kernel");
+
+    error = clSetKernelArg(mKernel, 0, sizeof(mDepths), &mDepths);
+    error |= clSetKernelArg(mKernel, 1, sizeof(mPredOffsets), &mPredOffsets);
+    error |= clSetKernelArg(mKernel, 2, sizeof(mPreds), &mPreds);
+    test_error(error, "Unable to set kernel arguments");
+
+    return CL_SUCCESS;
+}
+
+cl_int DAGNodeKernelAction::Execute(cl_command_queue queue, cl_uint numWaits,
+                                    cl_event *waits, cl_event *outEvent)
+{
+    size_t threads[1] = { 1 };
+
+    cl_int error = clSetKernelArg(mKernel, 3, sizeof(mNode), &mNode);
+    test_error(error, "Unable to set kernel arguments");
+
+    error = clEnqueueNDRangeKernel(queue, mKernel, 1, NULL, threads, threads,
+                                   numWaits, waits, outEvent);
+    test_error(error, "Unable to execute kernel");
+
+    return CL_SUCCESS;
+}
+
+cl_int MarkerAction::Execute(cl_command_queue queue, cl_uint numWaits,
+                             cl_event *waits, cl_event *outEvent)
+{
+    cl_int error =
+        clEnqueueMarkerWithWaitList(queue, numWaits, waits, outEvent);
+    test_error(error, "Unable to enqueue marker");
+
+    return CL_SUCCESS;
+}
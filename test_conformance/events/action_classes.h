@@ -338,5 +338,55 @@ public:
     virtual const char *GetName(void) const { return "MapImage"; }
 };
 
+// Single work-item kernel used as a node of a dependency graph. Node n stores
+// one more than the largest depth stored by its predecessors (taken from a
+// CSR list), so the depth buffer only matches the host's longest-path
+// computation if every wait list was honoured. Unlike the actions above this
+// one deliberately shares I/O with the other nodes of the graph.
+// Kernel arguments are per-instance state, so each submitting thread needs
+// its own instance.
+class DAGNodeKernelAction : public Action {
+public:
+    DAGNodeKernelAction(cl_program program, cl_mem depths, cl_mem predOffsets,
+                        cl_mem preds)
+        : mProgram(program), mDepths(depths), mPredOffsets(predOffsets),
+          mPreds(preds), mNode(0)
+    {}
+    virtual ~DAGNodeKernelAction() {}
+
+    static const char *GetSource(void);
+
+    void SetNode(cl_uint node) { mNode = node; }
+
+    virtual cl_int Setup(cl_device_id device, cl_context context,
+                         cl_command_queue queue);
+    virtual cl_int Execute(cl_command_queue queue, cl_uint numWaits,
+                           cl_event *waits, cl_event *outEvent);
+
+    virtual const char *GetName(void) const { return "DAGNodeKernel"; }
+
+protected:
+    cl_program mProgram;
+    cl_mem mDepths, mPredOffsets, mPreds;
+    cl_uint mNode;
+    clKernelWrapper mKernel;
+};
+
+// Marker that only forwards the completion of its wait list
+class MarkerAction : public Action {
+public:
+    MarkerAction() {}
+    virtual ~MarkerAction() {}
+
+    virtual cl_int Setup(cl_device_id device, cl_context context,
+                         cl_command_queue queue)
+    {
+        return CL_SUCCESS;
+    }
+    virtual cl_int Execute(cl_command_queue queue, cl_uint numWaits,
+                           cl_event *waits, cl_event *outEvent);
+
+    virtual const char *GetName(void) const { return "Marker"; }
+};
 
 #endif // _action_classes_h
@@ -0,0 +1,393 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "action_classes.h"
+#include "harness/mt19937.h"
+#include "harness/profilingStats.h"
+#include "harness/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define DAG_NODE_COUNT 4096
+#define DAG_MAX_PREDS 4
+#define DAG_PRED_WINDOW 64
+#define DAG_MARKER_PERCENT 15
+#define DAG_QUEUES_PER_KIND 2
+#define DAG_MAX_SUBMIT_THREADS 8
+
+namespace {
+
+struct DAGNode
+{
+    bool isMarker;
+    cl_uint queue;
+    std::vector<cl_uint> preds;
+    // Kernel nodes reachable through preds, looking through markers
+    std::vector<cl_uint> kernelPreds;
+};
+
+// Random DAG in topological order: every predecessor has a lower index.
+std::vector<DAGNode> generate_dag(MTdata d, cl_uint nodeCount,
+                                  cl_uint queueCount)
+{
+    std::vector<DAGNode> nodes(nodeCount);
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        DAGNode &node = nodes[i];
+        node.isMarker = i > 0 && genrand_int32(d) % 100 < DAG_MARKER_PERCENT;
+        node.queue = genrand_int32(d) % queueCount;
+
+        cl_uint window = std::min<cl_uint>(i, DAG_PRED_WINDOW);
+        cl_uint maxPreds = std::min<cl_uint>(window, DAG_MAX_PREDS);
+        cl_uint predCount = window ? genrand_int32(d) % (maxPreds + 1) : 0;
+        for (cl_uint p = 0; p < predCount; p++)
+        {
+            cl_uint pred = i - 1 - genrand_int32(d) % window;
+            if (std::find(node.preds.begin(), node.preds.end(), pred)
+                == node.preds.end())
+                node.preds.push_back(pred);
+        }
+
+        for (cl_uint pred : node.preds)
+        {
+            if (nodes[pred].isMarker)
+                node.kernelPreds.insert(node.kernelPreds.end(),
+                                        nodes[pred].kernelPreds.begin(),
+                                        nodes[pred].kernelPreds.end());
+            else
+                node.kernelPreds.push_back(pred);
+        }
+        std::sort(node.kernelPreds.begin(), node.kernelPreds.end());
+        node.kernelPreds.erase(
+            std::unique(node.kernelPreds.begin(), node.kernelPreds.end()),
+            node.kernelPreds.end());
+    }
+    return nodes;
+}
+
+struct SubmitState
+{
+    const std::vector<DAGNode> *nodes;
+    std::vector<cl_command_queue> queues;
+    cl_event gate;
+    std::unique_ptr<std::atomic<cl_event>[]> events;
+    std::atomic<bool> abort;
+    std::atomic<cl_int> error;
+};
+
+// Each thread submits the nodes with index % threadCount == threadIndex, in
+// order, once the events of their predecessors have been published by
+// whichever thread submitted them.
+void submit_nodes(SubmitState *state, DAGNodeKernelAction *kernelAction,
+                  cl_uint threadIndex, cl_uint threadCount, double *seconds)
+{
+    const std::vector<DAGNode> &nodes = *state->nodes;
+    MarkerAction markerAction;
+    std::vector<cl_event> waits;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = threadIndex; i < nodes.size(); i += threadCount)
+    {
+        const DAGNode &node = nodes[i];
+
+        waits.clear();
+        if (node.preds.empty()) waits.push_back(state->gate);
+        for (cl_uint pred : node.preds)
+        {
+            cl_event e;
+            while (NULL == (e = state->events[pred].load()))
+            {
+                if (state->abort.load()) return;
+                std::this_thread::yield();
+            }
+            waits.push_back(e);
+        }
+
+        cl_event event = NULL;
+        cl_int error;
+        if (node.isMarker)
+        {
+            error = markerAction.Execute(state->queues[node.queue],
+                                         (cl_uint)waits.size(), waits.data(),
+                                         &event);
+        }
+        else
+        {
+            kernelAction->SetNode((cl_uint)i);
+            error = kernelAction->Execute(state->queues[node.queue],
+                                          (cl_uint)waits.size(), waits.data(),
+                                          &event);
+        }
+        if (error != CL_SUCCESS)
+        {
+            state->error = error;
+            state->abort = true;
+            return;
+        }
+        state->events[i].store(event);
+    }
+
+    *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                             - start)
+                   .count();
+}
+
+cl_ulong get_profiling(cl_event event, cl_profiling_info param)
+{
+    cl_ulong value = 0;
+    clGetEventProfilingInfo(event, param, sizeof(value), &value, NULL);
+    return value;
+}
+
+} // namespace
+
+// Builds a random dependency graph of kernels and markers spread over in-order
+// and out-of-order queues, submits it from several host threads behind a user
+// event gate, and checks the data, the event states and the profiling order.
+// Reports the submission rate and the time from the end of the last
+// dependency to the start of each command.
+REGISTER_TEST(event_dag_stress)
+{
+    cl_int error;
+    MTdataHolder d(gRandomSeed);
+
+    cl_command_queue_properties queueProps = 0;
+    error = clGetDeviceInfo(device, CL_DEVICE_QUEUE_PROPERTIES,
+                            sizeof(queueProps), &queueProps, NULL);
+    test_error(error, "Unable to query device queue properties");
+    bool outOfOrder =
+        0 != (queueProps & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+    if (!outOfOrder)
+        log_info("\tOut-of-order queues are not supported, using in-order "
+                 "queues only.\n");
+
+    cl_uint queueCount = DAG_QUEUES_PER_KIND * 2;
+    std::vector<clCommandQueueWrapper> queues(queueCount);
+    for (cl_uint i = 0; i < queueCount; i++)
+    {
+        cl_command_queue_properties props = CL_QUEUE_PROFILING_ENABLE;
+        if (outOfOrder && i >= DAG_QUEUES_PER_KIND)
+            props |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+        queues[i] = clCreateCommandQueue(context, device, props, &error);
+        test_error(error, "Unable to create command queue");
+    }
+
+    const cl_uint nodeCount = DAG_NODE_COUNT;
+    std::vector<DAGNode> nodes = generate_dag(d, nodeCount, queueCount);
+
+    // Host reference and the CSR predecessor list for the kernels
+    std::vector<cl_uint> predOffsets(nodeCount + 1, 0);
+    std::vector<cl_uint> preds;
+    std::vector<cl_uint> expected(nodeCount, 0);
+    size_t edgeCount = 0;
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        predOffsets[i] = (cl_uint)preds.size();
+        edgeCount += nodes[i].preds.size();
+        if (nodes[i].isMarker) continue;
+        cl_uint depth = 0;
+        for (cl_uint pred : nodes[i].kernelPreds)
+        {
+            preds.push_back(pred);
+            depth = std::max(depth, expected[pred]);
+        }
+        expected[i] = depth + 1;
+    }
+    predOffsets[nodeCount] = (cl_uint)preds.size();
+    if (preds.empty()) preds.push_back(0);
+
+    clMemWrapper depthsBuffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE,
+                       sizeof(cl_uint) * nodeCount, NULL, &error);
+    test_error(error, "Unable to create depth buffer");
+    clMemWrapper offsetsBuffer = clCreateBuffer(
+        context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        sizeof(cl_uint) * predOffsets.size(), predOffsets.data(), &error);
+    test_error(error, "Unable to create predecessor offset buffer");
+    clMemWrapper predsBuffer = clCreateBuffer(
+        context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        sizeof(cl_uint) * preds.size(), preds.data(), &error);
+    test_error(error, "Unable to create predecessor buffer");
+
+    cl_uint zero = 0;
+    error = clEnqueueFillBuffer(queues[0], depthsBuffer, &zero, sizeof(zero), 0,
+                                sizeof(cl_uint) * nodeCount, 0, NULL, NULL);
+    test_error(error, "Unable to clear depth buffer");
+    error = clFinish(queues[0]);
+    test_error(error, "clFinish failed");
+
+    clProgramWrapper program;
+    const char *source = DAGNodeKernelAction::GetSource();
+    error = create_single_kernel_helper_create_program(context, &program, 1,
+                                                        &source);
+    test_error(error, "Unable to create dag_node program");
+    error = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
+    test_error(error, "Unable to build dag_node program");
+
+    cl_uint threadCount =
+        std::min<cl_uint>(GetThreadCount(), DAG_MAX_SUBMIT_THREADS);
+    std::vector<std::unique_ptr<DAGNodeKernelAction>> kernelActions;
+    for (cl_uint t = 0; t < threadCount; t++)
+    {
+        kernelActions.emplace_back(new DAGNodeKernelAction(
+            program, depthsBuffer, offsetsBuffer, predsBuffer));
+        error = kernelActions.back()->Setup(device, context, queue);
+        test_error(error, "Unable to set up dag_node action");
+    }
+
+    clEventWrapper gate = clCreateUserEvent(context, &error);
+    test_error(error, "Unable to create user gate event");
+
+    SubmitState state;
+    state.nodes = &nodes;
+    for (auto &q : queues) state.queues.push_back(q);
+    state.gate = gate;
+    state.events.reset(new std::atomic<cl_event>[nodeCount]);
+    for (cl_uint i = 0; i < nodeCount; i++) state.events[i] = NULL;
+    state.abort = false;
+    state.error = CL_SUCCESS;
+
+    log_info("\t%u nodes, %zu edges, %u queues (%s), %u submitting threads\n",
+             nodeCount, edgeCount, queueCount,
+             outOfOrder ? "half out-of-order" : "in-order", threadCount);
+
+    std::vector<double> threadSeconds(threadCount, 0.0);
+    std::vector<std::thread> threads;
+    auto submitStart = std::chrono::steady_clock::now();
+    for (cl_uint t = 0; t < threadCount; t++)
+        threads.emplace_back(submit_nodes, &state, kernelActions[t].get(), t,
+                             threadCount, &threadSeconds[t]);
+    for (auto &t : threads) t.join();
+    double submitSeconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - submitStart)
+                               .count();
+
+    // Release whatever was created before checking for errors
+    std::vector<clEventWrapper> events(nodeCount);
+    for (cl_uint i = 0; i < nodeCount; i++) events[i] = state.events[i].load();
+
+    if (state.error != CL_SUCCESS)
+    {
+        clSetUserEventStatus(gate, -1);
+        for (auto &q : queues) clFinish(q);
+        error = state.error;
+        test_error(error, "Unable to submit dependency graph");
+    }
+
+    // Nothing may have started while the gate is closed
+    int failures = 0;
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        cl_int status;
+        error = clGetEventInfo(events[i], CL_EVENT_COMMAND_EXECUTION_STATUS,
+                               sizeof(status), &status, NULL);
+        test_error(error, "Unable to get event status");
+        if (status == CL_RUNNING || status == CL_COMPLETE)
+        {
+            if (failures++ < 10)
+                log_error("ERROR: node %u (%s) started before the gate was "
+                          "opened (status %d)\n",
+                          i, nodes[i].isMarker ? "marker" : "kernel", status);
+        }
+    }
+
+    auto runStart = std::chrono::steady_clock::now();
+    error = clSetUserEventStatus(gate, CL_COMPLETE);
+    test_error(error, "Unable to open the gate");
+    for (auto &q : queues)
+    {
+        error = clFinish(q);
+        test_error(error, "clFinish failed");
+    }
+    double runSeconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - runStart)
+                            .count();
+
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        cl_int status;
+        error = clGetEventInfo(events[i], CL_EVENT_COMMAND_EXECUTION_STATUS,
+                               sizeof(status), &status, NULL);
+        test_error(error, "Unable to get event status");
+        if (status != CL_COMPLETE)
+        {
+            if (failures++ < 10)
+                log_error("ERROR: node %u did not complete (status %d)\n", i,
+                          status);
+        }
+    }
+
+    std::vector<cl_uint> depths(nodeCount);
+    error = clEnqueueReadBuffer(queues[0], depthsBuffer, CL_TRUE, 0,
+                                sizeof(cl_uint) * nodeCount, depths.data(), 0,
+                                NULL, NULL);
+    test_error(error, "Unable to read depth buffer");
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        if (depths[i] != expected[i])
+        {
+            if (failures++ < 10)
+                log_error("ERROR: node %u has depth %u, expected %u; a "
+                          "dependency was not honoured\n",
+                          i, depths[i], expected[i]);
+        }
+    }
+
+    // Time from the end of the last dependency to the start of the command.
+    // A command starting before a dependency ended is reported, but only the
+    // data check above is treated as a failure since timestamps from
+    // different queues may be coarse.
+    std::vector<double> latencies;
+    size_t earlyStarts = 0;
+    for (cl_uint i = 0; i < nodeCount; i++)
+    {
+        if (nodes[i].preds.empty()) continue;
+        cl_ulong start = get_profiling(events[i], CL_PROFILING_COMMAND_START);
+        cl_ulong lastEnd = 0;
+        for (cl_uint pred : nodes[i].preds)
+            lastEnd = std::max(
+                lastEnd, get_profiling(events[pred], CL_PROFILING_COMMAND_END));
+        if (start < lastEnd)
+            earlyStarts++;
+        else
+            latencies.push_back((double)(start - lastEnd) * 1e-3);
+    }
+    SampleStats latency = compute_sample_stats(latencies);
+    if (earlyStarts)
+        log_info("\tWARNING: %zu commands report a start time before the end "
+                 "of one of their dependencies\n",
+                 earlyStarts);
+
+    double maxThreadSeconds =
+        *std::max_element(threadSeconds.begin(), threadSeconds.end());
+    log_perf(nodeCount / submitSeconds, true, "commands/s",
+             "DAG submission rate (%u threads)", threadCount);
+    log_perf(nodeCount / threadCount / maxThreadSeconds, true, "commands/s",
+             "DAG submission rate per thread");
+    log_perf(nodeCount / runSeconds, true, "commands/s",
+             "DAG execution rate after gate");
+    log_perf(latency.median, false, "us",
+             "Dependency resolution latency p50");
+    log_perf(latency.p99, false, "us", "Dependency resolution latency p99");
+    log_perf(latency.max, false, "us", "Dependency resolution latency max");
+
+    return failures ? TEST_FAIL : TEST_PASS;
+}
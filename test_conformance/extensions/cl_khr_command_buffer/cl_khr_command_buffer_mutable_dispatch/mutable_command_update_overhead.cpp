@@ -0,0 +1,249 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "mutable_command_basic.h"
+#include "../command_buffer_overhead.h"
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark of the submission cost of mutable dispatches: a command-buffer of
+// N dispatches of the same kernel is updated with a new scalar argument for
+// every command through one clUpdateMutableCommandsKHR call and enqueued.
+// This is compared with setting the argument and enqueuing each dispatch
+// directly, which is what an application would otherwise do every frame.
+
+namespace {
+
+const size_t update_overhead_lengths[] = { 1, 4, 16, 64, 256 };
+
+struct MutableDispatchUpdateOverhead : public BasicMutableCommandBufferTest
+{
+    MutableDispatchUpdateOverhead(cl_device_id device, cl_context context,
+                                  cl_command_queue queue)
+        : BasicMutableCommandBufferTest(device, context, queue)
+    {}
+
+    bool Skip() override
+    {
+        cl_mutable_dispatch_fields_khr mutable_capabilities;
+
+        bool mutable_support =
+            !clGetDeviceInfo(
+                device, CL_DEVICE_MUTABLE_DISPATCH_CAPABILITIES_KHR,
+                sizeof(mutable_capabilities), &mutable_capabilities, nullptr)
+            && mutable_capabilities & CL_MUTABLE_DISPATCH_ARGUMENTS_KHR;
+
+        return !mutable_support || BasicMutableCommandBufferTest::Skip();
+    }
+
+    cl_int SetUpKernel() override
+    {
+        const char *add_kernel_str =
+            R"(
+            __kernel void add(int value, __global int *data)
+            {
+                size_t id = get_global_id(0);
+                data[id] += value;
+            })";
+
+        cl_int error = create_single_kernel_helper(
+            context, &program, &kernel, 1, &add_kernel_str, "add");
+        test_error(error, "Creating kernel failed");
+
+        return CL_SUCCESS;
+    }
+
+    cl_int SetUpKernelArgs() override
+    {
+        cl_int error = CL_SUCCESS;
+        out_mem = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeToAllocate,
+                                 nullptr, &error);
+        test_error(error, "clCreateBuffer failed");
+
+        const cl_int value = 0;
+        error = clSetKernelArg(kernel, 0, sizeof(value), &value);
+        test_error(error, "clSetKernelArg failed");
+
+        error = clSetKernelArg(kernel, 1, sizeof(out_mem), &out_mem);
+        test_error(error, "clSetKernelArg failed");
+
+        return CL_SUCCESS;
+    }
+
+    // Value added by command 'index' during submission 'rep'
+    static cl_int ValueFor(size_t rep, size_t index)
+    {
+        return static_cast<cl_int>((rep * 7 + index) % 13);
+    }
+
+    cl_int ResetBuffer()
+    {
+        const cl_int zero = 0;
+        cl_int error = clEnqueueFillBuffer(queue, out_mem, &zero, sizeof(zero),
+                                           0, sizeToAllocate, 0, nullptr,
+                                           nullptr);
+        test_error(error, "clEnqueueFillBuffer failed");
+        return clFinish(queue);
+    }
+
+    cl_int VerifyBuffer(size_t length, size_t submissions)
+    {
+        cl_int expected = 0;
+        for (size_t rep = 0; rep < submissions; rep++)
+            for (size_t i = 0; i < length; i++) expected += ValueFor(rep, i);
+
+        std::vector<cl_int> result(global_work_size);
+        cl_int error =
+            clEnqueueReadBuffer(queue, out_mem, CL_TRUE, 0, sizeToAllocate,
+                                result.data(), 0, nullptr, nullptr);
+        test_error(error, "clEnqueueReadBuffer failed");
+
+        for (size_t i = 0; i < global_work_size; i++)
+        {
+            CHECK_VERIFICATION_ERROR(expected, result[i], i);
+        }
+        return CL_SUCCESS;
+    }
+
+    cl_int MeasureLength(size_t length)
+    {
+        const size_t submissions = OVERHEAD_WARMUP_REPS + OVERHEAD_TIMED_REPS;
+        clCommandBufferWrapper recorded(this);
+        cl_int error = CL_SUCCESS;
+        const cl_command_buffer_properties_khr props[] = {
+            CL_COMMAND_BUFFER_FLAGS_KHR, CL_COMMAND_BUFFER_MUTABLE_KHR, 0
+        };
+        recorded = clCreateCommandBufferKHR(1, &queue, props, &error);
+        test_error(error, "clCreateCommandBufferKHR failed");
+
+        cl_command_properties_khr command_props[] = {
+            CL_MUTABLE_DISPATCH_UPDATABLE_FIELDS_KHR,
+            CL_MUTABLE_DISPATCH_ARGUMENTS_KHR, 0
+        };
+        std::vector<cl_mutable_command_khr> commands(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            error = clCommandNDRangeKernelKHR(
+                recorded, nullptr, command_props, kernel, 1, nullptr,
+                &global_work_size, nullptr, 0, nullptr, nullptr, &commands[i]);
+            test_error(error, "clCommandNDRangeKernelKHR failed");
+        }
+        error = clFinalizeCommandBufferKHR(recorded);
+        test_error(error, "clFinalizeCommandBufferKHR failed");
+
+        // One update config per command, all submitted in a single call
+        std::vector<cl_int> values(length);
+        std::vector<cl_mutable_dispatch_arg_khr> args(length);
+        std::vector<cl_mutable_dispatch_config_khr> dispatch_configs(length);
+        std::vector<cl_command_buffer_update_type_khr> config_types(
+            length, CL_STRUCTURE_TYPE_MUTABLE_DISPATCH_CONFIG_KHR);
+        std::vector<const void *> configs(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            args[i] = { 0, sizeof(cl_int), &values[i] };
+            dispatch_configs[i] = {
+                commands[i],
+                1 /* num_args */,
+                0 /* num_svm_arg */,
+                0 /* num_exec_infos */,
+                0 /* work_dim - 0 means no change to dimensions */,
+                &args[i] /* arg_list */,
+                nullptr /* arg_svm_list - nullptr means no change*/,
+                nullptr /* exec_info_list */,
+                nullptr /* global_work_offset */,
+                nullptr /* global_work_size */,
+                nullptr /* local_work_size */
+            };
+            configs[i] = &dispatch_configs[i];
+        }
+
+        OverheadSample direct, updated;
+        size_t rep = 0;
+
+        error = ResetBuffer();
+        test_error(error, "Failed to reset buffer");
+        error = measure_overhead(
+            queue,
+            [&]() {
+                for (size_t i = 0; i < length; i++)
+                {
+                    const cl_int value = ValueFor(rep, i);
+                    cl_int command_error =
+                        clSetKernelArg(kernel, 0, sizeof(value), &value);
+                    test_error(command_error, "clSetKernelArg failed");
+
+                    command_error = clEnqueueNDRangeKernel(
+                        queue, kernel, 1, nullptr, &global_work_size, nullptr,
+                        0, nullptr, nullptr);
+                    test_error(command_error, "clEnqueueNDRangeKernel failed");
+                }
+                rep++;
+                return CL_SUCCESS;
+            },
+            direct);
+        test_error(error, "Direct submission failed");
+        error = VerifyBuffer(length, submissions);
+        test_error(error, "Direct submission results are wrong");
+
+        rep = 0;
+        error = ResetBuffer();
+        test_error(error, "Failed to reset buffer");
+        error = measure_overhead(
+            queue,
+            [&]() {
+                for (size_t i = 0; i < length; i++)
+                    values[i] = ValueFor(rep, i);
+                rep++;
+
+                cl_int command_error = clUpdateMutableCommandsKHR(
+                    recorded, static_cast<cl_uint>(length),
+                    config_types.data(), configs.data());
+                test_error(command_error, "clUpdateMutableCommandsKHR failed");
+
+                return clEnqueueCommandBufferKHR(0, nullptr, recorded, 0,
+                                                 nullptr, nullptr);
+            },
+            updated);
+        test_error(error, "Command-buffer submission failed");
+        error = VerifyBuffer(length, submissions);
+        test_error(error, "Command-buffer submission results are wrong");
+
+        report_overhead("mutable_argument_update", length, direct, updated);
+        return CL_SUCCESS;
+    }
+
+    cl_int Run() override
+    {
+        log_overhead_header("mutable_argument_update");
+        for (size_t length : update_overhead_lengths)
+        {
+            cl_int error = MeasureLength(length);
+            test_error(error, "MeasureLength failed");
+        }
+        return CL_SUCCESS;
+    }
+
+    const size_t sizeToAllocate = global_work_size * sizeof(cl_int);
+};
+
+} // anonymous namespace
+
+REGISTER_TEST(mutable_command_update_overhead)
+{
+    return MakeAndRunTest<MutableDispatchUpdateOverhead>(device, context, queue,
+                                                         num_elements);
+}
@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "basic_command_buffer.h"
+#include "command_buffer_overhead.h"
+
+#include <vector>
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark of the submission cost of command-buffers: sequences of NDRange,
+// copy and fill commands of increasing length are recorded once, then both
+// replayed with clEnqueueCommandBufferKHR and enqueued directly to the queue.
+// The commands work on a few small buffers so that the measured time is
+// dominated by submission rather than by execution. The results of both
+// paths are checked against each other after the timed runs.
+
+const size_t overhead_lengths[] = { 1, 4, 16, 64, 256 };
+const size_t overhead_elements = 256;
+
+enum SequenceKind
+{
+    SEQUENCE_NDRANGE,
+    SEQUENCE_COPY,
+    SEQUENCE_FILL,
+    SEQUENCE_MIXED,
+};
+
+const char *sequence_names[] = { "ndrange", "copy", "fill", "mixed" };
+
+struct CommandBufferEnqueueOverhead : public BasicCommandBufferTest
+{
+    CommandBufferEnqueueOverhead(cl_device_id device, cl_context context,
+                                 cl_command_queue queue)
+        : BasicCommandBufferTest(device, context, queue)
+    {}
+
+    cl_int SetUpKernel() override
+    {
+        const char* increment_kernel_str =
+            R"(
+            __kernel void increment(__global int* data)
+            {
+                size_t id = get_global_id(0);
+                data[id]++;
+            })";
+
+        cl_int error = create_single_kernel_helper_create_program(
+            context, &program, 1, &increment_kernel_str);
+        test_error(error, "Failed to create program with source");
+
+        error = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
+        test_error(error, "Failed to build program");
+
+        kernel = clCreateKernel(program, "increment", &error);
+        test_error(error, "Failed to create increment kernel");
+
+        return CL_SUCCESS;
+    }
+
+    cl_int SetUpKernelArgs() override
+    {
+        cl_int error = CL_SUCCESS;
+        // in_mem is counted up by the kernel and copied to out_mem, fills
+        // write to fill_mem
+        in_mem = clCreateBuffer(context, CL_MEM_READ_WRITE, data_size(),
+                                nullptr, &error);
+        test_error(error, "clCreateBuffer failed");
+
+        out_mem = clCreateBuffer(context, CL_MEM_READ_WRITE, data_size(),
+                                 nullptr, &error);
+        test_error(error, "clCreateBuffer failed");
+
+        fill_mem = clCreateBuffer(context, CL_MEM_READ_WRITE, data_size(),
+                                  nullptr, &error);
+        test_error(error, "clCreateBuffer failed");
+
+        error = clSetKernelArg(kernel, 0, sizeof(in_mem), &in_mem);
+        test_error(error, "clSetKernelArg failed");
+
+        return CL_SUCCESS;
+    }
+
+    cl_int SetUp(int elements) override
+    {
+        return BasicCommandBufferTest::SetUp(
+            std::min(elements, (int)overhead_elements));
+    }
+
+    static cl_uint CommandType(SequenceKind kind, size_t index)
+    {
+        return kind == SEQUENCE_MIXED ? index % 3 : kind;
+    }
+
+    // Records or enqueues command 'index' of a sequence
+    cl_int AddCommand(cl_command_buffer_khr cmd_buf, SequenceKind kind,
+                      size_t index)
+    {
+        const cl_int fill_value = static_cast<cl_int>(index);
+        switch (CommandType(kind, index))
+        {
+            case SEQUENCE_NDRANGE:
+                return cmd_buf
+                    ? clCommandNDRangeKernelKHR(cmd_buf, nullptr, nullptr,
+                                                kernel, 1, nullptr,
+                                                &num_elements, nullptr, 0,
+                                                nullptr, nullptr, nullptr)
+                    : clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                             &num_elements, nullptr, 0,
+                                             nullptr, nullptr);
+            case SEQUENCE_COPY:
+                return cmd_buf
+                    ? clCommandCopyBufferKHR(cmd_buf, nullptr, nullptr, in_mem,
+                                             out_mem, 0, 0, data_size(), 0,
+                                             nullptr, nullptr, nullptr)
+                    : clEnqueueCopyBuffer(queue, in_mem, out_mem, 0, 0,
+                                          data_size(), 0, nullptr, nullptr);
+            default:
+                return cmd_buf
+                    ? clCommandFillBufferKHR(cmd_buf, nullptr, nullptr,
+                                             fill_mem, &fill_value,
+                                             sizeof(fill_value), 0,
+                                             data_size(), 0, nullptr, nullptr,
+                                             nullptr)
+                    : clEnqueueFillBuffer(queue, fill_mem, &fill_value,
+                                          sizeof(fill_value), 0, data_size(),
+                                          0, nullptr, nullptr);
+        }
+    }
+
+    cl_int ResetBuffers()
+    {
+        const cl_int zero = 0;
+        for (cl_mem mem : { in_mem, out_mem, fill_mem })
+        {
+            cl_int error =
+                clEnqueueFillBuffer(queue, mem, &zero, sizeof(zero), 0,
+                                    data_size(), 0, nullptr, nullptr);
+            test_error(error, "clEnqueueFillBuffer failed");
+        }
+        return clFinish(queue);
+    }
+
+    cl_int ReadBuffers(std::vector<cl_int>& contents)
+    {
+        contents.resize(3 * num_elements);
+        cl_mem mems[] = { in_mem, out_mem, fill_mem };
+        for (size_t i = 0; i < 3; i++)
+        {
+            cl_int error = clEnqueueReadBuffer(
+                queue, mems[i], CL_TRUE, 0, data_size(),
+                contents.data() + i * num_elements, 0, nullptr, nullptr);
+            test_error(error, "clEnqueueReadBuffer failed");
+        }
+        return CL_SUCCESS;
+    }
+
+    cl_int MeasureSequence(SequenceKind kind, size_t length)
+    {
+        clCommandBufferWrapper recorded(this);
+        cl_int error = CL_SUCCESS;
+        recorded = clCreateCommandBufferKHR(1, &queue, nullptr, &error);
+        test_error(error, "clCreateCommandBufferKHR failed");
+
+        for (size_t i = 0; i < length; i++)
+        {
+            error = AddCommand(recorded, kind, i);
+            test_error(error, "Failed to record command");
+        }
+        error = clFinalizeCommandBufferKHR(recorded);
+        test_error(error, "clFinalizeCommandBufferKHR failed");
+
+        OverheadSample direct, replayed;
+        std::vector<cl_int> direct_contents, replayed_contents;
+
+        error = ResetBuffers();
+        test_error(error, "Failed to reset buffers");
+        error = measure_overhead(
+            queue,
+            [&]() {
+                for (size_t i = 0; i < length; i++)
+                {
+                    cl_int command_error = AddCommand(nullptr, kind, i);
+                    test_error(command_error, "Failed to enqueue command");
+                }
+                return CL_SUCCESS;
+            },
+            direct);
+        test_error(error, "Direct submission failed");
+        error = ReadBuffers(direct_contents);
+        test_error(error, "Failed to read results");
+
+        error = ResetBuffers();
+        test_error(error, "Failed to reset buffers");
+        error = measure_overhead(
+            queue,
+            [&]() {
+                return clEnqueueCommandBufferKHR(0, nullptr, recorded, 0,
+                                                 nullptr, nullptr);
+            },
+            replayed);
+        test_error(error, "Command-buffer submission failed");
+        error = ReadBuffers(replayed_contents);
+        test_error(error, "Failed to read results");
+
+        for (size_t i = 0; i < direct_contents.size(); i++)
+        {
+            CHECK_VERIFICATION_ERROR(direct_contents[i], replayed_contents[i],
+                                     i);
+        }
+
+        report_overhead(sequence_names[kind], length, direct, replayed);
+        return CL_SUCCESS;
+    }
+
+    cl_int Run() override
+    {
+        for (SequenceKind kind : { SEQUENCE_NDRANGE, SEQUENCE_COPY,
+                                   SEQUENCE_FILL, SEQUENCE_MIXED })
+        {
+            log_overhead_header(sequence_names[kind]);
+            for (size_t length : overhead_lengths)
+            {
+                cl_int error = MeasureSequence(kind, length);
+                test_error(error, "MeasureSequence failed");
+            }
+        }
+        return CL_SUCCESS;
+    }
+
+    clMemWrapper fill_mem;
+};
+} // anonymous namespace
+
+REGISTER_TEST(command_buffer_enqueue_overhead)
+{
+    return MakeAndRunTest<CommandBufferEnqueueOverhead>(device, context, queue,
+                                                        num_elements);
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CL_KHR_COMMAND_BUFFER_OVERHEAD_H
+#define CL_KHR_COMMAND_BUFFER_OVERHEAD_H
+
+#include "harness/csvHelpers.h"
+#include "harness/testHarness.h"
+#include "harness/profilingStats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+// Helpers shared by the command-buffer submission overhead benchmarks, which
+// compare replaying a recorded command-buffer with enqueuing the same
+// commands directly. Results are logged and, if
+// CL_COMMAND_BUFFER_OVERHEAD_CSV names a file, appended to it as CSV.
+
+#define OVERHEAD_WARMUP_REPS 2
+#define OVERHEAD_TIMED_REPS 15
+
+// Costs of one submission, in microseconds. submit is the wall time spent in
+// the enqueue calls, latency runs until clFinish returns and cpu is the
+// process CPU time over the same interval, which includes driver threads.
+struct OverheadSample
+{
+    double submit;
+    double latency;
+    double cpu;
+};
+
+// Runs submit OVERHEAD_TIMED_REPS times after a warm-up, each time followed
+// by clFinish, and returns the per-field medians
+template <typename Submit>
+cl_int measure_overhead(cl_command_queue queue, Submit submit,
+                        OverheadSample &median)
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<double> submit_us, latency_us, cpu_us;
+
+    for (int rep = 0; rep < OVERHEAD_WARMUP_REPS + OVERHEAD_TIMED_REPS; rep++)
+    {
+        std::clock_t cpu_start = std::clock();
+        clock::time_point start = clock::now();
+
+        cl_int error = submit();
+        test_error(error, "Submission failed");
+        clock::time_point submitted = clock::now();
+
+        error = clFinish(queue);
+        test_error(error, "clFinish failed");
+        clock::time_point finished = clock::now();
+        std::clock_t cpu_end = std::clock();
+
+        if (rep < OVERHEAD_WARMUP_REPS) continue;
+        submit_us.push_back(
+            std::chrono::duration<double, std::micro>(submitted - start)
+                .count());
+        latency_us.push_back(
+            std::chrono::duration<double, std::micro>(finished - start)
+                .count());
+        cpu_us.push_back((cpu_end - cpu_start) * 1e6 / CLOCKS_PER_SEC);
+    }
+
+    median.submit = compute_sample_stats(submit_us).median;
+    median.latency = compute_sample_stats(latency_us).median;
+    median.cpu = compute_sample_stats(cpu_us).median;
+    return CL_SUCCESS;
+}
+
+inline void write_overhead_csv(const char *benchmark, size_t commands,
+                               const OverheadSample &direct,
+                               const OverheadSample &command_buffer)
+{
+    FILE *file = open_results_csv(
+        "CL_COMMAND_BUFFER_OVERHEAD_CSV",
+        "benchmark,commands,direct_submit_us,direct_latency_us,direct_cpu_us,"
+        "command_buffer_submit_us,command_buffer_latency_us,"
+        "command_buffer_cpu_us");
+    if (file == NULL) return;
+
+    fprintf(file, "%s,%zu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", benchmark, commands,
+            direct.submit, direct.latency, direct.cpu, command_buffer.submit,
+            command_buffer.latency, command_buffer.cpu);
+    fclose(file);
+}
+
+inline void log_overhead_header(const char *benchmark)
+{
+    log_info("%s (median microseconds over %d submissions)\n", benchmark,
+             OVERHEAD_TIMED_REPS);
+    log_info("%8s %10s %10s %10s %10s %10s %10s\n", "commands", "q.submit",
+             "q.latency", "q.cpu", "cb.submit", "cb.latency", "cb.cpu");
+}
+
+inline void report_overhead(const char *benchmark, size_t commands,
+                            const OverheadSample &direct,
+                            const OverheadSample &command_buffer)
+{
+    log_info("%8zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", commands,
+             direct.submit, direct.latency, direct.cpu, command_buffer.submit,
+             command_buffer.latency, command_buffer.cpu);
+    log_perf(direct.submit / commands, false, "us/command",
+             "%s direct submission, %zu commands", benchmark, commands);
+    log_perf(command_buffer.submit / commands, false, "us/command",
+             "%s command-buffer submission, %zu commands", benchmark,
+             commands);
+    write_overhead_csv(benchmark, commands, direct, command_buffer);
+}
+
+#endif // CL_KHR_COMMAND_BUFFER_OVERHEAD_H
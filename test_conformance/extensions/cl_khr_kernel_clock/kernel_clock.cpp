@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
-#include "harness/typeWrappers.h"
+#include "kernel_clock.h"
 
 namespace {
 
@@ -41,135 +41,63 @@ static const char *kernel_sources[2] = {
     })",
 };
 
-class KernelClockTest {
-
-public:
-    KernelClockTest(cl_device_id device, cl_context context,
-                    cl_command_queue queue,
-                    cl_device_kernel_clock_capabilities_khr capability)
-        : device(device), context(context), queue(queue), capability(capability)
-    {}
+}
 
-    bool Skip()
+cl_int KernelClockTest::RunTest()
+{
+    size_t global_size = 1;
+    cl_uint buf = 0;
+    char kernel_src[512];
+    const char *ptr;
+    cl_int error;
+
+    // 2 built-ins for each scope
+    for (size_t i = 0; i < 2; i++)
     {
-        cl_device_kernel_clock_capabilities_khr capabilities;
-        cl_int error =
-            clGetDeviceInfo(device, CL_DEVICE_KERNEL_CLOCK_CAPABILITIES_KHR,
-                            sizeof(cl_device_kernel_clock_capabilities_khr),
-                            &capabilities, NULL);
-        test_error(error,
-                   "Unable to query "
-                   "CL_DEVICE_KERNEL_CLOCK_CAPABILITIES_KHR");
-
-        // Skip if capability is not supported
-        return capability != (capabilities & capability);
-    }
+        buf = 0;
+        clProgramWrapper program;
+        clKernelWrapper kernel;
+        clMemWrapper out_mem;
 
-    cl_int RunTest()
-    {
-        size_t global_size = 1;
-        cl_uint buf = 0;
-        char kernel_src[512];
-        const char *ptr;
-        cl_int error;
-
-        // 2 built-ins for each scope
-        for (size_t i = 0; i < 2; i++)
+        if (i == 0 && !gHasLong)
         {
-            buf = 0;
-            clProgramWrapper program;
-            clKernelWrapper kernel;
-            clMemWrapper out_mem;
-
-            if (i == 0 && !gHasLong)
-            {
-                log_info("The device does not support ulong. Testing hilo "
-                         "built-ins only\n");
-                continue;
-            }
-
-            switch (capability)
-            {
-                case CL_DEVICE_KERNEL_CLOCK_SCOPE_DEVICE_KHR: {
-                    sprintf(kernel_src, kernel_sources[i], "device", "device");
-                    break;
-                }
-                case CL_DEVICE_KERNEL_CLOCK_SCOPE_WORK_GROUP_KHR: {
-                    sprintf(kernel_src, kernel_sources[i], "work_group",
-                            "work_group");
-                    break;
-                }
-                case CL_DEVICE_KERNEL_CLOCK_SCOPE_SUB_GROUP_KHR: {
-                    sprintf(kernel_src, kernel_sources[i], "sub_group",
-                            "sub_group");
-                    break;
-                }
-            }
-
-            ptr = kernel_src;
-
-            error = create_single_kernel_helper(context, &program, &kernel, 1,
-                                                &ptr, "SampleClock");
-            test_error(error, "Failed to create program with source");
-
-            out_mem = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
-                                     sizeof(cl_uint), nullptr, &error);
-            test_error(error, "clCreateBuffer failed");
-
-            error = clSetKernelArg(kernel, 0, sizeof(out_mem), &out_mem);
-            test_error(error, "clSetKernelArg failed");
-
-            error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global_size,
-                                           NULL, 0, NULL, NULL);
-            test_error(error, "clNDRangeKernel failed");
-
-            error = clEnqueueReadBuffer(queue, out_mem, CL_BLOCKING, 0,
-                                        sizeof(cl_uint), &buf, 0, NULL, NULL);
-            test_error(error, "clEnqueueReadBuffer failed");
-
-            if (buf == 1)
-            {
-                log_error(
-                    "Sampling the clock returned bad values, time1 > time2.\n");
-                return TEST_FAIL;
-            }
+            log_info("The device does not support ulong. Testing hilo "
+                     "built-ins only\n");
+            continue;
         }
 
-        return CL_SUCCESS;
-    }
+        sprintf(kernel_src, kernel_sources[i], ScopeName(), ScopeName());
 
-private:
-    cl_device_id device;
-    cl_context context;
-    cl_command_queue queue;
-    cl_device_kernel_clock_capabilities_khr capability;
-};
+        ptr = kernel_src;
 
-int MakeAndRunTest(cl_device_id device, cl_context context,
-                   cl_command_queue queue,
-                   cl_device_kernel_clock_capabilities_khr capability)
-{
-    if (!is_extension_available(device, "cl_khr_kernel_clock"))
-    {
-        log_info(
-            "The device does not support the cl_khr_kernel_clock extension.\n");
-        return TEST_SKIPPED_ITSELF;
-    }
+        error = create_single_kernel_helper(context, &program, &kernel, 1,
+                                            &ptr, "SampleClock");
+        test_error(error, "Failed to create program with source");
 
-    KernelClockTest test_fixture =
-        KernelClockTest(device, context, queue, capability);
+        out_mem = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                                 sizeof(cl_uint), nullptr, &error);
+        test_error(error, "clCreateBuffer failed");
 
-    if (test_fixture.Skip())
-    {
-        return TEST_SKIPPED_ITSELF;
-    }
+        error = clSetKernelArg(kernel, 0, sizeof(out_mem), &out_mem);
+        test_error(error, "clSetKernelArg failed");
 
-    cl_int error = test_fixture.RunTest();
-    test_error_ret(error, "Test Failed", TEST_FAIL);
+        error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global_size,
+                                       NULL, 0, NULL, NULL);
+        test_error(error, "clNDRangeKernel failed");
 
-    return TEST_PASS;
-}
+        error = clEnqueueReadBuffer(queue, out_mem, CL_BLOCKING, 0,
+                                    sizeof(cl_uint), &buf, 0, NULL, NULL);
+        test_error(error, "clEnqueueReadBuffer failed");
+
+        if (buf == 1)
+        {
+            log_error(
+                "Sampling the clock returned bad values, time1 > time2.\n");
+            return TEST_FAIL;
+        }
+    }
 
+    return CL_SUCCESS;
 }
 
 REGISTER_TEST(device_scope)
@@ -0,0 +1,93 @@
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef CL_KHR_KERNEL_CLOCK_H
+#define CL_KHR_KERNEL_CLOCK_H
+
+#include "harness/typeWrappers.h"
+
+class KernelClockTest {
+
+public:
+    KernelClockTest(cl_device_id device, cl_context context,
+                    cl_command_queue queue,
+                    cl_device_kernel_clock_capabilities_khr capability)
+        : device(device), context(context), queue(queue), capability(capability)
+    {}
+
+    virtual ~KernelClockTest() = default;
+
+    bool Skip()
+    {
+        cl_device_kernel_clock_capabilities_khr capabilities;
+        cl_int error =
+            clGetDeviceInfo(device, CL_DEVICE_KERNEL_CLOCK_CAPABILITIES_KHR,
+                            sizeof(cl_device_kernel_clock_capabilities_khr),
+                            &capabilities, NULL);
+        test_error(error,
+                   "Unable to query "
+                   "CL_DEVICE_KERNEL_CLOCK_CAPABILITIES_KHR");
+
+        // Skip if capability is not supported
+        return capability != (capabilities & capability);
+    }
+
+    // Suffix of the clock_read_* built-ins for the tested scope
+    const char *ScopeName() const
+    {
+        switch (capability)
+        {
+            case CL_DEVICE_KERNEL_CLOCK_SCOPE_DEVICE_KHR: return "device";
+            case CL_DEVICE_KERNEL_CLOCK_SCOPE_WORK_GROUP_KHR:
+                return "work_group";
+            case CL_DEVICE_KERNEL_CLOCK_SCOPE_SUB_GROUP_KHR: return "sub_group";
+        }
+        return "";
+    }
+
+    virtual cl_int RunTest();
+
+protected:
+    cl_device_id device;
+    cl_context context;
+    cl_command_queue queue;
+    cl_device_kernel_clock_capabilities_khr capability;
+};
+
+template <class T = KernelClockTest>
+int MakeAndRunTest(cl_device_id device, cl_context context,
+                   cl_command_queue queue,
+                   cl_device_kernel_clock_capabilities_khr capability)
+{
+    if (!is_extension_available(device, "cl_khr_kernel_clock"))
+    {
+        log_info(
+            "The device does not support the cl_khr_kernel_clock extension.\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    T test_fixture = T(device, context, queue, capability);
+
+    if (test_fixture.Skip())
+    {
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    cl_int error = test_fixture.RunTest();
+    test_error_ret(error, "Test Failed", TEST_FAIL);
+
+    return TEST_PASS;
+}
+
+#endif // CL_KHR_KERNEL_CLOCK_H
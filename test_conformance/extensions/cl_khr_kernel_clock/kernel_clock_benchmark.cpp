@@ -0,0 +1,412 @@
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "kernel_clock.h"
+#include "harness/csvHelpers.h"
+#include "harness/profilingStats.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Each timed loop iteration repeats the operation this many times
+const int bench_unroll = 16;
+// Number of timed loop iterations per work-item
+const cl_int bench_iterations = 64;
+// Number of launches whose samples are pooled for each operation
+const int bench_launches = 5;
+// Work-group size used for all launches, clamped to the device limit
+const size_t bench_max_work_group_size = 64;
+
+// Floating-point operations are measured as a dependent chain. Multiplying
+// the result by zero and adding the original input keeps the value stable
+// without letting the compiler drop the call, since the multiplication cannot
+// be folded when NaNs and infinities have to be preserved.
+const char *bench_prelude = R"(
+#define CHAIN(v) x = (v) * 0.0f + x0
+)";
+
+const char *bench_kernel_pattern = R"(
+__kernel void bench_%zu(__global uint *cycles, __global float *data,
+                        __global int *counters, int iterations)
+{
+    __local int lmem[BENCH_WG_SIZE];
+    __local int lcounters[BENCH_WG_SIZE];
+    __local int lscratch[BENCH_WG_SIZE];
+    __local int lcounter;
+    volatile __local int *vscratch = lscratch;
+    size_t gid = get_global_id(0);
+    size_t lid = get_local_id(0);
+    float x0 = data[gid];
+    float x = x0;
+    float y = x0 + 0.5f;
+    int idx = (int)lid;
+
+    lmem[lid] = (int)((lid + 1) %% BENCH_WG_SIZE);
+    lcounters[lid] = 0;
+    lscratch[lid] = 0;
+    if (lid == 0) lcounter = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    BENCH_CLOCK_T start = BENCH_CLOCK();
+    for (int i = 0; i < iterations; i++)
+    {
+%s
+    }
+    BENCH_CLOCK_T end = BENCH_CLOCK();
+
+    cycles[gid] = BENCH_ELAPSED(start, end);
+    data[gid] = x + (float)idx;
+}
+)";
+
+struct ClockOp
+{
+    std::string name;
+    const char *category;
+    std::string body;
+    // Index of the operation whose cost is subtracted, -1 for none
+    int baseline;
+    bool needs_subgroups;
+};
+
+enum
+{
+    OP_EMPTY = 0,
+    OP_CHAIN = 1
+};
+
+// Float functions from the math_brute_force function list that take their
+// inputs in [0.25, 0.75] without producing NaNs
+const char *unary_math_functions[] = {
+    "acos",        "acospi",     "asin",        "asinh",       "asinpi",
+    "atan",        "atanh",      "atanpi",      "cbrt",        "ceil",
+    "cos",         "cosh",       "cospi",       "erf",         "erfc",
+    "exp",         "exp2",       "exp10",       "expm1",       "fabs",
+    "floor",       "lgamma",     "log",         "log10",       "log1p",
+    "log2",        "logb",       "rint",        "round",       "rsqrt",
+    "sin",         "sinh",       "sinpi",       "sqrt",        "tan",
+    "tanh",        "tanpi",      "tgamma",      "trunc",       "half_cos",
+    "half_exp",    "half_exp2",  "half_exp10",  "half_log",    "half_log2",
+    "half_log10",  "half_recip", "half_rsqrt",  "half_sin",    "half_sqrt",
+    "half_tan",    "native_cos", "native_exp",  "native_exp2", "native_exp10",
+    "native_log",  "native_log2", "native_log10", "native_recip",
+    "native_rsqrt", "native_sin", "native_sqrt", "native_tan",
+};
+
+const char *binary_math_functions[] = {
+    "atan2",      "atan2pi",     "copysign",      "fdim",
+    "fmax",       "fmin",        "fmod",          "hypot",
+    "maxmag",     "minmag",      "nextafter",     "pow",
+    "powr",       "remainder",   "half_divide",   "half_powr",
+    "native_divide", "native_powr",
+};
+
+const char *ternary_math_functions[] = { "fma", "mad" };
+
+std::vector<ClockOp> build_op_list()
+{
+    std::vector<ClockOp> ops;
+
+    ops.push_back({ "empty", "baseline", "", -1, false });
+    ops.push_back({ "chain", "baseline", "CHAIN(x);", OP_EMPTY, false });
+
+    for (const char *fn : unary_math_functions)
+        ops.push_back({ fn, "math", std::string("CHAIN(") + fn + "(x));",
+                        OP_CHAIN, false });
+    for (const char *fn : binary_math_functions)
+        ops.push_back({ fn, "math", std::string("CHAIN(") + fn + "(x, y));",
+                        OP_CHAIN, false });
+    for (const char *fn : ternary_math_functions)
+        ops.push_back({ fn, "math",
+                        std::string("CHAIN(") + fn + "(x, y, x0));", OP_CHAIN,
+                        false });
+    ops.push_back({ "divide", "math", "CHAIN(x / y);", OP_CHAIN, false });
+    ops.push_back({ "multiply", "math", "CHAIN(x * y);", OP_CHAIN, false });
+
+    ops.push_back({ "atomic_add_global_contended", "atomic",
+                    "idx += atomic_add(&counters[0], 1) & 1;", OP_EMPTY,
+                    false });
+    ops.push_back({ "atomic_add_global", "atomic",
+                    "idx += atomic_add(&counters[1 + gid], 1) & 1;", OP_EMPTY,
+                    false });
+    ops.push_back({ "atomic_cmpxchg_global", "atomic",
+                    "idx += atomic_cmpxchg(&counters[1 + gid], idx, idx + 1) "
+                    "& 1;",
+                    OP_EMPTY, false });
+    ops.push_back({ "atomic_add_local_contended", "atomic",
+                    "idx += atomic_add(&lcounter, 1) & 1;", OP_EMPTY, false });
+    ops.push_back({ "atomic_add_local", "atomic",
+                    "idx += atomic_add(&lcounters[lid], 1) & 1;", OP_EMPTY,
+                    false });
+
+    ops.push_back({ "barrier_local", "barrier",
+                    "barrier(CLK_LOCAL_MEM_FENCE);", OP_EMPTY, false });
+    ops.push_back({ "barrier_global", "barrier",
+                    "barrier(CLK_GLOBAL_MEM_FENCE);", OP_EMPTY, false });
+
+    ops.push_back({ "local_load_dependent", "local_memory", "idx = lmem[idx];",
+                    OP_EMPTY, false });
+    ops.push_back({ "local_store_load", "local_memory",
+                    "vscratch[lid] = idx + 1; idx = vscratch[lid] & 1;",
+                    OP_EMPTY, false });
+
+    ops.push_back({ "sub_group_barrier", "sub_group",
+                    "sub_group_barrier(CLK_LOCAL_MEM_FENCE);", OP_EMPTY,
+                    true });
+    ops.push_back({ "sub_group_broadcast", "sub_group",
+                    "CHAIN(sub_group_broadcast(x, 0));", OP_CHAIN, true });
+    ops.push_back({ "sub_group_reduce_add", "sub_group",
+                    "CHAIN(sub_group_reduce_add(x));", OP_CHAIN, true });
+    ops.push_back({ "sub_group_scan_inclusive_add", "sub_group",
+                    "CHAIN(sub_group_scan_inclusive_add(x));", OP_CHAIN,
+                    true });
+    ops.push_back({ "sub_group_any", "sub_group",
+                    "idx += sub_group_any(idx > (int)BENCH_WG_SIZE);",
+                    OP_EMPTY, true });
+
+    return ops;
+}
+
+void write_cost_table(const char *scope, const ClockOp &op, double net,
+                      double raw)
+{
+    FILE *file = open_results_csv(
+        "CL_KERNEL_CLOCK_COST_TABLE",
+        "scope,category,operation,cycles_per_op,raw_cycles_per_op");
+    if (file == NULL) return;
+
+    fprintf(file, "%s,%s,%s,%.2f,%.2f\n", scope, op.category, op.name.c_str(),
+            net, raw);
+    fclose(file);
+}
+
+// Measures the per-work-item cost of a list of built-ins with the
+// clock_read_* functions of the tested scope. All operations are built as one
+// program. The cost of an operation is the median cycle count of its timed
+// loop minus that of its baseline loop, divided by the number of operations
+// executed; the raw cost only subtracts the cost of reading the clock.
+class KernelClockBenchmark : public KernelClockTest {
+
+public:
+    KernelClockBenchmark(cl_device_id device, cl_context context,
+                         cl_command_queue queue,
+                         cl_device_kernel_clock_capabilities_khr capability)
+        : KernelClockTest(device, context, queue, capability)
+    {}
+
+    cl_int RunTest() override
+    {
+        cl_int error;
+        std::vector<ClockOp> ops = build_op_list();
+        bool has_subgroups = is_extension_available(device, "cl_khr_subgroups");
+
+        size_t max_work_group_size = 0;
+        error = clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE,
+                                sizeof(max_work_group_size),
+                                &max_work_group_size, NULL);
+        test_error(error, "Unable to query CL_DEVICE_MAX_WORK_GROUP_SIZE");
+        work_group_size =
+            std::min(max_work_group_size, bench_max_work_group_size);
+
+        std::string source;
+        if (has_subgroups)
+            source += "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n";
+        if (gHasLong)
+        {
+            source += "#define BENCH_CLOCK_T ulong\n";
+            source += std::string("#define BENCH_CLOCK() clock_read_")
+                + ScopeName() + "()\n";
+            source += "#define BENCH_ELAPSED(a, b) (uint)((b) - (a))\n";
+        }
+        else
+        {
+            source += "#define BENCH_CLOCK_T uint2\n";
+            source += std::string("#define BENCH_CLOCK() clock_read_hilo_")
+                + ScopeName() + "()\n";
+            source += "#define BENCH_ELAPSED(a, b) ((b).lo - (a).lo)\n";
+        }
+        source += bench_prelude;
+
+        std::vector<char> kernel_source;
+        for (size_t i = 0; i < ops.size(); i++)
+        {
+            if (ops[i].needs_subgroups && !has_subgroups) continue;
+
+            std::string body;
+            for (int u = 0; u < bench_unroll; u++)
+                body += "        " + ops[i].body + "\n";
+            kernel_source.resize(strlen(bench_kernel_pattern) + body.size()
+                                 + 32);
+            sprintf(kernel_source.data(), bench_kernel_pattern, i,
+                    body.c_str());
+            source += kernel_source.data();
+        }
+
+        std::string options =
+            "-DBENCH_WG_SIZE=" + std::to_string(work_group_size);
+        const char *source_ptr = source.c_str();
+        clProgramWrapper program;
+        clKernelWrapper empty_kernel;
+        error = create_single_kernel_helper(context, &program, &empty_kernel,
+                                            1, &source_ptr, "bench_0",
+                                            options.c_str());
+        test_error(error, "Unable to create benchmark program");
+
+        size_t global_size = work_group_size;
+        data = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                              sizeof(cl_float) * global_size, NULL, &error);
+        test_error(error, "clCreateBuffer failed");
+        counters = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                  sizeof(cl_int) * (global_size + 1), NULL,
+                                  &error);
+        test_error(error, "clCreateBuffer failed");
+        cycles = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                                sizeof(cl_uint) * global_size, NULL, &error);
+        test_error(error, "clCreateBuffer failed");
+
+        // Back-to-back clock reads give the overhead to subtract
+        double overhead;
+        error = MeasureMedian(empty_kernel, 0, &overhead);
+        test_error(error, "Unable to measure the clock overhead");
+
+        const double ops_per_item = (double)bench_unroll * bench_iterations;
+        std::vector<double> medians(ops.size(), -1.0);
+
+        log_info("clock_read_%s%s overhead: %.1f cycles, %zu work-items, "
+                 "%d ops per work-item\n",
+                 gHasLong ? "" : "hilo_", ScopeName(), overhead,
+                 work_group_size, (int)ops_per_item);
+        log_info("%-30s %-14s %12s %12s\n", "operation", "category",
+                 "cycles/op", "raw");
+
+        for (size_t i = 0; i < ops.size(); i++)
+        {
+            const ClockOp &op = ops[i];
+            if (op.needs_subgroups && !has_subgroups) continue;
+
+            clKernelWrapper kernel;
+            std::string name = "bench_" + std::to_string(i);
+            kernel = clCreateKernel(program, name.c_str(), &error);
+            test_error(error, "clCreateKernel failed");
+
+            size_t kernel_work_group_size = 0;
+            error = clGetKernelWorkGroupInfo(
+                kernel, device, CL_KERNEL_WORK_GROUP_SIZE,
+                sizeof(kernel_work_group_size), &kernel_work_group_size, NULL);
+            test_error(error, "clGetKernelWorkGroupInfo failed");
+            if (kernel_work_group_size < work_group_size)
+            {
+                log_info("%-30s skipped, kernel work-group size %zu is too "
+                         "small\n",
+                         op.name.c_str(), kernel_work_group_size);
+                continue;
+            }
+
+            error = MeasureMedian(kernel, bench_iterations, &medians[i]);
+            test_error(error, "Unable to measure operation");
+
+            double raw = (medians[i] - overhead) / ops_per_item;
+            double net = raw;
+            if (op.baseline >= 0 && medians[op.baseline] >= 0.0)
+                net = (medians[i] - medians[op.baseline]) / ops_per_item;
+
+            log_info("%-30s %-14s %12.2f %12.2f\n", op.name.c_str(),
+                     op.category, net, raw);
+            write_cost_table(ScopeName(), op, net, raw);
+        }
+
+        log_perf(overhead, false, "cycles", "clock_read_%s overhead",
+                 ScopeName());
+
+        return CL_SUCCESS;
+    }
+
+private:
+    // Runs the kernel bench_launches times and returns the median elapsed
+    // clock count over all work-items and launches
+    cl_int MeasureMedian(cl_kernel kernel, cl_int iterations, double *result)
+    {
+        cl_int error;
+        size_t global_size = work_group_size;
+        std::vector<cl_float> inputs(global_size);
+        std::vector<cl_uint> launch_cycles(global_size);
+        std::vector<double> samples;
+        const cl_int zero = 0;
+
+        for (size_t i = 0; i < global_size; i++)
+            inputs[i] = 0.25f + 0.5f * (float)i / (float)global_size;
+
+        error = clSetKernelArg(kernel, 0, sizeof(cycles), &cycles);
+        error |= clSetKernelArg(kernel, 1, sizeof(data), &data);
+        error |= clSetKernelArg(kernel, 2, sizeof(counters), &counters);
+        error |= clSetKernelArg(kernel, 3, sizeof(iterations), &iterations);
+        test_error(error, "clSetKernelArg failed");
+
+        for (int launch = 0; launch < bench_launches; launch++)
+        {
+            error = clEnqueueWriteBuffer(queue, data, CL_FALSE, 0,
+                                         sizeof(cl_float) * global_size,
+                                         inputs.data(), 0, NULL, NULL);
+            test_error(error, "clEnqueueWriteBuffer failed");
+            error = clEnqueueFillBuffer(queue, counters, &zero, sizeof(zero),
+                                        0, sizeof(cl_int) * (global_size + 1),
+                                        0, NULL, NULL);
+            test_error(error, "clEnqueueFillBuffer failed");
+
+            error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL,
+                                           &global_size, &work_group_size, 0,
+                                           NULL, NULL);
+            test_error(error, "clEnqueueNDRangeKernel failed");
+
+            error = clEnqueueReadBuffer(queue, cycles, CL_BLOCKING, 0,
+                                        sizeof(cl_uint) * global_size,
+                                        launch_cycles.data(), 0, NULL, NULL);
+            test_error(error, "clEnqueueReadBuffer failed");
+
+            samples.insert(samples.end(), launch_cycles.begin(),
+                           launch_cycles.end());
+        }
+
+        *result = compute_sample_stats(samples).median;
+        return CL_SUCCESS;
+    }
+
+    size_t work_group_size = 1;
+    clMemWrapper data;
+    clMemWrapper counters;
+    clMemWrapper cycles;
+};
+
+}
+
+REGISTER_TEST(benchmark_device_scope)
+{
+    return MakeAndRunTest<KernelClockBenchmark>(
+        device, context, queue, CL_DEVICE_KERNEL_CLOCK_SCOPE_DEVICE_KHR);
+}
+
+REGISTER_TEST(benchmark_workgroup_scope)
+{
+    return MakeAndRunTest<KernelClockBenchmark>(
+        device, context, queue, CL_DEVICE_KERNEL_CLOCK_SCOPE_WORK_GROUP_KHR);
+}
+
+REGISTER_TEST(benchmark_subgroup_scope)
+{
+    return MakeAndRunTest<KernelClockBenchmark>(
+        device, context, queue, CL_DEVICE_KERNEL_CLOCK_SCOPE_SUB_GROUP_KHR);
+}
@@ -0,0 +1,376 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <chrono>
+#include <vector>
+
+#include "semaphore_base.h"
+#include "harness/csvHelpers.h"
+#include "harness/profilingStats.h"
+
+// Latency and throughput of cross-queue synchronisation with binary
+// semaphores, compared with the same dependency chains built from events.
+//
+// The queues form a ring: queue i signals semaphore i, which queue i + 1
+// waits on before signalling semaphore i + 1, and so on until the last
+// semaphore is waited on by queue 0. The event-based equivalent replaces each
+// signal and wait with a marker that waits on the previous marker's event.
+//
+// * Latency: one round through the ring is submitted at a time and timed on
+//   the host until the final wait completes. When all queues are on the same
+//   device, the device-side signal-to-wait time of every hop is also taken
+//   from the profiling end times of the signal and the matching wait.
+// * Rate: many rounds are submitted back to back and the number of
+//   completed hops per second is measured.
+//
+// Results are logged as p50/p99 and, if CL_SEMAPHORE_BENCHMARK_CSV names a
+// file, appended to it as CSV.
+
+namespace {
+
+const size_t latency_rounds = 200;
+const size_t rate_rounds = 1000;
+
+void write_csv(const char *configuration, const char *mechanism,
+               size_t queues, double round_p50, double round_p99,
+               double hop_p50, double hop_p99, double hops_per_second)
+{
+    FILE *file = open_results_csv(
+        "CL_SEMAPHORE_BENCHMARK_CSV",
+        "configuration,mechanism,queues,round_p50_us,round_p99_us,"
+        "device_hop_p50_us,device_hop_p99_us,hops_per_second");
+    if (file == NULL) return;
+
+    fprintf(file, "%s,%s,%zu,%.2f,%.2f,%.2f,%.2f,%.0f\n", configuration,
+            mechanism, queues, round_p50, round_p99, hop_p50, hop_p99,
+            hops_per_second);
+    fclose(file);
+}
+
+struct SemaphoreBenchmark : public SemaphoreTestBase
+{
+    SemaphoreBenchmark(cl_device_id device, cl_context context,
+                       cl_command_queue queue, cl_int nelems)
+        : SemaphoreTestBase(device, context, queue, nelems)
+    {}
+
+    // Creates num_queues profiling queues, assigned round robin to the given
+    // devices, and one semaphore per queue
+    cl_int SetUpRing(cl_context ring_context,
+                     const std::vector<cl_device_id> &devices,
+                     size_t num_queues)
+    {
+        cl_int err = CL_SUCCESS;
+        queues.clear();
+        semaphores.clear();
+        semaphores.reserve(num_queues);
+        for (size_t i = 0; i < num_queues; i++)
+        {
+            clCommandQueueWrapper ring_queue =
+                clCreateCommandQueue(ring_context, devices[i % devices.size()],
+                                     CL_QUEUE_PROFILING_ENABLE, &err);
+            test_error(err, "Could not create command queue");
+            queues.push_back(ring_queue);
+
+            cl_semaphore_properties_khr sema_props[] = {
+                static_cast<cl_semaphore_properties_khr>(
+                    CL_SEMAPHORE_TYPE_KHR),
+                static_cast<cl_semaphore_properties_khr>(
+                    CL_SEMAPHORE_TYPE_BINARY_KHR),
+                0
+            };
+            semaphores.emplace_back(this);
+            semaphores.back() = clCreateSemaphoreWithPropertiesKHR(
+                ring_context, sema_props, &err);
+            test_error(err, "Could not create semaphore");
+        }
+        return CL_SUCCESS;
+    }
+
+    // Enqueues one round through the ring. If given, signal_events[i] and
+    // wait_events[i] receive the events of the signal of hop i and of the
+    // wait that consumes it. gate, if not null, is waited on by the first
+    // command of the round.
+    cl_int EnqueueRound(bool use_semaphores, cl_event gate,
+                        std::vector<clEventWrapper> *signal_events,
+                        std::vector<clEventWrapper> *wait_events)
+    {
+        cl_int err = CL_SUCCESS;
+        const size_t n = queues.size();
+        const bool want_events = signal_events && wait_events;
+        clEventWrapper previous;
+        for (size_t i = 0; i < n; i++)
+        {
+            cl_command_queue from = queues[i];
+            cl_command_queue to = queues[(i + 1) % n];
+            clEventWrapper signalled, consumed;
+
+            const cl_event *wait_list = nullptr;
+            if (i == 0 && gate)
+                wait_list = &gate;
+            else if (i > 0 && !use_semaphores)
+                wait_list = &previous;
+            cl_uint wait_count = wait_list ? 1 : 0;
+
+            if (use_semaphores)
+            {
+                err = clEnqueueSignalSemaphoresKHR(
+                    from, 1, semaphores[i], nullptr, wait_count, wait_list,
+                    want_events ? &signalled : nullptr);
+                test_error(err, "Could not signal semaphore");
+
+                err = clEnqueueWaitSemaphoresKHR(
+                    to, 1, semaphores[i], nullptr, 0, nullptr,
+                    want_events ? &consumed : nullptr);
+                test_error(err, "Could not wait semaphore");
+            }
+            else
+            {
+                err = clEnqueueMarkerWithWaitList(from, wait_count, wait_list,
+                                                  &signalled);
+                test_error(err, "clEnqueueMarkerWithWaitList failed");
+
+                err = clEnqueueMarkerWithWaitList(to, 1, &signalled,
+                                                  &consumed);
+                test_error(err, "clEnqueueMarkerWithWaitList failed");
+                previous = consumed;
+            }
+
+            if (want_events)
+            {
+                (*signal_events)[i] = std::move(signalled);
+                (*wait_events)[i] = std::move(consumed);
+            }
+        }
+        for (cl_command_queue ring_queue : queues)
+        {
+            err = clFlush(ring_queue);
+            test_error(err, "clFlush failed");
+        }
+        return CL_SUCCESS;
+    }
+
+    cl_int FinishRing()
+    {
+        for (cl_command_queue ring_queue : queues)
+        {
+            cl_int err = clFinish(ring_queue);
+            test_error(err, "clFinish failed");
+        }
+        return CL_SUCCESS;
+    }
+
+    cl_int MeasureLatency(bool use_semaphores, bool same_device,
+                          std::vector<double> &round_us,
+                          std::vector<double> &hop_us)
+    {
+        using clock = std::chrono::steady_clock;
+        const size_t n = queues.size();
+        std::vector<clEventWrapper> signal_events(n), wait_events(n);
+
+        for (size_t round = 0; round < latency_rounds + 1; round++)
+        {
+            clock::time_point start = clock::now();
+            cl_int err = EnqueueRound(use_semaphores, nullptr, &signal_events,
+                                      &wait_events);
+            test_error(err, "EnqueueRound failed");
+
+            err = clWaitForEvents(1, &wait_events[n - 1]);
+            test_error(err, "clWaitForEvents failed");
+            clock::time_point end = clock::now();
+
+            err = FinishRing();
+            test_error(err, "FinishRing failed");
+
+            // The first round warms up the queues
+            if (round == 0) continue;
+            round_us.push_back(
+                std::chrono::duration<double, std::micro>(end - start)
+                    .count());
+            if (!same_device) continue;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                cl_ulong signalled, waited;
+                err = clGetEventProfilingInfo(signal_events[i],
+                                              CL_PROFILING_COMMAND_END,
+                                              sizeof(signalled), &signalled,
+                                              nullptr);
+                test_error(err, "clGetEventProfilingInfo failed");
+                err = clGetEventProfilingInfo(wait_events[i],
+                                              CL_PROFILING_COMMAND_END,
+                                              sizeof(waited), &waited, nullptr);
+                test_error(err, "clGetEventProfilingInfo failed");
+                // A wait may be timestamped before the signal it consumes
+                // when both complete within the timer resolution
+                hop_us.push_back(
+                    waited > signalled ? (waited - signalled) * 1e-3 : 0.0);
+            }
+        }
+        return CL_SUCCESS;
+    }
+
+    // All rounds are gated on a user event so that submission cost is not
+    // part of the measured rate
+    cl_int MeasureRate(bool use_semaphores, double &hops_per_second)
+    {
+        using clock = std::chrono::steady_clock;
+        cl_int err = CL_SUCCESS;
+        clEventWrapper gate = clCreateUserEvent(context_for_rate, &err);
+        test_error(err, "clCreateUserEvent failed");
+
+        for (size_t round = 0; round < rate_rounds; round++)
+        {
+            err = EnqueueRound(use_semaphores, round == 0 ? gate : nullptr,
+                               nullptr, nullptr);
+            test_error(err, "EnqueueRound failed");
+        }
+
+        clock::time_point start = clock::now();
+        err = clSetUserEventStatus(gate, CL_COMPLETE);
+        test_error(err, "clSetUserEventStatus failed");
+        err = FinishRing();
+        test_error(err, "FinishRing failed");
+        clock::time_point end = clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        hops_per_second = rate_rounds * queues.size() / seconds;
+        return CL_SUCCESS;
+    }
+
+    cl_int MeasureConfiguration(const char *configuration,
+                                cl_context ring_context,
+                                const std::vector<cl_device_id> &devices,
+                                size_t num_queues)
+    {
+        cl_int err = SetUpRing(ring_context, devices, num_queues);
+        test_error(err, "SetUpRing failed");
+        context_for_rate = ring_context;
+        const bool same_device = devices.size() == 1;
+
+        for (bool use_semaphores : { true, false })
+        {
+            const char *mechanism = use_semaphores ? "semaphore" : "event";
+            std::vector<double> round_us, hop_us;
+            err = MeasureLatency(use_semaphores, same_device, round_us,
+                                 hop_us);
+            test_error(err, "MeasureLatency failed");
+
+            double hops_per_second = 0.0;
+            err = MeasureRate(use_semaphores, hops_per_second);
+            test_error(err, "MeasureRate failed");
+
+            SampleStats round = compute_sample_stats(round_us);
+            SampleStats hop = compute_sample_stats(hop_us);
+            double round_p50 = round.median;
+            double round_p99 = round.p99;
+            double hop_p50 = hop.median;
+            double hop_p99 = hop.p99;
+            log_info("%-20s %-9s %6zu %10.2f %10.2f", configuration, mechanism,
+                     num_queues, round_p50, round_p99);
+            if (same_device)
+                log_info(" %10.2f %10.2f", hop_p50, hop_p99);
+            else
+                log_info(" %10s %10s", "-", "-");
+            log_info(" %12.0f\n", hops_per_second);
+
+            log_perf(round_p50, false, "us",
+                     "%s %s round trip through %zu queues (p50)",
+                     configuration, mechanism, num_queues);
+            log_perf(hops_per_second, true, "hops/s",
+                     "%s %s sustained rate with %zu queues", configuration,
+                     mechanism, num_queues);
+            write_csv(configuration, mechanism, num_queues, round_p50,
+                      round_p99, hop_p50, hop_p99, hops_per_second);
+        }
+        return CL_SUCCESS;
+    }
+
+    // Another device of the same platform that supports semaphores, if any
+    cl_device_id FindSecondDevice()
+    {
+        cl_platform_id platform;
+        cl_uint num_devices = 0;
+        if (clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform),
+                            &platform, nullptr)
+                != CL_SUCCESS
+            || clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, nullptr,
+                              &num_devices)
+                != CL_SUCCESS)
+            return nullptr;
+
+        std::vector<cl_device_id> devices(num_devices);
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, num_devices,
+                           devices.data(), nullptr)
+            != CL_SUCCESS)
+            return nullptr;
+
+        for (cl_device_id other : devices)
+            if (other != device
+                && is_extension_available(other, "cl_khr_semaphore"))
+                return other;
+        return nullptr;
+    }
+
+    cl_int Run() override
+    {
+        log_info("%-20s %-9s %6s %10s %10s %10s %10s %12s\n", "configuration",
+                 "mechanism", "queues", "round p50", "round p99", "hop p50",
+                 "hop p99", "hops/s");
+
+        for (size_t num_queues : { 2, 4 })
+        {
+            cl_int err =
+                MeasureConfiguration("same_device", context, { device },
+                                     num_queues);
+            test_error(err, "MeasureConfiguration failed");
+        }
+
+        cl_device_id second = FindSecondDevice();
+        if (second == nullptr)
+        {
+            log_info("No second device with cl_khr_semaphore on the "
+                     "platform, skipping the cross-device configuration.\n");
+            return TEST_PASS;
+        }
+
+        cl_int err = CL_SUCCESS;
+        std::vector<cl_device_id> devices = { device, second };
+        clContextWrapper multi_context = clCreateContext(
+            nullptr, 2, devices.data(), nullptr, nullptr, &err);
+        test_error(err, "Could not create a context for two devices");
+
+        err = MeasureConfiguration("cross_device", multi_context, devices, 2);
+        test_error(err, "MeasureConfiguration failed");
+
+        // Release the ring before the context it belongs to
+        semaphores.clear();
+        queues.clear();
+        return TEST_PASS;
+    }
+
+    std::vector<clCommandQueueWrapper> queues;
+    std::vector<clSemaphoreWrapper> semaphores;
+    cl_context context_for_rate = nullptr;
+};
+
+} // anonymous namespace
+
+REGISTER_TEST_VERSION(semaphores_cross_queue_benchmark, Version(1, 2))
+{
+    return MakeAndRunTest<SemaphoreBenchmark>(device, context, queue,
+                                              num_elements);
+}
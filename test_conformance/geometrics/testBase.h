@@ -25,6 +25,14 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+// Builds one program holding a kernel named sample_test_<n> for every vector
+// size n of the zero-terminated sizes list. Each kernel is generated from
+// pattern (patternV3 for n == 3), formatted with the "_<n>" name suffix,
+// numSizeArgs copies of the vector size name and fnName.
+extern int create_geometrics_program(cl_context context, cl_program *outProgram,
+                                     const char *pattern, const char *patternV3,
+                                     int numSizeArgs, const char *fnName,
+                                     const size_t *sizes);
 extern int test_geom_cross_double(cl_device_id deviceID, cl_context context,
                                   cl_command_queue queue, int num_elements,
                                   MTdata d);
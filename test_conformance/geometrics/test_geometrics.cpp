@@ -22,8 +22,11 @@
 #include "harness/errorHelpers.h"
 #include <float.h>
 
+#include <string>
+#include <vector>
+
 const char *crossKernelSource =
-"__kernel void sample_test(__global float4 *sourceA, __global float4 *sourceB, __global float4 *destValues)\n"
+"__kernel void sample_test_4(__global float4 *sourceA, __global float4 *sourceB, __global float4 *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = cross( sourceA[tid], sourceB[tid] );\n"
@@ -31,7 +34,7 @@ const char *crossKernelSource =
 "}\n" ;
 
 const char *crossKernelSourceV3 =
-"__kernel void sample_test(__global float *sourceA, __global float *sourceB, __global float *destValues)\n"
+"__kernel void sample_test_3(__global float *sourceA, __global float *sourceB, __global float *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    vstore3( cross( vload3( tid, sourceA), vload3( tid,  sourceB) ), tid, destValues );\n"
@@ -39,7 +42,7 @@ const char *crossKernelSourceV3 =
 "}\n";
 
 const char *twoToFloatKernelPattern =
-"__kernel void sample_test(__global float%s *sourceA, __global float%s *sourceB, __global float *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float%s *sourceB, __global float *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid], sourceB[tid] );\n"
@@ -47,7 +50,7 @@ const char *twoToFloatKernelPattern =
 "}\n";
 
 const char *twoToFloatKernelPatternV3 =
-"__kernel void sample_test(__global float%s *sourceA, __global float%s *sourceB, __global float *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float%s *sourceB, __global float *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( vload3( tid, (__global float*) sourceA), vload3( tid, (__global float*) sourceB) );\n"
@@ -55,7 +58,7 @@ const char *twoToFloatKernelPatternV3 =
 "}\n";
 
 const char *oneToFloatKernelPattern =
-"__kernel void sample_test(__global float%s *sourceA, __global float *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid] );\n"
@@ -63,7 +66,7 @@ const char *oneToFloatKernelPattern =
 "}\n";
 
 const char *oneToFloatKernelPatternV3 =
-"__kernel void sample_test(__global float%s *sourceA, __global float *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( vload3( tid, (__global float*) sourceA) );\n"
@@ -71,7 +74,7 @@ const char *oneToFloatKernelPatternV3 =
 "}\n";
 
 const char *oneToOneKernelPattern =
-"__kernel void sample_test(__global float%s *sourceA, __global float%s *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float%s *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid] );\n"
@@ -79,7 +82,7 @@ const char *oneToOneKernelPattern =
 "}\n";
 
 const char *oneToOneKernelPatternV3 =
-"__kernel void sample_test(__global float%s *sourceA, __global float%s *destValues)\n"
+"__kernel void sample_test%s(__global float%s *sourceA, __global float%s *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    vstore3( %s( vload3( tid, (__global float*) sourceA) ), tid, (__global float*) destValues );\n"
@@ -88,6 +91,39 @@ const char *oneToOneKernelPatternV3 =
 
 #define TEST_SIZE (1 << 20)
 
+int create_geometrics_program(cl_context context, cl_program *outProgram,
+                              const char *pattern, const char *patternV3,
+                              int numSizeArgs, const char *fnName,
+                              const size_t *sizes)
+{
+    char sizeNames[][4] = { "", "2", "3", "4" };
+    char kernelSource[10240];
+    char kernelName[32];
+    std::vector<std::string> sources;
+
+    for (size_t i = 0; sizes[i] != 0; i++)
+    {
+        const char *sizeName = sizeNames[sizes[i] - 1];
+        sprintf(kernelName, "_%d", (int)sizes[i]);
+        if (numSizeArgs == 2)
+            sprintf(kernelSource, sizes[i] == 3 ? patternV3 : pattern,
+                    kernelName, sizeName, sizeName, fnName);
+        else
+            sprintf(kernelSource, sizes[i] == 3 ? patternV3 : pattern,
+                    kernelName, sizeName, fnName);
+        sources.push_back(kernelSource);
+    }
+
+    std::vector<const char *> lines;
+    for (const std::string &source : sources) lines.push_back(source.c_str());
+
+    clKernelWrapper kernel;
+    sprintf(kernelName, "sample_test_%d", (int)sizes[0]);
+    return create_single_kernel_helper(context, outProgram, &kernel,
+                                       (unsigned int)lines.size(),
+                                       lines.data(), kernelName);
+}
+
 double verifyFastDistance( float *srcA, float *srcB, size_t vecSize );
 double verifyFastLength( float *srcA, size_t vecSize );
 
@@ -159,9 +195,16 @@ REGISTER_TEST(geom_cross)
         return -1;
 
 
+    /* Create the program for both vector sizes */
+    const char *crossSources[] = { crossKernelSourceV3, crossKernelSource };
+    clProgramWrapper program;
+    clKernelWrapper crossKernel;
+    if (create_single_kernel_helper(context, &program, &crossKernel, 2,
+                                    crossSources, "sample_test_3"))
+        return -1;
+
     for(vecsize = 3; vecsize <= 4; ++vecsize)
     {
-        clProgramWrapper program;
         clKernelWrapper kernel;
         clMemWrapper streams[3];
         BufferOwningPtr<cl_float> A(malloc(sizeof(cl_float) * TEST_SIZE * vecsize));
@@ -175,8 +218,9 @@ REGISTER_TEST(geom_cross)
         size_t threads[1], localThreads[1];
 
         /* Create kernels */
-        if( create_single_kernel_helper( context, &program, &kernel, 1, vecsize == 3 ? &crossKernelSourceV3 : &crossKernelSource, "sample_test" ) )
-            return -1;
+        kernel = clCreateKernel(
+            program, vecsize == 3 ? "sample_test_3" : "sample_test_4", &error);
+        test_error(error, "Unable to create kernel");
 
         /* Generate some streams. Note: deliberately do some random data in w to verify that it gets ignored */
         for( i = 0; i < TEST_SIZE * vecsize; i++ )
@@ -292,17 +336,15 @@ float getMaxValue( float vecA[], float vecB[], size_t vecSize )
 
 typedef double (*twoToFloatVerifyFn)( float *srcA, float *srcB, size_t vecSize );
 
-int test_twoToFloat_kernel(cl_command_queue queue, cl_context context, const char *fnName,
+int test_twoToFloat_kernel(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                            size_t vecSize, twoToFloatVerifyFn verifyFn, float ulpLimit, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[3];
     int error;
     size_t i, threads[1], localThreads[1];
     char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     int hasInfNan = 1;
     cl_device_id device = NULL;
 
@@ -333,15 +375,10 @@ int test_twoToFloat_kernel(cl_command_queue queue, cl_context context, const cha
     cl_float *inDataB = B;
     cl_float *outData = C;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3 ? twoToFloatKernelPatternV3 : twoToFloatKernelPattern, sizeNames[vecSize-1], sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr, "sample_test" ) )
-    {
-        return -1;
-    }
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
     /* Generate some streams */
     for( i = 0; i < TEST_SIZE * vecSize; i++ )
     {
@@ -508,9 +545,15 @@ REGISTER_TEST(geom_dot)
     int retVal = 0;
     RandomSeed seed(gRandomSeed);
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern,
+            twoToFloatKernelPatternV3, 2, "dot", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
-        if( test_twoToFloat_kernel( queue, context, "dot", sizes[size], verifyDot, -1.0f /*magic value*/, seed ) != 0 )
+        if( test_twoToFloat_kernel( queue, context, program, "dot", sizes[size], verifyDot, -1.0f /*magic value*/, seed ) != 0 )
         {
             log_error( "   dot vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -553,13 +596,19 @@ REGISTER_TEST(geom_fast_distance)
     int retVal = 0;
     RandomSeed seed(gRandomSeed);
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern,
+            twoToFloatKernelPatternV3, 2, "fast_distance", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 8192.0f +                           // error in sqrt
         ( 1.5f * (float) sizes[size] +      // cumulative error for multiplications  (a-b+0.5ulp)**2 = (a-b)**2 + a*0.5ulp + b*0.5 ulp + 0.5 ulp for multiplication
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_twoToFloat_kernel( queue, context, "fast_distance",
+        if( test_twoToFloat_kernel( queue, context, program, "fast_distance",
                                    sizes[ size ], verifyFastDistance,
                                    maxUlps, seed ) != 0 )
         {
@@ -600,13 +649,19 @@ REGISTER_TEST(geom_distance)
     int retVal = 0;
     RandomSeed seed(gRandomSeed );
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern,
+            twoToFloatKernelPatternV3, 2, "distance", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 3.0f +                              // error in sqrt
         ( 1.5f * (float) sizes[size] +      // cumulative error for multiplications  (a-b+0.5ulp)**2 = (a-b)**2 + a*0.5ulp + b*0.5 ulp + 0.5 ulp for multiplication
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_twoToFloat_kernel( queue, context, "distance", sizes[ size ], verifyDistance, maxUlps, seed ) != 0 )
+        if( test_twoToFloat_kernel( queue, context, program, "distance", sizes[ size ], verifyDistance, maxUlps, seed ) != 0 )
         {
             log_error( "   distance vector size %d FAILED\n",
                       (int)sizes[ size ] );
@@ -633,31 +688,23 @@ REGISTER_TEST(geom_distance)
 
 typedef double (*oneToFloatVerifyFn)( float *srcA, size_t vecSize );
 
-int test_oneToFloat_kernel(cl_command_queue queue, cl_context context, const char *fnName,
+int test_oneToFloat_kernel(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                            size_t vecSize, oneToFloatVerifyFn verifyFn, float ulpLimit, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[2];
     BufferOwningPtr<cl_float> A(malloc(sizeof(cl_float) * TEST_SIZE * 4));
     BufferOwningPtr<cl_float> B(malloc(sizeof(cl_float) * TEST_SIZE));
     int error;
     size_t i, threads[1], localThreads[1];
-    char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     cl_float *inDataA = A;
     cl_float *outData = B;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3? oneToFloatKernelPatternV3 : oneToFloatKernelPattern, sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr, "sample_test" ) )
-    {
-        return -1;
-    }
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
 
     /* Generate some streams */
     for( i = 0; i < TEST_SIZE * vecSize; i++ )
@@ -766,6 +813,12 @@ REGISTER_TEST(geom_length)
     int retVal = 0;
     RandomSeed seed( gRandomSeed );
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToFloatKernelPattern,
+            oneToFloatKernelPatternV3, 1, "length", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 3.0f +                              // error in sqrt
@@ -773,7 +826,7 @@ REGISTER_TEST(geom_length)
         ( 0.5f * (float) sizes[size] +      // cumulative error for multiplications
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_oneToFloat_kernel( queue, context, "length", sizes[ size ], verifyLength, maxUlps, seed ) != 0 )
+        if( test_oneToFloat_kernel( queue, context, program, "length", sizes[ size ], verifyLength, maxUlps, seed ) != 0 )
         {
             log_error( "   length vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -822,13 +875,19 @@ REGISTER_TEST(geom_fast_length)
     int retVal = 0;
     RandomSeed seed(gRandomSeed);
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToFloatKernelPattern,
+            oneToFloatKernelPatternV3, 1, "fast_length", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 8192.0f +                           // error in half_sqrt
         ( 0.5f * (float) sizes[size] +      // cumulative error for multiplications
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_oneToFloat_kernel( queue, context, "fast_length", sizes[ size ], verifyFastLength, maxUlps, seed ) != 0 )
+        if( test_oneToFloat_kernel( queue, context, program, "fast_length", sizes[ size ], verifyFastLength, maxUlps, seed ) != 0 )
         {
             log_error( "   fast_length vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -845,10 +904,9 @@ REGISTER_TEST(geom_fast_length)
 typedef void (*oneToOneVerifyFn)( float *srcA, float *dstA, size_t vecSize );
 
 
-int test_oneToOne_kernel(cl_command_queue queue, cl_context context, const char *fnName,
+int test_oneToOne_kernel(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                          size_t vecSize, oneToOneVerifyFn verifyFn, float ulpLimit, int softball, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[2];
     BufferOwningPtr<cl_float> A(malloc(sizeof(cl_float) * TEST_SIZE
@@ -857,20 +915,15 @@ int test_oneToOne_kernel(cl_command_queue queue, cl_context context, const char
                                        * vecSize));
     int error;
     size_t i, j, threads[1], localThreads[1];
-    char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     cl_float *inDataA = A;
     cl_float *outData = B;
     float ulp_error = 0;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3 ? oneToOneKernelPatternV3: oneToOneKernelPattern, sizeNames[vecSize-1], sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr,  "sample_test" ) )
-        return -1;
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
 
     /* Initialize data.  First element always 0. */
     memset( inDataA, 0, sizeof(cl_float) * vecSize );
@@ -1072,12 +1125,18 @@ REGISTER_TEST(geom_normalize)
     int retVal = 0;
     RandomSeed seed(gRandomSeed);
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToOneKernelPattern,
+            oneToOneKernelPatternV3, 2, "normalize", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 2.5f +                              // error in rsqrt + error in multiply
         ( 0.5f * (float) sizes[size] +      // cumulative error for multiplications
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
-        if( test_oneToOne_kernel( queue, context, "normalize", sizes[ size ], verifyNormalize, maxUlps, 0, seed ) != 0 )
+        if( test_oneToOne_kernel( queue, context, program, "normalize", sizes[ size ], verifyNormalize, maxUlps, 0, seed ) != 0 )
         {
             log_error( "   normalized vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -1109,13 +1168,19 @@ REGISTER_TEST(geom_fast_normalize)
     int retVal = 0;
     RandomSeed seed( gRandomSeed );
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToOneKernelPattern,
+            oneToOneKernelPatternV3, 2, "fast_normalize", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         float maxUlps = 8192.5f +                           // error in rsqrt + error in multiply
         ( 0.5f * (float) sizes[size] +      // cumulative error for multiplications
          0.5f * (float) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_oneToOne_kernel( queue, context, "fast_normalize", sizes[ size ], verifyNormalize, maxUlps, 1, seed ) != 0 )
+        if( test_oneToOne_kernel( queue, context, program, "fast_normalize", sizes[ size ], verifyNormalize, maxUlps, 1, seed ) != 0 )
         {
             log_error( "   fast_normalize vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -20,7 +20,7 @@
 
 const char *crossKernelSource_double =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double4 *sourceA, __global double4 *sourceB, __global double4 *destValues)\n"
+"__kernel void sample_test_4(__global double4 *sourceA, __global double4 *sourceB, __global double4 *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = cross( sourceA[tid], sourceB[tid] );\n"
@@ -29,7 +29,7 @@ const char *crossKernelSource_double =
 
 const char *crossKernelSource_doubleV3 =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double *sourceA, __global double *sourceB, __global double *destValues)\n"
+"__kernel void sample_test_3(__global double *sourceA, __global double *sourceB, __global double *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    vstore3( cross( vload3( tid, sourceA), vload3( tid, sourceB) ), tid, destValues);\n"
@@ -38,7 +38,7 @@ const char *crossKernelSource_doubleV3 =
 
 const char *twoToFloatKernelPattern_double =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double%s *sourceB, __global double *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double%s *sourceB, __global double *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid], sourceB[tid] );\n"
@@ -47,7 +47,7 @@ const char *twoToFloatKernelPattern_double =
 
 const char *twoToFloatKernelPattern_doubleV3 =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double%s *sourceB, __global double *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double%s *sourceB, __global double *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( vload3( tid, (__global double*) sourceA), vload3( tid, (__global double*) sourceB ) );\n"
@@ -56,7 +56,7 @@ const char *twoToFloatKernelPattern_doubleV3 =
 
 const char *oneToFloatKernelPattern_double =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid] );\n"
@@ -65,7 +65,7 @@ const char *oneToFloatKernelPattern_double =
 
 const char *oneToFloatKernelPattern_doubleV3 =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( vload3( tid, (__global double*) sourceA) );\n"
@@ -74,7 +74,7 @@ const char *oneToFloatKernelPattern_doubleV3 =
 
 const char *oneToOneKernelPattern_double =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double%s *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double%s *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    destValues[tid] = %s( sourceA[tid] );\n"
@@ -83,7 +83,7 @@ const char *oneToOneKernelPattern_double =
 
 const char *oneToOneKernelPattern_doubleV3 =
 "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
-"__kernel void sample_test(__global double%s *sourceA, __global double%s *destValues)\n"
+"__kernel void sample_test%s(__global double%s *sourceA, __global double%s *destValues)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    vstore3( %s( vload3( tid, (__global double*) sourceA) ), tid, (__global double*) destValues );\n"
@@ -172,6 +172,15 @@ int test_geom_cross_double(cl_device_id deviceID, cl_context context, cl_command
     unsigned int adjustment;
     int vecsize;
 
+    /* Create the program for both vector sizes */
+    const char *crossSources[] = { crossKernelSource_doubleV3,
+                                   crossKernelSource_double };
+    clProgramWrapper program;
+    clKernelWrapper crossKernel;
+    if (create_single_kernel_helper(context, &program, &crossKernel, 2,
+                                    crossSources, "sample_test_3"))
+        return -1;
+
     adjustment = 32*1024*1024; /* Try to allocate a bit less than the limits */
     for(vecsize = 3; vecsize <= 4; ++vecsize)
     {
@@ -185,7 +194,6 @@ int test_geom_cross_double(cl_device_id deviceID, cl_context context, cl_command
         }
 
         /* Perform the test */
-        clProgramWrapper program;
         clKernelWrapper kernel;
         clMemWrapper streams[3];
         cl_double testVector[4];
@@ -199,8 +207,9 @@ int test_geom_cross_double(cl_device_id deviceID, cl_context context, cl_command
         cl_double *outData = C;
 
         /* Create kernels */
-        if( create_single_kernel_helper( context, &program, &kernel, 1, vecsize == 3 ? &crossKernelSource_doubleV3 : &crossKernelSource_double, "sample_test" ) )
-            return -1;
+        kernel = clCreateKernel(
+            program, vecsize == 3 ? "sample_test_3" : "sample_test_4", &error);
+        test_error(error, "Unable to create kernel");
 
         /* Generate some streams. Note: deliberately do some random data in w to verify that it gets ignored */
         for (unsigned int i = 0; i < size * vecsize; i++)
@@ -294,17 +303,14 @@ double getMaxValue_double( double vecA[], double vecB[], size_t vecSize )
 
 typedef double (*twoToFloatVerifyFn_double)( double *srcA, double *srcB, size_t vecSize );
 
-int test_twoToFloat_kernel_double(cl_command_queue queue, cl_context context, const char *fnName,
+int test_twoToFloat_kernel_double(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                                   size_t vecSize, twoToFloatVerifyFn_double verifyFn, double ulpLimit, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[3];
     int error;
     size_t i, threads[1], localThreads[1];
-    char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     BufferOwningPtr<cl_double> A(malloc(sizeof(cl_double) * TEST_SIZE * vecSize));
     BufferOwningPtr<cl_double> B(malloc(sizeof(cl_double) * TEST_SIZE * vecSize));
     BufferOwningPtr<cl_double> C(malloc(sizeof(cl_double) * TEST_SIZE));
@@ -313,13 +319,10 @@ int test_twoToFloat_kernel_double(cl_command_queue queue, cl_context context, co
     cl_double *inDataB = B;
     cl_double *outData = C;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3 ? twoToFloatKernelPattern_doubleV3 : twoToFloatKernelPattern_double, sizeNames[vecSize-1], sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr, "sample_test" ) )
-        return -1;
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
 
     /* Generate some streams */
     for( i = 0; i < TEST_SIZE * vecSize; i++ )
@@ -453,10 +456,15 @@ int test_geom_dot_double(cl_device_id deviceID, cl_context context, cl_command_q
     unsigned int size;
     int retVal = 0;
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern_double,
+            twoToFloatKernelPattern_doubleV3, 2, "dot", sizes))
+        return -1;
 
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
-        if( test_twoToFloat_kernel_double( queue, context, "dot", sizes[ size ], verifyDot_double, -1.0f /*magic value*/, d ) != 0 )
+        if( test_twoToFloat_kernel_double( queue, context, program, "dot", sizes[ size ], verifyDot_double, -1.0f /*magic value*/, d ) != 0 )
         {
             log_error( "   dot double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -474,6 +482,12 @@ int test_geom_fast_distance_double(cl_device_id deviceID, cl_context context, cl
 
     abort();    //there is no double precision fast_distance
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern_double,
+            twoToFloatKernelPattern_doubleV3, 2, "fast_distance", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         double maxUlps = 8192.0f +                           // error in sqrt
@@ -481,7 +495,7 @@ int test_geom_fast_distance_double(cl_device_id deviceID, cl_context context, cl
         ( 1.5f * (double) sizes[size] +      // cumulative error for multiplications  (a-b+0.5ulp)**2 = (a-b)**2 + a*0.5ulp + b*0.5 ulp + 0.5 ulp for multiplication
          0.5f * (double) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_twoToFloat_kernel_double( queue, context, "fast_distance", sizes[ size ], verifyDistance_double, maxUlps, d ) != 0 )
+        if( test_twoToFloat_kernel_double( queue, context, program, "fast_distance", sizes[ size ], verifyDistance_double, maxUlps, d ) != 0 )
         {
             log_error( "   fast_distance double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -512,6 +526,12 @@ int test_geom_distance_double(cl_device_id deviceID, cl_context context, cl_comm
     unsigned int size;
     int retVal = 0;
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, twoToFloatKernelPattern_double,
+            twoToFloatKernelPattern_doubleV3, 2, "distance", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         double maxUlps = 3.0f +                              // error in sqrt
@@ -521,7 +541,7 @@ int test_geom_distance_double(cl_device_id deviceID, cl_context context, cl_comm
 
         maxUlps *= 2.0;         // our reference code may be in error too
 
-        if( test_twoToFloat_kernel_double( queue, context, "distance", sizes[ size ], verifyDistance_double, maxUlps, d ) != 0 )
+        if( test_twoToFloat_kernel_double( queue, context, program, "distance", sizes[ size ], verifyDistance_double, maxUlps, d ) != 0 )
         {
             log_error( "   distance double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -536,29 +556,23 @@ int test_geom_distance_double(cl_device_id deviceID, cl_context context, cl_comm
 
 typedef double (*oneToFloatVerifyFn_double)( double *srcA, size_t vecSize );
 
-int test_oneToFloat_kernel_double(cl_command_queue queue, cl_context context, const char *fnName,
+int test_oneToFloat_kernel_double(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                                   size_t vecSize, oneToFloatVerifyFn_double verifyFn, double ulpLimit, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[2];
     BufferOwningPtr<cl_double> A(malloc(sizeof(cl_double) * TEST_SIZE * vecSize));
     BufferOwningPtr<cl_double> B(malloc(sizeof(cl_double) * TEST_SIZE));
     int error;
     size_t i, threads[1], localThreads[1];
-    char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     cl_double *inDataA = A;
     cl_double *outData = B;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3 ? oneToFloatKernelPattern_doubleV3 : oneToFloatKernelPattern_double, sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr, "sample_test" ) )
-        return -1;
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
 
     /* Generate some streams */
     for( i = 0; i < TEST_SIZE * vecSize; i++ )
@@ -675,6 +689,12 @@ int test_geom_length_double(cl_device_id deviceID, cl_context context, cl_comman
     unsigned int size;
     int retVal = 0;
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToFloatKernelPattern_double,
+            oneToFloatKernelPattern_doubleV3, 1, "length", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         double maxUlps = 3.0f +                              // error in sqrt
@@ -683,7 +703,7 @@ int test_geom_length_double(cl_device_id deviceID, cl_context context, cl_comman
          0.5f * (double) (sizes[size]-1));    // cumulative error for additions
 
         maxUlps *= 2.0;         // our reference code may be in error too
-        if( test_oneToFloat_kernel_double( queue, context, "length", sizes[ size ], verifyLength_double, maxUlps, d ) != 0 )
+        if( test_oneToFloat_kernel_double( queue, context, program, "length", sizes[ size ], verifyLength_double, maxUlps, d ) != 0 )
         {
             log_error( "   length double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -720,6 +740,12 @@ int test_geom_fast_length_double(cl_device_id deviceID, cl_context context, cl_c
 
     abort();    //there is no double precision fast_length
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToFloatKernelPattern_double,
+            oneToFloatKernelPattern_doubleV3, 1, "fast_length", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         double maxUlps = 8192.0f +                           // error in half_sqrt
@@ -727,7 +753,7 @@ int test_geom_fast_length_double(cl_device_id deviceID, cl_context context, cl_c
         ( 0.5f * (double) sizes[size] +      // cumulative error for multiplications
          0.5f * (double) (sizes[size]-1));    // cumulative error for additions
 
-        if( test_oneToFloat_kernel_double( queue, context, "fast_length", sizes[ size ], verifyFastLength_double, maxUlps, d ) != 0 )
+        if( test_oneToFloat_kernel_double( queue, context, program, "fast_length", sizes[ size ], verifyFastLength_double, maxUlps, d ) != 0 )
         {
             log_error( "   fast_length double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -743,29 +769,23 @@ int test_geom_fast_length_double(cl_device_id deviceID, cl_context context, cl_c
 
 typedef void (*oneToOneVerifyFn_double)( double *srcA, double *dstA, size_t vecSize );
 
-int test_oneToOne_kernel_double(cl_command_queue queue, cl_context context, const char *fnName,
+int test_oneToOne_kernel_double(cl_command_queue queue, cl_context context, cl_program program, const char *fnName,
                                 size_t vecSize, oneToOneVerifyFn_double verifyFn, double ulpLimit, MTdata d )
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
     clMemWrapper streams[2];
     BufferOwningPtr<cl_double> A(malloc(sizeof(cl_double) * TEST_SIZE * vecSize));
     BufferOwningPtr<cl_double> B(malloc(sizeof(cl_double) * TEST_SIZE * vecSize));
     int error;
     size_t i, j, threads[1], localThreads[1];
-    char kernelSource[10240];
-    char *programPtr;
-    char sizeNames[][4] = { "", "2", "3", "4", "", "", "", "8", "", "", "", "", "", "", "", "16" };
+    char kernelName[32];
     cl_double *inDataA = A;
     cl_double *outData = B;
 
-    /* Create the source */
-    sprintf( kernelSource, vecSize == 3 ? oneToOneKernelPattern_doubleV3 : oneToOneKernelPattern_double, sizeNames[vecSize-1], sizeNames[vecSize-1], fnName );
-
     /* Create kernels */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, &program, &kernel, 1, (const char **)&programPtr, "sample_test" ) )
-        return -1;
+    sprintf( kernelName, "sample_test_%d", (int)vecSize );
+    kernel = clCreateKernel( program, kernelName, &error );
+    test_error( error, "Unable to create kernel" );
 
     /* initialize data */
     memset( inDataA, 0, vecSize * sizeof( cl_double ) );
@@ -932,6 +952,12 @@ int test_geom_normalize_double(cl_device_id deviceID, cl_context context, cl_com
     unsigned int size;
     int retVal = 0;
 
+    clProgramWrapper program;
+    if (create_geometrics_program(
+            context, &program, oneToOneKernelPattern_double,
+            oneToOneKernelPattern_doubleV3, 2, "normalize", sizes))
+        return -1;
+
     for( size = 0; sizes[ size ] != 0 ; size++ )
     {
         double maxUlps = 2.5f +                              // error in rsqrt + error in multiply
@@ -940,7 +966,7 @@ int test_geom_normalize_double(cl_device_id deviceID, cl_context context, cl_com
          0.5f * (double) (sizes[size]-1));    // cumulative error for additions
 
         maxUlps *= 2.0; //our reference code is not infinitely precise and may have error of its own
-        if( test_oneToOne_kernel_double( queue, context, "normalize", sizes[ size ], verifyNormalize_double, maxUlps, d ) != 0 )
+        if( test_oneToOne_kernel_double( queue, context, program, "normalize", sizes[ size ], verifyNormalize_double, maxUlps, d ) != 0 )
         {
             log_error( "   normalize double vector size %d FAILED\n", (int)sizes[ size ] );
             retVal = -1;
@@ -25,6 +25,9 @@ static image_test_context_t ctx;
 extern int test_image_set(cl_device_id device, cl_context context,
                           cl_command_queue queue, MethodsToTest testMethod,
                           const image_test_context_t &ctx);
+extern int test_image_transfer_throughput(cl_device_id device,
+                                          cl_context context,
+                                          const image_test_context_t &ctx);
 
 REGISTER_TEST(1D) { return test_image_set(device, context, queue, k1D, ctx); }
 REGISTER_TEST(2D) { return test_image_set(device, context, queue, k2D, ctx); }
@@ -75,6 +78,11 @@ REGISTER_TEST(3Dto2Darray)
     return test_image_set(device, context, queue, k3DTo2DArray, ctx);
 }
 
+REGISTER_TEST(transfer_throughput)
+{
+    return test_image_transfer_throughput(device, context, ctx);
+}
+
 static test_status parseArgs(int &argc, const char *argv[],
                              std::vector<std::string> &removed_args,
                              std::string &help)
@@ -97,13 +97,8 @@ int test_copy_image_size_1D(cl_context context, cl_command_queue queue,
             sourcePos[1] = src_lod;
             destPos[1] = dst_lod;
         }
-      // Pick a random size
-      regionSize[ 0 ] = ( width_lod > 8 ) ? (size_t)random_in_range( 8, (int)width_lod - 1, d ) : width_lod;
-
-      // Now pick positions within valid ranges
-      sourcePos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-      destPos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-
+      get_random_copy_region(1, &width_lod, &width_lod, d, sourcePos, destPos,
+                             regionSize);
 
       // Go for it!
       retCode =
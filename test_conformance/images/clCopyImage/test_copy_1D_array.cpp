@@ -93,26 +93,10 @@ int test_copy_image_size_1D_array(cl_context context, cl_command_queue queue,
             sourcePos[ 2 ] = src_lod;
             destPos[ 2 ] = dst_lod;
         }
-        // Pick a random size
-        regionSize[ 0 ] = ( width_lod > 8 ) ? (size_t)random_in_range( 8, (int)width_lod - 1, d ) : (int)width_lod;
-        regionSize[1] = (srcImageInfo->arraySize > 8)
-            ? (size_t)random_in_range(8, (int)srcImageInfo->arraySize - 1, d)
-            : srcImageInfo->arraySize;
-
-        // Now pick positions within valid ranges
-        sourcePos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-        sourcePos[1] = (srcImageInfo->arraySize > regionSize[1])
-            ? (size_t)random_in_range(
-                0, (int)(srcImageInfo->arraySize - regionSize[1] - 1), d)
-            : 0;
-
-
-        destPos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-        destPos[1] = (dstImageInfo->arraySize > regionSize[1])
-            ? (size_t)random_in_range(
-                0, (int)(dstImageInfo->arraySize - regionSize[1] - 1), d)
-            : 0;
-
+        const size_t srcDims[] = { width_lod, srcImageInfo->arraySize };
+        const size_t dstDims[] = { width_lod, dstImageInfo->arraySize };
+        get_random_copy_region(2, srcDims, dstDims, d, sourcePos, destPos,
+                               regionSize);
 
         // Go for it!
         retCode =
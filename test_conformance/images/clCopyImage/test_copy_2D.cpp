@@ -110,16 +110,9 @@ int test_copy_image_size_2D(cl_context context, cl_command_queue queue,
             sourcePos[ 2 ] = src_lod;
             destPos[ 2 ] = dst_lod;
         }
-        // Pick a random size
-        regionSize[ 0 ] = ( width_lod > 8 ) ? (size_t)random_in_range( 8, (int)width_lod - 1, d ) : width_lod;
-        regionSize[ 1 ] = ( height_lod > 8 ) ? (size_t)random_in_range( 8, (int)height_lod - 1, d ) : height_lod;
-
-        // Now pick positions within valid ranges
-        sourcePos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-        sourcePos[ 1 ] = ( height_lod > regionSize[ 1 ] ) ? (size_t)random_in_range( 0, (int)( height_lod - regionSize[ 1 ] - 1 ), d ) : 0;
-
-        destPos[ 0 ] = ( width_lod > regionSize[ 0 ] ) ? (size_t)random_in_range( 0, (int)( width_lod - regionSize[ 0 ] - 1 ), d ) : 0;
-        destPos[ 1 ] = ( height_lod > regionSize[ 1 ] ) ? (size_t)random_in_range( 0, (int)( height_lod - regionSize[ 1 ] - 1 ), d ) : 0;
+        const size_t dims[] = { width_lod, height_lod };
+        get_random_copy_region(2, dims, dims, d, sourcePos, destPos,
+                               regionSize);
 
         // Go for it!
         retCode =
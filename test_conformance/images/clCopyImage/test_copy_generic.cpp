@@ -82,6 +82,30 @@ int test_copy_init_images(copy_image_env_t &env, image_descriptor *srcImageInfo,
     return CL_SUCCESS;
 }
 
+void get_random_copy_region(int dimCount, const size_t srcDims[],
+                            const size_t dstDims[], MTdata d,
+                            size_t sourcePos[], size_t destPos[],
+                            size_t regionSize[])
+{
+    // Pick a random size
+    for (int i = 0; i < dimCount; i++)
+        regionSize[i] = (srcDims[i] > 8)
+            ? (size_t)random_in_range(8, (int)srcDims[i] - 1, d)
+            : srcDims[i];
+
+    // Now pick positions within valid ranges
+    for (int i = 0; i < dimCount; i++)
+        sourcePos[i] = (srcDims[i] > regionSize[i])
+            ? (size_t)random_in_range(0, (int)(srcDims[i] - regionSize[i] - 1),
+                                      d)
+            : 0;
+    for (int i = 0; i < dimCount; i++)
+        destPos[i] = (dstDims[i] > regionSize[i])
+            ? (size_t)random_in_range(0, (int)(dstDims[i] - regionSize[i] - 1),
+                                      d)
+            : 0;
+}
+
 int test_copy_image_generic(copy_image_env_t &env,
                             image_descriptor *srcImageInfo,
                             image_descriptor *dstImageInfo,
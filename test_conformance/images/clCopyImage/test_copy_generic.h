@@ -44,4 +44,12 @@ int test_copy_image_generic(copy_image_env_t &env,
                             const size_t sourcePos[], const size_t destPos[],
                             const size_t regionSize[]);
 
+// Picks a random region of at least 8 pixels along each of the first
+// dimCount dimensions, and random positions in the source and destination
+// that it fits at. The other elements of the arrays are left untouched.
+void get_random_copy_region(int dimCount, const size_t srcDims[],
+                            const size_t dstDims[], MTdata d,
+                            size_t sourcePos[], size_t destPos[],
+                            size_t regionSize[]);
+
 #endif
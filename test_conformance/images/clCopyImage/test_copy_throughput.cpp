@@ -0,0 +1,508 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "../testBase.h"
+#include "../common.h"
+#include "test_copy_generic.h"
+#include "harness/parseParameters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Throughput of clEnqueueCopyImage, clEnqueueReadImage, clEnqueueWriteImage
+// and clEnqueueFillImage for every image type. Regions are picked the same
+// way as by the copy tests, and only one in kVerifyInterval commands is
+// checked on the host so that the checks do not disturb the measurement.
+// Images are kept to kSmokeImageBytes unless --benchmark is given.
+
+namespace {
+
+const int kCommandsPerPoint = 16;
+const int kVerifyInterval = 8;
+const size_t kMaxImageBytes = 64 * 1024 * 1024;
+const size_t kSmokeImageBytes = 1024 * 1024;
+const size_t kRowPadding = 16; // in pixels, for the padded host pitch
+
+enum TransferCommand
+{
+    kCopy,
+    kRead,
+    kWrite,
+    kFill,
+};
+const char *command_names[] = { "copy", "read", "write", "fill" };
+
+struct ImageType
+{
+    cl_mem_object_type type;
+    const char *name;
+};
+const ImageType image_types[] = {
+    { CL_MEM_OBJECT_IMAGE1D, "1D" },
+    { CL_MEM_OBJECT_IMAGE1D_ARRAY, "1D array" },
+    { CL_MEM_OBJECT_IMAGE2D, "2D" },
+    { CL_MEM_OBJECT_IMAGE2D_ARRAY, "2D array" },
+    { CL_MEM_OBJECT_IMAGE3D, "3D" },
+};
+
+// Images are addressed as (x, y, z) where y is the layer of a 1D array and z
+// the layer of a 2D array, matching the origin and region arguments.
+struct TransferImages
+{
+    image_descriptor info;
+    size_t dims[3];
+    size_t pixel_size;
+    clMemWrapper src, dst;
+    BufferOwningPtr<char> src_data;
+};
+
+struct DeviceLimits
+{
+    size_t max_width_2d, max_height_2d;
+    size_t max_width_3d, max_height_3d, max_depth_3d;
+    size_t max_array_size;
+    size_t max_bytes;
+};
+
+void pick_dims(cl_mem_object_type type, const DeviceLimits &limits,
+               size_t pixel_size, size_t dims[3])
+{
+    size_t pixels = limits.max_bytes / pixel_size;
+    dims[0] = dims[1] = dims[2] = 1;
+    switch (type)
+    {
+        case CL_MEM_OBJECT_IMAGE1D:
+            dims[0] = std::min(limits.max_width_2d, pixels);
+            break;
+        case CL_MEM_OBJECT_IMAGE1D_ARRAY:
+            dims[0] = std::min<size_t>(limits.max_width_2d, 4096);
+            dims[1] = std::min(limits.max_array_size, pixels / dims[0]);
+            break;
+        case CL_MEM_OBJECT_IMAGE2D:
+            dims[0] = dims[1] = std::min(
+                { limits.max_width_2d, limits.max_height_2d,
+                  (size_t)std::sqrt((double)pixels) });
+            break;
+        case CL_MEM_OBJECT_IMAGE2D_ARRAY:
+            dims[0] = dims[1] = std::min(
+                { limits.max_width_2d, limits.max_height_2d, (size_t)1024 });
+            dims[2] = std::min(limits.max_array_size,
+                               pixels / (dims[0] * dims[1]));
+            break;
+        case CL_MEM_OBJECT_IMAGE3D:
+            dims[0] = dims[1] = dims[2] = std::min(
+                { limits.max_width_3d, limits.max_height_3d,
+                  limits.max_depth_3d, (size_t)std::cbrt((double)pixels) });
+            break;
+    }
+    for (int i = 0; i < 3; i++) dims[i] = std::max<size_t>(dims[i], 1);
+}
+
+int create_images(cl_context context, cl_mem_object_type type,
+                  const cl_image_format *format, const DeviceLimits &limits,
+                  MTdata d, TransferImages &images)
+{
+    int error;
+
+    images.pixel_size = get_pixel_size(format);
+    pick_dims(type, limits, images.pixel_size, images.dims);
+
+    image_descriptor &info = images.info;
+    info = {};
+    info.format = format;
+    info.type = type;
+    info.width = images.dims[0];
+    info.rowPitch = info.width * images.pixel_size;
+    switch (type)
+    {
+        case CL_MEM_OBJECT_IMAGE1D_ARRAY:
+            info.arraySize = images.dims[1];
+            info.slicePitch = info.rowPitch;
+            break;
+        case CL_MEM_OBJECT_IMAGE2D: info.height = images.dims[1]; break;
+        case CL_MEM_OBJECT_IMAGE2D_ARRAY:
+            info.height = images.dims[1];
+            info.arraySize = images.dims[2];
+            info.slicePitch = info.rowPitch * info.height;
+            break;
+        case CL_MEM_OBJECT_IMAGE3D:
+            info.height = images.dims[1];
+            info.depth = images.dims[2];
+            info.slicePitch = info.rowPitch * info.height;
+            break;
+        default: break;
+    }
+
+    if (generate_random_image_data(&info, images.src_data, d) == NULL)
+        return -1;
+
+    cl_image_desc desc = {};
+    desc.image_type = type;
+    desc.image_width = info.width;
+    desc.image_height = info.height;
+    desc.image_depth = info.depth;
+    desc.image_array_size = info.arraySize;
+
+    images.src =
+        clCreateImage(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                      format, &desc, images.src_data, &error);
+    test_error(error, "Unable to create source image");
+    images.dst = clCreateImage(context, CL_MEM_READ_WRITE, format, &desc,
+                               nullptr, &error);
+    test_error(error, "Unable to create destination image");
+    return 0;
+}
+
+// Host pitches to pass for a region-sized host buffer. A 1D array takes the
+// distance between its layers as the slice pitch.
+void host_pitches(cl_mem_object_type type, size_t row_pitch,
+                  const size_t region[3], size_t *api_row_pitch,
+                  size_t *api_slice_pitch)
+{
+    *api_row_pitch = row_pitch;
+    switch (type)
+    {
+        case CL_MEM_OBJECT_IMAGE1D_ARRAY: *api_slice_pitch = row_pitch; break;
+        case CL_MEM_OBJECT_IMAGE2D_ARRAY:
+        case CL_MEM_OBJECT_IMAGE3D:
+            *api_slice_pitch = row_pitch * region[1];
+            break;
+        default: *api_slice_pitch = 0; break;
+    }
+}
+
+int compare_region(const char *a, const size_t a_pos[3], size_t a_row,
+                   size_t a_slice, const char *b, const size_t b_pos[3],
+                   size_t b_row, size_t b_slice, const size_t region[3],
+                   size_t pixel_size)
+{
+    for (size_t z = 0; z < region[2]; z++)
+    {
+        for (size_t y = 0; y < region[1]; y++)
+        {
+            const char *a_line = a + (a_pos[2] + z) * a_slice
+                + (a_pos[1] + y) * a_row + a_pos[0] * pixel_size;
+            const char *b_line = b + (b_pos[2] + z) * b_slice
+                + (b_pos[1] + y) * b_row + b_pos[0] * pixel_size;
+            if (memcmp(a_line, b_line, region[0] * pixel_size))
+            {
+                log_error("ERROR: Mismatch in row %zu of slice %zu of the "
+                          "region\n",
+                          y, z);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int measure_point(cl_command_queue queue, TransferCommand command,
+                  TransferImages &images, bool padded, MTdata d,
+                  double *device_gbps, double *wall_gbps)
+{
+    const size_t px = images.pixel_size;
+    const size_t zero[3] = { 0, 0, 0 };
+    const size_t image_row = images.info.rowPitch;
+    const size_t image_slice = image_row * images.dims[1];
+    std::vector<clEventWrapper> events(kCommandsPerPoint);
+    size_t total_bytes = 0;
+    double wall_seconds = 0.0;
+    int error;
+
+    // Region sized host buffers with room for the padded pitch
+    size_t host_size = (images.dims[0] + kRowPadding) * px * images.dims[1]
+        * images.dims[2];
+    std::vector<char> host(host_size);
+    std::vector<char> readback(host_size);
+    for (size_t i = 0; i < host_size; i++) host[i] = (char)genrand_int32(d);
+
+    // A fill color that every channel type represents exactly, and the
+    // pixel it is expected to produce
+    cl_uint4 fill_color = {};
+    std::vector<char> fill_pixel(px);
+    const cl_image_format *format = images.info.format;
+    switch (format->image_channel_data_type)
+    {
+        case CL_SIGNED_INT8:
+        case CL_SIGNED_INT16:
+        case CL_SIGNED_INT32: {
+            cl_int color[4] = { 5, -6, 7, -8 };
+            memcpy(&fill_color, color, sizeof(color));
+            pack_image_pixel(color, format, fill_pixel.data());
+        }
+        break;
+        case CL_UNSIGNED_INT8:
+        case CL_UNSIGNED_INT16:
+        case CL_UNSIGNED_INT32: {
+            cl_uint color[4] = { 5, 6, 7, 8 };
+            memcpy(&fill_color, color, sizeof(color));
+            pack_image_pixel(color, format, fill_pixel.data());
+        }
+        break;
+        default: {
+            // We need to know the rounding mode, in the case of half to
+            // allow the pixel pack that generates the expected value to
+            // succeed.
+            if (format->image_channel_data_type == CL_HALF_FLOAT)
+                DetectFloatToHalfRoundingMode(queue);
+            float color[4] = { 1.0f, 0.0f, 1.0f, 1.0f };
+            memcpy(&fill_color, color, sizeof(color));
+            pack_image_pixel(color, format, fill_pixel.data());
+        }
+        break;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCommandsPerPoint; i++)
+    {
+        // The whole image first, then random regions as the copy tests do
+        size_t src_pos[3] = { 0, 0, 0 }, dst_pos[3] = { 0, 0, 0 }, region[3];
+        if (i == 0)
+            memcpy(region, images.dims, sizeof(region));
+        else
+            get_random_copy_region(3, images.dims, images.dims, d, src_pos,
+                                   dst_pos, region);
+
+        size_t host_row = (region[0] + (padded ? kRowPadding : 0)) * px;
+        size_t host_slice = host_row * region[1];
+        size_t api_row, api_slice;
+        host_pitches(images.info.type, host_row, region, &api_row, &api_slice);
+
+        switch (command)
+        {
+            case kCopy:
+                error = clEnqueueCopyImage(queue, images.src, images.dst,
+                                           src_pos, dst_pos, region, 0, NULL,
+                                           &events[i]);
+                break;
+            case kRead:
+                error = clEnqueueReadImage(queue, images.src, CL_FALSE, src_pos,
+                                           region, api_row, api_slice,
+                                           host.data(), 0, NULL, &events[i]);
+                break;
+            case kWrite:
+                error = clEnqueueWriteImage(
+                    queue, images.dst, CL_FALSE, dst_pos, region, api_row,
+                    api_slice, host.data(), 0, NULL, &events[i]);
+                break;
+            case kFill:
+                error = clEnqueueFillImage(queue, images.dst, &fill_color,
+                                           dst_pos, region, 0, NULL,
+                                           &events[i]);
+                break;
+        }
+        test_error(error, "Unable to enqueue image transfer");
+        total_bytes += region[0] * region[1] * region[2] * px;
+
+        if (i % kVerifyInterval) continue;
+
+        error = clFinish(queue);
+        test_error(error, "clFinish failed");
+        auto pause = std::chrono::steady_clock::now();
+        wall_seconds += std::chrono::duration<double>(pause - start).count();
+
+        if (command == kRead)
+        {
+            error = compare_region(host.data(), zero, host_row, host_slice,
+                                   images.src_data, src_pos, image_row,
+                                   image_slice, region, px);
+        }
+        else
+        {
+            size_t packed_row = region[0] * px;
+            size_t packed_slice = packed_row * region[1];
+            size_t read_row, read_slice;
+            host_pitches(images.info.type, packed_row, region, &read_row,
+                         &read_slice);
+            error = clEnqueueReadImage(queue, images.dst, CL_TRUE, dst_pos,
+                                       region, read_row, read_slice,
+                                       readback.data(), 0, NULL, NULL);
+            test_error(error, "Unable to read back destination image");
+
+            if (command == kCopy)
+                error = compare_region(readback.data(), zero, packed_row,
+                                       packed_slice, images.src_data, src_pos,
+                                       image_row, image_slice, region, px);
+            else if (command == kWrite)
+                error = compare_region(readback.data(), zero, packed_row,
+                                       packed_slice, host.data(), zero,
+                                       host_row, host_slice, region, px);
+            else
+            {
+                size_t pixels = region[0] * region[1] * region[2];
+                for (size_t p = 0; p < pixels && !error; p++)
+                    if (memcmp(fill_pixel.data(), readback.data() + p * px,
+                               px))
+                    {
+                        log_error("ERROR: Pixel %zu of the filled region "
+                                  "is not the fill color\n",
+                                  p);
+                        error = -1;
+                    }
+            }
+        }
+        if (error)
+        {
+            log_error("ERROR: %s of region %zux%zux%zu from (%zu,%zu,%zu) to "
+                      "(%zu,%zu,%zu) failed\n",
+                      command_names[command], region[0], region[1], region[2],
+                      src_pos[0], src_pos[1], src_pos[2], dst_pos[0],
+                      dst_pos[1], dst_pos[2]);
+            return -1;
+        }
+
+        start = std::chrono::steady_clock::now();
+    }
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+    wall_seconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    double device_seconds = 0.0;
+    for (auto &event : events)
+    {
+        cl_ulong begin, end;
+        error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                        sizeof(begin), &begin, NULL);
+        test_error(error, "Unable to get command start time");
+        error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                        sizeof(end), &end, NULL);
+        test_error(error, "Unable to get command end time");
+        device_seconds += (end - begin) * 1e-9;
+    }
+
+    *device_gbps =
+        device_seconds > 0.0 ? total_bytes / device_seconds * 1e-9 : 0.0;
+    *wall_gbps = total_bytes / wall_seconds * 1e-9;
+    return 0;
+}
+
+// Transfer speed depends on the pixel size far more than on the channel
+// layout, so unless a format is requested on the command line only the first
+// supported format of each pixel size is measured.
+std::vector<cl_image_format> pick_formats(cl_context context,
+                                          cl_mem_object_type type,
+                                          const image_test_context_t &ctx)
+{
+    std::vector<cl_image_format> formats, picked;
+    if (get_format_list(context, type, formats, CL_MEM_READ_WRITE))
+        return picked;
+
+    std::vector<bool> filter_flags(formats.size(), false);
+    filter_formats(formats, filter_flags, nullptr, ctx.channelTypeToUse,
+                   ctx.channelOrderToUse);
+    bool all = ctx.channelTypeToUse != (cl_channel_type)-1
+        || ctx.channelOrderToUse != (cl_channel_order)-1;
+
+    std::vector<size_t> sizes_seen;
+    for (size_t i = 0; i < formats.size(); i++)
+    {
+        if (filter_flags[i]) continue;
+        size_t size = get_pixel_size(&formats[i]);
+        if (!all
+            && std::find(sizes_seen.begin(), sizes_seen.end(), size)
+                != sizes_seen.end())
+            continue;
+        sizes_seen.push_back(size);
+        picked.push_back(formats[i]);
+    }
+    return picked;
+}
+
+} // namespace
+
+int test_image_transfer_throughput(cl_device_id device, cl_context context,
+                                   const image_test_context_t &ctx)
+{
+    int error;
+    RandomSeed seed(gRandomSeed);
+
+    DeviceLimits limits;
+    cl_ulong max_alloc_size;
+    error = clGetDeviceInfo(device, CL_DEVICE_IMAGE2D_MAX_WIDTH,
+                            sizeof(size_t), &limits.max_width_2d, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_IMAGE2D_MAX_HEIGHT,
+                             sizeof(size_t), &limits.max_height_2d, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_IMAGE3D_MAX_WIDTH,
+                             sizeof(size_t), &limits.max_width_3d, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_IMAGE3D_MAX_HEIGHT,
+                             sizeof(size_t), &limits.max_height_3d, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_IMAGE3D_MAX_DEPTH,
+                             sizeof(size_t), &limits.max_depth_3d, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_IMAGE_MAX_ARRAY_SIZE,
+                             sizeof(size_t), &limits.max_array_size, NULL);
+    error |= clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                             sizeof(max_alloc_size), &max_alloc_size, NULL);
+    test_error(error, "Unable to get image limits from device");
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    limits.max_bytes = (size_t)std::min<cl_ulong>(
+        max_alloc_size / 4, full_sweep ? kMaxImageBytes : kSmokeImageBytes);
+
+    clCommandQueueWrapper queue = clCreateCommandQueue(
+        context, device, CL_QUEUE_PROFILING_ENABLE, &error);
+    test_error(error, "Unable to create profiling command queue");
+
+    bool has_3d = checkFor3DImageSupport(device) == 0;
+
+    log_info("%-8s %-34s %-5s %-6s %11s %11s\n", "type", "format", "cmd",
+             "pitch", "device GB/s", "wall GB/s");
+    for (const ImageType &image_type : image_types)
+    {
+        if (image_type.type == CL_MEM_OBJECT_IMAGE3D && !has_3d) continue;
+
+        for (const cl_image_format &format :
+             pick_formats(context, image_type.type, ctx))
+        {
+            TransferImages images;
+            if (create_images(context, image_type.type, &format, limits, seed,
+                              images))
+                return -1;
+
+            char format_name[64];
+            snprintf(format_name, sizeof(format_name), "%s/%s",
+                     GetChannelOrderName(format.image_channel_order),
+                     GetChannelTypeName(format.image_channel_data_type));
+
+            for (int command = kCopy; command <= kFill; command++)
+            {
+                bool has_host_pitch = command == kRead || command == kWrite;
+                for (int padded = 0; padded < (has_host_pitch ? 2 : 1);
+                     padded++)
+                {
+                    double device_gbps, wall_gbps;
+                    if (measure_point(queue, (TransferCommand)command, images,
+                                      padded != 0, seed, &device_gbps,
+                                      &wall_gbps))
+                        return -1;
+
+                    const char *pitch =
+                        has_host_pitch ? (padded ? "padded" : "packed") : "-";
+                    log_info("%-8s %-34s %-5s %-6s %11.3f %11.3f\n",
+                             image_type.name, format_name,
+                             command_names[command], pitch, device_gbps,
+                             wall_gbps);
+                    log_perf(device_gbps, true, "GB/s", "%s %s %s %s",
+                             command_names[command], image_type.name,
+                             format_name, pitch);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -189,7 +189,7 @@ REGISTER_TEST(integer_mad24)
     cl_mem streams[4];
     cl_int *input_ptr[3], *output_ptr, *p;
 
-    cl_program program[2*NUM_PROGRAMS];
+    cl_program program[2];
     cl_kernel kernel[2*NUM_PROGRAMS];
     size_t threads[1];
 
@@ -231,43 +231,38 @@ REGISTER_TEST(integer_mad24)
     err = clEnqueueWriteBuffer(queue, streams[2], CL_TRUE, 0, length, input_ptr[2], 0, NULL, NULL);
       test_error(err, "clEnqueueWriteBuffer failed");
 
-    err = create_single_kernel_helper(context, &program[0], &kernel[0], 1, &int_mad24_kernel_code, "test_int_mad24");
+    // Each element type is built as a single program holding the kernels for
+    // all vector sizes.
+    const char *int_mad24_codes[NUM_PROGRAMS] = {
+        int_mad24_kernel_code,  int2_mad24_kernel_code, int3_mad24_kernel_code,
+        int4_mad24_kernel_code, int8_mad24_kernel_code, int16_mad24_kernel_code
+    };
+    const char *uint_mad24_codes[NUM_PROGRAMS] = {
+        uint_mad24_kernel_code,  uint2_mad24_kernel_code,
+        uint3_mad24_kernel_code, uint4_mad24_kernel_code,
+        uint8_mad24_kernel_code, uint16_mad24_kernel_code
+    };
+    char kernel_name[32];
+
+    err = create_single_kernel_helper(context, &program[0], &kernel[0],
+                                      NUM_PROGRAMS, int_mad24_codes,
+                                      "test_int_mad24");
     if (err)
         return -1;
-    err = create_single_kernel_helper(context, &program[1], &kernel[1], 1, &int2_mad24_kernel_code, "test_int2_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[2], &kernel[2], 1, &int3_mad24_kernel_code, "test_int3_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[3], &kernel[3], 1, &int4_mad24_kernel_code, "test_int4_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[4], &kernel[4], 1, &int8_mad24_kernel_code, "test_int8_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[5], &kernel[5], 1, &int16_mad24_kernel_code, "test_int16_mad24");
+    err = create_single_kernel_helper(context, &program[1],
+                                      &kernel[NUM_PROGRAMS], NUM_PROGRAMS,
+                                      uint_mad24_codes, "test_uint_mad24");
     if (err)
         return -1;
 
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS], &kernel[NUM_PROGRAMS], 1, &uint_mad24_kernel_code, "test_uint_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+1], &kernel[NUM_PROGRAMS+1], 1, &uint2_mad24_kernel_code, "test_uint2_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+2], &kernel[NUM_PROGRAMS+2], 1, &uint3_mad24_kernel_code, "test_uint3_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+3], &kernel[NUM_PROGRAMS+3], 1, &uint4_mad24_kernel_code, "test_uint4_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+4], &kernel[NUM_PROGRAMS+4], 1, &uint8_mad24_kernel_code, "test_uint8_mad24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+5], &kernel[NUM_PROGRAMS+5], 1, &uint16_mad24_kernel_code, "test_uint16_mad24");
-    if (err)
-        return -1;
+    for (i = 0; i < 2 * NUM_PROGRAMS; i++)
+    {
+        if (i % NUM_PROGRAMS == 0) continue;
+        sprintf(kernel_name, "test_%s_mad24", test_str_names[i]);
+        kernel[i] =
+            clCreateKernel(program[i / NUM_PROGRAMS], kernel_name, &err);
+        test_error(err, "clCreateKernel failed");
+    }
 
     for (i=0; i< 2*NUM_PROGRAMS; i++)
     {
@@ -353,8 +348,9 @@ REGISTER_TEST(integer_mad24)
     for (i=0; i<2*NUM_PROGRAMS; i++)
     {
         clReleaseKernel(kernel[i]);
-        clReleaseProgram(program[i]);
     }
+    clReleaseProgram(program[0]);
+    clReleaseProgram(program[1]);
     free(input_ptr[0]);
     free(input_ptr[1]);
     free(input_ptr[2]);
@@ -73,7 +73,7 @@ const char *int16_mul24_kernel_code =
 "}\n";
 
 const char *uint_mul24_kernel_code =
-"__kernel void test_int_mul24(__global uint *srcA, __global uint *srcB, __global uint *dst)\n"
+"__kernel void test_uint_mul24(__global uint *srcA, __global uint *srcB, __global uint *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -81,7 +81,7 @@ const char *uint_mul24_kernel_code =
 "}\n";
 
 const char *uint2_mul24_kernel_code =
-"__kernel void test_int2_mul24(__global uint2 *srcA, __global uint2 *srcB, __global uint2 *dst)\n"
+"__kernel void test_uint2_mul24(__global uint2 *srcA, __global uint2 *srcB, __global uint2 *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -89,7 +89,7 @@ const char *uint2_mul24_kernel_code =
 "}\n";
 
 const char *uint3_mul24_kernel_code =
-"__kernel void test_int3_mul24(__global uint *srcA, __global uint *srcB, __global uint *dst)\n"
+"__kernel void test_uint3_mul24(__global uint *srcA, __global uint *srcB, __global uint *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "    uint3 tmp = mul24(vload3(tid, srcA), vload3(tid, srcB));\n"
@@ -97,7 +97,7 @@ const char *uint3_mul24_kernel_code =
 "}\n";
 
 const char *uint4_mul24_kernel_code =
-"__kernel void test_int4_mul24(__global uint4 *srcA, __global uint4 *srcB, __global uint4 *dst)\n"
+"__kernel void test_uint4_mul24(__global uint4 *srcA, __global uint4 *srcB, __global uint4 *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -105,7 +105,7 @@ const char *uint4_mul24_kernel_code =
 "}\n";
 
 const char *uint8_mul24_kernel_code =
-"__kernel void test_int8_mul24(__global uint8 *srcA, __global uint8 *srcB, __global uint8 *dst)\n"
+"__kernel void test_uint8_mul24(__global uint8 *srcA, __global uint8 *srcB, __global uint8 *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -113,7 +113,7 @@ const char *uint8_mul24_kernel_code =
 "}\n";
 
 const char *uint16_mul24_kernel_code =
-"__kernel void test_int16_mul24(__global uint16 *srcA, __global uint16 *srcB, __global uint16 *dst)\n"
+"__kernel void test_uint16_mul24(__global uint16 *srcA, __global uint16 *srcB, __global uint16 *dst)\n"
 "{\n"
 "    int  tid = get_global_id(0);\n"
 "\n"
@@ -175,7 +175,7 @@ REGISTER_TEST(integer_mul24)
     cl_mem streams[3];
     cl_int *input_ptr[2], *output_ptr, *p;
 
-    cl_program program[NUM_PROGRAMS*2];
+    cl_program program[2];
     cl_kernel kernel[NUM_PROGRAMS*2];
     size_t threads[1];
 
@@ -229,43 +229,38 @@ REGISTER_TEST(integer_mul24)
         log_error("clEnqueueWriteBuffer failed\n");
         return -1;
     }
-    err = create_single_kernel_helper(context, &program[0], &kernel[0], 1, &int_mul24_kernel_code, "test_int_mul24");
+    // Each element type is built as a single program holding the kernels for
+    // all vector sizes.
+    const char *int_mul24_codes[NUM_PROGRAMS] = {
+        int_mul24_kernel_code,  int2_mul24_kernel_code, int3_mul24_kernel_code,
+        int4_mul24_kernel_code, int8_mul24_kernel_code, int16_mul24_kernel_code
+    };
+    const char *uint_mul24_codes[NUM_PROGRAMS] = {
+        uint_mul24_kernel_code,  uint2_mul24_kernel_code,
+        uint3_mul24_kernel_code, uint4_mul24_kernel_code,
+        uint8_mul24_kernel_code, uint16_mul24_kernel_code
+    };
+    char kernel_name[32];
+
+    err = create_single_kernel_helper(context, &program[0], &kernel[0],
+                                      NUM_PROGRAMS, int_mul24_codes,
+                                      "test_int_mul24");
     if (err)
         return -1;
-    err = create_single_kernel_helper(context, &program[1], &kernel[1], 1, &int2_mul24_kernel_code, "test_int2_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[2], &kernel[2], 1, &int3_mul24_kernel_code, "test_int3_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[3], &kernel[3], 1, &int4_mul24_kernel_code, "test_int4_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[4], &kernel[4], 1, &int8_mul24_kernel_code, "test_int8_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[5], &kernel[5], 1, &int16_mul24_kernel_code, "test_int16_mul24");
+    err = create_single_kernel_helper(context, &program[1],
+                                      &kernel[NUM_PROGRAMS], NUM_PROGRAMS,
+                                      uint_mul24_codes, "test_uint_mul24");
     if (err)
         return -1;
 
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS], &kernel[NUM_PROGRAMS], 1, &uint_mul24_kernel_code, "test_int_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+1], &kernel[NUM_PROGRAMS+1], 1, &uint2_mul24_kernel_code, "test_int2_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+2], &kernel[NUM_PROGRAMS+2], 1, &uint3_mul24_kernel_code, "test_int3_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+3], &kernel[NUM_PROGRAMS+3], 1, &uint4_mul24_kernel_code, "test_int4_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+4], &kernel[NUM_PROGRAMS+4], 1, &uint8_mul24_kernel_code, "test_int8_mul24");
-    if (err)
-        return -1;
-    err = create_single_kernel_helper(context, &program[NUM_PROGRAMS+5], &kernel[NUM_PROGRAMS+5], 1, &uint16_mul24_kernel_code, "test_int16_mul24");
-    if (err)
-        return -1;
+    for (i = 0; i < 2 * NUM_PROGRAMS; i++)
+    {
+        if (i % NUM_PROGRAMS == 0) continue;
+        sprintf(kernel_name, "test_%s_mul24", test_str_names[i]);
+        kernel[i] =
+            clCreateKernel(program[i / NUM_PROGRAMS], kernel_name, &err);
+        test_error(err, "clCreateKernel failed");
+    }
 
     for (i=0; i<2*NUM_PROGRAMS; i++)
     {
@@ -376,8 +371,9 @@ REGISTER_TEST(integer_mul24)
     for (i=0; i<2*NUM_PROGRAMS; i++)
     {
         clReleaseKernel(kernel[i]);
-        clReleaseProgram(program[i]);
     }
+    clReleaseProgram(program[0]);
+    clReleaseProgram(program[1]);
     free(input_ptr[0]);
     free(input_ptr[1]);
     free(output_ptr);
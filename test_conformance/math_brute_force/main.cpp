@@ -103,6 +103,7 @@ cl_mem gOutBuffer2[VECTOR_SIZE_COUNT] = { NULL, NULL, NULL, NULL, NULL, NULL };
 static MTdataHolder gMTdata;
 cl_device_fp_config gFloatCapabilities = 0;
 int gWimpyReductionFactor = 32;
+int gStratifiedSampling = 0;
 int gVerboseBruteForce = 0;
 
 cl_half_rounding_mode gHalfRoundingMode = CL_HALF_RTE;
@@ -407,6 +408,7 @@ static test_status ParseArgs(int &argc, const char *argv[],
         -s     Stop on error
         -[2^n] Set wimpy reduction factor, recommended range of n is 1-10, default factor()"
         + std::to_string(gWimpyReductionFactor) + R"()
+        -t     Toggle risk-weighted stratified sampling of float inputs in wimpy mode. (Default: off)
         -b     Fill buffers on host instead of device. (Default: off)
         -z     Toggle FTZ mode (Section 6.5.3) for all functions. (Set by device capabilities by default.)
         -v     Toggle Verbosity (Default: off)
@@ -455,6 +457,8 @@ static test_status ParseArgs(int &argc, const char *argv[],
 
                     case 'v': gVerboseBruteForce ^= 1; break;
 
+                    case 't': gStratifiedSampling ^= 1; break;
+
                     case '[':
                         parseWimpyReductionFactor(arg, gWimpyReductionFactor);
                         break;
@@ -527,8 +531,11 @@ static test_status ParseArgs(int &argc, const char *argv[],
         vlog("\n");
         vlog("*** WARNING: Testing in Wimpy mode!                     ***\n");
         vlog("*** Wimpy mode is not sufficient to verify correctness. ***\n");
-        vlog("*** Wimpy Reduction Factor: %-27u ***\n\n",
+        vlog("*** Wimpy Reduction Factor: %-27u ***\n",
              gWimpyReductionFactor);
+        if (gStratifiedSampling)
+            vlog("*** %-51s ***\n", "Stratified sampling of float inputs.");
+        vlog("\n");
     }
 
     if (gSkipCorrectnessTesting)
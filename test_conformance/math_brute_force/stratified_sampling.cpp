@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "stratified_sampling.h"
+#include "common.h"
+#include "utility.h"
+#include "harness/csvHelpers.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Number of ulps on either side of a special value, pole or previously
+// failing input that are tested exhaustively.
+constexpr uint32_t kNeighbourhoodUlps = 64;
+
+// Number of multiples of pi/2 (or of 1/2 for the *pi functions) on each side
+// of zero around which the trigonometric functions are tested exhaustively.
+constexpr int kTrigMultiples = 64;
+
+// Number of negative integers around which lgamma and tgamma are tested
+// exhaustively.
+constexpr int kGammaPoles = 64;
+
+// Relative sample density of each range of exponents.
+const char *ExponentKind(uint32_t exponent, double &weight)
+{
+    if (exponent == 0)
+    {
+        weight = 16.0;
+        return "denormal";
+    }
+    if (exponent == 0xff)
+    {
+        weight = 1.0;
+        return "inf_nan";
+    }
+    // Results of most functions underflow or overflow here
+    if (exponent <= 24)
+    {
+        weight = 4.0;
+        return "tiny";
+    }
+    if (exponent >= 230)
+    {
+        weight = 4.0;
+        return "huge";
+    }
+    // 2^-10 to 2^8: cancellation near 1, argument reduction of the
+    // trigonometric functions and the exp overflow thresholds
+    if (exponent >= 117 && exponent <= 134)
+    {
+        weight = 4.0;
+        return "unit";
+    }
+    weight = 1.0;
+    return "normal";
+}
+
+uint32_t AsUInt(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Strips the half_ and native_ prefixes from a function name
+const char *BaseName(const char *fname)
+{
+    if (strncmp(fname, "half_", 5) == 0) return fname + 5;
+    if (strncmp(fname, "native_", 7) == 0) return fname + 7;
+    return fname;
+}
+
+} // anonymous namespace
+
+FloatInputStrata::FloatInputStrata(const char *fname, uint64_t sampleCount)
+    : fname(fname)
+{
+    AddExponentStrata();
+
+    for (float value : getFloatSpecialValues())
+        AddNeighbourhood("special", value);
+
+    const char *base = BaseName(fname);
+    if (strcmp(base, "sin") == 0 || strcmp(base, "cos") == 0
+        || strcmp(base, "tan") == 0)
+    {
+        for (int k = 1; k <= kTrigMultiples; k++)
+        {
+            AddNeighbourhood("pole", (float)(k * M_PI_2));
+            AddNeighbourhood("pole", (float)(-k * M_PI_2));
+        }
+    }
+    else if (strcmp(base, "sinpi") == 0 || strcmp(base, "cospi") == 0
+             || strcmp(base, "tanpi") == 0)
+    {
+        for (int k = 1; k <= kTrigMultiples; k++)
+        {
+            AddNeighbourhood("pole", 0.5f * k);
+            AddNeighbourhood("pole", -0.5f * k);
+        }
+    }
+    else if (strcmp(base, "lgamma") == 0 || strcmp(base, "tgamma") == 0)
+    {
+        for (int k = 1; k <= kGammaPoles; k++)
+            AddNeighbourhood("pole", (float)-k);
+    }
+
+    AddHistory();
+    Allocate(sampleCount);
+}
+
+void FloatInputStrata::AddExponentStrata()
+{
+    for (uint32_t sign = 0; sign < 2; sign++)
+    {
+        for (uint32_t exponent = 0; exponent <= 0xff; exponent++)
+        {
+            Stratum stratum{};
+            stratum.kind = ExponentKind(exponent, stratum.weight);
+            stratum.first = (sign << 31) | (exponent << 23);
+            stratum.size = 1ULL << 23;
+            strata.push_back(stratum);
+        }
+    }
+}
+
+void FloatInputStrata::AddNeighbourhood(const char *kind, float value)
+{
+    uint32_t bits = AsUInt(value);
+    uint32_t sign = bits & 0x80000000U;
+    uint32_t magnitude = bits & 0x7fffffffU;
+
+    // Stay on the same side of zero; the other side has its own neighbourhood
+    // when it matters
+    uint32_t low = magnitude > kNeighbourhoodUlps
+        ? magnitude - kNeighbourhoodUlps
+        : 0;
+    uint32_t high = std::min(magnitude + kNeighbourhoodUlps, 0x7fffffffU);
+
+    Stratum stratum{};
+    stratum.kind = kind;
+    stratum.first = sign | low;
+    stratum.size = (uint64_t)(high - low) + 1;
+    stratum.exhaustive = true;
+    strata.push_back(stratum);
+}
+
+void FloatInputStrata::AddHistory()
+{
+    const char *file_name = getenv("CL_MATH_BRUTE_FORCE_HISTORY");
+    if (file_name == NULL) return;
+
+    FILE *file = fopen(file_name, "r");
+    if (file == NULL)
+    {
+        vlog_error("Error: Unable to open history file '%s'\n", file_name);
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        char name[128];
+        unsigned int bits;
+        if (line[0] == '#' || sscanf(line, "%127s %x", name, &bits) != 2)
+            continue;
+        if (strcmp(name, fname) != 0) continue;
+
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        AddNeighbourhood("history", value);
+    }
+    fclose(file);
+}
+
+void FloatInputStrata::Allocate(uint64_t sampleCount)
+{
+    uint64_t remaining = sampleCount;
+    for (Stratum &stratum : strata)
+    {
+        if (!stratum.exhaustive) continue;
+        stratum.samples = std::min(stratum.size, remaining);
+        remaining -= stratum.samples;
+    }
+
+    // Share what is left in proportion to the weights, handing out the share
+    // of strata that are smaller than their share to the others
+    bool progress = true;
+    while (remaining > 0 && progress)
+    {
+        double total_weight = 0.0;
+        for (const Stratum &stratum : strata)
+            if (!stratum.exhaustive && stratum.samples < stratum.size)
+                total_weight += stratum.weight;
+        if (total_weight == 0.0) break;
+
+        progress = false;
+        uint64_t available = remaining;
+        for (Stratum &stratum : strata)
+        {
+            if (stratum.exhaustive || stratum.samples == stratum.size)
+                continue;
+            uint64_t share = (uint64_t)(available * stratum.weight
+                                        / total_weight);
+            share = std::min(
+                { share, stratum.size - stratum.samples, remaining });
+            stratum.samples += share;
+            remaining -= share;
+            progress |= share > 0;
+        }
+    }
+
+    // Rounding leftovers
+    for (Stratum &stratum : strata)
+    {
+        if (remaining == 0) break;
+        if (stratum.exhaustive || stratum.samples == stratum.size) continue;
+        stratum.samples++;
+        remaining--;
+    }
+
+    totalSamples = 0;
+    for (Stratum &stratum : strata)
+    {
+        stratum.offset = totalSamples;
+        totalSamples += stratum.samples;
+    }
+}
+
+void FloatInputStrata::Fill(uint32_t *out, uint64_t first, size_t count) const
+{
+    if (totalSamples == 0) return;
+
+    uint64_t index = first % totalSamples;
+    auto it = std::upper_bound(
+        strata.begin(), strata.end(), index,
+        [](uint64_t i, const Stratum &stratum) { return i < stratum.offset; });
+    size_t s = (it - strata.begin()) - 1;
+
+    for (size_t j = 0; j < count; j++)
+    {
+        while (index >= strata[s].offset + strata[s].samples) s++;
+
+        // Spread the samples evenly over the stratum
+        const Stratum &stratum = strata[s];
+        uint64_t k = index - stratum.offset;
+        out[j] = stratum.first + (uint32_t)(k * stratum.size / stratum.samples);
+
+        if (++index == totalSamples)
+        {
+            index = 0;
+            s = 0;
+        }
+    }
+}
+
+void FloatInputStrata::LogCoverage() const
+{
+    struct KindCoverage
+    {
+        const char *kind;
+        size_t strata;
+        uint64_t samples;
+        uint64_t size;
+    };
+    std::vector<KindCoverage> kinds;
+    for (const Stratum &stratum : strata)
+    {
+        auto it = std::find_if(kinds.begin(), kinds.end(),
+                               [&](const KindCoverage &coverage) {
+                                   return strcmp(coverage.kind, stratum.kind)
+                                       == 0;
+                               });
+        if (it == kinds.end())
+            it = kinds.insert(kinds.end(), { stratum.kind, 0, 0, 0 });
+        it->strata++;
+        it->samples += stratum.samples;
+        it->size += stratum.size;
+    }
+
+    vlog("\tStratified sampling coverage for %s:\n", fname);
+    for (const KindCoverage &coverage : kinds)
+    {
+        vlog("\t  %-10s %5zu strata %12" PRIu64 " of %12" PRIu64
+             " inputs (%.4f%%)\n",
+             coverage.kind, coverage.strata, coverage.samples, coverage.size,
+             100.0 * coverage.samples / coverage.size);
+    }
+
+    FILE *file = open_results_csv(
+        "CL_MATH_STRATIFIED_COVERAGE_CSV",
+        "function,kind,first,last,allocation,samples,coverage");
+    if (file == NULL) return;
+
+    for (const Stratum &stratum : strata)
+    {
+        fprintf(file, "%s,%s,0x%08x,0x%08x,%s,%" PRIu64 ",%.6f\n", fname,
+                stratum.kind, stratum.first,
+                (uint32_t)(stratum.first + stratum.size - 1),
+                stratum.exhaustive ? "exhaustive" : "weighted", stratum.samples,
+                (double)stratum.samples / stratum.size);
+    }
+    fclose(file);
+}
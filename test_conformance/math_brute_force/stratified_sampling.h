@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef STRATIFIED_SAMPLING_H
+#define STRATIFIED_SAMPLING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Risk-weighted stratified sampling of the 32-bit float input space, used in
+// place of a fixed stride when wimpy mode runs with stratified sampling
+// enabled.
+//
+// The input space is partitioned into one stratum per sign and exponent, and
+// a fixed number of samples is shared between them in proportion to a risk
+// weight, so denormals, values near 1 and values close to underflow or
+// overflow are tested much more densely than the rest of the range.
+// Neighbourhoods of the special values, of the poles and zeros of the
+// trigonometric and gamma functions, and of inputs listed in the file named
+// by CL_MATH_BRUTE_FORCE_HISTORY are tested exhaustively. Each line of that
+// file holds a function name and the bit pattern of an input that failed on
+// an earlier run, e.g. "tan 0x4b3ba2e1".
+class FloatInputStrata {
+public:
+    // Distributes sampleCount samples between the strata for function fname
+    FloatInputStrata(const char *fname, uint64_t sampleCount);
+
+    // Writes the bit patterns of samples [first, first + count) to out.
+    // Sample indices wrap around if fewer samples than requested could be
+    // allocated.
+    void Fill(uint32_t *out, uint64_t first, size_t count) const;
+
+    // Logs the fraction of each kind of stratum that was sampled, and
+    // appends every stratum to the file named by
+    // CL_MATH_STRATIFIED_COVERAGE_CSV if it is set
+    void LogCoverage() const;
+
+private:
+    struct Stratum
+    {
+        const char *kind;
+        uint32_t first;
+        uint64_t size;
+        double weight;
+        bool exhaustive;
+        uint64_t samples;
+        // Index of the first sample in this stratum
+        uint64_t offset;
+    };
+
+    void AddExponentStrata();
+    void AddNeighbourhood(const char *kind, float value);
+    void AddHistory();
+    void Allocate(uint64_t sampleCount);
+
+    const char *fname;
+    std::vector<Stratum> strata;
+    uint64_t totalSamples = 0;
+};
+
+#endif /* STRATIFIED_SAMPLING_H */
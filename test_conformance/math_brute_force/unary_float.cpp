@@ -16,10 +16,12 @@
 
 #include "common.h"
 #include "function_list.h"
+#include "stratified_sampling.h"
 #include "test_functions.h"
 #include "utility.h"
 
 #include <cstring>
+#include <memory>
 
 namespace {
 
@@ -50,6 +52,9 @@ struct TestInfo : public TestInfoBase
 
     // Array of thread specific information
     std::vector<ThreadInfoUnary> tinfo;
+
+    // Input strata when stratified sampling is used instead of a fixed step.
+    std::unique_ptr<FloatInputStrata> strata;
 };
 
 cl_int Test(cl_uint job_id, cl_uint thread_id, void *data)
@@ -99,9 +104,12 @@ cl_int Test(cl_uint job_id, cl_uint thread_id, void *data)
 
     // Write the new values to the input array
     cl_uint *p = (cl_uint *)gIn + thread_id * buffer_elements;
+    if (job->strata)
+        job->strata->Fill(p, (uint64_t)job_id * buffer_elements,
+                          buffer_elements);
     for (size_t j = 0; j < buffer_elements; j++)
     {
-        p[j] = base + j * scale;
+        if (!job->strata) p[j] = base + j * scale;
         if (relaxedMode)
         {
             float p_j = *(float *)&p[j];
@@ -536,6 +544,12 @@ int TestFunc_Float_Float(const Func *f, MTdata d, bool relaxedMode)
             INFINITY; // out of range resut from finite inputs must be numeric
     }
 
+    // Sample as many inputs as the fixed step would, but concentrate them
+    // where failures are most likely
+    if (gWimpyMode && gStratifiedSampling)
+        test_info.strata = std::make_unique<FloatInputStrata>(
+            f->name, (uint64_t)test_info.jobCount * test_info.subBufferSize);
+
     bool correctlyRounded = strcmp(f->name, "sqrt_cr") == 0;
 
     // Init the kernels
@@ -573,5 +587,7 @@ int TestFunc_Float_Float(const Func *f, MTdata d, bool relaxedMode)
 
     vlog("\n");
 
+    if (test_info.strata) test_info.strata->LogCoverage();
+
     return CL_SUCCESS;
 }
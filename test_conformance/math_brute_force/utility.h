@@ -38,6 +38,7 @@
 struct Func;
 
 extern int gWimpyReductionFactor;
+extern int gStratifiedSampling;
 
 #define VECTOR_SIZE_COUNT 6
 extern const char *sizeNames[VECTOR_SIZE_COUNT];
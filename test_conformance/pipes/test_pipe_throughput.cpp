@@ -0,0 +1,327 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "harness/compat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "harness/conversions.h"
+#include "harness/csvHelpers.h"
+#include "harness/errorHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+#include "harness/testHarness.h"
+#include "harness/typeWrappers.h"
+
+// Benchmark of the throughput of pipes, using the producer and consumer
+// kernels of the pipe_readwrite tests. For int packets of 4 to 64 bytes and
+// pipes of 4K to 1M packets, a producer kernel fills the pipe and a consumer
+// kernel drains it, with:
+// - plain: read_pipe and write_pipe without reservation;
+// - reserve: a reservation of one packet per work-item;
+// - work_group: one reservation per work-group;
+// - sub_group: one reservation per sub-group, with cl_khr_subgroups.
+// The producer and consumer times come from profiling timestamps; the median
+// of a few runs is reported as packets and bytes per second, with the time
+// relative to plain access as the reservation overhead. As the generated
+// kernels do not retry, every run moves exactly as many packets as the pipe
+// holds. Results are appended to the file named by CL_PIPE_THROUGHPUT_CSV if
+// it is set.
+//
+// The larger pipes and all runs only happen with --benchmark. Otherwise each
+// style moves the packets of a 4K pipe twice, which checks the data but is
+// too short for stable rates.
+
+// Kernel source generators from test_pipe_read_write.cpp
+void createKernelSource(std::stringstream &stream, char *type);
+void createKernelSourceWorkGroup(std::stringstream &stream, char *type);
+void createKernelSourceSubGroup(std::stringstream &stream, char *type);
+void createKernelSourceConvenience(std::stringstream &stream, char *type);
+
+namespace {
+
+const unsigned int throughput_vector_sizes[] = { 1, 2, 4, 8, 16 };
+const cl_uint throughput_capacities[] = { 1 << 12, 1 << 16, 1 << 20 };
+const cl_uint throughput_smoke_capacities[] = { 1 << 12 };
+const size_t throughput_runs = 5;
+const size_t throughput_smoke_runs = 2;
+
+struct PipeStyle
+{
+    const char *name;
+    void (*create_source)(std::stringstream &, char *);
+    const char *kernel_prefix;
+    // Reservations are made by whole work-groups or sub-groups
+    bool group_reserve;
+};
+
+const PipeStyle pipe_styles[] = {
+    { "plain", createKernelSourceConvenience, "test_pipe_convenience_",
+      false },
+    { "reserve", createKernelSource, "test_pipe_", false },
+    { "work_group", createKernelSourceWorkGroup, "test_pipe_workgroup_", true },
+    { "sub_group", createKernelSourceSubGroup, "test_pipe_subgroup_", true },
+};
+
+struct PipeTimes
+{
+    double write_ns = 0.0;
+    double read_ns = 0.0;
+};
+
+cl_int event_duration_ns(cl_event event, double &duration)
+{
+    cl_ulong start = 0, end = 0;
+    cl_int err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                         sizeof(start), &start, NULL);
+    err |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                   sizeof(end), &end, NULL);
+    test_error(err, "clGetEventProfilingInfo failed");
+    duration = (double)(end - start);
+    return CL_SUCCESS;
+}
+
+// Fills a pipe of capacity packets of type int<vector_size> and drains it
+// runs times, checking the data moved every time
+cl_int run_pipe_style(cl_device_id device, cl_context context,
+                      cl_command_queue queue, const PipeStyle &style,
+                      unsigned int vector_size, cl_uint capacity, size_t runs,
+                      PipeTimes &times)
+{
+    char type[16];
+    if (vector_size == 1)
+        snprintf(type, sizeof(type), "int");
+    else
+        snprintf(type, sizeof(type), "int%u", vector_size);
+    const size_t packet_size = vector_size * sizeof(cl_int);
+    const size_t count = (size_t)capacity * vector_size;
+
+    std::stringstream source_code;
+    style.create_source(source_code, type);
+    std::string kernel_source = source_code.str();
+    const char *sources[] = { kernel_source.c_str() };
+    std::string write_name = std::string(style.kernel_prefix) + "write_" + type;
+    std::string read_name = std::string(style.kernel_prefix) + "read_" + type;
+
+    clProgramWrapper program;
+    clKernelWrapper producer, consumer;
+    cl_int err = create_single_kernel_helper(context, &program, &producer, 1,
+                                             sources, write_name.c_str());
+    test_error(err, "Error creating program");
+    consumer = clCreateKernel(program, read_name.c_str(), &err);
+    test_error(err, "Error creating kernel");
+
+    MTdataHolder d(gRandomSeed);
+    std::vector<cl_uint> input(count);
+    cl_uint input_sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        input[i] = genrand_int32(d);
+        input_sum += input[i];
+    }
+
+    clMemWrapper src =
+        clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                       count * sizeof(cl_uint), input.data(), &err);
+    test_error(err, "clCreateBuffer failed");
+    clMemWrapper dst = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                                      count * sizeof(cl_uint), NULL, &err);
+    test_error(err, "clCreateBuffer failed");
+    clMemWrapper pipe =
+        clCreatePipe(context, CL_MEM_HOST_NO_ACCESS, (cl_uint)packet_size,
+                     capacity, NULL, &err);
+    test_error(err, "clCreatePipe failed");
+
+    err = clSetKernelArg(producer, 0, sizeof(cl_mem), &src);
+    err |= clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe);
+    err |= clSetKernelArg(consumer, 0, sizeof(cl_mem), &pipe);
+    err |= clSetKernelArg(consumer, 1, sizeof(cl_mem), &dst);
+    test_error(err, "clSetKernelArg failed");
+
+    size_t global_size = capacity;
+    size_t producer_local = 0, consumer_local = 0;
+    if (style.group_reserve)
+    {
+        err = get_max_common_work_group_size(context, producer, global_size,
+                                             &producer_local);
+        test_error(err, "Unable to get work group size to use");
+        err = get_max_common_work_group_size(context, consumer, global_size,
+                                             &consumer_local);
+        test_error(err, "Unable to get work group size to use");
+    }
+
+    std::vector<double> write_ns, read_ns;
+    std::vector<cl_uint> output(count);
+    for (size_t run = 0; run < runs; run++)
+    {
+        // Nothing from the previous run may stand in for lost packets
+        const cl_uint pattern = 0;
+        err = clEnqueueFillBuffer(queue, dst, &pattern, sizeof(pattern), 0,
+                                  count * sizeof(cl_uint), 0, NULL, NULL);
+        test_error(err, "clEnqueueFillBuffer failed");
+
+        clEventWrapper producer_event, consumer_event;
+        err = clEnqueueNDRangeKernel(
+            queue, producer, 1, NULL, &global_size,
+            style.group_reserve ? &producer_local : NULL, 0, NULL,
+            &producer_event);
+        test_error(err, "clEnqueueNDRangeKernel failed");
+        err = clEnqueueNDRangeKernel(
+            queue, consumer, 1, NULL, &global_size,
+            style.group_reserve ? &consumer_local : NULL, 1, &producer_event,
+            &consumer_event);
+        test_error(err, "clEnqueueNDRangeKernel failed");
+        err = clEnqueueReadBuffer(queue, dst, CL_TRUE, 0,
+                                  count * sizeof(cl_uint), output.data(), 1,
+                                  &consumer_event, NULL);
+        test_error(err, "clEnqueueReadBuffer failed");
+
+        // Packets may come out in any order
+        cl_uint output_sum = 0;
+        for (cl_uint value : output) output_sum += value;
+        if (output_sum != input_sum)
+        {
+            log_error("ERROR: %s pipe of %u %s packets lost data on run "
+                      "%zu\n",
+                      style.name, capacity, type, run);
+            return -1;
+        }
+
+        double duration = 0.0;
+        err = event_duration_ns(producer_event, duration);
+        test_error(err, "Unable to get producer time");
+        write_ns.push_back(duration);
+        err = event_duration_ns(consumer_event, duration);
+        test_error(err, "Unable to get consumer time");
+        read_ns.push_back(duration);
+    }
+
+    times.write_ns = compute_sample_stats(write_ns).median;
+    times.read_ns = compute_sample_stats(read_ns).median;
+    return CL_SUCCESS;
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(pipe_throughput)
+{
+    cl_uint max_packet_size = 0;
+    cl_ulong max_alloc = 0;
+    cl_int err = clGetDeviceInfo(device, CL_DEVICE_PIPE_MAX_PACKET_SIZE,
+                                 sizeof(max_packet_size), &max_packet_size,
+                                 NULL);
+    err |= clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                           sizeof(max_alloc), &max_alloc, NULL);
+    test_error(err, "clGetDeviceInfo failed");
+
+    const bool subgroups = is_extension_available(device, "cl_khr_subgroups");
+    if (!subgroups)
+        log_info("cl_khr_subgroups is not supported; skipping sub-group "
+                 "reservations.\n");
+
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    std::vector<cl_uint> capacities;
+    if (full_sweep)
+        capacities.assign(std::begin(throughput_capacities),
+                          std::end(throughput_capacities));
+    else
+        capacities.assign(std::begin(throughput_smoke_capacities),
+                          std::end(throughput_smoke_capacities));
+    const size_t runs = full_sweep ? throughput_runs : throughput_smoke_runs;
+
+    clCommandQueueWrapper profiling_queue =
+        clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+    test_error(err, "Unable to create profiling queue");
+
+    FILE *file = open_results_csv(
+        "CL_PIPE_THROUGHPUT_CSV",
+        "style,packet_bytes,capacity,write_packets_per_s,read_packets_per_s,"
+        "write_bytes_per_s,read_bytes_per_s,write_vs_plain,read_vs_plain");
+    int total_errors = 0;
+
+    log_info("%-10s %6s %8s %14s %14s %10s %10s %8s %8s\n", "style", "bytes",
+             "packets", "write pkt/s", "read pkt/s", "write MB/s", "read MB/s",
+             "write x", "read x");
+    for (unsigned int vector_size : throughput_vector_sizes)
+    {
+        const size_t packet_size = vector_size * sizeof(cl_int);
+        if (packet_size > max_packet_size)
+        {
+            log_info("Packets of %zu bytes exceed "
+                     "CL_DEVICE_PIPE_MAX_PACKET_SIZE; skipping them.\n",
+                     packet_size);
+            continue;
+        }
+
+        for (cl_uint capacity : capacities)
+        {
+            if ((cl_ulong)capacity * packet_size > max_alloc) continue;
+
+            PipeTimes plain;
+            for (const PipeStyle &style : pipe_styles)
+            {
+                if (style.create_source == createKernelSourceSubGroup
+                    && !subgroups)
+                    continue;
+
+                PipeTimes times;
+                err = run_pipe_style(device, context, profiling_queue, style,
+                                     vector_size, capacity, runs, times);
+                if (err != CL_SUCCESS)
+                {
+                    log_error("ERROR: %s pipe of %u packets of %zu bytes "
+                              "failed\n",
+                              style.name, capacity, packet_size);
+                    total_errors++;
+                    continue;
+                }
+                if (&style == &pipe_styles[0]) plain = times;
+
+                const double write_packets = capacity / (1e-9 * times.write_ns);
+                const double read_packets = capacity / (1e-9 * times.read_ns);
+                const double write_ratio =
+                    plain.write_ns > 0.0 ? times.write_ns / plain.write_ns
+                                         : 0.0;
+                const double read_ratio =
+                    plain.read_ns > 0.0 ? times.read_ns / plain.read_ns : 0.0;
+                log_info("%-10s %6zu %8u %14.0f %14.0f %10.1f %10.1f %8.2f "
+                         "%8.2f\n",
+                         style.name, packet_size, capacity, write_packets,
+                         read_packets, 1e-6 * write_packets * packet_size,
+                         1e-6 * read_packets * packet_size, write_ratio,
+                         read_ratio);
+                log_perf(read_packets, true, "packets/s",
+                         "%s read, %zu byte packets, %u packet pipe",
+                         style.name, packet_size, capacity);
+                if (file)
+                    fprintf(file, "%s,%zu,%u,%.1f,%.1f,%.1f,%.1f,%.4f,%.4f\n",
+                            style.name, packet_size, capacity, write_packets,
+                            read_packets, write_packets * packet_size,
+                            read_packets * packet_size, write_ratio,
+                            read_ratio);
+            }
+        }
+    }
+
+    if (file) fclose(file);
+    return total_errors;
+}
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "procs.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+#include "harness/typeWrappers.h"
+
+#include <vector>
+
+// Reports the queue (queued->submit) and launch (submit->start) overheads and
+// the execution time of small commands of each type, over many repetitions.
+// The commands are as cheap as possible so that the overheads dominate. The
+// test fails if any command has its profiling timestamps out of order.
+
+namespace {
+
+const char *overhead_kernel_source = "__kernel void empty_kernel() {}";
+
+const size_t overhead_buffer_size = 4096;
+const size_t overhead_warmup = 5;
+const size_t overhead_samples = 200;
+const size_t overhead_wimpy_samples = 20;
+
+}
+
+REGISTER_TEST(command_overheads)
+{
+    cl_int error = CL_SUCCESS;
+    clProgramWrapper program;
+    clKernelWrapper kernel;
+    error = create_single_kernel_helper(context, &program, &kernel, 1,
+                                        &overhead_kernel_source,
+                                        "empty_kernel");
+    test_error(error, "Unable to create kernel");
+
+    clMemWrapper src = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                      overhead_buffer_size, nullptr, &error);
+    test_error(error, "Unable to create buffer");
+    clMemWrapper dst = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                      overhead_buffer_size, nullptr, &error);
+    test_error(error, "Unable to create buffer");
+
+    std::vector<cl_uchar> host(overhead_buffer_size, 0);
+    const cl_uint pattern = 0xA5A5A5A5;
+    const size_t global_size = 1;
+
+    struct NamedCommand
+    {
+        const char *name;
+        ProfiledCommand enqueue;
+    };
+    std::vector<NamedCommand> commands = {
+        { "ndrange_kernel",
+          [&](cl_event *event) {
+              return clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                            &global_size, nullptr, 0, nullptr,
+                                            event);
+          } },
+        { "write_buffer",
+          [&](cl_event *event) {
+              return clEnqueueWriteBuffer(queue, src, CL_FALSE, 0,
+                                          overhead_buffer_size, host.data(), 0,
+                                          nullptr, event);
+          } },
+        { "read_buffer",
+          [&](cl_event *event) {
+              return clEnqueueReadBuffer(queue, src, CL_FALSE, 0,
+                                         overhead_buffer_size, host.data(), 0,
+                                         nullptr, event);
+          } },
+        { "copy_buffer",
+          [&](cl_event *event) {
+              return clEnqueueCopyBuffer(queue, src, dst, 0, 0,
+                                         overhead_buffer_size, 0, nullptr,
+                                         event);
+          } },
+        { "fill_buffer",
+          [&](cl_event *event) {
+              return clEnqueueFillBuffer(queue, dst, &pattern, sizeof(pattern),
+                                         0, overhead_buffer_size, 0, nullptr,
+                                         event);
+          } },
+        { "map_buffer",
+          [&](cl_event *event) {
+              cl_int err = CL_SUCCESS;
+              void *mapped = clEnqueueMapBuffer(
+                  queue, dst, CL_FALSE, CL_MAP_READ, 0, overhead_buffer_size,
+                  0, nullptr, event, &err);
+              if (err != CL_SUCCESS) return err;
+              return clEnqueueUnmapMemObject(queue, dst, mapped, 0, nullptr,
+                                             nullptr);
+          } },
+        { "marker",
+          [&](cl_event *event) {
+              return clEnqueueMarkerWithWaitList(queue, 0, nullptr, event);
+          } },
+    };
+
+    const size_t samples =
+        gWimpyMode ? overhead_wimpy_samples : overhead_samples;
+    int result = TEST_PASS;
+    for (const NamedCommand &command : commands)
+    {
+        CommandProfile profile;
+        error = profile_command(queue, command.enqueue, overhead_warmup,
+                                samples, profile);
+        test_error(error, "Unable to profile command");
+
+        log_command_profile(command.name, profile);
+        log_perf(profile.queued_to_submit.median, false, "us",
+                 "%s queued->submit (median)", command.name);
+        log_perf(profile.submit_to_start.median, false, "us",
+                 "%s submit->start (median)", command.name);
+
+        if (profile.ordering_errors)
+        {
+            log_error("ERROR: %zu of %zu %s commands had profiling "
+                      "timestamps out of order.\n",
+                      profile.ordering_errors, samples, command.name);
+            result = TEST_FAIL;
+        }
+    }
+
+    return result;
+}
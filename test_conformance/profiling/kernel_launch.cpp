@@ -0,0 +1,297 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "procs.h"
+#include "harness/csvHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+#include "harness/typeWrappers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Benchmark of the cost of launching empty kernels, for workloads made of
+// many small dispatches. For in-order and out-of-order queues and kernels
+// taking 0 to 32 arguments it reports:
+// - the host time spent in each clEnqueueNDRangeKernel call, alone and
+//   together with setting every argument again before each launch, with and
+//   without returning an event;
+// - the sustained number of launches per second of the same bursts, up to
+//   the clFinish that completes them;
+// - the time from enqueue to start of a single launch, from the
+//   CL_PROFILING_COMMAND_QUEUED and CL_PROFILING_COMMAND_START timestamps.
+// Bursts run on queues without profiling so that it does not add to the
+// host cost. The test fails if any launch starts before it was queued.
+// Results are appended to the file named by CL_KERNEL_LAUNCH_CSV if it is
+// set.
+//
+// Full bursts only run with --benchmark. Otherwise every configuration is
+// launched a few dozen times, which checks the timestamps but is too short
+// for stable rates.
+
+namespace {
+
+const unsigned int launch_arg_counts[] = { 0, 1, 8, 32 };
+
+const size_t launch_warmup = 20;
+const size_t launch_burst = 2000;
+const size_t launch_smoke_burst = 50;
+const size_t latency_samples = 200;
+const size_t latency_smoke_samples = 10;
+
+using clock_type = std::chrono::steady_clock;
+
+double microseconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(clock_type::now() - start)
+        .count();
+}
+
+// Empty kernel whose arguments alternate between global pointers and ints
+std::string launch_kernel_source(unsigned int arg_count)
+{
+    std::string source = "__kernel void launch_kernel(";
+    for (unsigned int i = 0; i < arg_count; i++)
+    {
+        if (i) source += ", ";
+        source += (i % 2 ? "int a" : "__global int *a") + std::to_string(i);
+    }
+    return source + ") {}";
+}
+
+cl_int set_launch_args(cl_kernel kernel, unsigned int arg_count,
+                       cl_mem buffer)
+{
+    cl_int error = CL_SUCCESS;
+    for (cl_uint i = 0; i < arg_count; i++)
+    {
+        cl_int value = i;
+        error |= i % 2 ? clSetKernelArg(kernel, i, sizeof(value), &value)
+                       : clSetKernelArg(kernel, i, sizeof(buffer), &buffer);
+    }
+    return error;
+}
+
+struct BurstConfig
+{
+    bool churn_args;
+    bool events;
+};
+
+const BurstConfig burst_configs[] = {
+    { false, false },
+    { false, true },
+    { true, false },
+    { true, true },
+};
+
+struct BurstResult
+{
+    SampleStats host_us;
+    double launches_per_second = 0.0;
+};
+
+// Launches the kernel burst times back to back, timing each enqueue, then
+// waits for all of them
+cl_int run_burst(cl_command_queue queue, cl_kernel kernel,
+                 unsigned int arg_count, cl_mem buffer,
+                 const BurstConfig &config, size_t burst, BurstResult &result)
+{
+    const size_t global_size = 1;
+    std::vector<double> host_us;
+    host_us.reserve(burst);
+
+    cl_int error = CL_SUCCESS;
+    clock_type::time_point burst_start;
+    for (size_t i = 0; i < launch_warmup + burst; i++)
+    {
+        if (i == launch_warmup)
+        {
+            error = clFinish(queue);
+            test_error(error, "clFinish failed");
+            burst_start = clock_type::now();
+        }
+
+        clock_type::time_point start = clock_type::now();
+        if (config.churn_args)
+        {
+            error = set_launch_args(kernel, arg_count, buffer);
+            test_error(error, "Unable to set kernel arguments");
+        }
+        clEventWrapper event;
+        error = clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                       &global_size, nullptr, 0, nullptr,
+                                       config.events ? &event : nullptr);
+        if (i >= launch_warmup) host_us.push_back(microseconds_since(start));
+        test_error(error, "clEnqueueNDRangeKernel failed");
+    }
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+
+    result.launches_per_second =
+        burst / (1e-6 * microseconds_since(burst_start));
+    result.host_us = compute_sample_stats(host_us);
+    return CL_SUCCESS;
+}
+
+// Time from CL_PROFILING_COMMAND_QUEUED to CL_PROFILING_COMMAND_START of
+// single launches, each completed before the next
+cl_int measure_start_latency(cl_command_queue queue, cl_kernel kernel,
+                             size_t samples, SampleStats &stats,
+                             size_t &ordering_errors)
+{
+    const size_t global_size = 1;
+    std::vector<double> latencies_us;
+    for (size_t i = 0; i < launch_warmup + samples; i++)
+    {
+        clEventWrapper event;
+        cl_int error =
+            clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &global_size,
+                                   nullptr, 0, nullptr, &event);
+        test_error(error, "clEnqueueNDRangeKernel failed");
+        error = clFinish(queue);
+        test_error(error, "clFinish failed");
+        if (i < launch_warmup) continue;
+
+        cl_ulong queued = 0, start = 0;
+        error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED,
+                                        sizeof(queued), &queued, nullptr);
+        error |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                         sizeof(start), &start, nullptr);
+        test_error(error, "Unable to get profiling timestamps");
+        if (start < queued)
+        {
+            ordering_errors++;
+            continue;
+        }
+        latencies_us.push_back(1e-3 * (start - queued));
+    }
+    if (!latencies_us.empty()) stats = compute_sample_stats(latencies_us);
+    return CL_SUCCESS;
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(kernel_launch_latency)
+{
+    cl_command_queue_properties device_properties = 0;
+    cl_int error =
+        clGetDeviceInfo(device, CL_DEVICE_QUEUE_PROPERTIES,
+                        sizeof(device_properties), &device_properties, nullptr);
+    test_error(error, "Unable to query CL_DEVICE_QUEUE_PROPERTIES");
+
+    struct QueueType
+    {
+        const char *name;
+        cl_command_queue_properties properties;
+    };
+    std::vector<QueueType> queue_types = { { "in_order", 0 } };
+    if (device_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE)
+        queue_types.push_back(
+            { "out_of_order", CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE });
+    else
+        log_info("Out-of-order queues are not supported; skipping them.\n");
+
+    clMemWrapper buffer = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                         sizeof(cl_int), nullptr, &error);
+    test_error(error, "Unable to create buffer");
+
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    const size_t burst = full_sweep ? launch_burst : launch_smoke_burst;
+    const size_t samples =
+        full_sweep ? latency_samples : latency_smoke_samples;
+    FILE *file = open_results_csv(
+        "CL_KERNEL_LAUNCH_CSV",
+        "queue,args,set_args,events,host_median_us,host_p99_us,"
+        "launches_per_s,start_latency_median_us");
+    int result = TEST_PASS;
+
+    log_info("%-12s %4s %-8s %-6s %12s %12s %12s %12s\n", "queue", "args",
+             "set_args", "events", "host med us", "host p99 us", "launches/s",
+             "start med us");
+    for (const QueueType &queue_type : queue_types)
+    {
+        clCommandQueueWrapper burst_queue = clCreateCommandQueue(
+            context, device, queue_type.properties, &error);
+        test_error(error, "Unable to create queue");
+        clCommandQueueWrapper profiling_queue = clCreateCommandQueue(
+            context, device, queue_type.properties | CL_QUEUE_PROFILING_ENABLE,
+            &error);
+        test_error(error, "Unable to create profiling queue");
+
+        for (unsigned int arg_count : launch_arg_counts)
+        {
+            std::string source = launch_kernel_source(arg_count);
+            const char *source_ptr = source.c_str();
+            clProgramWrapper program;
+            clKernelWrapper kernel;
+            error = create_single_kernel_helper(context, &program, &kernel, 1,
+                                                &source_ptr, "launch_kernel");
+            test_error(error, "Unable to create kernel");
+            error = set_launch_args(kernel, arg_count, buffer);
+            test_error(error, "Unable to set kernel arguments");
+
+            SampleStats latency;
+            size_t ordering_errors = 0;
+            error = measure_start_latency(profiling_queue, kernel, samples,
+                                          latency, ordering_errors);
+            test_error(error, "Unable to measure launch latency");
+            if (ordering_errors)
+            {
+                log_error("ERROR: %zu of %zu launches on an %s queue started "
+                          "before they were queued.\n",
+                          ordering_errors, samples, queue_type.name);
+                result = TEST_FAIL;
+            }
+
+            for (const BurstConfig &config : burst_configs)
+            {
+                // Setting arguments again is the same as not for a kernel
+                // without any
+                if (config.churn_args && arg_count == 0) continue;
+
+                BurstResult burst_result;
+                error = run_burst(burst_queue, kernel, arg_count, buffer,
+                                  config, burst, burst_result);
+                test_error(error, "Unable to run launch burst");
+
+                const char *set_args = config.churn_args ? "each" : "once";
+                const char *events = config.events ? "yes" : "no";
+                log_info("%-12s %4u %-8s %-6s %12.2f %12.2f %12.0f %12.2f\n",
+                         queue_type.name, arg_count, set_args, events,
+                         burst_result.host_us.median,
+                         burst_result.host_us.p99,
+                         burst_result.launches_per_second, latency.median);
+                log_perf(burst_result.launches_per_second, true, "launches/s",
+                         "%s %u args, set %s, events %s", queue_type.name,
+                         arg_count, set_args, events);
+                if (file)
+                    fprintf(file, "%s,%u,%s,%s,%.3f,%.3f,%.1f,%.3f\n",
+                            queue_type.name, arg_count, set_args, events,
+                            burst_result.host_us.median,
+                            burst_result.host_us.p99,
+                            burst_result.launches_per_second, latency.median);
+            }
+        }
+    }
+
+    if (file) fclose(file);
+    return result;
+}
@@ -14,18 +14,27 @@
 // limitations under the License.
 //
 
+#include <chrono>
 #include <iomanip>
+#include <string>
 #include <vector>
 #include "testBase.h"
 #include "harness/conversions.h"
+#include "harness/parseParameters.h"
 #include "harness/typeWrappers.h"
 #include "harness/testHarness.h"
+#include "harness/traceHelpers.h"
 
 // #define USE_NEW_SYNTAX    1
 // The number of shuffles to test per test
 #define NUM_TESTS 32
 // The number of times to run each combination of shuffles
 #define NUM_ITERATIONS_PER_TEST 2
+// The number of kernels (each testing NUM_TESTS shuffles) put into the single
+// program built per type/vector size pair by the batched tests with
+// --benchmark. Without it they use NUM_ITERATIONS_PER_TEST kernels, testing as
+// many shuffles as the unbatched tests.
+#define NUM_BATCHED_KERNELS 8
 #define MAX_PROGRAM_SIZE NUM_TESTS*1024
 #define PRINT_SHUFFLE_KERNEL_SOURCE 0
 #define SPEW_ORDER_DETAILS 0
@@ -40,7 +49,7 @@ enum ShuffleMode
 };
 
 static const char *shuffleKernelPattern[3] =  {
-    "__kernel void sample_test( __global %s%s *source, __global %s%s *dest )\n"
+    "__kernel void sample_test%s( __global %s%s *source, __global %s%s *dest )\n"
     "{\n"
     "    if (get_global_id(0) != 0) return;\n"
     "     //%s%s src1 %s, src2%s;\n",// Here's a comma...
@@ -327,15 +336,18 @@ std::string generate_shuffle_mask(size_t maskSize, const ShuffleOrder *order)
     return outMaskString.str();
 }
 
-static int create_shuffle_kernel( cl_context context, cl_program *outProgram, cl_kernel *outKernel,
-                                 size_t *outRealVecSize,
-                                 ExplicitType vecType, size_t inVecSize, size_t outVecSize, cl_uint *lengthToUse, bool inUseNumerics, bool outUseNumerics,
-                                 size_t numOrders, ShuffleOrder *inOrders, ShuffleOrder *outOrders,
-                                 MTdata d, ShuffleMode shuffleMode = kNormalMode )
+// Appends the source of a kernel named sample_test<kernelSuffix> that performs
+// numOrders shuffles to programSource. The preamble (extension pragmas and
+// helper functions) must be emitted exactly once per program.
+static void append_shuffle_kernel_source(
+    std::string &programSource, const char *kernelSuffix, bool withPreamble,
+    size_t *outRealVecSize, ExplicitType vecType, size_t inVecSize,
+    size_t outVecSize, cl_uint *lengthToUse, bool inUseNumerics,
+    bool outUseNumerics, size_t numOrders, ShuffleOrder *inOrders,
+    ShuffleOrder *outOrders, MTdata d, ShuffleMode shuffleMode)
 {
     char inOrder[18], shuffledOrder[18];
     char kernelSource[MAX_PROGRAM_SIZE], progLine[ 10240 ];
-    char *programPtr;
     char inSizeName[4], outSizeName[4], outRealSizeName[4], inSizeArgName[4];
     char outSizeNameTmpVar[4];
 
@@ -371,11 +383,12 @@ static int create_shuffle_kernel( cl_context context, cl_program *outProgram, cl
 
     // Loop through and create the source for all order strings
     kernelSource[ 0 ] = 0;
-    if (vecType == kDouble) {
+    if (withPreamble && vecType == kDouble)
+    {
         strcat(kernelSource, "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n");
     }
 
-    if( shuffleMode == kFunctionCallMode )
+    if (withPreamble && shuffleMode == kFunctionCallMode)
     {
         sprintf( progLine, shuffleFnLinePattern, get_explicit_type_name( vecType ), inSizeName, get_explicit_type_name( vecType ), inSizeName,
                 get_explicit_type_name( vecType ), inSizeName, get_explicit_type_name( vecType ), inSizeName );
@@ -394,7 +407,8 @@ static int create_shuffle_kernel( cl_context context, cl_program *outProgram, cl
     const char * src2EnableA = ( shuffleMode == kBuiltInDualInputFnMode ) ? "" : "/*";
     const char * src2EnableB = ( shuffleMode == kBuiltInDualInputFnMode ) ? "" : "*/";
 
-    sprintf( progLine, shuffleKernelPattern[ 0 ], get_explicit_type_name( vecType ), inParamSizeString,
+    sprintf(progLine, shuffleKernelPattern[0], kernelSuffix,
+            get_explicit_type_name(vecType), inParamSizeString,
             get_explicit_type_name( vecType ), outRealSizeName, get_explicit_type_name( vecType ), inSizeName,
             src2EnableA, src2EnableB );
     strcat(kernelSource, progLine);
@@ -597,97 +611,134 @@ static int create_shuffle_kernel( cl_context context, cl_program *outProgram, cl
     }
     strcat( kernelSource, shuffleKernelPattern[ 1 ] );
 
+    programSource += kernelSource;
+}
+
+static int create_shuffle_kernel( cl_context context, cl_program *outProgram, cl_kernel *outKernel,
+                                 size_t *outRealVecSize,
+                                 ExplicitType vecType, size_t inVecSize, size_t outVecSize, cl_uint *lengthToUse, bool inUseNumerics, bool outUseNumerics,
+                                 size_t numOrders, ShuffleOrder *inOrders, ShuffleOrder *outOrders,
+                                 MTdata d, ShuffleMode shuffleMode = kNormalMode )
+{
+    std::string kernelSource;
+    append_shuffle_kernel_source(kernelSource, "", true, outRealVecSize,
+                                 vecType, inVecSize, outVecSize, lengthToUse,
+                                 inUseNumerics, outUseNumerics, numOrders,
+                                 inOrders, outOrders, d, shuffleMode);
+
     // Print the kernel source
     if (PRINT_SHUFFLE_KERNEL_SOURCE)
-        log_info( "Kernel:%s\n", kernelSource );
+        log_info("Kernel:%s\n", kernelSource.c_str());
 
     /* Create kernel */
-    programPtr = kernelSource;
-    if( create_single_kernel_helper( context, outProgram, outKernel, 1, (const char **)&programPtr, "sample_test" ) )
+    const char *programPtr = kernelSource.c_str();
+    if (create_single_kernel_helper(context, outProgram, outKernel, 1,
+                                    &programPtr, "sample_test"))
     {
         return -1;
     }
     return 0;
 }
 
-int test_shuffle_dual_kernel(cl_context context, cl_command_queue queue,
-                             ExplicitType vecType, size_t inVecSize, size_t outVecSize, cl_uint *lengthToUse, size_t numOrders,
-                             ShuffleOrder *inOrderIdx, ShuffleOrder *outOrderIdx, bool inUseNumerics, bool outUseNumerics, MTdata d,
-                             ShuffleMode shuffleMode = kNormalMode )
+// Device buffers and host data for one shuffle kernel dispatch.
+struct ShuffleRun
 {
-    clProgramWrapper program;
     clKernelWrapper kernel;
+    clMemWrapper streams[3];
+    std::vector<cl_long> inData;
+    std::vector<cl_long> inSecondData;
+    std::vector<cl_long> outData;
+};
+
+// Creates the buffers for run.kernel, then enqueues the kernel and a
+// non-blocking read of its results. The caller must finish the queue before
+// verifying the run.
+static int enqueue_shuffle_run(cl_context context, cl_command_queue queue,
+                               ShuffleRun &run, ExplicitType vecType,
+                               size_t inVecSize, size_t outRealVecSize,
+                               size_t numOrders, MTdata d,
+                               ShuffleMode shuffleMode)
+{
     int error;
     size_t threads[1], localThreads[1];
-    size_t typeSize, outRealVecSize;
-    clMemWrapper streams[ 3 ];
-
-    /* Create the source */
-    error = create_shuffle_kernel( context, &program, &kernel, &outRealVecSize, vecType,
-                                  inVecSize, outVecSize, lengthToUse, inUseNumerics, outUseNumerics, numOrders, inOrderIdx, outOrderIdx,
-                                  d, shuffleMode );
-    if( error != 0 )
-        return error;
+    size_t typeSize = get_explicit_type_size(vecType);
 
-    typeSize = get_explicit_type_size(vecType);
-    std::vector<cl_long> inData(inVecSize * numOrders);
-    std::vector<cl_long> inSecondData(inVecSize * numOrders);
-    std::vector<cl_long> outData(outRealVecSize * numOrders);
+    run.inData.assign(inVecSize * numOrders, 0);
+    run.inSecondData.assign(inVecSize * numOrders, 0);
+    run.outData.assign(outRealVecSize * numOrders, 0);
 
     generate_random_data(vecType, (unsigned int)(numOrders * inVecSize), d,
-                         inData.data());
+                         run.inData.data());
     if( shuffleMode == kBuiltInDualInputFnMode )
         generate_random_data(vecType, (unsigned int)(numOrders * inVecSize), d,
-                             inSecondData.data());
+                             run.inSecondData.data());
 
-    streams[0] =
-        clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
-                       typeSize * inVecSize * numOrders, inData.data(), &error);
+    run.streams[0] = clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
+                                    typeSize * inVecSize * numOrders,
+                                    run.inData.data(), &error);
     test_error( error, "Unable to create input stream" );
 
-    streams[1] = clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
-                                typeSize * outRealVecSize * numOrders,
-                                outData.data(), &error);
+    run.streams[1] = clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
+                                    typeSize * outRealVecSize * numOrders,
+                                    run.outData.data(), &error);
     test_error( error, "Unable to create output stream" );
 
     int argIndex = 0;
     if( shuffleMode == kBuiltInDualInputFnMode )
     {
-        streams[2] = clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
-                                    typeSize * inVecSize * numOrders,
-                                    inSecondData.data(), &error);
+        run.streams[2] = clCreateBuffer(context, CL_MEM_COPY_HOST_PTR,
+                                        typeSize * inVecSize * numOrders,
+                                        run.inSecondData.data(), &error);
         test_error( error, "Unable to create second input stream" );
 
-        error = clSetKernelArg( kernel, argIndex++, sizeof( streams[ 2 ] ), &streams[ 2 ] );
+        error = clSetKernelArg(run.kernel, argIndex++,
+                               sizeof(run.streams[2]), &run.streams[2]);
         test_error( error, "Unable to set kernel argument" );
     }
 
     // Set kernel arguments
-    error = clSetKernelArg( kernel, argIndex++, sizeof( streams[ 0 ] ), &streams[ 0 ] );
+    error = clSetKernelArg(run.kernel, argIndex++, sizeof(run.streams[0]),
+                           &run.streams[0]);
     test_error( error, "Unable to set kernel argument" );
-    error = clSetKernelArg( kernel, argIndex++, sizeof( streams[ 1 ] ), &streams[ 1 ] );
+    error = clSetKernelArg(run.kernel, argIndex++, sizeof(run.streams[1]),
+                           &run.streams[1]);
     test_error( error, "Unable to set kernel argument" );
 
 
     /* Run the kernel */
     threads[0] = numOrders;
 
-    error = get_max_common_work_group_size( context, kernel, threads[0], &localThreads[0] );
+    error = get_max_common_work_group_size(context, run.kernel, threads[0],
+                                           &localThreads[0]);
     test_error( error, "Unable to get work group size to use" );
 
-    error = clEnqueueNDRangeKernel( queue, kernel, 1, NULL, threads, localThreads, 0, NULL, NULL );
+    error = trace_enqueue_nd_range_kernel(queue, run.kernel, 1, NULL, threads,
+                                          localThreads, 0, NULL, NULL);
     test_error( error, "Unable to execute test kernel" );
 
 
     // Read the results back
-    error = clEnqueueReadBuffer(queue, streams[1], CL_TRUE, 0,
-                                typeSize * numOrders * outRealVecSize,
-                                outData.data(), 0, NULL, NULL);
+    error = trace_enqueue_read_buffer(queue, run.streams[1], CL_FALSE, 0,
+                                      typeSize * numOrders * outRealVecSize,
+                                      run.outData.data(), 0, NULL, NULL);
     test_error( error, "Unable to read results" );
 
-    unsigned char *inDataPtr = (unsigned char *)inData.data();
-    unsigned char *inSecondDataPtr = (unsigned char *)inSecondData.data();
-    unsigned char *outDataPtr = (unsigned char *)outData.data();
+    return CL_SUCCESS;
+}
+
+static int verify_shuffle_run(ShuffleRun &run, ExplicitType vecType,
+                              size_t inVecSize, size_t outVecSize,
+                              size_t outRealVecSize, cl_uint *lengthToUse,
+                              size_t numOrders, ShuffleOrder *inOrderIdx,
+                              ShuffleOrder *outOrderIdx, bool inUseNumerics,
+                              bool outUseNumerics, MTdata d,
+                              ShuffleMode shuffleMode)
+{
+    TraceSpan span("verify_shuffle_run", "verification");
+    size_t typeSize = get_explicit_type_size(vecType);
+    unsigned char *inDataPtr = (unsigned char *)run.inData.data();
+    unsigned char *inSecondDataPtr = (unsigned char *)run.inSecondData.data();
+    unsigned char *outDataPtr = (unsigned char *)run.outData.data();
     int ret = 0;
     int errors_printed = 0;
     for( size_t i = 0; i < numOrders; i++ )
@@ -737,6 +788,144 @@ int test_shuffle_dual_kernel(cl_context context, cl_command_queue queue,
     return ret;
 }
 
+// Build and execute time accumulated over the type/vector size pairs of a
+// shuffle test, reported at the end of the test.
+struct ShuffleTimings
+{
+    double compileSeconds = 0.0;
+    double executeSeconds = 0.0;
+    size_t programs = 0;
+    size_t orders = 0;
+};
+
+// Tests numOrders shuffles with a single program holding one sample_test_<n>
+// kernel per NUM_TESTS orders. All kernels are dispatched before the queue is
+// finished and the results are verified, so each type/vector size pair costs
+// one compile instead of one per NUM_TESTS orders.
+int test_shuffle_batched_kernels(cl_context context, cl_command_queue queue,
+                                 ExplicitType vecType, size_t inVecSize,
+                                 size_t outVecSize, cl_uint *lengthToUse,
+                                 size_t numOrders, ShuffleOrder *inOrderIdx,
+                                 ShuffleOrder *outOrderIdx, MTdata d,
+                                 ShuffleMode shuffleMode,
+                                 ShuffleTimings *timings)
+{
+    clProgramWrapper program;
+    int error;
+    size_t outRealVecSize;
+    size_t numKernels = (numOrders + NUM_TESTS - 1) / NUM_TESTS;
+    std::vector<ShuffleRun> runs(numKernels);
+    std::string programSource;
+    char kernelName[32];
+
+    for (size_t k = 0; k < numKernels; k++)
+    {
+        size_t first = k * NUM_TESTS;
+        size_t count = std::min<size_t>(NUM_TESTS, numOrders - first);
+        sprintf(kernelName, "_%zu", k);
+        append_shuffle_kernel_source(
+            programSource, kernelName, k == 0, &outRealVecSize, vecType,
+            inVecSize, outVecSize, lengthToUse, true, true, count,
+            inOrderIdx + first, outOrderIdx + first, d, shuffleMode);
+    }
+
+    if (PRINT_SHUFFLE_KERNEL_SOURCE)
+        log_info("Program:%s\n", programSource.c_str());
+
+    auto compileStart = std::chrono::steady_clock::now();
+    const char *programPtr = programSource.c_str();
+    if (create_single_kernel_helper(context, &program, &runs[0].kernel, 1,
+                                    &programPtr, "sample_test_0"))
+    {
+        return -1;
+    }
+    for (size_t k = 1; k < numKernels; k++)
+    {
+        sprintf(kernelName, "sample_test_%zu", k);
+        runs[k].kernel = clCreateKernel(program, kernelName, &error);
+        test_error(error, "Unable to create kernel");
+    }
+
+    auto executeStart = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < numKernels; k++)
+    {
+        size_t count = std::min<size_t>(NUM_TESTS, numOrders - k * NUM_TESTS);
+        error = enqueue_shuffle_run(context, queue, runs[k], vecType,
+                                    inVecSize, outRealVecSize, count, d,
+                                    shuffleMode);
+        if (error != CL_SUCCESS) return error;
+    }
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+    auto executeEnd = std::chrono::steady_clock::now();
+
+    if (timings != NULL)
+    {
+        timings->compileSeconds +=
+            std::chrono::duration<double>(executeStart - compileStart).count();
+        timings->executeSeconds +=
+            std::chrono::duration<double>(executeEnd - executeStart).count();
+        timings->programs++;
+        timings->orders += numOrders;
+    }
+
+    int ret = 0;
+    for (size_t k = 0; k < numKernels; k++)
+    {
+        size_t first = k * NUM_TESTS;
+        size_t count = std::min<size_t>(NUM_TESTS, numOrders - first);
+        ret += verify_shuffle_run(runs[k], vecType, inVecSize, outVecSize,
+                                  outRealVecSize, lengthToUse, count,
+                                  inOrderIdx + first, outOrderIdx + first,
+                                  true, true, d, shuffleMode);
+    }
+    return ret;
+}
+
+int test_shuffle_dual_kernel(cl_context context, cl_command_queue queue,
+                             ExplicitType vecType, size_t inVecSize, size_t outVecSize, cl_uint *lengthToUse, size_t numOrders,
+                             ShuffleOrder *inOrderIdx, ShuffleOrder *outOrderIdx, bool inUseNumerics, bool outUseNumerics, MTdata d,
+                             ShuffleMode shuffleMode = kNormalMode,
+                             ShuffleTimings *timings = NULL )
+{
+    clProgramWrapper program;
+    ShuffleRun run;
+    int error;
+    size_t outRealVecSize;
+
+    /* Create the source */
+    auto compileStart = std::chrono::steady_clock::now();
+    error = create_shuffle_kernel( context, &program, &run.kernel, &outRealVecSize, vecType,
+                                  inVecSize, outVecSize, lengthToUse, inUseNumerics, outUseNumerics, numOrders, inOrderIdx, outOrderIdx,
+                                  d, shuffleMode );
+    if( error != 0 )
+        return error;
+
+    auto executeStart = std::chrono::steady_clock::now();
+    error = enqueue_shuffle_run(context, queue, run, vecType, inVecSize,
+                                outRealVecSize, numOrders, d, shuffleMode);
+    if (error != CL_SUCCESS) return error;
+
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+    auto executeEnd = std::chrono::steady_clock::now();
+
+    if (timings != NULL)
+    {
+        timings->compileSeconds +=
+            std::chrono::duration<double>(executeStart - compileStart).count();
+        timings->executeSeconds +=
+            std::chrono::duration<double>(executeEnd - executeStart).count();
+        timings->programs++;
+        timings->orders += numOrders;
+    }
+
+    return verify_shuffle_run(run, vecType, inVecSize, outVecSize,
+                              outRealVecSize, lengthToUse, numOrders,
+                              inOrderIdx, outOrderIdx, inUseNumerics,
+                              outUseNumerics, d, shuffleMode);
+}
+
 void    build_random_shuffle_order( ShuffleOrder &outIndices, unsigned int length, unsigned int selectLength, bool allowRepeats, MTdata d )
 {
     char flags[ 16 ];
@@ -760,7 +949,9 @@ class shuffleBuffer
 {
 public:
 
-    shuffleBuffer( cl_context ctx, cl_command_queue queue, ExplicitType type, size_t inSize, size_t outSize, ShuffleMode mode )
+    shuffleBuffer(cl_context ctx, cl_command_queue queue, ExplicitType type,
+                  size_t inSize, size_t outSize, ShuffleMode mode,
+                  size_t batchedKernels = 0, ShuffleTimings *timings = NULL)
     {
         mContext = ctx;
         mQueue = queue;
@@ -768,8 +959,11 @@ public:
         mInVecSize = inSize;
         mOutVecSize = outSize;
         mShuffleMode = mode;
+        mBatched = batchedKernels != 0;
+        mTimings = timings;
 
         mCount = 0;
+        mCapacity = mBatched ? NUM_TESTS * batchedKernels : NUM_TESTS;
 
         // Here's the deal with mLengthToUse[i].
         // if you have, for instance
@@ -815,7 +1009,7 @@ public:
         memcpy( &mOutOrders[ mCount ], &outOrder, sizeof( outOrder ) );
         mCount++;
 
-        if( mCount == NUM_TESTS )
+        if( mCount == mCapacity )
             return Flush(d);
 
         return CL_SUCCESS;
@@ -824,10 +1018,19 @@ public:
     int Flush( MTdata d )
     {
         int err = CL_SUCCESS;
-        if( mCount > 0 )
+        if (mCount > 0 && mBatched)
+        {
+            err = test_shuffle_batched_kernels(
+                mContext, mQueue, mVecType, mInVecSize, mOutVecSize,
+                mLengthToUse, mCount, mInOrders, mOutOrders, d, mShuffleMode,
+                mTimings);
+            mCount = 0;
+        }
+        else if( mCount > 0 )
         {
             err = test_shuffle_dual_kernel( mContext, mQueue, mVecType, mInVecSize, mOutVecSize, mLengthToUse,
-                                           mCount, mInOrders, mOutOrders, true, true, d, mShuffleMode );
+                                           mCount, mInOrders, mOutOrders, true, true, d, mShuffleMode,
+                                           mTimings );
             mCount = 0;
         }
         return err;
@@ -837,21 +1040,29 @@ protected:
     cl_context            mContext;
     cl_command_queue    mQueue;
     ExplicitType        mVecType;
-    size_t                mInVecSize, mOutVecSize, mCount;
+    size_t                mInVecSize, mOutVecSize, mCount, mCapacity;
     ShuffleMode            mShuffleMode;
+    bool                mBatched;
+    ShuffleTimings      *mTimings;
     cl_uint             mLengthToUse[ NUM_TESTS ];
 
-    ShuffleOrder        mInOrders[ NUM_TESTS ], mOutOrders[ NUM_TESTS ];
+    ShuffleOrder        mInOrders[ NUM_TESTS * NUM_BATCHED_KERNELS ];
+    ShuffleOrder        mOutOrders[ NUM_TESTS * NUM_BATCHED_KERNELS ];
 };
 
 
-int test_shuffle_random(cl_device_id device, cl_context context, cl_command_queue queue, ShuffleMode shuffleMode, MTdata d )
+// batchedKernels is the number of kernels per program for the batched tests,
+// 0 for a program per NUM_TESTS shuffles
+int test_shuffle_random(cl_device_id device, cl_context context,
+                        cl_command_queue queue, ShuffleMode shuffleMode,
+                        MTdata d, size_t batchedKernels = 0)
 {
     ExplicitType vecType[] = { kChar, kUChar, kShort, kUShort, kInt, kUInt, kLong, kULong, kFloat, kDouble };
     unsigned int vecSizes[] = { 1, 2, 3, 4, 8, 16, 0 };
     unsigned int srcIdx, dstIdx, typeIndex;
     int error = 0, totalError = 0, prevTotalError = 0;
     RandomSeed seed(gRandomSeed);
+    ShuffleTimings timings;
 
     for( typeIndex = 0; typeIndex < 10; typeIndex++ )
     {
@@ -884,9 +1095,13 @@ int test_shuffle_random(cl_device_id device, cl_context context, cl_command_queu
                 }
 
                 log_info("Testing [%s%d to %s%d]... ", get_explicit_type_name( vecType[ typeIndex ] ) , vecSizes[srcIdx], get_explicit_type_name( vecType[ typeIndex ] ) , vecSizes[dstIdx]);
-                shuffleBuffer buffer( context, queue, vecType[ typeIndex ], vecSizes[ srcIdx ], vecSizes[ dstIdx ], shuffleMode );
+                shuffleBuffer buffer(context, queue, vecType[typeIndex],
+                                     vecSizes[srcIdx], vecSizes[dstIdx],
+                                     shuffleMode, batchedKernels, &timings);
 
-                int numTests = NUM_TESTS*NUM_ITERATIONS_PER_TEST;
+                int numTests = NUM_TESTS
+                    * (batchedKernels ? batchedKernels
+                                      : NUM_ITERATIONS_PER_TEST);
                 for( int i = 0; i < numTests /*&& error == 0*/; i++ )
                 {
                     ShuffleOrder src{ 0 };
@@ -923,6 +1138,20 @@ int test_shuffle_random(cl_device_id device, cl_context context, cl_command_queu
             }
         }
     }
+
+    log_info("%zu shuffles in %zu programs: %.3f s compiling, %.3f s "
+             "executing\n",
+             timings.orders, timings.programs, timings.compileSeconds,
+             timings.executeSeconds);
+    // Per shuffle, as the batched tests can test more shuffles
+    if (timings.orders)
+    {
+        const char *suffix = batchedKernels ? " (batched)" : "";
+        log_perf(1e6 * timings.compileSeconds / timings.orders, false, "us",
+                 "shuffle compile time per shuffle%s", suffix);
+        log_perf(1e6 * timings.executeSeconds / timings.orders, false, "us",
+                 "shuffle execute time per shuffle%s", suffix);
+    }
     return totalError;
 }
 
@@ -955,3 +1184,43 @@ REGISTER_TEST(shuffle_built_in_dual_input)
     RandomSeed seed(gRandomSeed);
     return test_shuffle_random( device, context, queue, kBuiltInDualInputFnMode, seed );
 }
+
+// The batched variants test the orders of a type/vector size pair in one
+// program, to compare the compile and execution time split with the tests
+// above. By default they test as many orders as those tests; --benchmark
+// raises that to NUM_BATCHED_KERNELS kernels of NUM_TESTS orders.
+int test_shuffle_batched(cl_device_id device, cl_context context,
+                         cl_command_queue queue, ShuffleMode shuffleMode)
+{
+    RandomSeed seed(gRandomSeed);
+    size_t kernels =
+        gBenchmarkMode ? NUM_BATCHED_KERNELS : NUM_ITERATIONS_PER_TEST;
+    return test_shuffle_random(device, context, queue, shuffleMode, seed,
+                               kernels);
+}
+
+REGISTER_TEST(shuffle_copy_batched)
+{
+    return test_shuffle_batched(device, context, queue, kNormalMode);
+}
+
+REGISTER_TEST(shuffle_function_call_batched)
+{
+    return test_shuffle_batched(device, context, queue, kFunctionCallMode);
+}
+
+REGISTER_TEST(shuffle_array_cast_batched)
+{
+    return test_shuffle_batched(device, context, queue, kArrayAccessMode);
+}
+
+REGISTER_TEST(shuffle_built_in_batched)
+{
+    return test_shuffle_batched(device, context, queue, kBuiltInFnMode);
+}
+
+REGISTER_TEST(shuffle_built_in_dual_input_batched)
+{
+    return test_shuffle_batched(device, context, queue,
+                                kBuiltInDualInputFnMode);
+}
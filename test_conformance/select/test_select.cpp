@@ -21,6 +21,7 @@
 #include <time.h>
 #include <string.h>
 
+#include <chrono>
 #include <cinttypes>
 #include <vector>
 
@@ -341,12 +342,29 @@ static cl_program makeSelectProgram(cl_kernel *kernel_ptr,
 
 #define VECTOR_SIZE_COUNT   6
 
+// Device buffers and host copies for one block of comparison values
+struct SelectBlock
+{
+    clMemWrapper cmp;
+    clMemWrapper dest;
+    std::vector<char> cmp_host;
+    std::vector<char> ref;
+    std::vector<char> dest_host;
+    clEventWrapper read_event;
+};
+
+struct QueueFinisher
+{
+    cl_command_queue queue;
+    ~QueueFinisher() { clFinish(queue); }
+};
+
 static int doTest(cl_command_queue queue, cl_context context, Type stype, Type cmptype, cl_device_id device)
 {
     int err = CL_SUCCESS;
     MTdataHolder d(gRandomSeed);
     const size_t element_count[VECTOR_SIZE_COUNT] = { 1, 2, 3, 4, 8, 16 };
-    clMemWrapper src1, src2, cmp, dest;
+    clMemWrapper src1, src2;
 
     const size_t block_elements = BUFFER_SIZE / type_size[stype];
 
@@ -387,10 +405,22 @@ static int doTest(cl_command_queue queue, cl_context context, Type stype, Type c
     test_error_count(err, "Error: could not allocate src1 buffer\n");
     src2 = clCreateBuffer( context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL, &err );
     test_error_count(err, "Error: could not allocate src2 buffer\n");
-    cmp = clCreateBuffer( context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL, &err );
-    test_error_count(err, "Error: could not allocate cmp buffer\n");
-    dest = clCreateBuffer( context, CL_MEM_WRITE_ONLY, BUFFER_SIZE, NULL, &err );
-    test_error_count(err, "Error: could not allocate dest buffer\n");
+
+    // Blocks are double buffered so that the host can compute the reference
+    // for and check one block while the device works on the next
+    SelectBlock blocks[2];
+    for (SelectBlock &block : blocks)
+    {
+        block.cmp = clCreateBuffer(context, CL_MEM_READ_ONLY, BUFFER_SIZE,
+                                   NULL, &err);
+        test_error_count(err, "Error: could not allocate cmp buffer\n");
+        block.dest = clCreateBuffer(context, CL_MEM_WRITE_ONLY, BUFFER_SIZE,
+                                    NULL, &err);
+        test_error_count(err, "Error: could not allocate dest buffer\n");
+        block.cmp_host.resize(BUFFER_SIZE);
+        block.ref.resize(BUFFER_SIZE);
+        block.dest_host.resize(BUFFER_SIZE);
+    }
 
     for (size_t vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
     {
@@ -401,22 +431,18 @@ static int doTest(cl_command_queue queue, cl_context context, Type stype, Type c
             return -1;
         }
 
-        err = clSetKernelArg(kernels[vecsize], 0, sizeof dest, &dest);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
         err = clSetKernelArg(kernels[vecsize], 1, sizeof src1, &src1);
         test_error_count(err, "Error: Cannot set kernel arg dest!\n");
         err = clSetKernelArg(kernels[vecsize], 2, sizeof src2, &src2);
         test_error_count(err, "Error: Cannot set kernel arg dest!\n");
-        err = clSetKernelArg(kernels[vecsize], 3, sizeof cmp, &cmp);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
     }
 
-    std::vector<char> ref(BUFFER_SIZE);
-    std::vector<char> sref(BUFFER_SIZE);
     std::vector<char> src1_host(BUFFER_SIZE);
     std::vector<char> src2_host(BUFFER_SIZE);
-    std::vector<char> cmp_host(BUFFER_SIZE);
-    std::vector<char> dest_host(BUFFER_SIZE);
+
+    // Don't let reads still in flight outlive the host buffers on early
+    // returns
+    QueueFinisher finisher{ queue };
 
     log_info("Testing...");
 
@@ -430,65 +456,129 @@ static int doTest(cl_command_queue queue, cl_context context, Type stype, Type c
                                src2_host.data(), 0, NULL, NULL);
     test_error_count(err, "Error: Could not write src2");
 
-
+    struct SelectStep
+    {
+        int vector_idx;
+        uint32_t start;
+    };
+    std::vector<SelectStep> steps;
     for (int vector_idx = 0; vector_idx < VECTOR_SIZE_COUNT; ++vector_idx)
     {
         const uint32_t vecsize = element_count[vector_idx];
-        const size_t vector_size = vecsize * type_size[stype];
-        const size_t vector_count =
-            (BUFFER_SIZE + vector_size - 1) / vector_size;
         const uint32_t full_msb_mask_elements = vecsize * (1u << vecsize);
         const uint32_t min_cmp_elements = 64 * 1024;
         const uint32_t nb_elements =
             std::max(min_cmp_elements, full_msb_mask_elements);
 
         for (uint32_t i = 0; i < nb_elements; i += block_elements)
+            steps.push_back({ vector_idx, i });
+    }
+
+    const int cmp_idx = (cmptype == ctype[stype][0]) ? 0 : 1;
+
+    // Enqueues the device work for a step, up to the non-blocking read of its
+    // results
+    auto enqueue_step = [&](size_t s) -> cl_int {
+        SelectBlock &block = blocks[s % 2];
+        const int vector_idx = steps[s].vector_idx;
+        const uint32_t vecsize = element_count[vector_idx];
+        const size_t vector_size = vecsize * type_size[stype];
+        const size_t vector_count =
+            (BUFFER_SIZE + vector_size - 1) / vector_size;
+
+        initCmpBuffer(block.cmp_host.data(), cmptype, steps[s].start,
+                      block_elements, vecsize, d);
+
+        cl_int error = clEnqueueWriteBuffer(queue, block.cmp, CL_FALSE, 0,
+                                            BUFFER_SIZE, block.cmp_host.data(),
+                                            0, NULL, NULL);
+        test_error_count(error, "Error: Could not write cmp");
+
+        const cl_int pattern = -1;
+        error = clEnqueueFillBuffer(queue, block.dest, &pattern,
+                                    sizeof(cl_int), 0, BUFFER_SIZE, 0, nullptr,
+                                    nullptr);
+        test_error_count(error, "clEnqueueFillBuffer failed");
+
+        error = clSetKernelArg(kernels[vector_idx], 0, sizeof block.dest,
+                               &block.dest);
+        test_error_count(error, "Error: Cannot set kernel arg dest!\n");
+        error = clSetKernelArg(kernels[vector_idx], 3, sizeof block.cmp,
+                               &block.cmp);
+        test_error_count(error, "Error: Cannot set kernel arg cmp!\n");
+
+        error = clEnqueueNDRangeKernel(queue, kernels[vector_idx], 1, NULL,
+                                       &vector_count, NULL, 0, NULL, NULL);
+        test_error_count(error, "clEnqueueNDRangeKernel failed errcode\n");
+
+        clEventWrapper read_event;
+        error = clEnqueueReadBuffer(queue, block.dest, CL_FALSE, 0,
+                                    BUFFER_SIZE, block.dest_host.data(), 0,
+                                    NULL, &read_event);
+        test_error_count(
+            error, "Error: Reading buffer from dest to dest_host failed\n");
+        block.read_event = std::move(read_event);
+
+        error = clFlush(queue);
+        test_error_count(error, "clFlush failed");
+        return CL_SUCCESS;
+    };
+
+    auto reference_step = [&](size_t s) -> cl_int {
+        SelectBlock &block = blocks[s % 2];
+        Select sfunc = steps[s].vector_idx == 0 ? refSelects[stype][cmp_idx]
+                                                : vrefSelects[stype][cmp_idx];
+        return parallelSelect(sfunc, block.ref.data(), src1_host.data(),
+                              src2_host.data(), block.cmp_host.data(),
+                              block_elements, type_size[stype]);
+    };
+
+    using clock = std::chrono::steady_clock;
+    clock::duration host_time{};
+
+    err = enqueue_step(0);
+    if (err != CL_SUCCESS) return err;
+    clock::time_point host_start = clock::now();
+    err = reference_step(0);
+    host_time += clock::now() - host_start;
+    test_error_count(err, "Reference computation failed");
+
+    for (size_t s = 0; s < steps.size(); s++)
+    {
+        if (s + 1 < steps.size())
         {
-            initCmpBuffer(cmp_host.data(), cmptype, i, block_elements, vecsize,
-                          d);
-
-            err = clEnqueueWriteBuffer(queue, cmp, CL_FALSE, 0, BUFFER_SIZE,
-                                       cmp_host.data(), 0, NULL, NULL);
-            test_error_count(err, "Error: Could not write cmp");
-
-            Select sfunc = (cmptype == ctype[stype][0]) ? vrefSelects[stype][0]
-                                                        : vrefSelects[stype][1];
-            (*sfunc)(ref.data(), src1_host.data(), src2_host.data(),
-                     cmp_host.data(), block_elements);
-
-            sfunc = (cmptype == ctype[stype][0]) ? refSelects[stype][0]
-                                                 : refSelects[stype][1];
-            (*sfunc)(sref.data(), src1_host.data(), src2_host.data(),
-                     cmp_host.data(), block_elements);
-
-            const cl_int pattern = -1;
-            err = clEnqueueFillBuffer(queue, dest, &pattern, sizeof(cl_int), 0,
-                                      BUFFER_SIZE, 0, nullptr, nullptr);
-            test_error_count(err, "clEnqueueFillBuffer failed");
-
-
-            err = clEnqueueNDRangeKernel(queue, kernels[vector_idx], 1, NULL,
-                                         &vector_count, NULL, 0, NULL, NULL);
-            test_error_count(err, "clEnqueueNDRangeKernel failed errcode\n");
-
-            err = clEnqueueReadBuffer(queue, dest, CL_TRUE, 0, BUFFER_SIZE,
-                                      dest_host.data(), 0, NULL, NULL);
-            test_error_count(
-                err, "Error: Reading buffer from dest to dest_host failed\n");
-
-            if ((*checkResults[stype])(
-                    dest_host.data(),
-                    vector_idx == 0 ? sref.data() : ref.data(), block_elements,
-                    element_count[vector_idx])
-                != 0)
-            {
-                log_error("vec_size:%d indx: 0x%8x\n",
-                          (int)element_count[vector_idx], i);
-                return TEST_FAIL;
-            }
+            err = enqueue_step(s + 1);
+            if (err != CL_SUCCESS) return err;
+        }
+
+        SelectBlock &block = blocks[s % 2];
+        err = clWaitForEvents(1, &block.read_event);
+        test_error_count(err, "clWaitForEvents failed");
+
+        host_start = clock::now();
+        if (parallelCheckResults(stype, block.dest_host.data(),
+                                 block.ref.data(), block_elements,
+                                 element_count[steps[s].vector_idx])
+            != 0)
+        {
+            log_error("vec_size:%d indx: 0x%8x\n",
+                      (int)element_count[steps[s].vector_idx], steps[s].start);
+            return TEST_FAIL;
         }
+
+        if (s + 1 < steps.size())
+        {
+            err = reference_step(s + 1);
+            test_error_count(err, "Reference computation failed");
+        }
+        host_time += clock::now() - host_start;
     }
 
+    double host_seconds = std::chrono::duration<double>(host_time).count();
+    size_t verified = steps.size() * block_elements;
+    log_info(" verified %zu elements at %.1f M elements/s\n", verified,
+             host_seconds > 0.0 ? verified / host_seconds * 1e-6 : 0.0);
+
     return err;
 }
 
@@ -71,6 +71,19 @@ typedef size_t (*CheckResults)(const void *const out1, const void *const out2,
                                size_t count, size_t vectorSize);
 extern CheckResults checkResults[kTypeCount];
 
+// Computes a reference with func on the thread pool, in chunks of the
+// buffers of elements of element_size bytes
+cl_int parallelSelect(Select func, void *const dest, const void *const src1,
+                      const void *const src2, const void *const cmp,
+                      size_t count, size_t element_size);
+
+// Compares the results with the reference on the thread pool, and only runs
+// the check function for the type if they differ. Returns the index of the
+// first error plus one, or 0 if there are none.
+size_t parallelCheckResults(Type stype, const void *const out1,
+                            const void *const out2, size_t count,
+                            size_t vectorSize);
+
 // Helpful macros
 
 // The next three functions check on different return values.  Returns -1
@@ -133,58 +133,76 @@ int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
                         const cl_context context, const char *prog_name,
                         spec_const spec_const_def)
 {
-    cl_int err = 0;
     if (gCompilationMode == kBinary)
     {
         return offline_get_program_with_il(prog, deviceID, context, prog_name);
     }
 
     std::vector<unsigned char> buffer_vec = readSPIRV(prog_name);
-
-    int file_bytes = buffer_vec.size();
-    if (file_bytes == 0)
+    if (buffer_vec.empty())
     {
         log_error("File %s not found\n", prog_name);
         return -1;
     }
 
-    unsigned char *buffer = &buffer_vec[0];
+    return get_program_with_il(prog, deviceID, context, buffer_vec,
+                               spec_const_def);
+}
+
+clCreateProgramWithILKHR_fn get_create_program_with_il(cl_device_id deviceID)
+{
     if (gCoreILProgram)
     {
-        prog = clCreateProgramWithIL(context, buffer, file_bytes, &err);
-        SPIRV_CHECK_ERROR(
-            err, "Failed to create program with clCreateProgramWithIL");
+        return clCreateProgramWithIL;
+    }
 
-        if (spec_const_def.spec_value != NULL)
-        {
-            err = clSetProgramSpecializationConstant(
-                prog, spec_const_def.spec_id, spec_const_def.spec_size,
-                spec_const_def.spec_value);
-            SPIRV_CHECK_ERROR(
-                err, "Failed to run clSetProgramSpecializationConstant");
-        }
+    cl_platform_id platform;
+    cl_int err = clGetDeviceInfo(deviceID, CL_DEVICE_PLATFORM,
+                                 sizeof(cl_platform_id), &platform, NULL);
+    if (err != CL_SUCCESS)
+    {
+        log_error("ERROR: Failed to get platform info with clGetDeviceInfo\n");
+        return NULL;
     }
-    else
+
+    clCreateProgramWithILKHR_fn clCreateProgramWithILKHR =
+        (clCreateProgramWithILKHR_fn)clGetExtensionFunctionAddressForPlatform(
+            platform, "clCreateProgramWithILKHR");
+    if (clCreateProgramWithILKHR == NULL)
     {
-        cl_platform_id platform;
-        err = clGetDeviceInfo(deviceID, CL_DEVICE_PLATFORM,
-                              sizeof(cl_platform_id), &platform, NULL);
-        SPIRV_CHECK_ERROR(err,
-                          "Failed to get platform info with clGetDeviceInfo");
-        clCreateProgramWithILKHR_fn clCreateProgramWithILKHR = NULL;
+        log_error("ERROR: clGetExtensionFunctionAddressForPlatform failed\n");
+    }
+    return clCreateProgramWithILKHR;
+}
 
-        clCreateProgramWithILKHR = (clCreateProgramWithILKHR_fn)
-            clGetExtensionFunctionAddressForPlatform(
-                platform, "clCreateProgramWithILKHR");
-        if (clCreateProgramWithILKHR == NULL)
-        {
-            log_error(
-                "ERROR: clGetExtensionFunctionAddressForPlatform failed\n");
-            return -1;
-        }
-        prog = clCreateProgramWithILKHR(context, buffer, file_bytes, &err);
-        SPIRV_CHECK_ERROR(
-            err, "Failed to create program with clCreateProgramWithILKHR");
+int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
+                        const cl_context context,
+                        const std::vector<unsigned char> &buffer_vec,
+                        spec_const spec_const_def)
+{
+    cl_int err = 0;
+    size_t file_bytes = buffer_vec.size();
+    const unsigned char *buffer = buffer_vec.data();
+
+    clCreateProgramWithILKHR_fn create_program_with_il =
+        get_create_program_with_il(deviceID);
+    if (create_program_with_il == NULL)
+    {
+        return -1;
+    }
+
+    prog = create_program_with_il(context, buffer, file_bytes, &err);
+    SPIRV_CHECK_ERROR(err, "Failed to create program with %s",
+                      gCoreILProgram ? "clCreateProgramWithIL"
+                                     : "clCreateProgramWithILKHR");
+
+    if (gCoreILProgram && spec_const_def.spec_value != NULL)
+    {
+        err = clSetProgramSpecializationConstant(
+            prog, spec_const_def.spec_id, spec_const_def.spec_size,
+            spec_const_def.spec_value);
+        SPIRV_CHECK_ERROR(err,
+                          "Failed to run clSetProgramSpecializationConstant");
     }
 
     err = clBuildProgram(prog, 1, &deviceID, NULL, NULL, NULL);
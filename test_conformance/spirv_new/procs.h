@@ -48,4 +48,16 @@ struct spec_const
 int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
                         const cl_context context, const char *prog_name,
                         spec_const spec_const_def = spec_const());
+// Builds a program from a SPIR-V module in memory, such as one generated with
+// SpirvModuleBuilder. The module is always consumed online, so callers skip
+// when the compilation mode is not online.
+int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
+                        const cl_context context,
+                        const std::vector<unsigned char> &buffer_vec,
+                        spec_const spec_const_def = spec_const());
 std::vector<unsigned char> readSPIRV(const char *file_name);
+
+// Returns clCreateProgramWithIL, or clCreateProgramWithILKHR on devices that
+// only support IL programs through cl_khr_il_program, or NULL if neither is
+// available
+clCreateProgramWithILKHR_fn get_create_program_with_il(cl_device_id deviceID);
@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "spirv_builder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+SpirvModuleBuilder::SpirvModuleBuilder(spv::AddressingModel addressing_model,
+                                       uint32_t version)
+    : addressing_model(addressing_model), version(version)
+{
+    AddCapability(spv::CapabilityAddresses);
+    AddCapability(spv::CapabilityKernel);
+    if (addressing_model == spv::AddressingModelPhysical64)
+        AddCapability(spv::CapabilityInt64);
+}
+
+void SpirvModuleBuilder::Append(std::vector<uint32_t> &section, spv::Op op,
+                                const std::vector<uint32_t> &operands)
+{
+    uint32_t word_count = static_cast<uint32_t>(operands.size() + 1);
+    section.push_back((word_count << 16) | static_cast<uint32_t>(op));
+    section.insert(section.end(), operands.begin(), operands.end());
+}
+
+std::vector<uint32_t> SpirvModuleBuilder::StringWords(const std::string &string)
+{
+    // Nul terminated and padded with nuls to a whole number of words
+    std::vector<uint32_t> words(string.size() / 4 + 1, 0);
+    memcpy(words.data(), string.data(), string.size());
+    return words;
+}
+
+void SpirvModuleBuilder::AddCapability(spv::Capability capability)
+{
+    if (std::find(capabilities.begin(), capabilities.end(), capability)
+        == capabilities.end())
+        capabilities.push_back(capability);
+}
+
+void SpirvModuleBuilder::AddName(uint32_t id, const std::string &name)
+{
+    std::vector<uint32_t> operands = { id };
+    std::vector<uint32_t> string = StringWords(name);
+    operands.insert(operands.end(), string.begin(), string.end());
+    Append(names, spv::OpName, operands);
+}
+
+void SpirvModuleBuilder::AddDecoration(uint32_t id, spv::Decoration decoration,
+                                       const std::vector<uint32_t> &literals)
+{
+    std::vector<uint32_t> operands = { id,
+                                       static_cast<uint32_t>(decoration) };
+    operands.insert(operands.end(), literals.begin(), literals.end());
+    Append(annotations, spv::OpDecorate, operands);
+}
+
+uint32_t SpirvModuleBuilder::DeclareType(spv::Op op,
+                                         const std::vector<uint32_t> &operands)
+{
+    std::vector<uint32_t> key = { static_cast<uint32_t>(op) };
+    key.insert(key.end(), operands.begin(), operands.end());
+    auto it = declared.find(key);
+    if (it != declared.end()) return it->second;
+
+    uint32_t id = NewId();
+    std::vector<uint32_t> with_result = { id };
+    with_result.insert(with_result.end(), operands.begin(), operands.end());
+    Append(declarations, op, with_result);
+    declared[key] = id;
+    return id;
+}
+
+uint32_t SpirvModuleBuilder::TypeVoid()
+{
+    return DeclareType(spv::OpTypeVoid, {});
+}
+
+uint32_t SpirvModuleBuilder::TypeBool()
+{
+    return DeclareType(spv::OpTypeBool, {});
+}
+
+uint32_t SpirvModuleBuilder::TypeInt(uint32_t width)
+{
+    return DeclareType(spv::OpTypeInt, { width, 0 });
+}
+
+uint32_t SpirvModuleBuilder::TypeFloat(uint32_t width)
+{
+    return DeclareType(spv::OpTypeFloat, { width });
+}
+
+uint32_t SpirvModuleBuilder::TypeVector(uint32_t component_type,
+                                        uint32_t count)
+{
+    return DeclareType(spv::OpTypeVector, { component_type, count });
+}
+
+uint32_t SpirvModuleBuilder::TypePointer(spv::StorageClass storage_class,
+                                         uint32_t pointee)
+{
+    return DeclareType(spv::OpTypePointer,
+                       { static_cast<uint32_t>(storage_class), pointee });
+}
+
+uint32_t
+SpirvModuleBuilder::TypeFunction(uint32_t return_type,
+                                 const std::vector<uint32_t> &parameter_types)
+{
+    std::vector<uint32_t> operands = { return_type };
+    operands.insert(operands.end(), parameter_types.begin(),
+                    parameter_types.end());
+    return DeclareType(spv::OpTypeFunction, operands);
+}
+
+uint32_t SpirvModuleBuilder::TypeSize()
+{
+    return TypeInt(addressing_model == spv::AddressingModelPhysical64 ? 64
+                                                                      : 32);
+}
+
+// Constants take the result type before the result id
+uint32_t SpirvModuleBuilder::Constant(uint32_t type,
+                                      const std::vector<uint32_t> &words)
+{
+    std::vector<uint32_t> key = { spv::OpConstant, type };
+    key.insert(key.end(), words.begin(), words.end());
+    auto it = declared.find(key);
+    if (it != declared.end()) return it->second;
+
+    uint32_t id = NewId();
+    std::vector<uint32_t> operands = { type, id };
+    operands.insert(operands.end(), words.begin(), words.end());
+    Append(declarations, spv::OpConstant, operands);
+    declared[key] = id;
+    return id;
+}
+
+uint32_t
+SpirvModuleBuilder::ConstantComposite(uint32_t type,
+                                      const std::vector<uint32_t> &constituents)
+{
+    std::vector<uint32_t> key = { spv::OpConstantComposite, type };
+    key.insert(key.end(), constituents.begin(), constituents.end());
+    auto it = declared.find(key);
+    if (it != declared.end()) return it->second;
+
+    uint32_t id = NewId();
+    std::vector<uint32_t> operands = { type, id };
+    operands.insert(operands.end(), constituents.begin(), constituents.end());
+    Append(declarations, spv::OpConstantComposite, operands);
+    declared[key] = id;
+    return id;
+}
+
+uint32_t SpirvModuleBuilder::BuiltInVariable(spv::BuiltIn builtin)
+{
+    std::vector<uint32_t> key = { spv::OpVariable, spv::DecorationBuiltIn,
+                                  static_cast<uint32_t>(builtin) };
+    auto it = declared.find(key);
+    if (it != declared.end()) return it->second;
+
+    uint32_t pointer =
+        TypePointer(spv::StorageClassInput, TypeVector(TypeSize(), 3));
+    uint32_t id = NewId();
+    Append(declarations, spv::OpVariable,
+           { pointer, id, spv::StorageClassInput });
+    AddDecoration(id, spv::DecorationBuiltIn,
+                  { static_cast<uint32_t>(builtin) });
+    AddDecoration(id, spv::DecorationConstant);
+    interface.push_back(id);
+    declared[key] = id;
+    return id;
+}
+
+uint32_t
+SpirvModuleBuilder::BeginKernel(const std::string &name,
+                                const std::vector<uint32_t> &parameter_types,
+                                std::vector<uint32_t> &parameters)
+{
+    uint32_t void_type = TypeVoid();
+    uint32_t function_type = TypeFunction(void_type, parameter_types);
+
+    uint32_t function = NewId();
+    Append(functions, spv::OpFunction,
+           { void_type, function, spv::FunctionControlMaskNone,
+             function_type });
+    parameters.clear();
+    for (uint32_t type : parameter_types)
+    {
+        parameters.push_back(NewId());
+        Append(functions, spv::OpFunctionParameter,
+               { type, parameters.back() });
+    }
+    BeginBlock(NewId());
+
+    AddName(function, name);
+    entry_points.emplace_back(function, name);
+    return function;
+}
+
+void SpirvModuleBuilder::BeginBlock(uint32_t label)
+{
+    Append(functions, spv::OpLabel, { label });
+}
+
+void SpirvModuleBuilder::EndKernel()
+{
+    Append(functions, spv::OpReturn, {});
+    Append(functions, spv::OpFunctionEnd, {});
+}
+
+uint32_t SpirvModuleBuilder::Emit(spv::Op op, uint32_t result_type,
+                                  const std::vector<uint32_t> &operands)
+{
+    uint32_t id = NewId();
+    std::vector<uint32_t> with_result = { result_type, id };
+    with_result.insert(with_result.end(), operands.begin(), operands.end());
+    Append(functions, op, with_result);
+    return id;
+}
+
+void SpirvModuleBuilder::EmitNoResult(spv::Op op,
+                                      const std::vector<uint32_t> &operands)
+{
+    Append(functions, op, operands);
+}
+
+std::vector<uint32_t> SpirvModuleBuilder::Words() const
+{
+    std::vector<uint32_t> words = { spv::MagicNumber, version, 0, bound, 0 };
+
+    for (uint32_t capability : capabilities)
+        Append(words, spv::OpCapability, { capability });
+    Append(words, spv::OpMemoryModel,
+           { static_cast<uint32_t>(addressing_model),
+             spv::MemoryModelOpenCL });
+    for (const auto &entry_point : entry_points)
+    {
+        std::vector<uint32_t> operands = { spv::ExecutionModelKernel,
+                                           entry_point.first };
+        std::vector<uint32_t> string = StringWords(entry_point.second);
+        operands.insert(operands.end(), string.begin(), string.end());
+        operands.insert(operands.end(), interface.begin(), interface.end());
+        Append(words, spv::OpEntryPoint, operands);
+    }
+
+    for (const std::vector<uint32_t> *section :
+         { &names, &annotations, &declarations, &functions })
+        words.insert(words.end(), section->begin(), section->end());
+    return words;
+}
+
+std::vector<unsigned char> SpirvModuleBuilder::Binary() const
+{
+    std::vector<uint32_t> words = Words();
+    std::vector<unsigned char> binary(words.size() * sizeof(uint32_t));
+    memcpy(binary.data(), words.data(), binary.size());
+    return binary;
+}
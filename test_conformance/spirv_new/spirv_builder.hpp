@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <spirv/unified1/spirv.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Builds SPIR-V modules in memory, so that tests can sweep types, vector
+// widths and addressing models without a prebuilt binary per variant, and
+// generate modules of any size. Instructions are stored in the section of
+// the module that the logical layout requires, so types, constants and
+// decorations can be declared while a function body is being emitted. Types
+// and constants are deduplicated.
+//
+// The builder covers what OpenCL kernels need and does not validate the
+// module; consumers are expected to report invalid modules.
+class SpirvModuleBuilder {
+public:
+    // Starts a module for the OpenCL memory model with the Addresses, Kernel
+    // and, for Physical64, Int64 capabilities
+    explicit SpirvModuleBuilder(spv::AddressingModel addressing_model,
+                                uint32_t version = 0x00010000);
+
+    uint32_t NewId() { return bound++; }
+
+    void AddCapability(spv::Capability capability);
+    void AddName(uint32_t id, const std::string &name);
+    void AddDecoration(uint32_t id, spv::Decoration decoration,
+                       const std::vector<uint32_t> &literals = {});
+
+    uint32_t TypeVoid();
+    uint32_t TypeBool();
+    // OpenCL integer types are signless
+    uint32_t TypeInt(uint32_t width);
+    uint32_t TypeFloat(uint32_t width);
+    uint32_t TypeVector(uint32_t component_type, uint32_t count);
+    uint32_t TypePointer(spv::StorageClass storage_class, uint32_t pointee);
+    uint32_t TypeFunction(uint32_t return_type,
+                          const std::vector<uint32_t> &parameter_types);
+    // Integer type of size_t for the addressing model
+    uint32_t TypeSize();
+
+    // Scalar constant given as 32-bit words, low order word first
+    uint32_t Constant(uint32_t type, const std::vector<uint32_t> &words);
+    uint32_t ConstantComposite(uint32_t type,
+                               const std::vector<uint32_t> &constituents);
+
+    // Input variable of three size_t values decorated with builtin, such as
+    // spv::BuiltInGlobalInvocationId. It is listed in the interface of every
+    // entry point.
+    uint32_t BuiltInVariable(spv::BuiltIn builtin);
+
+    // Starts a kernel entry point taking parameters of the given types and
+    // its first block. The ids of the parameters are stored in parameters.
+    uint32_t BeginKernel(const std::string &name,
+                         const std::vector<uint32_t> &parameter_types,
+                         std::vector<uint32_t> &parameters);
+    // Starts a block with the given label in the current function
+    void BeginBlock(uint32_t label);
+    // Emits OpReturn and ends the current function
+    void EndKernel();
+
+    // Appends an instruction with a new result id to the current function and
+    // returns the id
+    uint32_t Emit(spv::Op op, uint32_t result_type,
+                  const std::vector<uint32_t> &operands);
+    // Appends an instruction without a result to the current function
+    void EmitNoResult(spv::Op op, const std::vector<uint32_t> &operands = {});
+
+    std::vector<uint32_t> Words() const;
+    std::vector<unsigned char> Binary() const;
+
+private:
+    uint32_t DeclareType(spv::Op op, const std::vector<uint32_t> &operands);
+
+    static void Append(std::vector<uint32_t> &section, spv::Op op,
+                       const std::vector<uint32_t> &operands);
+    static std::vector<uint32_t> StringWords(const std::string &string);
+
+    spv::AddressingModel addressing_model;
+    uint32_t version;
+    uint32_t bound = 1;
+
+    std::vector<uint32_t> capabilities;
+    std::vector<std::pair<uint32_t, std::string>> entry_points;
+    std::vector<uint32_t> interface;
+    std::vector<uint32_t> names;
+    std::vector<uint32_t> annotations;
+    std::vector<uint32_t> declarations;
+    std::vector<uint32_t> functions;
+
+    // Deduplication of types, constants and builtin variables, keyed by
+    // opcode and operands other than the result id
+    std::map<std::vector<uint32_t>, uint32_t> declared;
+};
@@ -15,6 +15,7 @@
 //
 
 #include "testBase.h"
+#include "spirv_builder.hpp"
 #include "types.hpp"
 
 #include <sstream>
@@ -127,3 +128,206 @@ TEST_NOT(short)
 TEST_NEG_VEC(float  , 4)
 TEST_NEG_VEC(int    , 4)
 TEST_NOT_VEC(int    , 4)
+
+namespace {
+
+struct GeneratedType
+{
+    const char *name;
+    bool is_float;
+    uint32_t bits;
+    spv::Capability capability;
+};
+
+// Kernel that applies op to each element of its argument in place, as in the
+// op_neg and op_not modules in spirv_asm
+std::vector<unsigned char> generate_negation(spv::AddressingModel model,
+                                             const GeneratedType &type,
+                                             uint32_t width, spv::Op op,
+                                             const std::string &name)
+{
+    SpirvModuleBuilder builder(model);
+    builder.AddCapability(type.capability);
+    if (width > 4) builder.AddCapability(spv::CapabilityVector16);
+
+    uint32_t scalar = type.is_float ? builder.TypeFloat(type.bits)
+                                    : builder.TypeInt(type.bits);
+    uint32_t element =
+        width == 1 ? scalar : builder.TypeVector(scalar, width);
+    uint32_t pointer =
+        builder.TypePointer(spv::StorageClassCrossWorkgroup, element);
+    uint32_t size_type = builder.TypeSize();
+
+    std::vector<uint32_t> parameters;
+    builder.BeginKernel(name, { pointer }, parameters);
+    builder.AddName(parameters[0], "in");
+    uint32_t ids = builder.Emit(
+        spv::OpLoad, builder.TypeVector(size_type, 3),
+        { builder.BuiltInVariable(spv::BuiltInGlobalInvocationId) });
+    uint32_t gid = builder.Emit(spv::OpCompositeExtract, size_type, { ids, 0 });
+    uint32_t address = builder.Emit(spv::OpInBoundsPtrAccessChain, pointer,
+                                    { parameters[0], gid });
+    uint32_t value = builder.Emit(spv::OpLoad, element, { address });
+    uint32_t result = builder.Emit(op, element, { value });
+    builder.EmitNoResult(spv::OpStore, { address, result });
+    builder.EndKernel();
+    return builder.Binary();
+}
+
+// Reference result of op on a component, computed on its bit pattern
+uint64_t negation_reference(const GeneratedType &type, spv::Op op,
+                            uint64_t bits)
+{
+    uint64_t mask = type.bits == 64 ? ~0ULL : (1ULL << type.bits) - 1;
+    switch (op)
+    {
+        case spv::OpFNegate: return bits ^ (1ULL << (type.bits - 1));
+        case spv::OpNot: return ~bits & mask;
+        default: return (0 - bits) & mask;
+    }
+}
+
+int test_generated_negation(cl_device_id device, cl_context context,
+                            cl_command_queue queue, spv::AddressingModel model,
+                            const GeneratedType &type, uint32_t width,
+                            spv::Op op, const char *op_name, MTdata d)
+{
+    std::string name = std::string(op_name) + "_generated_" + type.name;
+    if (width > 1) name += std::to_string(width);
+
+    const size_t num = 4096;
+    const size_t component_size = type.bits / 8;
+    const size_t count = num * width;
+    std::vector<uint64_t> h_in(count);
+    for (uint64_t &bits : h_in)
+    {
+        bits = ((uint64_t)genrand_int32(d) << 32) | genrand_int32(d);
+        if (type.bits < 64) bits &= (1ULL << type.bits) - 1;
+        if (type.is_float)
+        {
+            // Keep inputs finite and normal so that the result is exact
+            uint32_t mantissa_bits = type.bits == 64 ? 52 : 23;
+            uint64_t exponent_mask = type.bits == 64 ? 0x7ff : 0xff;
+            uint64_t exponent = (bits >> mantissa_bits) & exponent_mask;
+            if (exponent == 0 || exponent == exponent_mask)
+                bits ^= (exponent ^ (exponent_mask >> 1)) << mantissa_bits;
+        }
+    }
+
+    // Components are packed at their natural size in the buffer
+    std::vector<unsigned char> bytes(count * component_size);
+    for (size_t i = 0; i < count; i++)
+        memcpy(&bytes[i * component_size], &h_in[i], component_size);
+
+    cl_int err = CL_SUCCESS;
+    clMemWrapper in = clCreateBuffer(context, CL_MEM_READ_WRITE
+                                         | CL_MEM_COPY_HOST_PTR,
+                                     bytes.size(), bytes.data(), &err);
+    SPIRV_CHECK_ERROR(err, "Failed to create in buffer");
+
+    clProgramWrapper prog;
+    err = get_program_with_il(prog, device, context,
+                              generate_negation(model, type, width, op, name));
+    SPIRV_CHECK_ERROR(err, "Failed to build generated program %s",
+                      name.c_str());
+
+    clKernelWrapper kernel = clCreateKernel(prog, name.c_str(), &err);
+    SPIRV_CHECK_ERROR(err, "Failed to create spv kernel");
+
+    err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &in);
+    SPIRV_CHECK_ERROR(err, "Failed to set arg 1");
+
+    size_t global = num;
+    err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global, NULL, 0,
+                                 NULL, NULL);
+    SPIRV_CHECK_ERROR(err, "Failed to enqueue cl kernel");
+
+    err = clEnqueueReadBuffer(queue, in, CL_TRUE, 0, bytes.size(),
+                              bytes.data(), 0, NULL, NULL);
+    SPIRV_CHECK_ERROR(err, "Failed to read from in buffer");
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t out = 0;
+        memcpy(&out, &bytes[i * component_size], component_size);
+        uint64_t expected = negation_reference(type, op, h_in[i]);
+        if (out != expected)
+        {
+            log_error("%s: values do not match at component %zu, got 0x%llx, "
+                      "expected 0x%llx\n",
+                      name.c_str(), i, (unsigned long long)out,
+                      (unsigned long long)expected);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+// Sweeps the integer and floating-point types and vector widths of OpSNegate,
+// OpFNegate and OpNot with modules generated in memory
+REGISTER_TEST(op_negate_generated)
+{
+    if (gCompilationMode != kOnline)
+    {
+        log_info("Skipping op_negate_generated, compilation mode not online\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    cl_uint address_bits = 0;
+    cl_int err = clGetDeviceInfo(device, CL_DEVICE_ADDRESS_BITS,
+                                 sizeof(address_bits), &address_bits, NULL);
+    SPIRV_CHECK_ERROR(err, "Failed to get address bits");
+    spv::AddressingModel model = address_bits == 32
+        ? spv::AddressingModelPhysical32
+        : spv::AddressingModelPhysical64;
+
+    const GeneratedType types[] = {
+        { "char", false, 8, spv::CapabilityInt8 },
+        { "short", false, 16, spv::CapabilityInt16 },
+        { "int", false, 32, spv::CapabilityKernel },
+        { "long", false, 64, spv::CapabilityInt64 },
+        { "float", true, 32, spv::CapabilityKernel },
+        { "double", true, 64, spv::CapabilityFloat64 },
+    };
+    const uint32_t widths[] = { 1, 2, 4, 8, 16 };
+
+    RandomSeed seed(gRandomSeed);
+    int variants = 0;
+    for (const GeneratedType &type : types)
+    {
+        if (type.capability == spv::CapabilityInt64 && !gHasLong)
+        {
+            log_info("Device does not support long; skipping long tests.\n");
+            continue;
+        }
+        if (type.capability == spv::CapabilityFloat64
+            && !is_extension_available(device, "cl_khr_fp64"))
+        {
+            log_info("Extension cl_khr_fp64 not supported; skipping double "
+                     "tests.\n");
+            continue;
+        }
+
+        for (uint32_t width : widths)
+        {
+            const std::pair<spv::Op, const char *> ops[] = {
+                { type.is_float ? spv::OpFNegate : spv::OpSNegate, "op_neg" },
+                { spv::OpNot, "op_not" },
+            };
+            for (const auto &op : ops)
+            {
+                if (op.first == spv::OpNot && type.is_float) continue;
+                if (test_generated_negation(device, context, queue, model,
+                                            type, width, op.first, op.second,
+                                            seed))
+                    return TEST_FAIL;
+                variants++;
+            }
+        }
+    }
+
+    log_info("Tested %d generated variants.\n", variants);
+    return TEST_PASS;
+}
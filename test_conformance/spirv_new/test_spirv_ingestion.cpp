@@ -0,0 +1,436 @@
+//
+// Copyright (c) 2025 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "testBase.h"
+#include "spirv_builder.hpp"
+#include "harness/csvHelpers.h"
+#include "harness/parseParameters.h"
+#include "harness/profilingStats.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Benchmark of how fast kernels given as SPIR-V are consumed compared to the
+// same kernels given as OpenCL C source. Each kernel is created, built and
+// dispatched once from both forms, and the latency of each step is reported.
+// Kernels come from existing modules in spirv_bin, with their OpenCL C
+// equivalent below, and from chains of integer operations of increasing
+// length that are generated in both forms. The two forms of every kernel
+// must produce the same results.
+//
+// Every program is made unique, with a comment in OpenCL C and an OpString
+// in SPIR-V, so that compiler caches do not serve repeated measurements.
+// Results are appended to the file named by CL_SPIRV_INGESTION_CSV if it is
+// set.
+//
+// The longest chains and all repetitions only run with --benchmark. Otherwise
+// short chains are built twice, which checks that both forms agree.
+
+namespace {
+
+struct IngestionCase
+{
+    std::string name;
+    std::string kernel_name;
+    std::string source;
+    std::vector<unsigned char> spirv;
+};
+
+struct IngestionTimes
+{
+    double create = 0.0;
+    double build = 0.0;
+    double dispatch = 0.0;
+
+    double Total() const { return create + build + dispatch; }
+};
+
+const struct
+{
+    const char *name;
+    const char *source;
+} existing_modules[] = {
+    { "op_neg_int4",
+      "__kernel void op_neg_int4(__global int4 *in)\n"
+      "{\n"
+      "    size_t i = get_global_id(0);\n"
+      "    in[i] = -in[i];\n"
+      "}\n" },
+    { "op_neg_float4",
+      "__kernel void op_neg_float4(__global float4 *in)\n"
+      "{\n"
+      "    size_t i = get_global_id(0);\n"
+      "    in[i] = -in[i];\n"
+      "}\n" },
+    { "op_not_int4",
+      "__kernel void op_not_int4(__global int4 *in)\n"
+      "{\n"
+      "    size_t i = get_global_id(0);\n"
+      "    in[i] = ~in[i];\n"
+      "}\n" },
+};
+
+const unsigned int chain_lengths[] = { 256, 4096, 32768 };
+const unsigned int smoke_chain_lengths[] = { 256, 2048 };
+
+const unsigned int ingestion_reps = 5;
+const unsigned int smoke_reps = 2;
+const size_t dispatch_items = 1024;
+// Large enough for dispatch_items elements of any of the kernels
+const size_t dispatch_bytes = dispatch_items * 4 * sizeof(cl_int);
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// Kernel of length steps of x = (x * c) ^ (x >> s) on an element of a uint
+// buffer, in OpenCL C and in SPIR-V
+IngestionCase generate_chain(spv::AddressingModel model, unsigned int length,
+                             MTdata d)
+{
+    IngestionCase chain;
+    chain.name = "chain_" + std::to_string(length);
+    chain.kernel_name = "ingestion_chain";
+    chain.source = "__kernel void ingestion_chain(__global uint *data)\n"
+                   "{\n"
+                   "    size_t i = get_global_id(0);\n"
+                   "    uint x = data[i];\n";
+
+    SpirvModuleBuilder builder(model);
+    uint32_t uint_type = builder.TypeInt(32);
+    uint32_t pointer =
+        builder.TypePointer(spv::StorageClassCrossWorkgroup, uint_type);
+    uint32_t size_type = builder.TypeSize();
+
+    std::vector<uint32_t> parameters;
+    builder.BeginKernel(chain.kernel_name, { pointer }, parameters);
+    uint32_t ids = builder.Emit(
+        spv::OpLoad, builder.TypeVector(size_type, 3),
+        { builder.BuiltInVariable(spv::BuiltInGlobalInvocationId) });
+    uint32_t gid = builder.Emit(spv::OpCompositeExtract, size_type, { ids, 0 });
+    uint32_t address = builder.Emit(spv::OpInBoundsPtrAccessChain, pointer,
+                                    { parameters[0], gid });
+    uint32_t x = builder.Emit(spv::OpLoad, uint_type, { address });
+
+    for (unsigned int i = 0; i < length; i++)
+    {
+        uint32_t multiplier = genrand_int32(d) | 1;
+        uint32_t shift = 1 + genrand_int32(d) % 31;
+        chain.source += "    x = (x * " + std::to_string(multiplier)
+            + "u) ^ (x >> " + std::to_string(shift) + "u);\n";
+
+        uint32_t product = builder.Emit(
+            spv::OpIMul, uint_type,
+            { x, builder.Constant(uint_type, { multiplier }) });
+        uint32_t shifted =
+            builder.Emit(spv::OpShiftRightLogical, uint_type,
+                         { x, builder.Constant(uint_type, { shift }) });
+        x = builder.Emit(spv::OpBitwiseXor, uint_type, { product, shifted });
+    }
+
+    chain.source += "    data[i] = x;\n"
+                    "}\n";
+    builder.EmitNoResult(spv::OpStore, { address, x });
+    builder.EndKernel();
+    chain.spirv = builder.Binary();
+    return chain;
+}
+
+// Copy of a module with an OpString holding salt inserted at the start of
+// its debug instructions
+std::vector<unsigned char> salt_spirv(const std::vector<unsigned char> &binary,
+                                      uint32_t salt)
+{
+    std::vector<uint32_t> words(binary.size() / sizeof(uint32_t));
+    memcpy(words.data(), binary.data(), words.size() * sizeof(uint32_t));
+    if (words.size() < 5 || words[0] != spv::MagicNumber) return binary;
+
+    size_t offset = 5;
+    while (offset < words.size())
+    {
+        uint32_t opcode = words[offset] & 0xffff;
+        uint32_t word_count = words[offset] >> 16;
+        if (word_count == 0
+            || (opcode != spv::OpCapability && opcode != spv::OpExtension
+                && opcode != spv::OpExtInstImport
+                && opcode != spv::OpMemoryModel
+                && opcode != spv::OpEntryPoint
+                && opcode != spv::OpExecutionMode
+                && opcode != spv::OpExecutionModeId))
+            break;
+        offset += word_count;
+    }
+
+    std::string string = std::to_string(salt);
+    std::vector<uint32_t> instruction(2 + string.size() / 4 + 1, 0);
+    instruction[0] =
+        (static_cast<uint32_t>(instruction.size()) << 16) | spv::OpString;
+    instruction[1] = words[3]++;
+    memcpy(&instruction[2], string.data(), string.size());
+    words.insert(words.begin() + offset, instruction.begin(),
+                 instruction.end());
+
+    std::vector<unsigned char> salted(words.size() * sizeof(uint32_t));
+    memcpy(salted.data(), words.data(), salted.size());
+    return salted;
+}
+
+cl_int build_and_dispatch(cl_device_id device, cl_command_queue queue,
+                          cl_program program, const std::string &kernel_name,
+                          cl_mem buffer, IngestionTimes &times)
+{
+    clock_type::time_point start = clock_type::now();
+    cl_int error = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
+    times.build = seconds_since(start);
+    if (error != CL_SUCCESS)
+    {
+        OutputBuildLog(program, device);
+        test_error(error, "clBuildProgram failed");
+    }
+
+    start = clock_type::now();
+    clKernelWrapper kernel =
+        clCreateKernel(program, kernel_name.c_str(), &error);
+    test_error(error, "clCreateKernel failed");
+    error = clSetKernelArg(kernel, 0, sizeof(buffer), &buffer);
+    test_error(error, "clSetKernelArg failed");
+    error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &dispatch_items,
+                                   NULL, 0, NULL, NULL);
+    test_error(error, "clEnqueueNDRangeKernel failed");
+    error = clFinish(queue);
+    test_error(error, "clFinish failed");
+    times.dispatch = seconds_since(start);
+    return CL_SUCCESS;
+}
+
+cl_int measure_source(cl_device_id device, cl_context context,
+                      cl_command_queue queue, const IngestionCase &c,
+                      uint32_t salt, cl_mem buffer,
+                      clProgramWrapper &program, IngestionTimes &times)
+{
+    std::string source = "// " + std::to_string(salt) + "\n" + c.source;
+    const char *source_ptr = source.c_str();
+
+    cl_int error = CL_SUCCESS;
+    clock_type::time_point start = clock_type::now();
+    program =
+        clCreateProgramWithSource(context, 1, &source_ptr, NULL, &error);
+    times.create = seconds_since(start);
+    test_error(error, "clCreateProgramWithSource failed");
+
+    return build_and_dispatch(device, queue, program, c.kernel_name, buffer,
+                              times);
+}
+
+cl_int measure_spirv(cl_device_id device, cl_context context,
+                     cl_command_queue queue,
+                     clCreateProgramWithILKHR_fn create_program_with_il,
+                     const IngestionCase &c, uint32_t salt, cl_mem buffer,
+                     clProgramWrapper &program, IngestionTimes &times)
+{
+    std::vector<unsigned char> spirv = salt_spirv(c.spirv, salt);
+
+    cl_int error = CL_SUCCESS;
+    clock_type::time_point start = clock_type::now();
+    program =
+        create_program_with_il(context, spirv.data(), spirv.size(), &error);
+    times.create = seconds_since(start);
+    test_error(error, "Failed to create program with IL");
+
+    return build_and_dispatch(device, queue, program, c.kernel_name, buffer,
+                              times);
+}
+
+// Runs the kernel of both programs on the same input and compares the results
+cl_int check_equivalent(cl_context context, cl_command_queue queue,
+                        const std::string &kernel_name,
+                        cl_program source_program, cl_program spirv_program,
+                        MTdata d)
+{
+    // Floats in [1, 2), which every kernel handles exactly
+    std::vector<cl_uint> input(dispatch_bytes / sizeof(cl_uint));
+    for (cl_uint &value : input)
+        value = 0x3f800000 | (genrand_int32(d) & 0x007fffff);
+
+    std::vector<cl_uint> results[2];
+    cl_program programs[2] = { source_program, spirv_program };
+    for (int i = 0; i < 2; i++)
+    {
+        cl_int error = CL_SUCCESS;
+        clMemWrapper buffer =
+            clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                           dispatch_bytes, input.data(), &error);
+        test_error(error, "clCreateBuffer failed");
+        clKernelWrapper kernel =
+            clCreateKernel(programs[i], kernel_name.c_str(), &error);
+        test_error(error, "clCreateKernel failed");
+        error = clSetKernelArg(kernel, 0, sizeof(buffer), &buffer);
+        test_error(error, "clSetKernelArg failed");
+        error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL,
+                                       &dispatch_items, NULL, 0, NULL, NULL);
+        test_error(error, "clEnqueueNDRangeKernel failed");
+
+        results[i].resize(input.size());
+        error = clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0, dispatch_bytes,
+                                    results[i].data(), 0, NULL, NULL);
+        test_error(error, "clEnqueueReadBuffer failed");
+    }
+
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        if (results[0][i] != results[1][i])
+        {
+            log_error("ERROR: %s differs between OpenCL C and SPIR-V at word "
+                      "%zu: 0x%08x vs 0x%08x\n",
+                      kernel_name.c_str(), i, results[0][i], results[1][i]);
+            return TEST_FAIL;
+        }
+    }
+    return CL_SUCCESS;
+}
+
+IngestionTimes median_times(const std::vector<IngestionTimes> &reps)
+{
+    IngestionTimes median;
+    auto median_of = [&](double IngestionTimes::*field) {
+        std::vector<double> values;
+        for (const IngestionTimes &times : reps)
+            values.push_back(times.*field);
+        median.*field = compute_sample_stats(values).median;
+    };
+    median_of(&IngestionTimes::create);
+    median_of(&IngestionTimes::build);
+    median_of(&IngestionTimes::dispatch);
+    return median;
+}
+
+} // anonymous namespace
+
+REGISTER_TEST(spirv_ingestion)
+{
+    if (gCompilationMode != kOnline)
+    {
+        log_info("Skipping spirv_ingestion, compilation mode not online\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    clCreateProgramWithILKHR_fn create_program_with_il =
+        get_create_program_with_il(device);
+    if (create_program_with_il == NULL) return TEST_FAIL;
+
+    cl_uint address_bits = 0;
+    cl_int error = clGetDeviceInfo(device, CL_DEVICE_ADDRESS_BITS,
+                                   sizeof(address_bits), &address_bits, NULL);
+    test_error(error, "Unable to get address bits");
+    spv::AddressingModel model = address_bits == 32
+        ? spv::AddressingModelPhysical32
+        : spv::AddressingModelPhysical64;
+
+    RandomSeed seed(gRandomSeed);
+    std::vector<IngestionCase> cases;
+    for (const auto &module : existing_modules)
+    {
+        IngestionCase c;
+        c.name = c.kernel_name = module.name;
+        c.source = module.source;
+        c.spirv = readSPIRV(module.name);
+        if (c.spirv.empty())
+        {
+            log_info("Module %s not found; skipping it.\n", module.name);
+            continue;
+        }
+        cases.push_back(c);
+    }
+    bool full_sweep = gBenchmarkMode && !gWimpyMode;
+    if (full_sweep)
+        for (unsigned int length : chain_lengths)
+            cases.push_back(generate_chain(model, length, seed));
+    else
+        for (unsigned int length : smoke_chain_lengths)
+            cases.push_back(generate_chain(model, length, seed));
+
+    FILE *file =
+        open_results_csv("CL_SPIRV_INGESTION_CSV",
+                         "kernel,form,size,create_ms,build_ms,dispatch_ms");
+
+    std::vector<cl_uint> zeros(dispatch_bytes / sizeof(cl_uint), 0);
+    clMemWrapper buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                       dispatch_bytes, zeros.data(), &error);
+    test_error(error, "clCreateBuffer failed");
+
+    unsigned int reps = full_sweep ? ingestion_reps : smoke_reps;
+    log_info("%-14s %-9s %8s %10s %10s %12s %10s\n", "kernel", "form", "bytes",
+             "create ms", "build ms", "dispatch ms", "total ms");
+    int result = TEST_PASS;
+    for (const IngestionCase &c : cases)
+    {
+        std::vector<IngestionTimes> source_reps(reps), spirv_reps(reps);
+        clProgramWrapper source_program, spirv_program;
+        for (unsigned int rep = 0; rep < reps; rep++)
+        {
+            error = measure_source(device, context, queue, c,
+                                   genrand_int32(seed), buffer, source_program,
+                                   source_reps[rep]);
+            test_error(error, "Unable to ingest OpenCL C");
+            error = measure_spirv(device, context, queue,
+                                  create_program_with_il, c,
+                                  genrand_int32(seed), buffer, spirv_program,
+                                  spirv_reps[rep]);
+            test_error(error, "Unable to ingest SPIR-V");
+        }
+
+        error = check_equivalent(context, queue, c.kernel_name,
+                                 source_program, spirv_program, seed);
+        if (error != CL_SUCCESS) result = TEST_FAIL;
+
+        const struct
+        {
+            const char *form;
+            size_t size;
+            IngestionTimes times;
+        } forms[] = {
+            { "opencl_c", c.source.size(), median_times(source_reps) },
+            { "spirv", c.spirv.size(), median_times(spirv_reps) },
+        };
+        for (const auto &form : forms)
+        {
+            const IngestionTimes &t = form.times;
+            log_info("%-14s %-9s %8zu %10.3f %10.3f %12.3f %10.3f\n",
+                     c.name.c_str(), form.form, form.size, 1e3 * t.create,
+                     1e3 * t.build, 1e3 * t.dispatch, 1e3 * t.Total());
+            log_perf(1e3 * t.Total(), false, "ms", "%s %s", c.name.c_str(),
+                     form.form);
+            if (file)
+                fprintf(file, "%s,%s,%zu,%.4f,%.4f,%.4f\n", c.name.c_str(),
+                        form.form, form.size, 1e3 * t.create, 1e3 * t.build,
+                        1e3 * t.dispatch);
+        }
+        log_info("%-14s SPIR-V takes %.2fx the time of OpenCL C\n",
+                 c.name.c_str(),
+                 forms[1].times.Total() / forms[0].times.Total());
+    }
+
+    if (file) fclose(file);
+    return result;
+}
@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 #include "harness/compat.h"
+#include "harness/deviceVerify.h"
 #include "harness/kernelHelpers.h"
 #include "harness/testHarness.h"
 #include "harness/errorHelpers.h"
@@ -307,7 +308,7 @@ int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
              cl_mem array, cl_uint memory_size, cl_uint dimensions,
              cl_uint final_x_size, cl_uint final_y_size, cl_uint final_z_size,
              cl_uint local_x_size, cl_uint local_y_size, cl_uint local_z_size,
-             int explict_local)
+             int explict_local, DeviceVerifier &verifier)
 {
     cl_uint errors = 0;
     size_t global_size[3], local_size[3];
@@ -430,45 +431,66 @@ int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
             return -3;
         }
 
-        void *mapped = clEnqueueMapBuffer(queue, array, CL_TRUE, CL_MAP_READ, 0,
-                                          memory_size, 0, NULL, NULL, &err);
+        cl_uint last_address =
+            (cl_uint)(end_valid_memory_address - start_valid_memory_address)
+            / (cl_uint)sizeof(cl_uint);
+
+        // Verify the data on the device, and only map it if it is wrong
+        const cl_uint expected = 1;
+        DeviceVerifyResult verify_result;
+        err = verifier.CompareWithPattern(
+            queue, array, 0, (size_t)last_address * sizeof(cl_uint), &expected,
+            sizeof(expected), verify_result);
         if (err != CL_SUCCESS)
         {
-            print_error(err, "Failed to map results\n");
+            print_error(err, "Failed to verify results\n");
             return -4;
         }
-        cl_uint *data = (cl_uint *)mapped;
 
-        // Verify the data
-        cl_uint i;
-        cl_uint last_address =
-            (cl_uint)(end_valid_memory_address - start_valid_memory_address)
-            / (cl_uint)sizeof(cl_uint);
-        for (i = 0; i < last_address; i++)
+        if (verify_result.mismatches)
         {
-            if (i < last_address)
+            log_info("\t\t\t%" PRIu64 " mismatches, the first at index %" PRIu64
+                     ".\n",
+                     verify_result.mismatches, verify_result.first_mismatch);
+
+            void *mapped =
+                clEnqueueMapBuffer(queue, array, CL_TRUE, CL_MAP_READ, 0,
+                                   memory_size, 0, NULL, NULL, &err);
+            if (err != CL_SUCCESS)
             {
-                if (data[i] != 1)
-                {
-                    errors++;
-                    //        log_info("%d expected 1 got %d\n", i, data[i]);
-                }
+                print_error(err, "Failed to map results\n");
+                return -4;
             }
-            else
+            cl_uint *data = (cl_uint *)mapped;
+
+            // Count the errors on the host
+            cl_uint i;
+            for (i = 0; i < last_address; i++)
             {
-                if (data[i] != 0)
+                if (i < last_address)
+                {
+                    if (data[i] != 1)
+                    {
+                        errors++;
+                        // log_info("%d expected 1 got %d\n", i, data[i]);
+                    }
+                }
+                else
                 {
-                    errors++;
-                    log_info("%d expected 0 got %d\n", i, data[i]);
+                    if (data[i] != 0)
+                    {
+                        errors++;
+                        log_info("%d expected 0 got %d\n", i, data[i]);
+                    }
                 }
             }
-        }
 
-        err = clEnqueueUnmapMemObject(queue, array, mapped, 0, NULL, NULL);
-        if (err != CL_SUCCESS)
-        {
-            print_error(err, "Failed to unmap results\n");
-            return -4;
+            err = clEnqueueUnmapMemObject(queue, array, mapped, 0, NULL, NULL);
+            if (err != CL_SUCCESS)
+            {
+                print_error(err, "Failed to unmap results\n");
+                return -4;
+            }
         }
 
         err = clFlush(queue);
@@ -518,6 +540,7 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
     cl_uint device_max_dimensions;
     int use_atomics = 1;
     MTdata d;
+    DeviceVerifier verifier(context);
 
     char dim_str[128];
     char dim_str2[128];
@@ -1054,7 +1077,7 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
                             run_test(context, queue, kernel, array, memory_size,
                                      dimensions, final_x_size, final_y_size,
                                      final_z_size, local_x_size, local_y_size,
-                                     local_z_size, explicit_local);
+                                     local_z_size, explicit_local, verifier);
 
                         // If we failed to execute, then return so we don't
                         // crash.